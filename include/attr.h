@@ -50,6 +50,8 @@ typedef struct attr_t {
 // ---------------------------------------------------------------------------------------------------------------------
 
 attr_id_t attr_create(const char *name, enum field_type data_type, size_t data_type_rep, schema_t *schema);
+attr_id_t attr_create_ex(const char *name, enum field_type data_type, size_t data_type_rep, int flags,
+                         schema_t *schema);
 const char *attr_name(const struct attr_t *attr);
 bool attr_isstring(const attr_t *attr);
 size_t attr_str_max_len(attr_t *attr);
@@ -57,6 +59,13 @@ enum field_type attr_type(const attr_t *attr);
 const attr_t *attr_cpy(const attr_t *template, schema_t *new_owner);
 size_t attr_total_size(const struct attr_t *attr);
 
+/*!
+ * @brief Returns the size of a (decoded) value of <i>attr</i>. This equals attr_total_size() unless the attribute is
+ * dictionary-encoded or of variable length, in which case attr_total_size() is the size of a code resp. a string
+ * header stored in a field.
+ */
+size_t attr_value_size(const struct attr_t *attr);
+
 DECLARE_ATTRIBUTE_CREATE(bool, FT_BOOL)
 DECLARE_ATTRIBUTE_CREATE(int8, FT_INT8)
 DECLARE_ATTRIBUTE_CREATE(int16, FT_INT16)
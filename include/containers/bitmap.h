@@ -0,0 +1,64 @@
+// An implementation of a word-aligned bitmap
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define BITMAP_WORD_NBITS   64
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* A bitmap is a plain array of 64-bit words. The number of words is always rounded up such that a bitmap for n bits
+ * can be processed word-at-a-time without any special handling of the last (partial) word. */
+typedef u64 bitmap_word_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t bitmap_nwords(size_t nbits);
+bitmap_word_t *bitmap_new(size_t nbits, bool value);
+bitmap_word_t *bitmap_resize(bitmap_word_t *bitmap, size_t old_nbits, size_t new_nbits, bool value);
+void bitmap_free(bitmap_word_t *bitmap);
+size_t bitmap_popcount(const bitmap_word_t *bitmap, size_t nbits);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N L I N E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+static inline void bitmap_set(bitmap_word_t *bitmap, size_t pos)
+{
+    bitmap[pos / BITMAP_WORD_NBITS] |= (1ULL << (pos % BITMAP_WORD_NBITS));
+}
+
+static inline void bitmap_clear(bitmap_word_t *bitmap, size_t pos)
+{
+    bitmap[pos / BITMAP_WORD_NBITS] &= ~(1ULL << (pos % BITMAP_WORD_NBITS));
+}
+
+static inline bool bitmap_test(const bitmap_word_t *bitmap, size_t pos)
+{
+    return ((bitmap[pos / BITMAP_WORD_NBITS] >> (pos % BITMAP_WORD_NBITS)) & 1ULL);
+}
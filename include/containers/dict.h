@@ -0,0 +1,60 @@
+// An implementation of a string dictionary for dictionary encoding
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <apr_pools.h>
+#include <apr_hash.h>
+#include <containers/vec.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+typedef u32 dict_code_t;
+
+/* A dictionary assigns dense integer codes 0, 1, 2, ... to distinct strings in the order in which the strings are
+ * encoded first. Each distinct string is stored exactly once; decoding a code is a single array access. */
+typedef struct dict_t {
+    apr_pool_t *pool; /*!< memory for the distinct strings and the hash table */
+    apr_hash_t *codes; /*!< maps a string to (a pointer to) its code */
+    vec_t *strings; /*!< maps a code to its string, i.e., the i-th element is the string with code i */
+} dict_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+dict_t *dict_new(size_t capacity);
+void dict_free(dict_t *dict);
+
+/*!
+ * @brief Returns the code of <i>str</i>, and adds <i>str</i> to the dictionary if it is not contained yet.
+ */
+dict_code_t dict_encode(dict_t *dict, const char *str);
+
+/*!
+ * @brief Looks up the code of <i>str</i> without modifying the dictionary.
+ *
+ * @return <b>true</b> and stores the code in <i>code</i> if <i>str</i> is contained, or <b>false</b> otherwise
+ */
+bool dict_lookup(dict_code_t *code, const dict_t *dict, const char *str);
+
+const char *dict_decode(const dict_t *dict, dict_code_t code);
+size_t dict_size(const dict_t *dict);
@@ -0,0 +1,82 @@
+// A HyperLogLog sketch to estimate the number of distinct values in a multiset
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define HLL_PRECISION   12                      /*!< log2 of the number of registers; the standard error is about
+                                                     1.04 / sqrt(HLL_NREGISTERS), i.e., 1.6% */
+#define HLL_NREGISTERS  (1 << HLL_PRECISION)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* Each value is hashed to 64 bits, of which the first HLL_PRECISION bits select a register, and the register keeps the
+ * maximum position of the first set bit in the remaining bits. Sketches of the same precision are merged by taking the
+ * maximum per register, which yields exactly the sketch of the union of both multisets. Values cannot be removed. */
+typedef struct hll_t {
+    u8 registers[HLL_NREGISTERS];
+} hll_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void hll_create(hll_t *hll);
+
+/*!
+ * @brief Returns a 64-bit hash of the <i>size</i> bytes at <i>data</i> that is suited for hll_add().
+ */
+u64 hll_hash(const void *data, size_t size);
+
+/*!
+ * @brief Returns a 64-bit hash of <i>value</i> that is suited for hll_add().
+ */
+static inline u64 hll_hash_u64(u64 value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+static inline void hll_add(hll_t *hll, u64 hash)
+{
+    size_t idx = hash >> (64 - HLL_PRECISION);
+    u64 rest = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));
+    u8 rank = __builtin_clzll(rest) + 1;
+    hll->registers[idx] = max(hll->registers[idx], rank);
+}
+
+/*!
+ * @brief Adds all values of <i>src</i> to <i>dst</i>.
+ */
+void hll_merge(hll_t *dst, const hll_t *src);
+
+/*!
+ * @brief Returns the estimated number of distinct values that were added to <i>hll</i>.
+ */
+double hll_estimate(const hll_t *hll);
@@ -0,0 +1,84 @@
+// A concurrent allocator of 32-bit identifiers with per-thread caches
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <stdatomic.h>
+#include "range_tree.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define ID_ALLOCATOR_CACHE_SIZE   256 /*!< minimum number of released ids a thread claims from the pool at once */
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct id_cache_t;
+
+/* Hands out identifiers that are unique among all threads. Never used identifiers are reserved per call in a single
+ * contiguous range from an atomic high-water mark, and released identifiers are collected in a shared pool of ranges
+ * from which the threads refill their own caches in batches. Hence, the common case (i.e., binding identifiers) neither
+ * locks nor touches cache lines that are written by other threads. Since the pool coalesces adjacent ranges and hands
+ * out the smallest range first, identifiers that are released together are mostly bound together again. */
+typedef struct id_allocator_t {
+    atomic_uint_fast64_t high_water; /*!< the smallest identifier that was not reserved by any thread yet */
+    pthread_mutex_t latch; /*!< protects 'released' and 'caches' */
+    range_tree_t released; /*!< released identifiers that are not claimed by the cache of a thread */
+    atomic_size_t nreleased; /*!< number of identifiers in 'released', which is read without latch to skip an empty
+                                  pool */
+    struct id_cache_t *caches; /*!< the caches of all threads that bound identifiers from this allocator */
+} id_allocator_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void id_allocator_create(id_allocator_t *allocator);
+
+/*!
+ * @brief Disposes <i>allocator</i>. Must not be called while other threads bind or release identifiers of
+ * <i>allocator</i>. Caches of threads that are still alive are freed by these threads later on.
+ */
+void id_allocator_dispose(id_allocator_t *allocator);
+
+/*!
+ * @brief Writes <i>num_ids</i> identifiers to <i>out</i> that are not bound by any thread. Released identifiers are
+ * bound before never used ones, in ascending order of their ranges. Safe to be called from several threads at once.
+ */
+void id_allocator_bind(u32 *out, id_allocator_t *allocator, size_t num_ids);
+
+/*!
+ * @brief Returns the identifiers <i>ids</i> to <i>allocator</i> such that these can be bound again. Safe to be called
+ * from several threads at once. Runs of consecutive identifiers are released in O(log n) each, for n released ranges.
+ */
+void id_allocator_release(id_allocator_t *allocator, const u32 *ids, size_t num_ids);
+
+/*!
+ * @brief Returns the identifiers [<i>begin</i>, <i>end</i>) to <i>allocator</i> in O(log n), for n released ranges.
+ */
+void id_allocator_release_range(id_allocator_t *allocator, u32 begin, u32 end);
+
+/*!
+ * @brief Returns the smallest identifier that was not reserved by any thread yet, i.e., all identifiers that were
+ * ever bound are less than this one.
+ */
+u64 id_allocator_high_water(const id_allocator_t *allocator);
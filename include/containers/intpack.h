@@ -0,0 +1,132 @@
+// An implementation of lightweight integer compression (frame-of-reference, delta and bit-packing)
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <field_type.h>
+#include <containers/bitmap.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifndef INTPACK_BLOCK_SIZE
+#define INTPACK_BLOCK_SIZE 1024 /*!< number of values per compressed block; must be a multiple of 64 */
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+enum intpack_scheme {
+    IPS_BITPACK, /*!< values are packed as they are with the bit width of the largest value */
+    IPS_FOR,     /*!< frame-of-reference, i.e., the difference to the block minimum is packed */
+    IPS_DELTA    /*!< the difference to the preceding value, minus the smallest such difference, is packed */
+};
+
+/* Values are compressed in a normalized domain: each value is widened to u64 such that the order of values is
+ * preserved (unsigned values are zero-extended, signed values are sign-extended with the sign bit flipped). A block
+ * chooses its scheme from the observed min/max (resp. the range of differences for delta), and packs one code of
+ * 'width' bits per value. For bit-packing and frame-of-reference, value i is 'base + code i'. */
+typedef struct intpack_block_t {
+    enum intpack_scheme scheme; /*!< the scheme chosen for this block */
+    u32 count; /*!< number of values in this block */
+    u8 width; /*!< number of bits per code in [0, 64] */
+    u64 min; /*!< smallest normalized value in this block */
+    u64 max; /*!< largest normalized value in this block */
+    u64 base; /*!< reference value for bit-packing and frame-of-reference, or the smallest difference for delta */
+    u64 first; /*!< first normalized value in this block (delta only) */
+    u64 words[]; /*!< codes, where code i occupies the bits [i * width, (i + 1) * width), plus one padding word */
+} intpack_block_t;
+
+/* A sequence of compressed blocks of INTPACK_BLOCK_SIZE values each, i.e., value i is stored in the block
+ * i / INTPACK_BLOCK_SIZE */
+typedef struct intpack_column_t {
+    enum field_type type; /*!< the integer type of the (decompressed) values */
+    size_t nblocks; /*!< number of blocks in 'blocks' */
+    size_t capacity; /*!< number of blocks for which 'blocks' provides space */
+    intpack_block_t **blocks; /*!< the compressed blocks */
+} intpack_column_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Returns <b>true</b> iff values of type <i>type</i> can be compressed, i.e., for FT_INT* and FT_UINT*
+ */
+bool intpack_supports(enum field_type type);
+
+u64 intpack_normalize(const void *value, enum field_type type);
+void intpack_denormalize(void *dst, u64 value, enum field_type type);
+
+/*!
+ * @brief Compresses <i>count</i> values of type <i>type</i> stored consecutively at <i>values</i> into a new block,
+ * using the scheme that results in the smallest code width.
+ */
+intpack_block_t *intpack_encode(const void *values, size_t count, enum field_type type);
+void intpack_free(intpack_block_t *block);
+
+/*!
+ * @brief Returns the size in bytes of <i>block</i>, including its header
+ */
+size_t intpack_size(const intpack_block_t *block);
+
+/*!
+ * @brief Unpacks all codes of <i>block</i> into <i>dst</i>, which must provide space for <code>block->count</code>
+ * values. Uses AVX2 if the CPU supports it.
+ */
+void intpack_unpack(u64 *dst, const intpack_block_t *block);
+
+/*!
+ * @brief Decompresses all values of <i>block</i> into <i>dst</i> as values of type <i>type</i>
+ */
+void intpack_decode(void *dst, const intpack_block_t *block, enum field_type type);
+
+/*!
+ * @brief Decompresses the <i>idx</i>-th value of <i>block</i> into <i>dst</i> as a value of type <i>type</i>. This
+ * takes constant time for bit-packing and frame-of-reference, and linear time in <i>idx</i> for delta.
+ */
+void intpack_get(void *dst, const intpack_block_t *block, size_t idx, enum field_type type);
+
+/*!
+ * @brief Evaluates <code>lower <= value <= upper</code> for each value in <i>block</i> on the compressed data, and
+ * sets the bit <code>offset + i</code> in <i>result</i> iff the i-th value qualifies.
+ *
+ * The bounds are normalized values, see intpack_normalize(). The block is skipped if its min/max excludes the range.
+ * For bit-packing and frame-of-reference, the bounds are translated into the code domain such that codes are compared
+ * without decompressing the values.
+ *
+ * @return The number of qualifying values
+ */
+size_t intpack_select_between(bitmap_word_t *result, size_t offset, const intpack_block_t *block, u64 lower, u64 upper);
+
+intpack_column_t *intpack_column_new(enum field_type type);
+void intpack_column_free(intpack_column_t *column);
+
+/*!
+ * @brief Compresses <i>INTPACK_BLOCK_SIZE</i> values at <i>values</i> and appends the block to <i>column</i>
+ *
+ * @return The size in bytes of the new block
+ */
+size_t intpack_column_append(intpack_column_t *column, const void *values);
+size_t intpack_column_num_of_values(const intpack_column_t *column);
+size_t intpack_column_size(const intpack_column_t *column);
+void intpack_column_get(void *dst, const intpack_column_t *column, size_t idx);
+void intpack_column_decode(void *dst, const intpack_column_t *column);
@@ -0,0 +1,68 @@
+// A balanced search tree of disjoint, coalesced integer ranges
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct range_node_t;
+
+/* A set of integers that is stored as right-open ranges [begin, end) in a treap ordered by 'begin'. Ranges in the tree
+ * never overlap or touch each other, since adjacent ranges are merged on insertion. Hence, freeing a contiguous run of
+ * n integers costs a single node, and inserting or taking a range costs O(log r) expected time for r ranges. */
+typedef struct range_tree_t {
+    struct range_node_t *root; /*!< the root of the treap, or NULL if the tree is empty */
+    size_t num_ranges; /*!< number of (disjoint) ranges in the tree */
+    u64 num_elements; /*!< number of integers in all ranges */
+    u64 seed; /*!< state of the generator for the node priorities */
+} range_tree_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void range_tree_create(range_tree_t *tree);
+void range_tree_dispose(range_tree_t *tree);
+
+/*!
+ * @brief Adds the integers [<i>begin</i>, <i>end</i>) to <i>tree</i>, and merges them with the ranges right before
+ * and right after.
+ *
+ * @return <b>false</b> if some of these integers are contained in <i>tree</i> already (in which case <i>tree</i> is
+ * not modified), and <b>true</b> otherwise
+ */
+bool range_tree_insert(range_tree_t *tree, u64 begin, u64 end);
+
+/*!
+ * @brief Removes at most <i>max_length</i> integers from the beginning of the smallest range in <i>tree</i>, and
+ * returns these as [<i>begin</i>, <i>end</i>).
+ *
+ * @return <b>false</b> if <i>tree</i> is empty, and <b>true</b> otherwise
+ */
+bool range_tree_take_first(u64 *begin, u64 *end, range_tree_t *tree, u64 max_length);
+
+bool range_tree_contains(const range_tree_t *tree, u64 value);
+
+static inline bool range_tree_is_empty(const range_tree_t *tree)
+{
+    return (tree->root == NULL);
+}
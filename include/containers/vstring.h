@@ -0,0 +1,100 @@
+// An implementation of variable-length strings with inline prefixes and a string heap
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define VSTRING_PREFIX_LEN    4  /*!< number of leading bytes stored in each header */
+#define VSTRING_INLINE_MAXLEN 11 /*!< longest string stored inside the header, excluding its terminating zero */
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* A 16-byte string header. Strings of at most VSTRING_INLINE_MAXLEN bytes are stored in the header itself, starting
+ * at 'prefix' and zero-terminated. Longer strings are stored in a string heap at 'offset', and the header keeps a copy
+ * of their first VSTRING_PREFIX_LEN bytes. Unused bytes are zero, such that two headers with equal length and prefix
+ * words can be compared without touching the heap for most values. */
+typedef struct vstring_t {
+    u32 length; /*!< length of the string in bytes, excluding the terminating zero */
+    char prefix[VSTRING_PREFIX_LEN]; /*!< first bytes of the string; for inline strings, the first bytes of the value */
+    union {
+        char suffix[8]; /*!< remaining bytes of an inline string */
+        u64 offset; /*!< position of the (zero-terminated) string in the heap */
+    };
+} vstring_t;
+
+/* An append-only buffer of zero-terminated strings that are addressed by their offset, i.e., positions stay valid
+ * if the buffer is re-allocated. Space of overwritten strings is reclaimed by compaction into a new heap. */
+typedef struct strheap_t {
+    char *data; /*!< the string data */
+    size_t size; /*!< number of bytes in use */
+    size_t capacity; /*!< number of bytes for which 'data' provides space */
+} strheap_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+strheap_t *strheap_new(size_t capacity);
+void strheap_free(strheap_t *heap);
+
+/*!
+ * @brief Appends the first <i>length</i> bytes of <i>str</i> followed by a zero to <i>heap</i>
+ *
+ * @return The offset of the new string in <i>heap</i>
+ */
+u64 strheap_add(strheap_t *heap, const char *str, size_t length);
+const char *strheap_get(const strheap_t *heap, u64 offset);
+size_t strheap_size(const strheap_t *heap);
+
+/*!
+ * @brief Initializes <i>dst</i> for the string <i>str</i>, and appends <i>str</i> to <i>heap</i> if it is too long
+ * to be stored inline.
+ */
+void vstring_make(vstring_t *dst, strheap_t *heap, const char *str);
+
+/*!
+ * @brief Moves the string of <i>str</i> from heap <i>src</i> to heap <i>dst</i> and updates the offset accordingly.
+ * Inline strings are not affected.
+ */
+void vstring_move(vstring_t *str, const strheap_t *src, strheap_t *dst);
+
+const char *vstring_str(const vstring_t *str, const strheap_t *heap);
+
+static inline bool vstring_is_inline(const vstring_t *str)
+{
+    return (str->length <= VSTRING_INLINE_MAXLEN);
+}
+
+/*!
+ * @brief Returns <b>true</b> iff <i>lhs</i> (stored in <i>lhs_heap</i>) and <i>rhs</i> (stored in <i>rhs_heap</i>)
+ * are equal. Strings of different length or prefix are rejected by a single comparison of the header's first word.
+ */
+bool vstring_equals(const vstring_t *lhs, const strheap_t *lhs_heap, const vstring_t *rhs, const strheap_t *rhs_heap);
+
+/*!
+ * @brief Returns <b>true</b> iff the string <i>str</i> starts with the first <i>length</i> bytes of <i>prefix</i>.
+ * Prefixes of at most VSTRING_PREFIX_LEN bytes are evaluated on the header only.
+ */
+bool vstring_has_prefix(const vstring_t *str, const strheap_t *heap, const char *prefix, size_t length);
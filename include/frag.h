@@ -23,8 +23,33 @@
 #include <tuplet.h>
 #include <frag_printer.h>
 #include <containers/vec.h>
+#include <containers/bitmap.h>
+#include <containers/dict.h>
+#include <containers/intpack.h>
+#include <containers/vstring.h>
+#include <frag_allocator.h>
 #include <frags/frag_host_vm.h>
 
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifndef FRAG_DICT_CAPACITY
+#define FRAG_DICT_CAPACITY 1024 /*!< initial number of distinct strings per dictionary-encoded attribute */
+#endif
+
+#ifndef FRAG_STRHEAP_CAPACITY
+#define FRAG_STRHEAP_CAPACITY 4096 /*!< initial size in bytes of the string heap for variable-length strings */
+#endif
+
+#ifndef FRAG_VIEW_BATCH_SIZE
+#define FRAG_VIEW_BATCH_SIZE 1024 /*!< default maximum number of values in a single batch of a column view */
+#endif
+
+#ifndef FRAG_ZONE_NTUPLETS
+#define FRAG_ZONE_NTUPLETS 1024 /*!< number of tuplets summarized by a single zone map entry */
+#endif
+
 // ---------------------------------------------------------------------------------------------------------------------
 // F O R W A R D I N G
 // ---------------------------------------------------------------------------------------------------------------------
@@ -38,17 +63,92 @@ struct tuplet_t;
 
 enum frag_impl_type_t {
     FIT_HOST_NSM_VM,
-    FIT_HOST_DSM_VM
+    FIT_HOST_DSM_VM,
+    FIT_HOST_PAX_VM,
+    FIT_HOST_NSM_MMAP,
+    FIT_HOST_NSM_SEG
 };
 
+/* Summary of the values of one attribute in one block of FRAG_ZONE_NTUPLETS tuplets. Bounds are conservative: they
+ * are widened on each write but not narrowed on overwrites, hence they include every value in the block. */
+typedef struct frag_zone_t {
+    u64 min; /*!< smallest key (see frag_zone_key()) of a non-null value in this block */
+    u64 max; /*!< largest key of a non-null value in this block; 'min > max' iff there is no such value */
+    u32 null_count; /*!< number of NULL values in this block */
+} frag_zone_t;
+
+/* Location of the fields of one attribute inside the tuplet data of a fragment. */
+typedef struct frag_field_layout_t {
+    const attr_t *attr; /*!< the attribute in the fragment schema */
+    enum field_type type; /*!< the type of the attribute */
+    size_t size; /*!< size in bytes of a stored field, i.e., attr_total_size() */
+    size_t offset; /*!< offset in bytes of the field inside an NSM tuplet, which is the sum of the sizes of all
+                        preceding attributes. For PAX, the mini-column starts at 'offset * page_ntuplets' in a page. */
+} frag_field_layout_t;
+
+/* Immutable description of the tuplet layout of a fragment that is built once when the fragment is created, such that
+ * a field is addressed by a single indexed lookup regardless of its attribute position. The base pointers of DSM
+ * columns are not part of the layout, since columns move when they grow or are (de)compressed; these are indexed by
+ * attribute in 'tuplet_data'. */
+typedef struct frag_layout_t {
+    size_t nattrs; /*!< number of attributes, i.e., entries in 'fields' */
+    size_t page_ntuplets; /*!< number of tuplets per PAX mini-page, or 0 for other formats */
+    frag_field_layout_t fields[]; /*!< per-attribute field layout */
+} frag_layout_t;
+
+/* A batch of consecutive fields of one attribute that are equidistant in memory. The i-th value of the batch belongs
+ * to the tuplet 'begin + i' and is located at 'base + i * stride'. Values are in their stored representation, i.e.,
+ * dictionary codes for dictionary-encoded attributes and vstring_t headers for variable-length strings. */
+typedef struct frag_column_view_t {
+    const void *base; /*!< address of the field of tuplet 'begin' */
+    size_t stride; /*!< distance in bytes between two consecutive values, i.e., the tuplet size for NSM fragments and
+                        the attribute size for DSM fragments */
+    size_t count; /*!< number of values in this batch */
+    tuplet_id_t begin; /*!< tuplet id of the first value in this batch */
+    const bitmap_word_t *validity; /*!< validity bitmap of the attribute indexed by tuplet id, or NULL if the
+                                        attribute contains no NULL value */
+    const bitmap_word_t *tombstones; /*!< tombstones of the fragment indexed by tuplet id, or NULL if no tuplet was
+                                          deleted */
+} frag_column_view_t;
+
+/* Iterates the fields of one attribute in a range of tuplets in batches, see frag_column_open() */
+typedef struct frag_column_cursor_t {
+    struct frag_t *frag; /*!< fragment that is iterated */
+    attr_id_t attr_id; /*!< attribute that is iterated */
+    tuplet_id_t next; /*!< first tuplet of the next batch */
+    tuplet_id_t end; /*!< end (exclusive) of the tuplet range */
+    size_t batch_size; /*!< maximum number of values per batch */
+    void *buffer; /*!< values of a decompressed block for compressed columns, or NULL */
+    size_t buffer_block; /*!< id of the compressed block in 'buffer', or SIZE_MAX */
+} frag_column_cursor_t;
+
 typedef struct frag_t {
     schema_t *schema; /*!< schema of this fragment */
-    void *tuplet_data; /*!< data inside this fragment; the record format (e.g., NSM/DSM) is implementation-specific */
+    frag_layout_t *layout; /*!< layout of the tuplets in this fragment, built from 'schema' and 'format' */
+    void *tuplet_data; /*!< data inside this fragment; the record format (e.g., NSM/DSM) is implementation-specific.
+                         For DSM, this is an array of per-attribute column segment base pointers */
     size_t ntuplets; /*!< number of tuplets stored in this fragment */
     size_t ncapacity; /*!< number of tuplets that can be stored in this fragment, before a resize-opp is required */
     size_t tuplet_size; /*!< size in byte of a single tuplet */
-    enum tuplet_format format; /*!< the tuplet format that defined whether NSM or DSM is used*/
+    enum tuplet_format format; /*!< the tuplet format that defined whether NSM, DSM or PAX is used*/
     enum frag_impl_type_t impl_type; /*!< the implementation type of the data fragment*/
+    bitmap_word_t **validity; /*!< per-attribute validity bitmap (bit set iff value is non-null) over 'ncapacity'
+                                   tuplets, padded to 64-bit words. An entry is NULL as long as the attribute has no
+                                   NULL value, i.e., dense columns do not pay for a bitmap. */
+    size_t *null_counts; /*!< per-attribute number of NULL values in this fragment */
+    bitmap_word_t *tombstones; /*!< deletion bitmap (bit set iff tuplet is deleted) over 'ncapacity' tuplets. NULL as
+                                    long as no tuplet in this fragment was deleted. */
+    size_t ndeleted; /*!< number of tuplets marked as deleted, i.e., not yet reclaimed by compaction */
+    dict_t **dictionaries; /*!< per-attribute string dictionary for dictionary-encoded attributes (FLAG_DICTIONARY),
+                                NULL for all other attributes. Fields of encoded attributes store a dict_code_t. */
+    strheap_t *strings; /*!< heap of the variable-length strings (FLAG_VARLEN) in this fragment, or NULL if there is
+                             no such attribute. Fields of these attributes store a vstring_t. */
+    frag_zone_t **zones; /*!< per-attribute zone map with one entry per FRAG_ZONE_NTUPLETS tuplets over 'ncapacity'.
+                              An entry is NULL for attributes without a total order (i.e., strings). */
+    intpack_column_t **packed; /*!< per-attribute compressed prefix of a column (see frag_compress), or NULL if the
+                                    implementation does not compress. An entry is NULL for uncompressed columns. */
+    void *extra; /*!< implementation-specific state (e.g., the backing file of a mapped fragment), or NULL */
+    frag_allocator_t *allocator; /*!< allocator for the tuplet data, or NULL if the implementation maps its storage */
 
     /* operations */
     struct frag_t *(*_scan)(struct frag_t *self, const pred_tree_t *pred, size_t batch_size, size_t nthreads);
@@ -60,15 +160,32 @@ typedef struct frag_t {
     /*!< inserts a number of (uninitialized) ntuplets into this fragment and returns a tuplet pointer to the first
      * tuplets of these newly added tuplets. */
     void (*_insert)(struct tuplet_t *dst, struct frag_t *self, size_t ntuplets);
+
+    /*!< writes the tuplets in [begin, end) back to persistent storage; NULL for volatile fragments */
+    void (*_flush)(struct frag_t *self, tuplet_id_t begin, tuplet_id_t end);
+
+    /*!< writes 'count' values of attribute 'attr_id' into the tuplets in [begin, begin + count) */
+    void (*_write)(struct frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void *values);
+
+    /*!< locates the fields of attribute 'attr_id' in up to 'count' tuplets starting at 'begin' that are equidistant
+     * in memory, and returns how many these are; 'begin' is behind a compressed prefix of the column */
+    size_t (*_view)(struct frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void **base,
+                    size_t *stride);
+
+    /*!< compresses the tuplet data and returns the number of bytes saved; NULL if not supported */
+    size_t (*_compress)(struct frag_t *self);
 } frag_t;
 
 
 static struct frag_type_pool_t {
     enum frag_impl_type_t binding;
-    frag_t *(*_create)(schema_t *schema, size_t tuplet_capacity);
+    frag_t *(*_create)(schema_t *schema, size_t tuplet_capacity, frag_allocator_t *allocator);
 } frag_type_pool[] = {
     { FIT_HOST_NSM_VM, frag_host_vm_nsm_new },
     { FIT_HOST_DSM_VM, frag_host_vm_dsm_new },
+    { FIT_HOST_PAX_VM, frag_host_vm_pax_new },
+    { FIT_HOST_NSM_MMAP, frag_host_mmap_nsm_new },
+    { FIT_HOST_NSM_SEG, frag_host_seg_nsm_new },
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -78,9 +195,39 @@ static struct frag_type_pool_t {
 __BEGIN_DECLS
 
 frag_t *frag_new(schema_t *schema, size_t tuplet_capacity, enum frag_impl_type_t type);
+
+/*!
+ * @brief Creates a new fragment like frag_new() but allocates its tuplet data via the allocator <i>allocator_type</i>
+ * rather than FRAG_DEFAULT_ALLOCATOR.
+ */
+frag_t *frag_new_ex(schema_t *schema, size_t tuplet_capacity, enum frag_impl_type_t type,
+                    frag_allocator_type_tag allocator_type);
+
+/*!
+ * @brief Creates or re-opens a file-backed NSM fragment stored at <i>path</i>, see frag_host_mmap_open(). Fragments
+ * of type FIT_HOST_NSM_MMAP obtained from frag_new() use an anonymous temporary file instead.
+ */
+frag_t *frag_new_mapped(schema_t *schema, const char *path, size_t tuplet_capacity);
 void frag_delete(frag_t *frag);
 
 void frag_insert(struct tuplet_t *out, frag_t *frag, size_t ntuplets);
+
+/*!
+ * @brief Writes <i>count</i> values of attribute <i>attr_id</i> into the tuplets [<i>begin</i>, <i>begin</i> +
+ * <i>count</i>) and marks these fields as non-null.
+ *
+ * <i>values</i> is a dense array of <i>count</i> values of the attribute's type, or of <code>const char *</code> for
+ * string attributes. Columns of DSM fragments and mini-columns of PAX fragments are filled by a single memcpy per
+ * contiguous range; NSM fragments copy the values with the tuplet size as stride.
+ */
+void frag_write_column(frag_t *frag, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void *values);
+
+/*!
+ * @brief Synchronously writes the tuplets in the range [<i>begin</i>, <i>end</i>) of a file-backed fragment to its
+ * backing store. This is a no-op for fragments that are not persistent.
+ */
+void frag_flush(frag_t *frag, tuplet_id_t begin, tuplet_id_t end);
+void frag_flush_all(frag_t *frag);
 void frag_print(FILE *file, frag_t *frag, size_t row_offset, size_t limit);
 void frag_print_ex(FILE *file, enum frag_printer_type_tag printer_type, frag_t *frag, size_t row_offset, size_t limit);
 const char *frag_str(enum frag_impl_type_t type);
@@ -89,6 +236,178 @@ size_t frag_num_of_tuplets(const frag_t *frag);
 schema_t *frag_schema(const frag_t *frag);
 enum field_type frag_field_type(const frag_t *frag, attr_id_t id);
 
+/*!
+ * @brief Returns the layout of the fields of attribute <i>attr_id</i> in <i>frag</i>, see frag_layout_t.
+ */
+const frag_field_layout_t *frag_field_layout(const frag_t *frag, attr_id_t attr_id);
+
+// N U L L   V A L U E S -----------------------------------------------------------------------------------------------
+
+void frag_set_null(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+void frag_set_valid(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+bool frag_is_null(const frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+size_t frag_null_count(const frag_t *frag, attr_id_t attr_id);
+const size_t *frag_null_counts(const frag_t *frag);
+
+/*!
+ * @brief Returns the validity bitmap of the attribute <i>attr_id</i> in <i>frag</i>, or <b>NULL</b> if this attribute
+ * contains no NULL values at all. In the latter case, callers can skip NULL checks for this column entirely.
+ */
+const bitmap_word_t *frag_validity(const frag_t *frag, attr_id_t attr_id);
+
+/*!
+ * @brief Adjusts the per-tuplet bookkeeping (e.g., validity bitmaps) of <i>frag</i> to a changed tuplet capacity.
+ * Must be called by fragment implementations whenever 'ncapacity' changes.
+ */
+void frag_bookkeeping_resize(frag_t *frag, size_t old_capacity, size_t new_capacity);
+
+// V A R I A B L E - L E N G T H   S T R I N G S ---------------------------------------------------------------------
+
+/*!
+ * @brief Returns the heap of the variable-length strings in <i>frag</i>, or <b>NULL</b> if no attribute is of
+ * variable length.
+ */
+const strheap_t *frag_string_heap(const frag_t *frag);
+
+/*!
+ * @brief Moves the strings referenced by the tuplets of <i>frag</i> into a new heap, which drops the space of
+ * overwritten strings and of strings of removed tuplets. This is called by frag_compact().
+ *
+ * @return The number of bytes reclaimed
+ */
+size_t frag_strings_compact(frag_t *frag);
+
+// Z O N E   M A P S ---------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Maps <i>value</i> of type <i>type</i> to an unsigned key with the same order, such that keys of all numeric
+ * types are compared as u64. For integers, this is intpack_normalize().
+ */
+u64 frag_zone_key(enum field_type type, const void *value);
+
+/*!
+ * @brief Widens the zone map entry of the block containing <i>tuplet_id</i> by <i>value</i>. Must be called by
+ * fragment implementations whenever a (non-null) value is written.
+ */
+void frag_zone_add(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id, const void *value);
+
+/*!
+ * @brief Returns the number of zone map entries that cover the tuplets of <i>frag</i>
+ */
+size_t frag_num_of_zones(const frag_t *frag);
+
+/*!
+ * @brief Returns the zone map entry of attribute <i>attr_id</i> for the tuplets
+ * [<i>block_id</i> * FRAG_ZONE_NTUPLETS, (<i>block_id</i> + 1) * FRAG_ZONE_NTUPLETS), or <b>NULL</b> if the attribute
+ * has no zone map.
+ */
+const frag_zone_t *frag_zone(const frag_t *frag, attr_id_t attr_id, size_t block_id);
+
+/*!
+ * @brief Returns <b>false</b> if no value of attribute <i>attr_id</i> in block <i>block_id</i> can be in the range
+ * [<i>lower</i>, <i>upper</i>], i.e., if a scan can skip this block. Returns <b>true</b> if the block might contain
+ * such a value, or if the attribute has no zone map.
+ */
+bool frag_zone_overlaps(const frag_t *frag, attr_id_t attr_id, size_t block_id, const void *lower, const void *upper);
+
+/*!
+ * @brief Recomputes all zone map entries of <i>frag</i> from its tuplets, which narrows bounds that were widened by
+ * overwritten values.
+ */
+void frag_zones_rebuild(frag_t *frag);
+
+// D I C T I O N A R Y   E N C O D I N G -------------------------------------------------------------------------------
+
+/*!
+ * @brief Returns the dictionary of the dictionary-encoded attribute <i>attr_id</i>, or <b>NULL</b> if the attribute
+ * is not encoded.
+ */
+dict_t *frag_dictionary(const frag_t *frag, attr_id_t attr_id);
+
+// C O M P R E S S I O N -----------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Compresses the tuplet data of <i>frag</i>. This is a no-op for fragments that do not support compression.
+ *
+ * DSM fragments compress each integer column in blocks of INTPACK_BLOCK_SIZE tuplets, choosing frame-of-reference,
+ * delta or bit-packing per block (see intpack.h). Only entire blocks are compressed, and the compressed blocks form a
+ * prefix of the column; the remaining tuplets stay uncompressed such that inserts are not affected. Reads decode
+ * single values, while scans (e.g., select_int_between()) evaluate predicates on the compressed blocks. Updating a
+ * compressed tuplet decompresses its column. Calling this function again compresses blocks filled since the last call.
+ *
+ * @return The number of bytes saved
+ */
+size_t frag_compress(frag_t *frag);
+
+/*!
+ * @brief Returns the compressed prefix of the column <i>attr_id</i>, or <b>NULL</b> if this column is not compressed.
+ * Tuplets behind this prefix are stored uncompressed.
+ */
+const intpack_column_t *frag_packed_column(const frag_t *frag, attr_id_t attr_id);
+
+// C O L U M N   V I E W S ---------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Opens a cursor over the fields of attribute <i>attr_id</i> in the tuplets [<i>begin</i>, <i>end</i>) of
+ * <i>frag</i>, which returns these fields in batches of at most <i>batch_size</i> values via frag_column_next().
+ *
+ * Other than tuplet_next() and tuplet_field_next(), each batch is described by a base pointer and a stride (see
+ * frag_column_view_t) such that operators can process it in a tight loop. A batch never spans a region in which fields
+ * are not equidistant, e.g., a PAX mini-page or a segment of a segmented fragment, hence batches can be shorter than
+ * <i>batch_size</i>. Compressed blocks of DSM columns are decoded into a buffer owned by the cursor. The fragment must
+ * not be modified while the cursor is open.
+ */
+void frag_column_open(frag_column_cursor_t *cursor, frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,
+                      tuplet_id_t end, size_t batch_size);
+
+/*!
+ * @brief Moves <i>cursor</i> to the next batch and returns it in <i>view</i>, or returns <b>false</b> if there is no
+ * batch left. The view is valid until the next call.
+ */
+bool frag_column_next(frag_column_view_t *view, frag_column_cursor_t *cursor);
+void frag_column_close(frag_column_cursor_t *cursor);
+
+/*!
+ * @brief Returns the address of the <i>idx</i>-th value in <i>view</i>
+ */
+static inline const void *frag_column_view_at(const frag_column_view_t *view, size_t idx)
+{
+    return view->base + idx * view->stride;
+}
+
+/*!
+ * @brief Returns <b>true</b> if the <i>idx</i>-th value in <i>view</i> is neither NULL nor in a deleted tuplet
+ */
+static inline bool frag_column_view_is_valid(const frag_column_view_t *view, size_t idx)
+{
+    tuplet_id_t tuplet_id = view->begin + idx;
+    return ((view->validity == NULL || bitmap_test(view->validity, tuplet_id)) &&
+            (view->tombstones == NULL || !bitmap_test(view->tombstones, tuplet_id)));
+}
+
+// T O M B S T O N E S -------------------------------------------------------------------------------------------------
+
+void frag_tuplet_delete(frag_t *frag, tuplet_id_t tuplet_id);
+bool frag_is_deleted(const frag_t *frag, tuplet_id_t tuplet_id);
+size_t frag_num_of_deleted(const frag_t *frag);
+size_t frag_num_of_live_tuplets(const frag_t *frag);
+float frag_dead_ratio(const frag_t *frag);
+
+/*!
+ * @brief Returns the tombstone bitmap of <i>frag</i>, or <b>NULL</b> if no tuplet was deleted. Scans combine this
+ * bitmap word-wise with their selection (<code>sel & ~tombstones</code>) to drop deleted tuplets.
+ */
+const bitmap_word_t *frag_tombstones(const frag_t *frag);
+
+/*!
+ * @brief Physically removes all deleted tuplets from <i>frag</i> by moving live tuplets down, preserving their order.
+ *
+ * @param removed If non-null, receives the (pre-compaction) tuplet ids of the removed tuplets in ascending order.
+ *                Must provide space for <code>frag_num_of_deleted(frag)</code> entries.
+ * @return The number of tuplets removed
+ */
+size_t frag_compact(frag_t *frag, tuplet_id_t *removed);
+
 void gs_checksum_nsm(schema_t *tab, const void *tuplets, size_t ntuplets);
 void gs_checksum_dms(schema_t *tab, const void *tuplets, size_t ntuplets);
 void gs_checksum_begin(checksum_context_t *context);
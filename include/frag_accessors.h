@@ -0,0 +1,131 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// M A C R O S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* All field types for which specialized accessors are generated, as (name, C type, field type). */
+#define FRAG_ACCESSOR_TYPES(X)                                                                                         \
+    X(boolean, BOOL,    FT_BOOL)                                                                                       \
+    X(int8,    INT8,    FT_INT8)                                                                                       \
+    X(int16,   INT16,   FT_INT16)                                                                                      \
+    X(int32,   INT32,   FT_INT32)                                                                                      \
+    X(int64,   INT64,   FT_INT64)                                                                                      \
+    X(uint8,   UINT8,   FT_UINT8)                                                                                      \
+    X(uint16,  UINT16,  FT_UINT16)                                                                                     \
+    X(uint32,  UINT32,  FT_UINT32)                                                                                     \
+    X(uint64,  UINT64,  FT_UINT64)                                                                                     \
+    X(float32, FLOAT32, FT_FLOAT32)                                                                                    \
+    X(float64, FLOAT64, FT_FLOAT64)
+
+/* Generates the accessors frag_nsm_<name>_*() for fields of type 'ftype' in NSM fragments with a contiguous tuplet
+ * buffer. Fields are located by the fragment layout; since NSM fields are not aligned, values are moved by memcpy,
+ * which compiles to a single (unaligned) load or store. */
+#define FRAG_NSM_ACCESSORS(name, ctype, ftype)                                                                         \
+static inline bool frag_nsm_##name##_supports(const frag_t *frag, attr_id_t attr_id)                                  \
+{                                                                                                                      \
+    return (frag->format == TF_NSM && frag->impl_type != FIT_HOST_NSM_SEG && attr_id < frag->layout->nattrs &&         \
+            frag->layout->fields[attr_id].type == ftype && frag->layout->fields[attr_id].size == sizeof(ctype) &&      \
+            frag->dictionaries[attr_id] == NULL);                                                                      \
+}                                                                                                                      \
+                                                                                                                       \
+static inline ctype frag_nsm_##name##_read(const frag_t *frag, attr_id_t attr_id, tuplet_id_t tuplet_id)              \
+{                                                                                                                      \
+    assert (frag_nsm_##name##_supports(frag, attr_id) && tuplet_id < frag->ntuplets);                                  \
+    ctype value;                                                                                                       \
+    memcpy(&value, frag->tuplet_data + tuplet_id * frag->tuplet_size + frag->layout->fields[attr_id].offset,          \
+           sizeof(ctype));                                                                                             \
+    return value;                                                                                                      \
+}                                                                                                                      \
+                                                                                                                       \
+static inline void frag_nsm_##name##_write(frag_t *frag, attr_id_t attr_id, tuplet_id_t tuplet_id, ctype value)       \
+{                                                                                                                      \
+    assert (frag_nsm_##name##_supports(frag, attr_id) && tuplet_id < frag->ntuplets);                                  \
+    memcpy(frag->tuplet_data + tuplet_id * frag->tuplet_size + frag->layout->fields[attr_id].offset, &value,          \
+           sizeof(ctype));                                                                                             \
+    frag_zone_add(frag, tuplet_id, attr_id, &value);                                                                   \
+    frag_set_valid(frag, tuplet_id, attr_id);                                                                          \
+}                                                                                                                      \
+                                                                                                                       \
+static inline void frag_nsm_##name##_gather(ctype *dst, const frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,     \
+                                            size_t count)                                                              \
+{                                                                                                                      \
+    assert (frag_nsm_##name##_supports(frag, attr_id) && begin + count <= frag->ntuplets);                             \
+    const void *src = frag->tuplet_data + begin * frag->tuplet_size + frag->layout->fields[attr_id].offset;            \
+    size_t stride = frag->tuplet_size;                                                                                 \
+    for (size_t i = 0; i < count; i++, src += stride) {                                                                \
+        memcpy(dst + i, src, sizeof(ctype));                                                                           \
+    }                                                                                                                  \
+}
+
+/* Generates the accessors frag_dsm_<name>_*() for fields of type 'ftype' in DSM fragments. These address the column
+ * as a plain array, and hence require the column to be uncompressed (see frag_compress()). */
+#define FRAG_DSM_ACCESSORS(name, ctype, ftype)                                                                         \
+static inline bool frag_dsm_##name##_supports(const frag_t *frag, attr_id_t attr_id)                                  \
+{                                                                                                                      \
+    return (frag->format == TF_DSM && attr_id < frag->layout->nattrs &&                                                \
+            frag->layout->fields[attr_id].type == ftype && frag->layout->fields[attr_id].size == sizeof(ctype) &&      \
+            frag->dictionaries[attr_id] == NULL && (frag->packed == NULL || frag->packed[attr_id] == NULL));           \
+}                                                                                                                      \
+                                                                                                                       \
+static inline const ctype *frag_dsm_##name##_column(const frag_t *frag, attr_id_t attr_id)                            \
+{                                                                                                                      \
+    assert (frag_dsm_##name##_supports(frag, attr_id));                                                                \
+    return ((ctype **) frag->tuplet_data)[attr_id];                                                                    \
+}                                                                                                                      \
+                                                                                                                       \
+static inline ctype frag_dsm_##name##_read(const frag_t *frag, attr_id_t attr_id, tuplet_id_t tuplet_id)              \
+{                                                                                                                      \
+    assert (tuplet_id < frag->ntuplets);                                                                               \
+    return frag_dsm_##name##_column(frag, attr_id)[tuplet_id];                                                         \
+}                                                                                                                      \
+                                                                                                                       \
+static inline void frag_dsm_##name##_write(frag_t *frag, attr_id_t attr_id, tuplet_id_t tuplet_id, ctype value)       \
+{                                                                                                                      \
+    assert (frag_dsm_##name##_supports(frag, attr_id) && tuplet_id < frag->ntuplets);                                  \
+    ((ctype **) frag->tuplet_data)[attr_id][tuplet_id] = value;                                                        \
+    frag_zone_add(frag, tuplet_id, attr_id, &value);                                                                   \
+    frag_set_valid(frag, tuplet_id, attr_id);                                                                          \
+}                                                                                                                      \
+                                                                                                                       \
+static inline void frag_dsm_##name##_gather(ctype *dst, const frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,     \
+                                            size_t count)                                                              \
+{                                                                                                                      \
+    assert (begin + count <= frag->ntuplets);                                                                          \
+    memcpy(dst, frag_dsm_##name##_column(frag, attr_id) + begin, count * sizeof(ctype));                               \
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   D E C L A R A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* Specialized field accessors for each pair of field type and tuplet format, e.g., frag_nsm_uint32_read() or
+ * frag_dsm_float64_gather(). Other than tuplet_field_read() and tuplet_field_update(), these are neither dispatched
+ * via the function pointers of tuplet_t resp. tuplet_field_t, nor do they branch on the tuplet format. A loop over a
+ * column is therefore straight-line typed code, which the compiler is free to unroll and vectorize.
+ *
+ * Callers check frag_<format>_<name>_supports() once per column and fall back to the generic tuplet interface
+ * otherwise (e.g., for PAX or segmented fragments, dictionary-encoded or compressed columns). Accessors do not check
+ * NULL values or tombstones; writes maintain zone maps and validity bitmaps as tuplet_field_update() does. */
+
+FRAG_ACCESSOR_TYPES(FRAG_NSM_ACCESSORS)
+FRAG_ACCESSOR_TYPES(FRAG_DSM_ACCESSORS)
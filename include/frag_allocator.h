@@ -0,0 +1,70 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <frag_allocators/malloc_allocator.h>
+#include <frag_allocators/hugepage_allocator.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifndef FRAG_DEFAULT_ALLOCATOR
+#define FRAG_DEFAULT_ALLOCATOR FATT_HUGEPAGE /*!< allocator used for fragments created via frag_new() */
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+typedef enum frag_allocator_type_tag {
+    FATT_MALLOC,    /*!< plain malloc/realloc/free; growth copies the region */
+    FATT_HUGEPAGE   /*!< 64-byte aligned regions; large regions are 2MB aligned mappings backed by huge pages that
+                         grow in place via mremap where available */
+} frag_allocator_type_tag;
+
+/*!
+ * @brief Memory allocator for the tuplet data of fragments. Allocators are stateless singletons; the size of a region
+ * is passed back on each call such that allocators do not need to track their regions.
+ */
+typedef struct frag_allocator_t {
+    void *(*_alloc)(struct frag_allocator_t *self, size_t size);
+    void *(*_realloc)(struct frag_allocator_t *self, void *ptr, size_t old_size, size_t new_size);
+    void (*_free)(struct frag_allocator_t *self, void *ptr, size_t size);
+    frag_allocator_type_tag tag;
+    void *extra;
+} frag_allocator_t;
+
+static struct frag_allocator_register_entry {
+    frag_allocator_type_tag type;
+    frag_allocator_t *(*get)();
+} frag_allocator_register[] = {
+    { FATT_MALLOC,   malloc_allocator_get },
+    { FATT_HUGEPAGE, hugepage_allocator_get }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   D E C L A R A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+frag_allocator_t *frag_allocator_get(frag_allocator_type_tag type);
+const char *frag_allocator_str(frag_allocator_type_tag type);
+void *frag_allocator_alloc(frag_allocator_t *allocator, size_t size);
+void *frag_allocator_realloc(frag_allocator_t *allocator, void *ptr, size_t old_size, size_t new_size);
+void frag_allocator_free(frag_allocator_t *allocator, void *ptr, size_t size);
@@ -0,0 +1,50 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// F O R W A R D   D E C L A R A T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct frag_allocator_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define HUGEPAGE_ALLOCATOR_ALIGNMENT  64                  /*!< alignment of each region (a cache line) */
+#define HUGEPAGE_ALLOCATOR_PAGE_SIZE  (2 * 1024 * 1024)   /*!< size of a huge page */
+
+#ifndef HUGEPAGE_ALLOCATOR_THRESHOLD
+#define HUGEPAGE_ALLOCATOR_THRESHOLD  HUGEPAGE_ALLOCATOR_PAGE_SIZE /*!< regions of at least this size are mapped */
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Returns the allocator for cache-line aligned, huge-page aware fragment memory.
+ *
+ * Regions smaller than HUGEPAGE_ALLOCATOR_THRESHOLD are 64-byte aligned heap blocks. Larger regions are anonymous
+ * mappings aligned to and rounded up to HUGEPAGE_ALLOCATOR_PAGE_SIZE, advised with MADV_HUGEPAGE to reduce TLB misses
+ * when scanning large fragments. On Linux, such mappings grow via mremap, i.e., without copying the region.
+ */
+struct frag_allocator_t *hugepage_allocator_get();
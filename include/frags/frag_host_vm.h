@@ -20,15 +20,83 @@
 #include <gs.h>
 #include <schema.h>
 
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifndef FRAG_PAX_PAGE_SIZE
+#define FRAG_PAX_PAGE_SIZE 16384 /*!< upper bound in bytes for a PAX mini-page; sized to stay in the L1/L2 cache */
+#endif
+
+#ifndef FRAG_MMAP_DIR
+#define FRAG_MMAP_DIR "/tmp" /*!< directory in which file-backed fragments without an explicit path are created */
+#endif
+
+#ifndef FRAG_SEGMENT_NTUPLETS
+#define FRAG_SEGMENT_NTUPLETS 65536 /*!< number of tuplets per segment of a segmented fragment */
+#endif
+
+#define FRAG_MMAP_MAGIC       0x4745434B4F4D4D50ULL /*!< file signature of a file-backed fragment ("GECKOMMP") */
+#define FRAG_MMAP_HEADER_SIZE 64                    /*!< bytes reserved in front of the tuplet data in a mapped file */
+
 // ---------------------------------------------------------------------------------------------------------------------
 // T Y P E   F O R W A R D I N G S
 // ---------------------------------------------------------------------------------------------------------------------
 
 struct frag_t;
+struct frag_allocator_t;
 
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E   F U N C T I O N S
 // ---------------------------------------------------------------------------------------------------------------------
 
-struct frag_t *frag_host_vm_nsm_new(schema_t *schema, size_t tuplet_capacity);
-struct frag_t *frag_host_vm_dsm_new(schema_t *schema, size_t tuplet_capacity);
+struct frag_t *frag_host_vm_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator);
+struct frag_t *frag_host_vm_dsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator);
+
+/*!
+ * @brief Creates a fragment that stores tuplets in PAX (partition attributes across) format.
+ *
+ * Tuplets are grouped into mini-pages of at most FRAG_PAX_PAGE_SIZE bytes. Inside a single mini-page, the values of
+ * each attribute are stored column-wise (i.e., DSM per page) while all attributes of one tuplet stay in the same
+ * page (i.e., NSM across pages). Hence, materializing an entire tuplet touches only one page, and scanning a single
+ * attribute reads contiguous values per page.
+ */
+struct frag_t *frag_host_vm_pax_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator);
+
+/*!
+ * @brief Creates a fragment in NSM format whose tuplet data is split into segments of FRAG_SEGMENT_NTUPLETS tuplets.
+ *
+ * The fragment grows by appending segments to a segment directory, hence inserts never copy existing tuplets and
+ * addresses of tuplets (e.g., <code>tuplet_t.attr_base</code>) stay valid while the fragment grows. The capacity is
+ * always a multiple of FRAG_SEGMENT_NTUPLETS. Segments are obtained from <i>allocator</i>; 'tuplet_data' is unused.
+ */
+struct frag_t *frag_host_seg_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator);
+
+/*!
+ * @brief Creates a fragment in NSM format whose tuplet data lives in a memory-mapped file.
+ *
+ * The backing file is an anonymous temporary file in FRAG_MMAP_DIR that is removed when the fragment is disposed.
+ * Use frag_host_mmap_open() to create or re-open a fragment that persists under a given path.
+ */
+struct frag_t *frag_host_mmap_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator);
+
+/*!
+ * @brief Opens (or creates) a file-backed NSM fragment stored at <i>path</i>.
+ *
+ * The tuplet data is mapped directly from the file with MAP_SHARED, hence the page cache holds hot tuplets and
+ * fragments larger than main memory are paged in on demand. If <i>path</i> refers to an existing fragment file, its
+ * tuplets are available right away without copying; the file must have been written with the same tuplet size.
+ * Growth extends the file via ftruncate and re-maps it. Call frag_flush() to write dirty pages back to the file.
+ *
+ * Note that NULL bitmaps and tombstones are in-memory bookkeeping and are not persisted with the file. Hence, a
+ * fragment stored under <i>path</i> rejects nullable attributes and deletes (see frag_tuplet_delete()). For the same
+ * reason, dictionary-encoded and variable-length attributes are not supported.
+ *
+ * @param path The file path. If <b>NULL</b>, an anonymous temporary file is used.
+ */
+struct frag_t *frag_host_mmap_open(schema_t *schema, const char *path, size_t tuplet_capacity);
+
+/*!
+ * @brief Returns true if <i>frag</i> is a file-backed fragment that persists under a path, see frag_host_mmap_open().
+ */
+bool frag_host_mmap_is_persistent(const struct frag_t *frag);
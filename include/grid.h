@@ -19,11 +19,29 @@
 
 #include <frag.h>
 #include <tuple.h>
+#include <tuplet_field.h>
 #include <interval.h>
 #include <indexes/vindex.h>
 #include <indexes/hindex.h>
-#include <containers/freelist.h>
+#include <containers/id_allocator.h>
 #include <tuple_cursor.h>
+#include <async.h>
+#include <grid_monitor.h>
+#include <grid_stats.h>
+#include <stdatomic.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define GRID_COMPACT_DEAD_RATIO     0.25f   /* fraction of deleted tuplets in a grid at which compaction pays off */
+#define GRID_MELT_MAX_WORKERS       8       /* maximum number of threads that melt columns in parallel */
+#define GRID_MELT_MIN_PARALLEL      65536   /* minimum number of melted tuples for which threads are spawned */
+#define GRID_MELT_LATCH_SIZE        16384   /* tuplets that melting copies from a grid per acquisition of its latch */
+#define GRID_RELAYOUT_MAX_RETRIES   4       /* optimistic copies of a grid before grid_relayout() blocks writers */
+#define GRID_RELAYOUT_BLOCK_SIZE    16384   /* bytes of tuplets per block that grid_relayout() transposes at once */
+#define GRID_RECLAIM_MAX_WAITS      1024    /* times grid_relayout() yields for pinned readers before leaving the old
+                                               fragment to a later grid_reclaim() */
 
 // ---------------------------------------------------------------------------------------------------------------------
 // D A T A   T Y P E S
@@ -31,11 +49,34 @@
 
 typedef size_t grid_id_t;
 
+typedef struct grid_latch_t {
+    atomic_uint_fast64_t version; /*<! Even while no writer holds the latch, odd while a writer holds it. Incremented
+                                       when a writer acquires and when it releases the latch. */
+    atomic_size_t nshared; /*<! Number of readers that hold the latch in shared mode (see grid_share_lock()), which a
+                                writer waits for after acquiring the latch. */
+} grid_latch_t;
+
+/* Readers that pin a grid (see grid_pin()) may dereference its fragment and its interval directory until they unpin
+ * it. Writers that replace these retire the old storage instead of freeing it (see grid_retired_t). Readers that pin
+ * the grid after the replacement do not reach the retired storage, hence it is freed once the number of pinned readers
+ * dropped to zero (see grid_reclaim()). */
+typedef struct grid_readers_t {
+    atomic_uint_fast64_t epoch; /*<! The number of fragments that replaced the fragment of the grid. */
+    atomic_size_t count; /*<! The number of readers that pin the grid. */
+} grid_readers_t;
+
+typedef struct grid_retired_t {
+    bool is_frag; /*<! True if 'storage' is a fragment, false if it is a vector of an interval directory. */
+    void *storage; /*<! Storage that was replaced while readers might have pinned the grid. */
+} grid_retired_t;
+
 typedef struct grid_t {
     apr_pool_t *pool;
     struct table_t *context; /*<! The grid table in which this grid exists. */
     grid_id_t grid_id; /*<! The id of this grid in context of the grid table. */
-    frag_t *frag; /*<! The physical data fragment including the applied physical schema of this grid. */
+    frag_t *_Atomic frag; /*<! The physical data fragment including the applied physical schema of this grid. Replaced
+                               under the grid latch if the grid is converted into another layout (see
+                               grid_relayout()). Readers must pin the grid while they dereference it. */
     apr_hash_t *schema_map_indicies; /*<! An (inverted) index that allows direct access from a table schema attribute to
                                       the associated grid schema attribute via indices mapping. This index returns the
                                       position j in the grid schema attribute list given a position i in the table
@@ -44,10 +85,11 @@ typedef struct grid_t {
                                       iterating through all i that are mapped into the grid yields all associated j.
                                       Note, the order of attributes might change between the table schema and the grid
                                       schema. */
-    vec_t /* of tuple_id_interval_t */ *tuple_ids; /*<! A list of right-open intervals that describe which tuples in the table
+    vec_t /* of tuple_id_interval_t */ *_Atomic tuple_ids; /*<! A list of right-open intervals that describe which tuples in the table
                                          are covered in this grid. Intervals [a, b), [c,d ),... in this list are assumed
                                          to be ordered ascending by their lower bound, e.g., a, c for a < c. Further,
-                                         the intervals do not overlap. This information is required to translate from
+                                         the intervals neither overlap nor touch, i.e., adjacent intervals are merged
+                                         on insertion and compaction. This information is required to translate from
                                          tuple identifiers to per-grid tuplet identifiers and vice versa, since
                                          the intervals in 'tuple_ids' contain a subset of all tuple identifiers in the
                                          table (e.g., [100, 105)). With other words, the union of all intervals describe
@@ -55,58 +97,128 @@ typedef struct grid_t {
                                          tuplet identifiers per grid is strictly monotonically continuous increasing
                                          (i.e., 0, 1, 2, 3, ...). These information are needed to map a tuple
                                          identifier (e.g., 100) to a tuplet identifier (e.g. 2), and vice versa. */
-    tuple_id_interval_t *last_interval_cache; /*<! A nullable pointer into 'tuple_ids' data that is the last accessed interval.
-                                         it's used to speedup translation between tuplet and tuple identifier. Caching
-                                         the last access avoids searching the interval when a tuplet is request in the
-                                         same interval as before. In case the pointer is null, no entry is in the cache.
-                                         In case the pointer is non-null, an entry is cached. Note, that's not
-                                         guaranteed to find a certain tuplet in this cache. In case the tuplet is not
-                                         found here, 'tuple_ids' are searched for a match according some specific
-                                         algorithm that is implemented in the manager of this cache. */
-
-    pthread_mutex_t mutex; // TODO: locking a single grid
+    vec_t /* of tuplet_id_t */ *_Atomic tuplet_offsets; /*<! Prefix sums over the spans of the intervals in
+                                         'tuple_ids': the i-th entry is the tuplet identifier to which the first tuple
+                                         of the i-th interval is mapped, i.e., the number of tuples covered by all
+                                         preceding intervals. Together with 'tuple_ids', this is the interval directory
+                                         of the grid, which translates between tuple and tuplet identifiers by binary
+                                         search. Must be rebuilt via grid_intervals_changed() whenever 'tuple_ids'
+                                         changes. Published directories are immutable: writers replace both vectors
+                                         under the grid latch rather than changing them in place. */
+
+    grid_latch_t latch; /*<! Optimistic version latch of this grid. Writers (inserts, updates, deletions and
+                             compaction) hold it exclusively for the duration of their modification. Readers do not
+                             block: they remember the version before reading (grid_read_begin()), and discard and
+                             repeat their read if the version changed meanwhile (grid_read_validate()). Readers that
+                             dereference buffers which writers might free (e.g., to copy values) hold the latch in
+                             shared mode instead. */
+    vec_t /* of grid_retired_t */ *retired; /*<! Fragments replaced by conversions and interval directories replaced by
+                             compaction, which pinned readers might still traverse. */
+    pthread_mutex_t retired_latch; /*<! Serializes retiring and reclaiming the storage in 'retired'. */
+    grid_readers_t readers; /*<! The readers that pinned this grid, which delay freeing replaced storage. */
+    pthread_mutex_t relayout_latch; /*<! Serializes the conversions of this grid, see grid_relayout(). */
+    grid_monitor_t monitor; /*<! Counts the accesses to this grid for the reorganizer, see grid_reorg.h. */
+    grid_stats_t stats; /*<! Sketches of the values written into this grid for the catalog, see stats_catalog.h. */
 } grid_t;
 
-typedef enum {
-    AT_SEQUENTIAL,  /*<! A call for translation between tuplet and tuple identifier forward iterates through the
-                         the intervals of tuple identifiers coverd by a grid. If a tuple is not found in the
-                         last (cached) interval, it is guaranteed that the tuple is not in a preceding interval
-                         w.r.t. to the cached interval. With other words, if a tuple is not in the (cached) interval
-                         it must be in one of the successors of the cached one. Sequential access is typical for
-                         full table scans. */
-    AT_RANDOM       /*<! A call for translation between tuplet and tuple identifier where there are no guarantees
-                         on the order in which intervals are accessed. With other words, when running a random
-                         access type, intervals between succeeding calls for translation are likely to change. Hence,
-                         if the tuple is not in the last (cached) interval, the entire list of intervals must be
-                         searched. Random access is typical for index scans. */
-} access_type;
+typedef struct grid_list_t {
+    size_t capacity; /*<! The number of slots in 'grids'. */
+    atomic_size_t length; /*<! The number of published grids in 'grids'. Slots are written before they are published,
+                               and published slots are never modified. */
+    struct grid_list_t *retired; /*<! The list that was replaced by this list after it became full, or NULL. Readers
+                               that still hold a retired list see a consistent prefix of the grids. */
+    grid_t *grids[]; /*<! The grids in this list. */
+} grid_list_t;
+
+#define GRID_TUPLET_NONE    UINT32_MAX   /* marks tuples that are not covered by a grid, see grid_tuples_to_tuplets() */
+
+typedef struct grid_translation_cache_t {
+    const grid_t *grid; /*<! The grid to which 'interval_idx' refers, or NULL if nothing is cached. */
+    size_t interval_idx; /*<! The index of the interval in 'grid->tuple_ids' in which the last translation ended. The
+                              next translation checks this interval and its successor before searching, which makes
+                              translations during a scan constant-time. The cache is owned by a single cursor (resp.
+                              thread) rather than by the grid, hence readers of a grid never write to shared state. An
+                              outdated entry (e.g., after compaction of the grid) is detected and ignored. */
+} grid_translation_cache_t;
+
+typedef struct table_column_t {
+    attr_id_t attr_id; /*<! The table attribute to which the values in this column batch belong. */
+    const void *values; /*<! A dense array of 'nvalues' values of the attribute's type. For string attributes, this is
+                             an array of 'const char *' instead (like a single field write takes a string). */
+    size_t nvalues; /*<! The number of values in 'values'. All column batches passed at once have the same length. */
+} table_column_t;
 
 typedef struct grids_by_attr_index_elem_t {
     attr_id_t attr_id;
-    vec_t *grid_ptrs;
+    _Atomic(grid_list_t *) grid_ptrs;
 } grids_by_attr_index_elem_t;
 
 typedef struct table_t {
     schema_t *schema; /*<! The schema assigned to this table. Note that this schema is 'logical', i.e., grids
                            have their own schema that might be a subset of this schema with another order on the
                            attributes. The table's schema is used to give a logical structure to a caller. */
-    vec_t *grid_ptrs;  /*<! A vector of pointers to elements of type grid_t. Each grid contained in this table is
-                           referenced here, and will be freed from here once the table will be disposed. */
+    _Atomic(grid_list_t *) grid_ptrs; /*<! The grids of this table in the order of their identifiers. Each grid
+                           contained in this table is referenced here, and will be freed from here once the table will
+                           be disposed. The list is append-only and read without latches. */
+    pthread_mutex_t latch; /*<! Serializes the writers of the table metadata, i.e., the grid list, the grid
+                           directory and the indexes. Reads of the grid list, the grid directory and the version
+                           counters do not acquire this latch, and tuple identifiers are bound without it. */
     vindex_t *schema_cover; /*<! An index that maps attribute ids from this tables schema to a list of pointers
                              to grids that cover at least this attribute in their 'physical' schemata. */
     hindex_t *tuple_cover; /*<! An index that maps ranges of tuple ids to a list of pointers to grids that
                              contribute to at least one of the tuples in the range. */
-    freelist_t tuple_id_freelist; /*<! Tuple identifiers that can be re-used. A tuple identifier will be added to this
-                                      list after the physical tuple associated with the identifier was removed from
-                                      the grid table. A strictly auto-increasing number that provides a new tuple
-                                      identifier that never was used before is also stored here. */
-    size_t num_tuples; /*<! The number of tuples in this table. Note: it's guaranteed that the sequence of
+    id_allocator_t tuple_id_allocator; /*<! Hands out the identifiers of new tuples. Identifiers released to this
+                                      allocator are re-used before identifiers that never were used before. Threads
+                                      bind identifiers concurrently and mostly without locking. */
+    vec_t /* of grids_by_attr_index_elem_t */ *grids_by_attr; /*<! A directory that lists for the i-th attribute in the
+                           table schema all grids that cover this attribute. Unlike 'schema_cover', this directory is
+                           read without allocations or latches, and is used to resolve access plans (see
+                           table_plan_t). */
+    atomic_size_t grid_set_version; /*<! Incremented whenever a grid is added to this table or the mapping of tuples to
+                           tuplets in some grid changes (e.g., by compaction). Resolved access plans and plan steps
+                           are stamped with this version, and are re-resolved once it changed. */
+    table_monitor_t monitor; /*<! Counts which attributes of this table are accessed together. */
+    atomic_size_t num_tuples; /*<! The number of tuples in this table. Note: it's guaranteed that the sequence of
                             tuple identifiers from 0 to num_tuples - 1 is strictly monotonically continuous increasing.
                             With other words, each tuple identifier in the right open interval [0, num_tuples) is
                             accessible. However, it's neither guaranteed that a tuple associated with an identifier in
                             this interval is not marked as 'deleted' nor that the tuple data is initialized. */
 } table_t;
 
+typedef struct table_plan_step_t {
+    const grid_t *grid; /*<! The grid that serves the tuples in 'tuples', or NULL if the step is not resolved. */
+    attr_id_t grid_attr_id; /*<! The attribute id in the grid schema that corresponds to the planned table attribute. */
+    tuple_id_interval_t tuples; /*<! The tuples served by this step, mapped to consecutive tuplets in 'grid'. */
+    tuplet_id_t tuplet_base; /*<! The tuplet identifier in 'grid' of the first tuple in 'tuples'. */
+    size_t version; /*<! The 'grid_set_version' of the table at the time this step was resolved. */
+    u64 naccesses; /*<! The number of fields accessed via this step since it was resolved, which are counted in the
+                        monitor of 'grid' once the step is resolved again. */
+    u64 pin; /*<! The pin of 'grid' held by the plan of this step, see table_plan_seek(). */
+} table_plan_step_t;
+
+typedef struct table_plan_t {
+    const table_t *table; /*<! The table on which this plan operates. */
+    size_t nattr_ids; /*<! The number of planned attributes. */
+    attr_id_t *attr_ids; /*<! The planned table attributes in the order requested by the caller. */
+    table_plan_step_t *steps; /*<! For the i-th planned attribute the step that served the last requested tuple. A
+                                   step is re-resolved only if a tuple outside its interval is requested or if the
+                                   grid set of the table changed since it was resolved. */
+    u64 ntuples; /*<! The number of tuples visited via this plan, counted in the table monitor when the plan is
+                      deleted. */
+    tuple_id_t last_tuple_id; /*<! The tuple of the last seek. */
+} table_plan_t;
+
+typedef struct table_window_t {
+    table_plan_t *plan; /*<! Resolves the grids that serve the attributes of the visited rows. */
+    tuple_id_t begin; /*<! The tuple of the first row in the window, or the end of the table if the window is empty. */
+    tuple_id_t next; /*<! The tuple at which the search for the next live row starts. */
+    tuple_id_t current; /*<! The tuple of the current row. */
+    size_t limit; /*<! The maximum number of rows in the window. */
+    size_t nvisited; /*<! The number of rows visited since the window was opened or rewound. */
+    void *value; /*<! Copy of the value returned by table_window_read() last, or NULL if no value was read yet. */
+    size_t value_capacity; /*<! The size in bytes of the storage 'value' points to. */
+} table_window_t;
+
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E  D E C L A R A T I O N S
 // ---------------------------------------------------------------------------------------------------------------------
@@ -116,9 +228,21 @@ void table_delete(table_t *table);
 const char *table_name(const table_t *table);
 grid_id_t table_add(table_t *table, const attr_id_t *attr_ids_covered, size_t nattr_ids_covered,
                     const tuple_id_interval_t *tuple_ids_covered, size_t ntuple_ids_covered, enum frag_impl_type_t type);
-const freelist_t *table_freelist(const struct table_t *table);
+const id_allocator_t *table_id_allocator(const struct table_t *table);
 grid_cursor_t *table_find(const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids,
                           const tuple_id_t *tuple_ids, size_t ntuple_ids);
+/*!
+ * @brief Copies the attributes <i>attr_ids</i> of the tuples <i>tuple_ids</i> in <i>src_table</i> into a new table
+ * that consists of a single grid of type <i>type</i>. The i-th tuple of the new table is the i-th tuple in
+ * <i>tuple_ids</i>, and its j-th attribute is the j-th attribute in <i>attr_ids</i>.
+ *
+ * Melting is column-wise: each source grid is translated once into runs of tuplets that map to consecutive tuplets
+ * of the new grid, and these runs are copied per attribute in batches by memcpy (gathering strided NSM values as
+ * required). Attributes are melted in parallel on up to GRID_MELT_MAX_WORKERS threads. Since writers free replaced
+ * buffers of a grid (e.g., its string heap or dictionaries) in place, runs are copied under the grid latch, which is
+ * released after every GRID_MELT_LATCH_SIZE tuplets to let writers proceed. The latch is held in shared mode, such that
+ * attributes of the same grid are still melted in parallel.
+ */
 table_t *table_melt(enum frag_impl_type_t type, const table_t *src_table, const tuple_id_t *tuple_ids,
                     size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids);
 const attr_t *table_attr_by_id(const table_t *table, attr_id_t id);
@@ -131,97 +255,383 @@ vec_t *table_grids_by_attr(const table_t *table, const attr_id_t *attr_ids, size
 vec_t *table_grids_by_tuples(const table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids);
 bool table_is_valide(table_t *table);
 
+/*!
+ * @brief Creates an access plan for the attributes <i>attr_ids</i> of <i>table</i>. The plan resolves which grid,
+ * grid attribute and tuplet serve each attribute of a requested tuple, and keeps this resolution for the entire run of
+ * tuples that are mapped to consecutive tuplets in that grid. Hence, cursors that move across tuples and attributes by
+ * table_plan_seek() query the table indexes only at interval boundaries.
+ */
+table_plan_t *table_plan_new(const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids);
+void table_plan_delete(table_plan_t *plan);
+
+/*!
+ * @brief Returns the step that serves the <i>attr_idx</i>-th planned attribute of <i>tuple_id</i>, resolving it if
+ * required. Panics if no grid covers the field.
+ */
+const table_plan_step_t *table_plan_seek(table_plan_t *plan, size_t attr_idx, tuple_id_t tuple_id);
+
+/*!
+ * @brief Opens a window over the rows [<i>row_offset</i>, <i>row_offset</i> + <i>limit</i>) of <i>table</i> for the
+ * attributes <i>attr_ids</i> (or all attributes, if <i>attr_ids</i> is NULL). Rows are the live (i.e., not deleted)
+ * tuples ordered by their identifier. Only the grids that serve rows inside the window are accessed, and the cost of
+ * visiting a window is linear in <i>limit</i>. If no tuple of <i>table</i> is deleted or was removed by compaction,
+ * positioning at <i>row_offset</i> does not visit the preceding tuples; otherwise, these are tested for deletion.
+ *
+ * This is the paging primitive for the interactive inspection of tables: a page is read by table_window_next() and
+ * table_window_read(), and the next page is the window that starts at <i>row_offset</i> + <i>limit</i>.
+ */
+void table_window_open(table_window_t *window, const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids,
+                       size_t row_offset, size_t limit);
+
+/*!
+ * @brief Moves <i>window</i> to its next row and returns the tuple of this row in <i>tuple_id</i>, or returns false
+ * if the window is exhausted.
+ */
+bool table_window_next(table_window_t *window, tuple_id_t *tuple_id);
+
+/*!
+ * @brief Returns the value of the <i>attr_idx</i>-th windowed attribute in the current row of <i>window</i>, or NULL
+ * if the field is NULL. The value is copied under the grid latch into storage owned by <i>window</i>, and stays valid
+ * until the next call to table_window_read() or table_window_close() on <i>window</i>.
+ */
+const void *table_window_read(table_window_t *window, size_t attr_idx);
+void table_window_rewind(table_window_t *window);
+void table_window_close(table_window_t *window);
+
+/*!
+ * @brief Resolves the grid of <i>table</i> that covers the field (<i>tuple_id</i>, <i>table_attr_id</i>) by use of the
+ * grid directory of <i>table</i>, and stores the result in <i>step</i>. Returns false if no grid covers the field.
+ */
+bool table_plan_step_resolve(table_plan_step_t *step, const table_t *table, attr_id_t table_attr_id,
+                             tuple_id_t tuple_id);
+
+/*!
+ * @brief Marks the tuples <i>tuple_ids</i> as deleted in each grid that covers them. Space is reclaimed lazily by
+ * table_compact().
+ */
+void table_delete_tuples(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids);
+
+/*!
+ * @brief Rewrites each grid of <i>table</i> whose ratio of deleted tuplets is at least <i>min_dead_ratio</i>.
+ *
+ * The grid's fragment is compacted, its 'tuple_ids' intervals and the table's tuple cover index are updated
+ * accordingly. The identifiers of removed tuples are not covered by any grid afterwards and are never bound again.
+ *
+ * @return The number of removed tuplets
+ */
+size_t table_compact(table_t *table, float min_dead_ratio);
+
+/*!
+ * @brief Runs table_compact() in a background thread. The table must not be accessed by the caller until the
+ * returned future is resolved via future_resolve().
+ */
+future_t table_compact_async(table_t *table, float min_dead_ratio);
+
+/*!
+ * @brief Inserts as many new tuples as there are values in each column batch of <i>columns</i>, and writes the values
+ * into the grids covering the tuples. The new tuples are returned via <i>resultset</i> as in grid_insert(); attributes
+ * not contained in <i>columns</i> are left uninitialized.
+ *
+ * Other than writing field by field via tuple_field_write(), the attribute mapping of each grid is resolved once per
+ * call, and runs of consecutive tuples that fall into the same interval of a grid are written as a range of tuplets
+ * via frag_write_column(), i.e., by a memcpy per column for DSM and PAX grids.
+ */
+void table_insert_columns(tuple_cursor_t *resultset, table_t *table, const table_column_t *columns, size_t ncolumns);
+
+/*!
+ * @brief Overwrites the fields of the tuples <i>tuple_ids</i> with the values in <i>columns</i>, where the i-th value
+ * of each column batch belongs to the i-th tuple. Runs of consecutive tuple identifiers are written as in
+ * table_insert_columns(), hence updates in ascending order of tuple identifiers are the fastest.
+ */
+void table_update_columns(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids,
+                          const table_column_t *columns, size_t ncolumns);
+
 void grid_delete(grid_t *grid);
 const grid_t *grid_by_id(const table_t *table, grid_id_t id);
+
+/*!
+ * @brief Rebuilds the interval directory (i.e., 'tuplet_offsets') of <i>grid</i>. Must be called whenever the
+ * intervals in 'tuple_ids' of <i>grid</i> are changed. The previous directory is retired rather than freed, since
+ * pinned readers might still traverse it.
+ */
+void grid_intervals_changed(grid_t *grid);
+
+/*!
+ * @brief Frees the storage that was retired by writers of <i>grid</i> if no reader pins <i>grid</i>. Retired storage
+ * that is not freed here is freed by a later call, at the latest when <i>grid</i> is deleted. Conversions and
+ * compactions of <i>grid</i> and closing plans that pinned <i>grid</i> call this function.
+ *
+ * @return true if no retired storage is left
+ */
+bool grid_reclaim(grid_t *grid);
+
+/*!
+ * @brief Converts the fragment of <i>grid</i> into a fragment of type <i>type</i> with the same tuplets, NULL values
+ * and deletion marks. The new fragment is copied without blocking readers, in blocks of GRID_RELAYOUT_BLOCK_SIZE bytes
+ * that are transposed attribute by attribute while they are cached. Each block is copied under the grid latch in
+ * shared mode, which writers may acquire between two blocks. The copy is swapped in under the grid latch if no writer
+ * modified the grid meanwhile; otherwise, the copy is abandoned and repeated, and writers are blocked for the entire
+ * copy after GRID_RELAYOUT_MAX_RETRIES attempts. The old fragment is retired and freed as soon as no reader pins the
+ * grid anymore. Since open plans and windows keep their grids pinned, waiting for this is bounded by
+ * GRID_RECLAIM_MAX_WAITS, after which the fragment is left to grid_reclaim(). The calling thread must not hold the
+ * latch of <i>grid</i>.
+ *
+ * @return false if the fragment of <i>grid</i> already is of type <i>type</i>, true otherwise
+ */
+bool grid_relayout(grid_t *grid, enum frag_impl_type_t type);
+
+/*!
+ * @brief Converts the grid <i>grid_id</i> of <i>table</i> into a fragment of type <i>type</i> in the background (see
+ * grid_relayout()). Readers and writers of the table may proceed meanwhile. The future is resolved once the new
+ * fragment is swapped in.
+ */
+future_t grid_convert(table_t *table, grid_id_t grid_id, enum frag_impl_type_t type);
+
+/*!
+ * @brief Translates the tuple identifiers <i>tuple_ids</i>, which must be sorted ascending, into the tuplet identifiers
+ * of <i>grid</i> in a single merge pass over the tuple identifiers and the intervals of <i>grid</i>. The i-th entry of
+ * <i>out</i> is the tuplet of the i-th tuple, or GRID_TUPLET_NONE if <i>grid</i> does not cover this tuple.
+ *
+ * @return The number of tuples covered by <i>grid</i>
+ */
+size_t grid_tuples_to_tuplets(tuplet_id_t *out, const grid_t *grid, const tuple_id_t *tuple_ids, size_t ntuple_ids);
 size_t grid_num_of_attributes(const grid_t *grid);
+
+/*!
+ * @brief Binds <i>ntuplets</i> tuple identifiers for new tuples in <i>table</i> and returns them via
+ * <i>resultset</i>. Safe to be called from several threads on the same table. Released identifiers are bound first.
+ * The new identifiers of a single call are contiguous, and concurrent calls bind disjoint ranges that together fill
+ * the identifier space without gaps; hence, grids that cover [0, n) cover the first n inserted tuples.
+ */
 void grid_insert(tuple_cursor_t *resultset, table_t *table, size_t ntuplets);
+size_t grid_compact(table_t *table, grid_t *grid);
 void grid_print(FILE *file, const table_t *table, grid_id_t grid_id, size_t row_offset, size_t limit);
 void table_grid_list_print(FILE *file, const table_t *table, size_t row_offset, size_t limit);
 void table_print(FILE *file, const table_t *table, size_t row_offset, size_t limit);
 void table_structure_print(FILE *file, const table_t *table, size_t row_offset, size_t limit);
 
-static inline int interval_tuple_id_comp_by_element(const void *needle, const void *element)
+/*!
+ * @brief Returns the version of <i>grid</i> at which an optimistic read starts. Waits while a writer holds the latch.
+ */
+static inline u64 grid_read_begin(const grid_t *grid)
+{
+    u64 version;
+    while ((version = atomic_load_explicit(&grid->latch.version, memory_order_acquire)) & 1);
+    return version;
+}
+
+/*!
+ * @brief Returns true if <i>grid</i> was not modified since grid_read_begin() returned <i>version</i>, i.e., if the
+ * values read in between are consistent.
+ */
+static inline bool grid_read_validate(const grid_t *grid, u64 version)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return (atomic_load_explicit(&grid->latch.version, memory_order_relaxed) == version);
+}
+
+/*!
+ * @brief Pins <i>grid</i> such that its fragment and its interval directory (i.e., the ones read after pinning and any
+ * that replace these) are not freed until the returned pin is passed to grid_unpin(). Pinning does not block, and does
+ * not block writers. The returned pin is the epoch of the readers of <i>grid</i> (see grid_readers_t).
+ */
+static inline u64 grid_pin(const grid_t *grid)
+{
+    grid_readers_t *readers = (grid_readers_t *) &grid->readers;
+    atomic_fetch_add(&readers->count, 1);
+    // The epoch is read after pinning, such that a fragment opened afterwards is at least as new as the epoch tells
+    return atomic_load(&readers->epoch);
+}
+
+static inline void grid_unpin(const grid_t *grid, u64 pin)
 {
-    tuple_id_t tuple_id = *(const tuple_id_t *) needle;
-    const tuple_id_interval_t *interval = element;
-    return (INTERVAL_CONTAINS(interval, tuple_id) ? 0 : (tuple_id < interval->begin ? - 1 : + 1));
+    atomic_fetch_sub_explicit((atomic_size_t *) &grid->readers.count, 1, memory_order_release);
 }
 
-static inline tuplet_id_t global_to_local(grid_t *grid, tuple_id_t tuple_id, access_type type)
+/*!
+ * @brief Returns the index of the interval of <i>grid</i> that contains <i>tuple_id</i>, or SIZE_MAX if <i>grid</i>
+ * does not cover this tuple. <i>cache</i> is optional.
+ */
+static inline size_t grid_interval_find(const grid_t *grid, tuple_id_t tuple_id, grid_translation_cache_t *cache)
 {
-    // TODO: apply a bunch of strategy alternatives here. For instance, one can buffer the distances for a given
-    // Cursor and all its processors. Then the translation does not require to scan the entire interval list in order
-    // to provide the tuplet id. Also, one can run binary search and linear search probably multi-threaded...
-
-    // The tuplet identifier that is mapped in this grid to the given 'tuplet_id'
-    tuplet_id_t result = 0;
-
-    // Determine where to start in the interval list. The last position was cached, so start_system here if possible
-    tuple_id_interval_t *cursor = (grid->last_interval_cache != NULL ? grid->last_interval_cache : grid->tuple_ids->data);
-
-    // Determine the end of the interval list. If cursor reaches this end, the tuple is not mapped into this grid.
-    // Clearly, if this case happens, there is an interval error since a request to this function requires
-    // a valid coverage of the given 'tuple_id' in this grid
-    const tuple_id_interval_t *end = vec_end(grid->tuple_ids);
-
-    if (!INTERVAL_CONTAINS(cursor, tuple_id)) {
-        switch (type) {
-            case AT_SEQUENTIAL:
-                // seek to interval that contains the tuple, move cursor to successor since its guaranteed not in the
-                // current one
-                for (cursor++; cursor < end && !INTERVAL_CONTAINS(cursor, tuple_id); cursor++);
-                break;
-            case AT_RANDOM:
-                // Assert that interval list is sorted. If sort state is not cached,
-                // re-evaluate the state and check again
-                assert (vec_issorted(grid->tuple_ids, CCP_USECACHE, NULL) ||
-                                vec_issorted(grid->tuple_ids, CCP_IGNORECACHE, interval_tuple_id_comp_by_lower_bound));
-
-                // TODO: apply evolutionary algorithm here to find choice of alternatives once alternatives exists
-                // Alternatives besides bsearch might be linear search w/o multi-threading from cache or start_system/end, ...
-
-                // Perform binary search. Note here that this only works, because we exploit an assumption on the
-                // intervals contained in the list: intervals do not overlap and the needle can be used to state whether
-                // a lower or higher interval must be considered during search if the needle is not contained in the
-                // current interval.
-                cursor = vec_bsearch(grid->tuple_ids, &tuple_id,
-                                     interval_tuple_id_comp_by_lower_bound, interval_tuple_id_comp_by_element);
-                break;
-            default: panic(BADBRANCH, grid);
+    const vec_t *tuple_ids = grid->tuple_ids;
+    const tuple_id_interval_t *intervals = vec_begin(tuple_ids);
+    size_t nintervals = vec_length(tuple_ids);
+
+    if (cache != NULL && cache->grid == grid) {
+        /* during scans, the tuple is mostly in the same or the next interval as the previous one */
+        for (size_t idx = cache->interval_idx; idx < min(cache->interval_idx + 2, nintervals); idx++) {
+            const tuple_id_interval_t *interval = intervals + idx;
+            if (INTERVAL_CONTAINS(interval, tuple_id)) {
+                cache->interval_idx = idx;
+                return idx;
+            }
+        }
+    }
+
+    /* binary search for the last interval that begins at or before the tuple, exploiting that intervals are ordered
+     * and do not overlap */
+    size_t lower = 0, upper = nintervals;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (intervals[mid].begin <= tuple_id) {
+            lower = mid + 1;
+        } else {
+            upper = mid;
         }
     }
+    if (lower == 0) {
+        return SIZE_MAX;
+    }
+    const tuple_id_interval_t *interval = intervals + lower - 1;
+    if (!INTERVAL_CONTAINS(interval, tuple_id)) {
+        return SIZE_MAX;
+    }
+    if (cache != NULL) {
+        *cache = (grid_translation_cache_t) { .grid = grid, .interval_idx = lower - 1 };
+    }
+    return lower - 1;
+}
 
-    panic_if((cursor == end), "Internal error: mapping of tuple '%u' is not resolvable", tuple_id);
+/*!
+ * @brief Returns the tuplet of <i>grid</i> that stores <i>tuple_id</i>, which must be covered by <i>grid</i>.
+ *
+ * Compaction replaces both lists of the interval directory (i.e., 'tuple_ids' and 'tuplet_offsets') under the grid
+ * latch, hence both are read in the same optimistic section, which is repeated until it pairs an interval with its own
+ * offset. The grid is pinned meanwhile, which keeps replaced directories. Must not be called while holding the latch of
+ * <i>grid</i>.
+ */
+static inline tuplet_id_t global_to_local(const grid_t *grid, tuple_id_t tuple_id, grid_translation_cache_t *cache)
+{
+    u64 pin = grid_pin(grid);
+    while (true) {
+        u64 version = grid_read_begin(grid);
+        const vec_t *tuple_ids = grid->tuple_ids, *tuplet_offsets = grid->tuplet_offsets;
+        size_t idx = grid_interval_find(grid, tuple_id, cache);
+        // Out of bounds only if the directory is replaced meanwhile, which fails the validation
+        bool found = (idx != SIZE_MAX && idx < vec_length(tuple_ids) && idx < vec_length(tuplet_offsets));
+        tuplet_id_t tuplet_id = 0;
+        if (found) {
+            const tuple_id_interval_t *interval = vec_at(tuple_ids, idx);
+            tuplet_id = *(const tuplet_id_t *) vec_at(tuplet_offsets, idx) + (tuple_id - interval->begin);
+        }
+        if (grid_read_validate(grid, version)) {
+            panic_if((!found), "Internal error: mapping of tuple '%u' is not resolvable", tuple_id);
+            grid_unpin(grid, pin);
+            return tuplet_id;
+        }
+    }
+}
+
+/*!
+ * @brief Returns the tuple stored in the tuplet <i>tuplet_id</i> of <i>grid</i>. Reads the interval directory like
+ * global_to_local(), hence must not be called while holding the latch of <i>grid</i>.
+ */
+static inline tuple_id_t local_to_global(const grid_t *grid, tuplet_id_t tuplet_id, grid_translation_cache_t *cache)
+{
+    u64 pin = grid_pin(grid);
+    while (true) {
+        u64 version = grid_read_begin(grid);
+        const vec_t *tuple_ids = grid->tuple_ids, *tuplet_offsets = grid->tuplet_offsets;
+        const tuplet_id_t *offsets = vec_begin(tuplet_offsets);
+        const tuple_id_interval_t *intervals = vec_begin(tuple_ids);
+        // Both lists differ in length only if the directory is replaced meanwhile, which fails the validation
+        size_t nintervals = min(vec_length(tuple_ids), vec_length(tuplet_offsets));
+        size_t idx;
+
+        if (cache != NULL && cache->grid == grid && cache->interval_idx < nintervals &&
+            offsets[cache->interval_idx] <= tuplet_id && (cache->interval_idx + 1 == nintervals ||
+                                                          tuplet_id < offsets[cache->interval_idx + 1])) {
+            idx = cache->interval_idx;
+        } else {
+            /* binary search for the last interval whose first tuplet is at or before the tuplet */
+            size_t lower = 0, upper = nintervals;
+            while (lower < upper) {
+                size_t mid = lower + (upper - lower) / 2;
+                if (offsets[mid] <= tuplet_id) {
+                    lower = mid + 1;
+                } else {
+                    upper = mid;
+                }
+            }
+            idx = (lower > 0 ? lower - 1 : SIZE_MAX);
+        }
 
-    // TODO: Cache this!
-    // calculate the number of tuplets that fall into preceding intervals
-    for (const tuple_id_interval_t *it = vec_begin(grid->tuple_ids); it < end; it++) {
-        result += (tuple_id >= it->begin) ? INTERVAL_SPAN(it) : 0;
+        tuple_id_t tuple_id = (idx != SIZE_MAX ? intervals[idx].begin + (tuplet_id - offsets[idx]) : 0);
+        if (grid_read_validate(grid, version)) {
+            assert (idx != SIZE_MAX);
+            if (cache != NULL) {
+                *cache = (grid_translation_cache_t) { .grid = grid, .interval_idx = idx };
+            }
+            grid_unpin(grid, pin);
+            return tuple_id;
+        }
     }
-    // calculate the exact identifier for the given tuple in the 'cursor' interval
-    result += (tuple_id - cursor->end);
+}
 
-    // update cache
-    grid->last_interval_cache = cursor;
+/*!
+ * @brief Returns true if <i>step</i> is resolved, still valid w.r.t. the grid set of <i>table</i>, and serves
+ * <i>tuple_id</i>.
+ */
+static inline bool table_plan_step_covers(const table_plan_step_t *step, const table_t *table, tuple_id_t tuple_id)
+{
+    return (step->grid != NULL && step->version == table->grid_set_version && tuple_id >= step->tuples.begin &&
+            tuple_id < step->tuples.end);
+}
 
-    return result;
+static inline tuplet_id_t table_plan_step_tuplet(const table_plan_step_t *step, tuple_id_t tuple_id)
+{
+    assert (tuple_id >= step->tuples.begin && tuple_id < step->tuples.end);
+    return step->tuplet_base + (tuple_id - step->tuples.begin);
 }
 
-static inline tuple_id_t local_to_global(grid_t *grid, tuplet_id_t tuplet_id)
+/*!
+ * @brief Counts an access to a field of <i>tuple_id</i> via <i>step</i>, and samples it for the heat of the grid.
+ */
+static inline void table_plan_step_touch(table_plan_step_t *step, tuple_id_t tuple_id)
 {
-    assert (tuplet_id < grid->frag->ntuplets);
+    if (++step->naccesses % GRID_MONITOR_HEAT_SAMPLE == 0) {
+        grid_monitor_heat((grid_monitor_t *) &step->grid->monitor, table_plan_step_tuplet(step, tuple_id), 1,
+                          GRID_MONITOR_HEAT_SAMPLE);
+    }
+}
 
-    // TODO: Cache this!
-    tuple_id_t num_tuple_covereed = 0;
+static inline void grid_write_lock(grid_t *grid)
+{
+    uint_fast64_t version = atomic_load_explicit(&grid->latch.version, memory_order_relaxed);
+    while ((version & 1) || !atomic_compare_exchange_weak_explicit(&grid->latch.version, &version, version + 1,
+                                                                   memory_order_seq_cst, memory_order_relaxed)) {
+        version = atomic_load_explicit(&grid->latch.version, memory_order_relaxed);
+    }
+    // Readers in shared mode that entered before the version became odd finish first, later ones wait for the writer
+    while (atomic_load(&grid->latch.nshared) > 0);
+}
 
-    const tuple_id_interval_t *it = vec_begin(grid->tuple_ids);
-    // since tuples in the interval list maps bidirectional to tuplets, it holds with all other assumptions on the
-    // interval list and the construction of the mapping: in the order-preserving union of all intervals,
-    // the i-th tuple is mapped to the tuplet is i.
+static inline void grid_write_unlock(grid_t *grid)
+{
+    atomic_fetch_add_explicit(&grid->latch.version, 1, memory_order_release);
+}
 
-    // sum up the number of tuples covered in each interval until this sum exceeds 'tuplet_id'
-    for (; num_tuple_covereed <= tuplet_id; num_tuple_covereed += INTERVAL_SPAN(it), it++);
+/*!
+ * @brief Acquires the latch of <i>grid</i> in shared mode, which excludes writers but not other readers in shared mode.
+ * The version of <i>grid</i> is not changed, hence optimistic readers are not affected.
+ */
+static inline void grid_share_lock(const grid_t *grid)
+{
+    grid_latch_t *latch = (grid_latch_t *) &grid->latch;
+    while (true) {
+        u64 version = grid_read_begin(grid);
+        atomic_fetch_add(&latch->nshared, 1);
+        // A writer that acquired the latch meanwhile might have missed this reader
+        if (atomic_load(&latch->version) == version) {
+            return;
+        }
+        atomic_fetch_sub(&latch->nshared, 1);
+    }
+}
+
+static inline void grid_share_unlock(const grid_t *grid)
+{
+    atomic_fetch_sub_explicit((atomic_size_t *) &grid->latch.nshared, 1, memory_order_release);
+}
 
-    // return the tuple identifier that is mapped to the tuplet id
-    return (it->end - (num_tuple_covereed - tuplet_id) - 1);
-}
\ No newline at end of file
@@ -0,0 +1,118 @@
+// Counters of the accesses to grids and attributes that drive the adaptive reorganization of grid tables
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <stdatomic.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define GRID_MONITOR_HEAT_BUCKETS   16   /* number of equal-sized tuplet ranges per grid for which heat is counted */
+#define GRID_MONITOR_HEAT_SAMPLE    64   /* every n-th field access by a cursor is recorded in the heat of its grid */
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+enum grid_access_kind {
+    GRID_ACCESS_ROW, /*!< tuple-at-a-time access to the fields of a tuple, e.g., by tuple fields and table windows */
+    GRID_ACCESS_COLUMN, /*!< column-at-a-time access to a run of tuplets, e.g., by melting and batch writes */
+    GRID_ACCESS_KIND_MAX
+};
+
+/* Access counters of a single grid. Counters are updated with relaxed atomics by any thread that accesses the grid,
+ * and are aged by the reorganizer (see grid_monitor_decay()), such that these reflect the recent workload. Cursors
+ * count their accesses locally and add them to the grid at once, hence counting costs no shared write per field. */
+typedef struct grid_monitor_t {
+    atomic_uint_fast64_t fields[GRID_ACCESS_KIND_MAX]; /*!< number of accessed fields per kind of access */
+    atomic_uint_fast64_t heat[GRID_MONITOR_HEAT_BUCKETS]; /*!< accessed fields per range of tuplets, where the i-th
+                                                               range starts at tuplet 'i << heat_shift' */
+    unsigned heat_shift; /*!< log2 of the number of tuplets per heat range, fixed when the grid is created */
+} grid_monitor_t;
+
+/* Attribute co-access counters of a table. The entry for the attributes (a, b) with a <= b counts the tuples in which
+ * both were accessed by the same operation (e.g., a cursor or a melt), and the entry (a, a) the tuples in which a was
+ * accessed at all. */
+typedef struct table_monitor_t {
+    size_t nattrs; /*!< number of attributes of the table */
+    atomic_uint_fast64_t *coaccess; /*!< 'nattrs x nattrs' matrix of which only the upper triangle is used */
+} table_monitor_t;
+
+/* A copy of the counters of a grid monitor at some point in time. */
+typedef struct grid_workload_t {
+    u64 fields[GRID_ACCESS_KIND_MAX];
+    u64 heat[GRID_MONITOR_HEAT_BUCKETS];
+} grid_workload_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Initializes <i>monitor</i> for a grid that holds at most <i>ntuplets</i> tuplets.
+ */
+void grid_monitor_create(grid_monitor_t *monitor, size_t ntuplets);
+
+/*!
+ * @brief Counts <i>nfields</i> accessed fields of the kind <i>kind</i>.
+ */
+void grid_monitor_count(grid_monitor_t *monitor, enum grid_access_kind kind, u64 nfields);
+
+/*!
+ * @brief Adds <i>weight</i> accesses per tuplet to the heat of the tuplets [<i>begin</i>, <i>begin</i> +
+ * <i>ntuplets</i>).
+ */
+void grid_monitor_heat(grid_monitor_t *monitor, size_t begin, size_t ntuplets, u64 weight);
+
+/*!
+ * @brief Counts an access of the kind <i>kind</i> to <i>nattrs</i> attributes of the tuplets [<i>begin</i>,
+ * <i>begin</i> + <i>ntuplets</i>), i.e., grid_monitor_count() and grid_monitor_heat() at once.
+ */
+void grid_monitor_record(grid_monitor_t *monitor, enum grid_access_kind kind, size_t begin, size_t ntuplets,
+                         size_t nattrs);
+
+void grid_monitor_snapshot(grid_workload_t *out, const grid_monitor_t *monitor);
+
+/*!
+ * @brief Divides all counters of <i>monitor</i> by 2^<i>shift</i>. Accesses that are counted concurrently are not lost.
+ */
+void grid_monitor_decay(grid_monitor_t *monitor, unsigned shift);
+
+void table_monitor_create(table_monitor_t *monitor, size_t nattrs);
+void table_monitor_dispose(table_monitor_t *monitor);
+
+/*!
+ * @brief Counts that the attributes <i>attr_ids</i> were accessed together in <i>ntuples</i> tuples.
+ */
+void table_monitor_record(table_monitor_t *monitor, const attr_id_t *attr_ids, size_t nattr_ids, u64 ntuples);
+
+/*!
+ * @brief Returns the number of tuples in which both <i>lhs</i> and <i>rhs</i> were accessed, or in which <i>lhs</i>
+ * was accessed if both are the same attribute.
+ */
+u64 table_monitor_coaccess(const table_monitor_t *monitor, attr_id_t lhs, attr_id_t rhs);
+
+void table_monitor_decay(table_monitor_t *monitor, unsigned shift);
+
+static inline u64 grid_workload_total(const grid_workload_t *workload)
+{
+    return workload->fields[GRID_ACCESS_ROW] + workload->fields[GRID_ACCESS_COLUMN];
+}
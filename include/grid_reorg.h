@@ -0,0 +1,113 @@
+// Adaptive reorganization of the grids of a table driven by the observed workload
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define GRID_REORG_MIN_ACCESSES     65536   /* accessed fields of a grid from which on its layout is reconsidered */
+#define GRID_REORG_MIN_GAIN         0.25    /* minimum estimated cost reduction for which a grid is converted */
+#define GRID_REORG_AFFINITY         0.10    /* minimum ratio of common accesses for which attributes belong together */
+#define GRID_REORG_DECAY_SHIFT      1       /* access counters are halved after each round */
+#define GRID_REORG_COOLDOWN         8       /* rounds after a conversion in which the grid is not converted again */
+#define GRID_REORG_LINE_SIZE        64      /* size in bytes of a cache line in the cost model */
+#define GRID_REORG_PROBE_SIZE       4096    /* tuplets read to measure the access cost of a grid */
+#define GRID_REORG_DETAIL_SIZE      128
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+enum grid_reorg_action {
+    GRID_REORG_CONVERT, /*!< the grid was converted into another layout */
+    GRID_REORG_ADVISE_SPLIT, /*!< the attributes of the grid are accessed in disjoint groups */
+    GRID_REORG_ADVISE_MERGE /*!< the attributes of two grids that cover common tuples are accessed together */
+};
+
+typedef struct grid_reorg_entry_t {
+    size_t round; /*!< the round of the reorganizer in which the decision was made */
+    enum grid_reorg_action action;
+    grid_id_t grid_id;
+    grid_id_t other_grid_id; /*!< the grid to merge with, for GRID_REORG_ADVISE_MERGE */
+    enum frag_impl_type_t from; /*!< the layout of the grid before the decision */
+    enum frag_impl_type_t to; /*!< the layout of the grid after the decision */
+    grid_workload_t workload; /*!< the (aged) accesses to the grid that led to the decision */
+    double coaccess; /*!< the average number of attributes of the grid that are accessed together in a tuple */
+    double est_gain; /*!< the relative cost reduction estimated by the cost model, for GRID_REORG_CONVERT */
+    double cost_before; /*!< the measured time in nanoseconds per field access of the observed mix of row-wise and
+                             column-wise accesses before the conversion, for GRID_REORG_CONVERT */
+    double cost_after; /*!< the same as 'cost_before' after the conversion */
+    char detail[GRID_REORG_DETAIL_SIZE]; /*!< the attribute groups, for GRID_REORG_ADVISE_SPLIT */
+} grid_reorg_entry_t;
+
+/* Decides per grid of a table, based on the counters of the workload monitor (see grid_monitor.h), whether its layout
+ * fits the accesses to it. A grid whose accesses are mostly row-wise is converted into NSM, and a grid whose accesses
+ * are mostly column-wise to a few of its attributes into DSM (fragments of other types are left as they are).
+ * Conversions do not block readers, see grid_relayout(); hence, rounds must not be run by a thread that holds the latch
+ * of a grid of the table. Grids are never removed from a table, hence splitting and merging grids is advised in the log
+ * rather than applied. Each decision is logged together with the cost of the accesses measured before and after. */
+typedef struct grid_reorg_t {
+    table_t *table; /*!< the table that is reorganized */
+    FILE *log_file; /*!< a file to which each decision is printed as well, or NULL */
+    pthread_mutex_t round_latch; /*!< serializes the rounds of the reorganizer */
+    pthread_mutex_t latch; /*!< protects 'log', 'round' and 'running' */
+    pthread_cond_t wakeup; /*!< signalled when the background reorganizer is stopped */
+    vec_t /* of grid_reorg_entry_t */ *log; /*!< all decisions made so far */
+    vec_t /* of size_t */ *converted; /*!< per grid id, the round after which the grid was converted last, or 0 */
+    size_t round; /*!< the number of completed rounds */
+    bool running; /*!< whether the background reorganizer is running */
+    unsigned interval_ms; /*!< the time between two rounds of the background reorganizer */
+    future_t worker; /*!< the background reorganizer while 'running' is set */
+} grid_reorg_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+grid_reorg_t *grid_reorg_new(table_t *table, FILE *log_file);
+
+/*!
+ * @brief Stops the background reorganizer of <i>reorg</i> if it is running, and frees <i>reorg</i>.
+ */
+void grid_reorg_delete(grid_reorg_t *reorg);
+
+/*!
+ * @brief Runs a single round of <i>reorg</i>, i.e., decides for each grid of the table whether it should be
+ * reorganized, converts the grids accordingly, and ages the counters of the workload monitor.
+ *
+ * @return The number of converted grids
+ */
+size_t grid_reorg_run(grid_reorg_t *reorg);
+
+/*!
+ * @brief Runs a round of <i>reorg</i> every <i>interval_ms</i> milliseconds in a background thread until
+ * grid_reorg_stop() is called.
+ */
+void grid_reorg_start(grid_reorg_t *reorg, unsigned interval_ms);
+void grid_reorg_stop(grid_reorg_t *reorg);
+
+/*!
+ * @brief Returns a copy of all decisions of <i>reorg</i> so far, which must be freed by the caller.
+ */
+vec_t /* of grid_reorg_entry_t */ *grid_reorg_log(grid_reorg_t *reorg);
+
+void grid_reorg_entry_print(FILE *file, const grid_reorg_entry_t *entry);
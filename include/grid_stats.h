@@ -0,0 +1,108 @@
+// Data statistics of the attributes of a grid that are maintained while the grid is written
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <schema.h>
+#include <field_type.h>
+#include <containers/hll.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define GRID_STATS_SAMPLE_SIZE      1024    /* values per attribute of a grid that are kept as a uniform sample */
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* The sketches of a single attribute of a grid. Values of attributes with a total order (i.e., scalar values of the
+ * built-in types but strings) are represented by their order-preserving key (see frag_zone_key()), such that sketches
+ * of different grids agree. Other values are only hashed. */
+typedef struct attr_sketch_t {
+    enum field_type type; /*!< the type of the attribute */
+    size_t size; /*!< the size of a value in a dense array of values as passed to grid_stats_add() */
+    bool ordered; /*!< whether the attribute has a total order, i.e., whether values are sampled */
+    bool string; /*!< whether the attribute is a string, i.e., whether values are hashed up to their terminator */
+    hll_t distinct; /*!< the hashes of all values written since the last refresh */
+    u64 *sample; /*!< a uniform sample of the keys of the values written since the last refresh (reservoir
+                      sampling), or NULL if the attribute has no total order */
+    size_t nsample; /*!< number of keys in 'sample' */
+    u64 nseen; /*!< number of values written since the last refresh, i.e., from which 'sample' was drawn */
+    u64 next; /*!< once 'sample' is full, the position of the next value that replaces a sampled one */
+    double weight; /*!< the state of the sampler from which the distance to 'next' is drawn */
+} attr_sketch_t;
+
+/* Sketches of all attributes of a grid. Writers of the grid add each written value to the sketches (see
+ * grid_stats_add()), while deletions and overwritten values cannot be removed from these; hence, the sketches are
+ * rebuilt from the grid from time to time (see stats_catalog.h). Row and NULL counts are kept by the fragment. */
+typedef struct grid_stats_t {
+    pthread_mutex_t latch; /*!< protects all fields */
+    size_t nattrs; /*!< number of attributes of the grid */
+    attr_sketch_t *attrs; /*!< sketches per attribute of the grid, indexed by grid attribute id */
+    u64 nchanges; /*!< number of fields written or deleted since the sketches were rebuilt last */
+    u64 seed; /*!< state of the generator for reservoir sampling */
+} grid_stats_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Initializes <i>stats</i> with empty sketches for the attributes of <i>schema</i>, i.e., of a grid.
+ */
+void grid_stats_create(grid_stats_t *stats, const schema_t *schema);
+void grid_stats_dispose(grid_stats_t *stats);
+
+/*!
+ * @brief Adds <i>count</i> values of the grid attribute <i>attr_id</i> to the sketches of <i>stats</i>. <i>values</i>
+ * is a dense array of values as passed to frag_write_column(), i.e., of <code>const char *</code> for strings. A
+ * single value is passed like to tuplet_field_write().
+ */
+void grid_stats_add(grid_stats_t *stats, attr_id_t attr_id, const void *values, size_t count);
+
+/*!
+ * @brief Counts the deletion of <i>count</i> tuplets, whose values remain in the sketches of <i>stats</i>.
+ */
+void grid_stats_deleted(grid_stats_t *stats, u64 count);
+
+/*!
+ * @brief Returns the number of fields of the grid that were written or deleted since its sketches were rebuilt last.
+ */
+u64 grid_stats_num_of_changes(grid_stats_t *stats);
+
+/*!
+ * @brief Copies the sketches of the grid attribute <i>attr_id</i> into <i>out</i>, whose 'sample' must provide space
+ * for GRID_STATS_SAMPLE_SIZE keys, or is ignored if the attribute has no total order.
+ */
+void grid_stats_snapshot(attr_sketch_t *out, grid_stats_t *stats, attr_id_t attr_id);
+
+/*!
+ * @brief Replaces the sketches of <i>stats</i> with the sketches of <i>fresh</i>, which were rebuilt from the grid, and
+ * discounts the <i>nchanges</i> changed fields that the rebuild has seen. Afterwards, <i>fresh</i> holds the replaced
+ * sketches and must be disposed by the caller.
+ */
+void grid_stats_swap(grid_stats_t *stats, grid_stats_t *fresh, u64 nchanges);
+
+/*!
+ * @brief Returns a 64-bit hash of <i>value</i> of the attribute whose sketch is <i>sketch</i> that is equal for equal
+ * values in all grids. <i>value</i> points to a value of the attribute's type, or is a string.
+ */
+u64 attr_sketch_hash(const attr_sketch_t *sketch, const void *value);
@@ -79,6 +79,7 @@ typedef int64_t    s64;
 enum tuplet_format {
     TF_NSM  = 1,
     TF_DSM  = 2,
+    TF_PAX  = 3,
 };
 
 #define FLAG_REGULAR          0
@@ -87,6 +88,8 @@ enum tuplet_format {
 #define FLAG_NULLABLE    1 << 3
 #define FLAG_AUTOINC     1 << 4
 #define FLAG_UNIQUE      1 << 5
+#define FLAG_DICTIONARY  1 << 6
+#define FLAG_VARLEN      1 << 7
 
 typedef struct {
     uint8_t primary  : 1;
@@ -94,6 +97,8 @@ typedef struct {
     uint8_t nullable : 1;
     uint8_t autoinc  : 1;
     uint8_t unique   : 1;
+    uint8_t dict     : 1; /* string values are dictionary-encoded, i.e., fields store codes */
+    uint8_t varlen   : 1; /* string values have variable length, i.e., fields store a vstring_t header */
 } ATTR_FLAGS;
 
 typedef MD5_CTX checksum_context_t;
@@ -8,6 +8,7 @@
 
 typedef struct gs_dispatcher_t gs_dispatcher_t;
 typedef struct gs_event_t gs_event_t;
+typedef struct stats_catalog_t stats_catalog_t;
 
 __BEGIN_DECLS
 
@@ -19,6 +20,12 @@ GS_DECLARE(gs_status_t) gs_shell_create(gs_shell_t **shell, gs_dispatcher_t *dis
 
 GS_DECLARE(gs_status_t) gs_shell_start(gs_shell_t *shell);
 
+/*!
+ * @brief Makes the statistics of <i>catalog</i> available to the 'stats' command of <i>shell</i>. Catalogs must be
+ * registered before the shell is started, and must outlive it.
+ */
+GS_DECLARE(gs_status_t) gs_shell_register_catalog(gs_shell_t *shell, stats_catalog_t *catalog);
+
 GS_DECLARE(gs_status_t) gs_shell_dispose(gs_shell_t **shell);
 
 GS_DECLARE(gs_status_t) gs_shell_handle_events(const gs_event_t *event);
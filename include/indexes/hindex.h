@@ -48,6 +48,7 @@ typedef struct hindex_t {
     void (*_add)(struct hindex_t *self, const tuple_id_interval_t *key, const struct grid_t *grid);
     void (*_remove_interval)(struct hindex_t *self, const tuple_id_interval_t *key);
     void (*_remove_intersec)(struct hindex_t *self, tuple_id_t tid);
+    void (*_remove_grid)(struct hindex_t *self, const tuple_id_interval_t *key, const struct grid_t *grid);
     bool (*_contains)(const struct hindex_t *self, tuple_id_t tid);
     void (*_query)(grid_cursor_t *result, const struct hindex_t *self, const tuple_id_t *tid_begin,
                    const tuple_id_t *tid_end);
@@ -67,6 +68,7 @@ void hindex_delete(struct hindex_t *index);
 void hindex_add(struct hindex_t *index, const tuple_id_interval_t *key, const struct grid_t *grid);
 void hindex_remove(struct hindex_t *index, const tuple_id_interval_t *key);
 void hindex_remove_having(struct hindex_t *index, tuple_id_t tid);
+void hindex_remove_grid(struct hindex_t *index, const tuple_id_interval_t *key, const struct grid_t *grid);
 bool hindex_contains(const struct hindex_t *index, tuple_id_t tid);
 grid_cursor_t *hindex_query(const struct hindex_t *index, const tuple_id_t *tid_begin,
                             const tuple_id_t *tid_end);
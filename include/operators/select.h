@@ -0,0 +1,76 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <frag.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/*!
+ * @brief Selects all tuplets in <i>frag</i> whose string attribute <i>attr_id</i> equals one of <i>values</i>.
+ *
+ * For dictionary-encoded attributes, the values are translated into codes once and the predicate is evaluated on
+ * the codes stored in the fragment; no field is decoded. If none of the values is contained in the dictionary, the
+ * fragment is not scanned at all. For variable-length attributes, the values are turned into string headers once, and
+ * a field is compared with a value only if their length and prefix match. Deleted tuplets and NULL fields never
+ * qualify.
+ *
+ * @param result A bitmap over at least <code>frag->ntuplets</code> bits; bit i is set iff tuplet i qualifies
+ * @return The number of qualifying tuplets
+ */
+size_t select_str_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues);
+
+/*!
+ * @brief Selects all tuplets in <i>frag</i> whose string attribute <i>attr_id</i> equals <i>value</i>, see
+ * select_str_in().
+ */
+size_t select_str_eq(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char *value);
+
+/*!
+ * @brief Selects all tuplets in <i>frag</i> whose string attribute <i>attr_id</i> starts with <i>prefix</i>.
+ *
+ * For variable-length attributes, the predicate is evaluated on the string headers if <i>prefix</i> is at most
+ * VSTRING_PREFIX_LEN bytes long, and longer strings are read only if their header matches. Deleted tuplets and NULL
+ * fields never qualify.
+ *
+ * @param result A bitmap over at least <code>frag->ntuplets</code> bits; bit i is set iff tuplet i qualifies
+ * @return The number of qualifying tuplets
+ */
+size_t select_str_prefix(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char *prefix);
+
+/*!
+ * @brief Selects all tuplets in <i>frag</i> whose integer attribute <i>attr_id</i> is in [<i>lower</i>, <i>upper</i>].
+ *
+ * Both bounds point to values of the attribute's type. Compressed blocks of a DSM column (see frag_compress()) are
+ * evaluated on the compressed data, and skipped entirely if their min/max does not overlap the range. Uncompressed
+ * tuplets are read only in blocks whose zone map (see frag_zone_overlaps()) overlaps the range. Deleted tuplets and
+ * NULL fields never qualify.
+ *
+ * @param result A bitmap over at least <code>frag->ntuplets</code> bits; bit i is set iff tuplet i qualifies
+ * @return The number of qualifying tuplets
+ */
+size_t select_int_between(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const void *lower, const void *upper);
+
+/*!
+ * @brief Selects all tuplets in <i>frag</i> whose integer attribute <i>attr_id</i> equals <i>value</i>, see
+ * select_int_between().
+ */
+size_t select_int_eq(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const void *value);
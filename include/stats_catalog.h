@@ -0,0 +1,142 @@
+// Statistics catalog over the grids of a table for cardinality estimation
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define STATS_CATALOG_BUCKETS           32      /* buckets of an equi-depth histogram */
+#define STATS_CATALOG_REFRESH_RATIO     0.10    /* ratio of changed fields of a grid from which on it is rescanned */
+#define STATS_CATALOG_BLOCK_SIZE        16384   /* tuplets that are scanned at once under the grid latch */
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* An equi-depth histogram over the keys (see frag_zone_key()) of the non-null values of an attribute, which is built
+ * from the samples of the grids. Each bucket holds about the same number of values, and buckets do not overlap. */
+typedef struct histogram_t {
+    size_t nbuckets; /*!< number of buckets in use, which is 0 if no value was sampled */
+    u64 lower[STATS_CATALOG_BUCKETS]; /*!< smallest sampled key per bucket */
+    u64 upper[STATS_CATALOG_BUCKETS]; /*!< largest sampled key per bucket */
+    double depths[STATS_CATALOG_BUCKETS]; /*!< estimated number of values per bucket */
+} histogram_t;
+
+/* Statistics of a table attribute in a single grid, or merged over all grids that cover the attribute. Row and NULL
+ * counts are exact, while the distinct count and the histogram are estimates. */
+typedef struct column_stats_t {
+    attr_id_t attr_id; /*!< the table attribute */
+    enum field_type type; /*!< the type of the attribute */
+    bool ordered; /*!< whether the attribute has a total order, i.e., whether 'histogram' is built */
+    size_t ngrids; /*!< number of grids that were merged */
+    u64 nrows; /*!< number of tuples (excluding deleted ones) */
+    u64 nnulls; /*!< number of NULL values */
+    u64 nchanges; /*!< number of fields changed since the sketches were rebuilt last, which degrade the estimates */
+    hll_t distinct; /*!< sketch of the distinct values */
+    histogram_t histogram; /*!< histogram of the values, if 'ordered' */
+} column_stats_t;
+
+/* Maintains the statistics of the grids of a table. Writers of a grid add the written values to its sketches (see
+ * grid_stats.h). Since deleted and overwritten values remain in the sketches, the catalog rescans grids in which more
+ * than STATS_CATALOG_REFRESH_RATIO of the fields changed since their last rescan, either on request or by a background
+ * task. Rescans latch a grid for at most STATS_CATALOG_BLOCK_SIZE tuplets at once, and delay its writers only shortly.
+ * The statistics of an attribute over the whole table are obtained by merging the sketches of all grids covering it. */
+typedef struct stats_catalog_t {
+    table_t *table; /*!< the table whose grids are described */
+    pthread_mutex_t refresh_latch; /*!< serializes the refreshes of the catalog */
+    pthread_mutex_t latch; /*!< protects 'nrefreshed' and 'running' */
+    pthread_cond_t wakeup; /*!< signalled when the background refresher is stopped */
+    size_t nrefreshed; /*!< the number of grids rescanned so far */
+    bool running; /*!< whether the background refresher is running */
+    unsigned interval_ms; /*!< the time between two refreshes of the background refresher */
+    future_t worker; /*!< the background refresher while 'running' is set */
+} stats_catalog_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E   F U N C T I O N S
+// ---------------------------------------------------------------------------------------------------------------------
+
+stats_catalog_t *stats_catalog_new(table_t *table);
+
+/*!
+ * @brief Stops the background refresher of <i>catalog</i> if it is running, and frees <i>catalog</i>.
+ */
+void stats_catalog_delete(stats_catalog_t *catalog);
+
+/*!
+ * @brief Rescans the grids of the table whose sketches are outdated, or all grids if <i>force</i> is set.
+ *
+ * @return The number of rescanned grids
+ */
+size_t stats_catalog_refresh(stats_catalog_t *catalog, bool force);
+
+/*!
+ * @brief Refreshes <i>catalog</i> every <i>interval_ms</i> milliseconds in a background thread until
+ * stats_catalog_stop() is called.
+ */
+void stats_catalog_start(stats_catalog_t *catalog, unsigned interval_ms);
+void stats_catalog_stop(stats_catalog_t *catalog);
+
+/*!
+ * @brief Returns in <i>out</i> the statistics of the table attribute <i>attr_id</i> in the grid <i>grid_id</i>.
+ *
+ * @return <b>false</b> if the grid does not cover the attribute
+ */
+bool stats_catalog_grid_column(column_stats_t *out, stats_catalog_t *catalog, grid_id_t grid_id, attr_id_t attr_id);
+
+/*!
+ * @brief Returns in <i>out</i> the statistics of the table attribute <i>attr_id</i> over all grids that cover it, i.e.,
+ * the sketches of these grids merged.
+ *
+ * @return <b>false</b> if no grid covers the attribute
+ */
+bool stats_catalog_column(column_stats_t *out, stats_catalog_t *catalog, attr_id_t attr_id);
+
+/*!
+ * @brief Returns the estimated number of distinct non-null values described by <i>stats</i>.
+ */
+double column_stats_distinct(const column_stats_t *stats);
+
+/*!
+ * @brief Returns the estimated ratio of the tuples described by <i>stats</i> whose value is equal to <i>value</i>,
+ * which points to a value of the attribute's type, or is a string.
+ */
+double column_stats_eq_selectivity(const column_stats_t *stats, const void *value);
+
+/*!
+ * @brief Returns the estimated ratio of the tuples described by <i>stats</i> whose value is in [<i>lower</i>,
+ * <i>upper</i>]. Both bounds point to values of the attribute's type, or are NULL for an unbounded side. The attribute
+ * must have a total order.
+ */
+double column_stats_range_selectivity(const column_stats_t *stats, const void *lower, const void *upper);
+
+/*!
+ * @brief Returns the value of the attribute's type to which <i>key</i> (see frag_zone_key()) belongs as a double.
+ */
+double column_stats_key_value(const column_stats_t *stats, u64 key);
+
+void column_stats_print(FILE *file, const table_t *table, const column_stats_t *stats);
+
+/*!
+ * @brief Prints the statistics of each attribute of the table per grid, and merged over all grids.
+ */
+void stats_catalog_print(FILE *file, stats_catalog_t *catalog);
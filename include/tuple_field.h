@@ -22,6 +22,12 @@
 #include <tuplet_field.h>
 #include <grid.h>
 
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define TUPLE_FIELD_INLINE_SIZE     32  /* values up to this size in bytes are copied into the field itself when read */
+
 // ---------------------------------------------------------------------------------------------------------------------
 // D A T A   T Y P E S
 // ---------------------------------------------------------------------------------------------------------------------
@@ -34,14 +40,50 @@ typedef struct tuple_field_t
     tuple_t *tuple;
     tuplet_t tuplet;
     tuplet_field_t tuplet_field;
+    table_plan_step_t step; /*!< grid and tuplet run resolved for the last seek, reused while the tuple stays in it */
+    u64 epoch; /*!< the epoch of the readers of 'grid' when 'tuplet' was opened, see grid_relayout() */
+    grid_t *latched; /*!< the grid whose latch is held across the writes to a tuple, see tuple_field_write(), or NULL */
+    union {
+        max_align_t align;
+        char bytes[TUPLE_FIELD_INLINE_SIZE];
+    } inline_value; /*!< copy of the value read last if it fits, see tuple_field_read() */
+    void *value; /*!< copy of the value read last if it is larger than 'inline_value', or NULL */
+    size_t value_capacity; /*!< size in bytes of the storage 'value' points to */
 } tuple_field_t;
 
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E   D E C L A R A T I O N
 // ---------------------------------------------------------------------------------------------------------------------
 
+/*!
+ * @brief Opens <i>field</i> at the first attribute of <i>tuple</i>. A field that was used before must be closed via
+ * tuple_field_close() before it is opened again.
+ */
 void tuple_field_open(tuple_field_t *field, tuple_t *tuple);
 void tuple_field_seek(tuple_field_t *tuple_field, tuple_t *tuple, attr_id_t table_attr_id);
 void tuple_field_next(tuple_field_t *field);
+
+/*!
+ * @brief Writes <i>data</i> into <i>field</i> and moves it to the next attribute. Writers hold the latch of the
+ * field's grid, which is acquired once for consecutive writes into the same grid: it is released when the field moves
+ * to another grid or beyond the last attribute of the tuple, when it is read or sought, and when it is closed. Hence, a
+ * tuple that is written attribute by attribute latches each of its grids once, and a field that stops writing in the
+ * middle of a tuple must be closed before the calling thread accesses the grid otherwise.
+ */
 void tuple_field_write(tuple_field_t *field, const void *data);
+
+/*!
+ * @brief Returns the value of <i>field</i>. The field is opened again if its grid was converted into another layout
+ * meanwhile. The value is copied under the grid latch into storage owned by <i>field</i>, since neither conversions nor
+ * writers keep the fragment's buffers once the latch is released. Values of up to TUPLE_FIELD_INLINE_SIZE bytes (e.g.,
+ * all numbers) are copied into <i>field</i> itself, longer strings into storage that <i>field</i> allocates. Hence, the
+ * returned value stays valid until the next call to tuple_field_read() or tuple_field_close() on <i>field</i>, and the
+ * calling thread must not hold the latch of the field's grid.
+ */
 const void *tuple_field_read(tuple_field_t *field);
+
+/*!
+ * @brief Releases the grid latch held by writes to <i>field</i> (see tuple_field_write()), and frees the storage of
+ * the values read from <i>field</i>.
+ */
+void tuple_field_close(tuple_field_t *field);
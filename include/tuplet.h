@@ -99,6 +99,14 @@ void tuplet_set_null(tuplet_t *tuplet);
 
 bool tuplet_is_null(tuplet_t *tuplet);
 
+/*!
+ * @brief Marks the tuplet as deleted in its fragment's tombstone bitmap. The tuplet data stays in place (and the
+ * cursor remains valid) until the fragment is compacted, see frag_compact().
+ */
+void tuplet_delete(tuplet_t *tuplet);
+
+bool tuplet_is_deleted(tuplet_t *tuplet);
+
 size_t tuplet_size(tuplet_t *tuplet);
 
 void *tuplet_update(void *dst, schema_t *frag, attr_id_t attr_id, void *src);
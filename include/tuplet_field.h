@@ -28,6 +28,7 @@ typedef struct tuplet_field_t {
 
     attr_id_t attr_id; /*<! current attribute tuplet_id to which this tuplet is seeked */
     void *attr_value_ptr; /*<! pointer in data in 'tuplet_base' of attr_value_ptr content of attribute 'attr_id */
+    u64 value; /*<! holds a copy of the current value if it is not addressable in the fragment (e.g., compressed) */
 
     /* operations */
     bool (*_next)(struct tuplet_field_t *self, bool auto_next); /* seeks to the next attr_value_ptr inside this tuplet */
@@ -0,0 +1,144 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <frag.h>
+#include <frag_accessors.h>
+#include <tuplet_field.h>
+#include <timer.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     10000000
+#define NUM_REPETITIONS 5
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+frag_t *create_fragment(schema_t *schema, enum frag_impl_type_t type);
+u64 sum_vtable(frag_t *frag, attr_id_t attr_id);
+u64 sum_nsm_specialized(frag_t *frag, attr_id_t attr_id);
+u64 sum_dsm_specialized(frag_t *frag, attr_id_t attr_id);
+void run(const char *name, frag_t *frag, attr_id_t attr_id, u64 (*sum)(frag_t *, attr_id_t));
+
+// Compares the generic field access via tuplet_t/tuplet_field_t (i.e., function pointers and format branches) with
+// the specialized accessors of frag_accessors.h by summing up a single 32-bit column of a fragment with four
+// attributes, once in row format (NSM) and once in column format (DSM).
+int main(void) {
+
+    schema_t *schema = schema_new("benchmark");
+    attr_create_uint64("A", schema); // attribute id 0
+    attr_create_uint32("B", schema); // attribute id 1
+    attr_create_uint16("C", schema); // attribute id 2
+    attr_create_uint64("D", schema); // attribute id 3
+
+    frag_t *nsm = create_fragment(schema, FIT_HOST_NSM_VM);
+    frag_t *dsm = create_fragment(schema, FIT_HOST_DSM_VM);
+
+    printf("summing up attribute 'B' of %d tuplets, best of %d runs\n", NUM_TUPLETS, NUM_REPETITIONS);
+    run("nsm, tuplet field  ", nsm, 1, sum_vtable);
+    run("nsm, specialized   ", nsm, 1, sum_nsm_specialized);
+    run("dsm, tuplet field  ", dsm, 1, sum_vtable);
+    run("dsm, specialized   ", dsm, 1, sum_dsm_specialized);
+
+    frag_delete(nsm);
+    frag_delete(dsm);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+frag_t *create_fragment(schema_t *schema, enum frag_impl_type_t type)
+{
+    frag_t *frag = frag_new(schema, NUM_TUPLETS, type);
+    frag_insert(NULL, frag, NUM_TUPLETS);
+
+    u64 *a = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(u64));
+    u32 *b = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(u32));
+    u16 *c = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(u16));
+    for (size_t i = 0; i < NUM_TUPLETS; i++) {
+        a[i] = i;
+        b[i] = (u32) (i % 1000);
+        c[i] = (u16) (i % 7);
+    }
+    frag_write_column(frag, 0, 0, NUM_TUPLETS, a);
+    frag_write_column(frag, 1, 0, NUM_TUPLETS, b);
+    frag_write_column(frag, 2, 0, NUM_TUPLETS, c);
+    frag_write_column(frag, 3, 0, NUM_TUPLETS, a);
+
+    free(a);
+    free(b);
+    free(c);
+    return frag;
+}
+
+u64 sum_vtable(frag_t *frag, attr_id_t attr_id)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    u64 sum = 0;
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_seek(&field, &tuplet, attr_id);
+        sum += *(const u32 *) tuplet_field_read(&field);
+    } while (tuplet_next(&tuplet));
+    return sum;
+}
+
+u64 sum_nsm_specialized(frag_t *frag, attr_id_t attr_id)
+{
+    REQUIRE(frag_nsm_uint32_supports(frag, attr_id), "specialized accessor not applicable");
+    u64 sum = 0;
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < frag->ntuplets; tuplet_id++) {
+        sum += frag_nsm_uint32_read(frag, attr_id, tuplet_id);
+    }
+    return sum;
+}
+
+u64 sum_dsm_specialized(frag_t *frag, attr_id_t attr_id)
+{
+    REQUIRE(frag_dsm_uint32_supports(frag, attr_id), "specialized accessor not applicable");
+    const u32 *column = frag_dsm_uint32_column(frag, attr_id);
+    size_t ntuplets = frag->ntuplets;
+    u64 sum = 0;
+    for (size_t i = 0; i < ntuplets; i++) {
+        sum += column[i];
+    }
+    return sum;
+}
+
+void run(const char *name, frag_t *frag, attr_id_t attr_id, u64 (*sum)(frag_t *, attr_id_t))
+{
+    m_timer_t timer;
+    double best = 0;
+    u64 result = 0;
+    for (int i = 0; i < NUM_REPETITIONS; i++) {
+        timer_start(&timer);
+        result = sum(frag, attr_id);
+        timer_stop(&timer);
+        double elapsed = timer_diff_ms(&timer);
+        best = (i == 0 ? elapsed : min(best, elapsed));
+    }
+    printf("%s: %10.2f ms (sum %" PRIu64 ")\n", name, best, result);
+}
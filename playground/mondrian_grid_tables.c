@@ -67,6 +67,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -100,6 +101,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -135,6 +137,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -167,6 +170,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -203,6 +207,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -240,6 +245,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -278,6 +284,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -316,6 +323,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
@@ -376,6 +384,7 @@ int main(void) {
         tuple_field_write(&field, &b);
         tuple_field_write(&field, &c);
         tuple_field_write(&field, &d);
+        tuple_field_close(&field);
         a += 4;
         b += 4;
         c += 4;
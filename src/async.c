@@ -125,7 +125,6 @@ bool _eval(future_t future, future_eval_policy policy)
 bool _sync_exec(void *call_result, future_t future, promise_result return_value)
 {
     call_result = future->func(&return_value, future->capture);
-    atomic_store(&future->promise_settled, true);
     switch (return_value) {
         case rejected:
             future->promise_state = promise_rejected;
@@ -138,6 +137,8 @@ bool _sync_exec(void *call_result, future_t future, promise_result return_value)
             return false;
     }
     future->call_result = call_result;
+    /* settle last, since a waiting thread may free the future as soon as it observes the settled promise */
+    atomic_store(&future->promise_settled, true);
     return true;
 }
 
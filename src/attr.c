@@ -20,6 +20,8 @@
 #include <tuplet_field.h>
 #include <frag.h>
 #include <schema.h>
+#include <containers/dict.h>
+#include <containers/vstring.h>
 
 #define DEFINE_ATTRIBUTE_CREATE(type_name,internal_type)                                                               \
 attr_id_t attr_create_##type_name(const char *name, schema_t *schema) {                                                \
@@ -77,6 +79,11 @@ const attr_t *attr_cpy(const attr_t *template, schema_t *new_owner)
 }
 
 size_t attr_total_size(const struct attr_t *attr)
+{
+    return (attr->flags.dict ? sizeof(dict_code_t) : (attr->flags.varlen ? sizeof(vstring_t) : attr_value_size(attr)));
+}
+
+size_t attr_value_size(const struct attr_t *attr)
 {
     return attr->type_rep * field_type_sizeof(attr->type);
 }
@@ -84,7 +91,30 @@ size_t attr_total_size(const struct attr_t *attr)
 attr_id_t attr_create(const char *name, enum field_type data_type, size_t data_type_rep, schema_t *schema)
 {
     return _attr_create(name, data_type, data_type_rep,
-                        (ATTR_FLAGS) { .autoinc = 0, .foreign = 0, .nullable = 0, .primary = 0, .unique = 0 },
+                        (ATTR_FLAGS) { .autoinc = 0, .foreign = 0, .nullable = 0, .primary = 0, .unique = 0,
+                                       .dict = 0, .varlen = 0 },
+                        schema);
+}
+
+attr_id_t attr_create_ex(const char *name, enum field_type data_type, size_t data_type_rep, int flags,
+                         schema_t *schema)
+{
+    REQUIRE((!IS_FLAG_SET(flags, FLAG_DICTIONARY) || data_type == FT_CHAR),
+            "Dictionary encoding is only supported for string attributes");
+    REQUIRE((!IS_FLAG_SET(flags, FLAG_VARLEN) || data_type == FT_CHAR),
+            "Variable length is only supported for string attributes");
+    REQUIRE((!IS_FLAG_SET(flags, FLAG_VARLEN) || !IS_FLAG_SET(flags, FLAG_DICTIONARY)),
+            "String attributes are either dictionary-encoded or of variable length");
+    return _attr_create(name, data_type, data_type_rep,
+                        (ATTR_FLAGS) {
+                            .autoinc  = IS_FLAG_SET(flags, FLAG_AUTOINC),
+                            .foreign  = IS_FLAG_SET(flags, FLAG_FOREIGN),
+                            .nullable = IS_FLAG_SET(flags, FLAG_NULLABLE),
+                            .primary  = IS_FLAG_SET(flags, FLAG_PRIMARY),
+                            .unique   = IS_FLAG_SET(flags, FLAG_UNIQUE),
+                            .dict     = IS_FLAG_SET(flags, FLAG_DICTIONARY),
+                            .varlen   = IS_FLAG_SET(flags, FLAG_VARLEN)
+                        },
                         schema);
 }
 
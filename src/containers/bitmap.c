@@ -0,0 +1,75 @@
+// An implementation of a word-aligned bitmap
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/bitmap.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t bitmap_nwords(size_t nbits)
+{
+    return max(1, (nbits + BITMAP_WORD_NBITS - 1) / BITMAP_WORD_NBITS);
+}
+
+bitmap_word_t *bitmap_new(size_t nbits, bool value)
+{
+    size_t nwords = bitmap_nwords(nbits);
+    bitmap_word_t *result = GS_REQUIRE_MALLOC(nwords * sizeof(bitmap_word_t));
+    memset(result, value ? 0xFF : 0x00, nwords * sizeof(bitmap_word_t));
+    return result;
+}
+
+bitmap_word_t *bitmap_resize(bitmap_word_t *bitmap, size_t old_nbits, size_t new_nbits, bool value)
+{
+    GS_REQUIRE_NONNULL(bitmap);
+    size_t old_nwords = bitmap_nwords(old_nbits);
+    size_t new_nwords = bitmap_nwords(new_nbits);
+    if (new_nwords != old_nwords) {
+        bitmap = realloc(bitmap, new_nwords * sizeof(bitmap_word_t));
+        panic_if((bitmap == NULL), BADMALLOC, "unable to resize bitmap");
+    }
+    /* initialize the bits that were added, including the unused tail of the last previously used word */
+    for (size_t pos = old_nbits; pos < min(new_nbits, old_nwords * BITMAP_WORD_NBITS); pos++) {
+        if (value) bitmap_set(bitmap, pos); else bitmap_clear(bitmap, pos);
+    }
+    if (new_nwords > old_nwords) {
+        memset(bitmap + old_nwords, value ? 0xFF : 0x00, (new_nwords - old_nwords) * sizeof(bitmap_word_t));
+    }
+    return bitmap;
+}
+
+void bitmap_free(bitmap_word_t *bitmap)
+{
+    free (bitmap);
+}
+
+size_t bitmap_popcount(const bitmap_word_t *bitmap, size_t nbits)
+{
+    GS_REQUIRE_NONNULL(bitmap);
+    size_t result = 0;
+    size_t nfull  = nbits / BITMAP_WORD_NBITS;
+    for (size_t i = 0; i < nfull; i++) {
+        result += __builtin_popcountll(bitmap[i]);
+    }
+    if (nbits % BITMAP_WORD_NBITS) {
+        bitmap_word_t mask = (1ULL << (nbits % BITMAP_WORD_NBITS)) - 1;
+        result += __builtin_popcountll(bitmap[nfull] & mask);
+    }
+    return result;
+}
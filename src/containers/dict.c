@@ -1,4 +1,4 @@
-// An implementation of the dictionary abstract data structure
+// An implementation of a string dictionary for dictionary encoding
 // Copyright (C) 2017 Marcus Pinnecke
 //
 // This program is free software: you can redistribute it and/or modify it under the terms of the
@@ -17,68 +17,66 @@
 // ---------------------------------------------------------------------------------------------------------------------
 
 #include <containers/dict.h>
+#include <apr_strings.h>
 
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E  I M P L E M E N T A T I O N
 // ---------------------------------------------------------------------------------------------------------------------
 
-bool dict_delete(dict_t *dict)
+dict_t *dict_new(size_t capacity)
 {
-    return DELEGATE_CALL(dict, free_dict);
+    dict_t *result = GS_REQUIRE_MALLOC(sizeof(dict_t));
+    apr_pool_create(&result->pool, NULL);
+    result->codes = apr_hash_make(result->pool);
+    result->strings = vec_new(sizeof(char *), max(1, capacity));
+    return result;
 }
 
-void dict_clear(dict_t *dict)
+void dict_free(dict_t *dict)
 {
-    DELEGATE_CALL(dict, clear);
+    GS_REQUIRE_NONNULL(dict);
+    vec_free(dict->strings);
+    apr_pool_destroy(dict->pool);
+    free (dict);
 }
 
-bool dict_empty(const dict_t *dict)
+dict_code_t dict_encode(dict_t *dict, const char *str)
 {
-    return DELEGATE_CALL(dict, empty);
-}
+    GS_REQUIRE_NONNULL(dict);
+    GS_REQUIRE_NONNULL(str);
 
-bool dict_contains_key(const dict_t *dict, const void *key)
-{
-    return DELEGATE_CALL_WARGS(dict, contains_key, key);
-}
-
-const struct vec_t *dict_keyset(const dict_t *dict)
-{
-    return DELEGATE_CALL(dict, keyset);
-}
-
-const void *dict_get(const dict_t *dict, const void *key)
-{
-    return DELEGATE_CALL_WARGS(dict, get, key);
-}
-
-struct vec_t *dict_gets(const dict_t *dict, size_t num_keys, const void *keys)
-{
-    return DELEGATE_CALL_WARGS(dict, gets, num_keys, keys);
-}
-
-bool dict_remove(dict_t *dict, size_t num_keys, const void *keys)
-{
-    return DELEGATE_CALL_WARGS(dict, remove, num_keys, keys);
-}
-
-void dict_put(dict_t *dict, const void *key, const void *value)
-{
-    DELEGATE_CALL_WARGS(dict, put, key, value);
+    dict_code_t code;
+    if (!dict_lookup(&code, dict, str)) {
+        REQUIRE((dict_size(dict) < UINT32_MAX), "Dictionary code space exhausted");
+        code = dict_size(dict);
+        char *entry = apr_pstrdup(dict->pool, str);
+        dict_code_t *value = apr_pmemdup(dict->pool, &code, sizeof(dict_code_t));
+        apr_hash_set(dict->codes, entry, APR_HASH_KEY_STRING, value);
+        vec_pushback(dict->strings, 1, &entry);
+    }
+    return code;
 }
 
-void dict_puts(dict_t *dict, size_t num_elements, const void *keys, const void *values)
+bool dict_lookup(dict_code_t *code, const dict_t *dict, const char *str)
 {
-    DELEGATE_CALL_WARGS(dict, puts, num_elements, keys, values);
+    GS_REQUIRE_NONNULL(dict);
+    GS_REQUIRE_NONNULL(str);
+    const dict_code_t *value = apr_hash_get(dict->codes, str, APR_HASH_KEY_STRING);
+    if (value != NULL && code != NULL) {
+        *code = *value;
+    }
+    return (value != NULL);
 }
 
-size_t dict_num_elements(dict_t *dict)
+const char *dict_decode(const dict_t *dict, dict_code_t code)
 {
-    return DELEGATE_CALL(dict, num_elements);
+    GS_REQUIRE_NONNULL(dict);
+    REQUIRE_LESSTHAN(code, vec_length(dict->strings));
+    return *(const char **) vec_at(dict->strings, code);
 }
 
-void dict_for_each(dict_t *dict, void *capture,
-                   void (*consumer)(void *capture, const void *key, const void *value))
+size_t dict_size(const dict_t *dict)
 {
-    DELEGATE_CALL_WARGS(dict, for_each, capture, consumer);
+    GS_REQUIRE_NONNULL(dict);
+    return vec_length(dict->strings);
 }
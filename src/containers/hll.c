@@ -0,0 +1,66 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/hll.h>
+#include <math.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+void hll_create(hll_t *hll)
+{
+    GS_REQUIRE_NONNULL(hll);
+    memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+u64 hll_hash(const void *data, size_t size)
+{
+    // FNV-1a spreads the bytes over the word, and the finalizer of hll_hash_u64() spreads them over all bits
+    const u8 *bytes = data;
+    u64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hll_hash_u64(hash);
+}
+
+void hll_merge(hll_t *dst, const hll_t *src)
+{
+    GS_REQUIRE_NONNULL(dst);
+    GS_REQUIRE_NONNULL(src);
+    for (size_t i = 0; i < HLL_NREGISTERS; i++) {
+        dst->registers[i] = max(dst->registers[i], src->registers[i]);
+    }
+}
+
+double hll_estimate(const hll_t *hll)
+{
+    GS_REQUIRE_NONNULL(hll);
+    double m = HLL_NREGISTERS, sum = 0;
+    size_t nzeros = 0;
+    for (size_t i = 0; i < HLL_NREGISTERS; i++) {
+        sum += ldexp(1.0, -hll->registers[i]);
+        nzeros += (hll->registers[i] == 0);
+    }
+    double estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+    // Few distinct values leave registers empty, for which linear counting is more accurate
+    if (estimate <= 2.5 * m && nzeros > 0) {
+        estimate = m * log(m / nzeros);
+    }
+    return estimate;
+}
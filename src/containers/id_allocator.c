@@ -0,0 +1,250 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/id_allocator.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* The identifiers of a single allocator that are owned by a single thread. Each thread keeps a list of its caches
+ * (one per allocator it used) as its value of 'cache_key'. */
+typedef struct id_cache_t {
+    _Atomic(id_allocator_t *) owner; /* the allocator of this cache, or NULL once the allocator was disposed */
+    u64 released_next; /* the next identifier in the range of released identifiers claimed from the owner's pool */
+    u64 released_end; /* the end of the range of released identifiers claimed from the owner's pool */
+    struct id_cache_t *next_of_thread;
+    struct id_cache_t *prev_of_owner;
+    struct id_cache_t *next_of_owner;
+} id_cache_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// G L O B A L S
+// ---------------------------------------------------------------------------------------------------------------------
+
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cache_key;
+
+/* Serializes linking and unlinking of caches against disposing of their owners, i.e., it is acquired only when a
+ * thread uses an allocator for the first time, when a thread exits, and when an allocator is disposed. */
+static pthread_mutex_t cache_registry_latch = PTHREAD_MUTEX_INITIALIZER;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void cache_key_create();
+
+ void thread_caches_free(void *caches);
+
+ id_cache_t *thread_cache(id_allocator_t *allocator);
+
+ void cache_unlink(id_cache_t *cache, id_allocator_t *owner);
+
+ void cache_refill(id_cache_t *cache, id_allocator_t *allocator, size_t num_ids);
+
+ void pool_insert(id_allocator_t *allocator, u64 begin, u64 end);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+void id_allocator_create(id_allocator_t *allocator)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    pthread_once(&cache_key_once, cache_key_create);
+    atomic_init(&allocator->high_water, 0);
+    pthread_mutex_init(&allocator->latch, NULL);
+    range_tree_create(&allocator->released);
+    atomic_init(&allocator->nreleased, 0);
+    allocator->caches = NULL;
+}
+
+void id_allocator_dispose(id_allocator_t *allocator)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    pthread_mutex_lock(&cache_registry_latch);
+    for (id_cache_t *cache = allocator->caches; cache != NULL; cache = cache->next_of_owner) {
+        atomic_store(&cache->owner, NULL);
+    }
+    allocator->caches = NULL;
+    pthread_mutex_unlock(&cache_registry_latch);
+    range_tree_dispose(&allocator->released);
+    pthread_mutex_destroy(&allocator->latch);
+}
+
+void id_allocator_bind(u32 *out, id_allocator_t *allocator, size_t num_ids)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(allocator);
+    REQUIRE((num_ids > 0), BADINT);
+
+    id_cache_t *cache = thread_cache(allocator);
+    while (num_ids > 0) {
+        if (cache->released_next == cache->released_end &&
+            atomic_load_explicit(&allocator->nreleased, memory_order_relaxed) > 0) {
+            cache_refill(cache, allocator, num_ids);
+        }
+        if (cache->released_next < cache->released_end) {
+            size_t n = min(num_ids, cache->released_end - cache->released_next);
+            for (size_t i = 0; i < n; i++) {
+                *out++ = (u32) cache->released_next++;
+            }
+            num_ids -= n;
+        } else {
+            /* Exactly the remaining identifiers are reserved as a single range, which keeps the identifiers of a
+             * batch contiguous and never reserves identifiers that are not bound (and hence, not covered by a grid) */
+            u64 next = atomic_fetch_add_explicit(&allocator->high_water, num_ids, memory_order_relaxed);
+            panic_if((next + num_ids > (u64) UINT32_MAX + 1), BADINTERNAL, "identifier space is exhausted");
+            for (size_t i = 0; i < num_ids; i++) {
+                *out++ = (u32) next++;
+            }
+            num_ids = 0;
+        }
+    }
+}
+
+void id_allocator_release(id_allocator_t *allocator, const u32 *ids, size_t num_ids)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    GS_REQUIRE_NONNULL(ids);
+    REQUIRE((num_ids > 0), BADINT);
+    pthread_mutex_lock(&allocator->latch);
+    // Runs of consecutive identifiers (e.g., of sorted input) are released as a single range
+    for (size_t i = 0, run; i < num_ids; i += run) {
+        for (run = 1; i + run < num_ids && ids[i + run] == (u64) ids[i] + run; run++);
+        pool_insert(allocator, ids[i], (u64) ids[i] + run);
+    }
+    pthread_mutex_unlock(&allocator->latch);
+}
+
+void id_allocator_release_range(id_allocator_t *allocator, u32 begin, u32 end)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    REQUIRE((begin < end), "Corrupted range");
+    pthread_mutex_lock(&allocator->latch);
+    pool_insert(allocator, begin, end);
+    pthread_mutex_unlock(&allocator->latch);
+}
+
+u64 id_allocator_high_water(const id_allocator_t *allocator)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    return atomic_load(&allocator->high_water);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void cache_key_create()
+{
+    panic_if((pthread_key_create(&cache_key, thread_caches_free) != 0), BADINTERNAL,
+             "unable to create thread-local identifier caches");
+}
+
+ void thread_caches_free(void *caches)
+{
+    pthread_mutex_lock(&cache_registry_latch);
+    for (id_cache_t *cache = caches, *next; cache != NULL; cache = next) {
+        next = cache->next_of_thread;
+        id_allocator_t *owner = atomic_load(&cache->owner);
+        if (owner != NULL) {
+            cache_unlink(cache, owner);
+        }
+        free(cache);
+    }
+    pthread_mutex_unlock(&cache_registry_latch);
+}
+
+ id_cache_t *thread_cache(id_allocator_t *allocator)
+{
+    id_cache_t *head = pthread_getspecific(cache_key);
+    id_cache_t *prev = NULL;
+    for (id_cache_t *cache = head; cache != NULL; prev = cache, cache = cache->next_of_thread) {
+        if (atomic_load_explicit(&cache->owner, memory_order_relaxed) == allocator) {
+            if (prev != NULL) {
+                // Keep the most recently used cache in front, since threads tend to insert into the same table
+                prev->next_of_thread = cache->next_of_thread;
+                cache->next_of_thread = head;
+                pthread_setspecific(cache_key, cache);
+            }
+            return cache;
+        }
+    }
+
+    // Caches of disposed allocators are freed by the thread that owns them
+    pthread_mutex_lock(&cache_registry_latch);
+    id_cache_t **it = &head;
+    while (*it != NULL) {
+        if (atomic_load(&(*it)->owner) == NULL) {
+            id_cache_t *orphan = *it;
+            *it = orphan->next_of_thread;
+            free(orphan);
+        } else it = &(*it)->next_of_thread;
+    }
+
+    id_cache_t *cache = GS_REQUIRE_MALLOC(sizeof(id_cache_t));
+    atomic_init(&cache->owner, allocator);
+    cache->released_next = cache->released_end = 0;
+    cache->next_of_thread = head;
+    cache->prev_of_owner = NULL;
+    pthread_mutex_lock(&allocator->latch);
+    cache->next_of_owner = allocator->caches;
+    if (allocator->caches != NULL) {
+        allocator->caches->prev_of_owner = cache;
+    }
+    allocator->caches = cache;
+    pthread_mutex_unlock(&allocator->latch);
+    pthread_setspecific(cache_key, cache);
+    pthread_mutex_unlock(&cache_registry_latch);
+    return cache;
+}
+
+ void cache_unlink(id_cache_t *cache, id_allocator_t *owner)
+{
+    // Identifiers owned by an exiting thread are released to the allocator for other threads
+    pthread_mutex_lock(&owner->latch);
+    if (cache->released_next < cache->released_end) {
+        pool_insert(owner, cache->released_next, cache->released_end);
+    }
+    if (cache->prev_of_owner != NULL) {
+        cache->prev_of_owner->next_of_owner = cache->next_of_owner;
+    } else {
+        owner->caches = cache->next_of_owner;
+    }
+    if (cache->next_of_owner != NULL) {
+        cache->next_of_owner->prev_of_owner = cache->prev_of_owner;
+    }
+    pthread_mutex_unlock(&owner->latch);
+}
+
+ void cache_refill(id_cache_t *cache, id_allocator_t *allocator, size_t num_ids)
+{
+    // The smallest released identifiers are claimed first, at most as many as needed but at least a whole batch
+    pthread_mutex_lock(&allocator->latch);
+    range_tree_take_first(&cache->released_next, &cache->released_end, &allocator->released,
+                          max(num_ids, ID_ALLOCATOR_CACHE_SIZE));
+    atomic_store_explicit(&allocator->nreleased, allocator->released.num_elements, memory_order_relaxed);
+    pthread_mutex_unlock(&allocator->latch);
+}
+
+ void pool_insert(id_allocator_t *allocator, u64 begin, u64 end)
+{
+    panic_if(!range_tree_insert(&allocator->released, begin, end), BADINTERNAL, "identifier is released twice");
+    atomic_store_explicit(&allocator->nreleased, allocator->released.num_elements, memory_order_relaxed);
+}
@@ -0,0 +1,373 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/intpack.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_AVX2_UNPACK
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// M A C R O S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define SIGN_BIT       (1ULL << 63)
+#define CODE_MASK(w)   ((w) == 64 ? ~0ULL : ((1ULL << (w)) - 1))
+#define NUM_WORDS(n,w) ((((n) * (w)) + 63) / 64 + 1)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u8 bit_width(u64 value);
+ void pack_code(u64 *words, size_t idx, u8 width, u64 code);
+ u64 unpack_code(const u64 *words, size_t idx, u8 width);
+ void unpack_scalar(u64 *dst, const u64 *words, size_t begin, size_t end, u8 width);
+ void unpack_values(u64 *dst, const intpack_block_t *block);
+#ifdef HAVE_AVX2_UNPACK
+ __attribute__((target("avx2"))) void unpack_avx2(u64 *dst, const intpack_block_t *block);
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool intpack_supports(enum field_type type)
+{
+    return (type >= FT_INT8 && type <= FT_UINT64);
+}
+
+u64 intpack_normalize(const void *value, enum field_type type)
+{
+    switch (type) {
+        case FT_INT8:   return ((u64) (s64) *(const int8_t *) value) ^ SIGN_BIT;
+        case FT_INT16:  return ((u64) (s64) *(const int16_t *) value) ^ SIGN_BIT;
+        case FT_INT32:  return ((u64) (s64) *(const int32_t *) value) ^ SIGN_BIT;
+        case FT_INT64:  return ((u64) *(const int64_t *) value) ^ SIGN_BIT;
+        case FT_UINT8:  return *(const uint8_t *) value;
+        case FT_UINT16: return *(const uint16_t *) value;
+        case FT_UINT32: return *(const uint32_t *) value;
+        case FT_UINT64: return *(const uint64_t *) value;
+        default: panic(BADARG, "type");
+    }
+}
+
+void intpack_denormalize(void *dst, u64 value, enum field_type type)
+{
+    switch (type) {
+        case FT_INT8:   *(int8_t *) dst   = (int8_t) (s64) (value ^ SIGN_BIT); break;
+        case FT_INT16:  *(int16_t *) dst  = (int16_t) (s64) (value ^ SIGN_BIT); break;
+        case FT_INT32:  *(int32_t *) dst  = (int32_t) (s64) (value ^ SIGN_BIT); break;
+        case FT_INT64:  *(int64_t *) dst  = (int64_t) (value ^ SIGN_BIT); break;
+        case FT_UINT8:  *(uint8_t *) dst  = (uint8_t) value; break;
+        case FT_UINT16: *(uint16_t *) dst = (uint16_t) value; break;
+        case FT_UINT32: *(uint32_t *) dst = (uint32_t) value; break;
+        case FT_UINT64: *(uint64_t *) dst = value; break;
+        default: panic(BADARG, "type");
+    }
+}
+
+intpack_block_t *intpack_encode(const void *values, size_t count, enum field_type type)
+{
+    GS_REQUIRE_NONNULL(values);
+    REQUIRE(intpack_supports(type), "Compression requires an integer type");
+    REQUIRE((count > 0 && count <= UINT32_MAX), "Illegal number of values for a compressed block");
+
+    size_t value_size = field_type_sizeof(type);
+    u64 *normalized = GS_REQUIRE_MALLOC(count * sizeof(u64));
+    u64 min_value = UINT64_MAX, max_value = 0;
+    for (size_t i = 0; i < count; i++) {
+        normalized[i] = intpack_normalize(values + i * value_size, type);
+        min_value = min(min_value, normalized[i]);
+        max_value = max(max_value, normalized[i]);
+    }
+
+    /* bit-packing needs no reference value at all if the values are non-negative; otherwise the range is packed */
+    u64 zero = (type <= FT_INT64 ? SIGN_BIT : 0);
+    u8 width = bit_width(max_value - min_value);
+    enum intpack_scheme scheme = (min_value >= zero && bit_width(max_value - zero) == width ? IPS_BITPACK : IPS_FOR);
+    u64 base = (scheme == IPS_BITPACK ? zero : min_value);
+
+    /* delta pays off for (nearly) sorted values, i.e., if the differences span a smaller range than the values */
+    s64 delta_min = INT64_MAX, delta_max = INT64_MIN;
+    bool delta_exact = (count > 1);
+    for (size_t i = 1; i < count && delta_exact; i++) {
+        s64 delta = (s64) (normalized[i] - normalized[i - 1]);
+        delta_exact = ((normalized[i] >= normalized[i - 1]) == (delta >= 0));
+        delta_min = min(delta_min, delta);
+        delta_max = max(delta_max, delta);
+    }
+    if (delta_exact && bit_width((u64) delta_max - (u64) delta_min) < width) {
+        scheme = IPS_DELTA;
+        width = bit_width((u64) delta_max - (u64) delta_min);
+        base = (u64) delta_min;
+    }
+
+    intpack_block_t *block = calloc(1, sizeof(intpack_block_t) + NUM_WORDS(count, width) * sizeof(u64));
+    panic_if((block == NULL), BADMALLOC, "compressed block");
+    block->scheme = scheme;
+    block->count = count;
+    block->width = width;
+    block->min = min_value;
+    block->max = max_value;
+    block->base = base;
+    block->first = normalized[0];
+    for (size_t i = 0; i < count; i++) {
+        /* differences are taken modulo 2^64, which is exact for prefix sums */
+        u64 code = (scheme != IPS_DELTA ? normalized[i] - base :
+                                          (i == 0 ? 0 : normalized[i] - normalized[i - 1] - base));
+        pack_code(block->words, i, width, code);
+    }
+
+    free (normalized);
+    return block;
+}
+
+void intpack_free(intpack_block_t *block)
+{
+    free (block);
+}
+
+size_t intpack_size(const intpack_block_t *block)
+{
+    GS_REQUIRE_NONNULL(block);
+    return sizeof(intpack_block_t) + NUM_WORDS(block->count, block->width) * sizeof(u64);
+}
+
+void intpack_unpack(u64 *dst, const intpack_block_t *block)
+{
+    GS_REQUIRE_NONNULL(dst);
+    GS_REQUIRE_NONNULL(block);
+#ifdef HAVE_AVX2_UNPACK
+    /* the gather-based kernel loads 64 bits per code at a byte offset, hence codes must fit into 57 bits */
+    if (block->width > 0 && block->width <= 56 && __builtin_cpu_supports("avx2")) {
+        unpack_avx2(dst, block);
+        return;
+    }
+#endif
+    unpack_scalar(dst, block->words, 0, block->count, block->width);
+}
+
+void intpack_decode(void *dst, const intpack_block_t *block, enum field_type type)
+{
+    GS_REQUIRE_NONNULL(dst);
+    size_t value_size = field_type_sizeof(type);
+    size_t count = block->count;
+    u64 *values = GS_REQUIRE_MALLOC(count * sizeof(u64));
+    unpack_values(values, block);
+    for (size_t i = 0; i < count; i++) {
+        intpack_denormalize(dst + i * value_size, values[i], type);
+    }
+    free (values);
+}
+
+void intpack_get(void *dst, const intpack_block_t *block, size_t idx, enum field_type type)
+{
+    GS_REQUIRE_NONNULL(dst);
+    GS_REQUIRE_NONNULL(block);
+    REQUIRE_LESSTHAN(idx, block->count);
+    u64 value;
+    if (block->scheme == IPS_DELTA) {
+        value = block->first;
+        for (size_t i = 1; i <= idx; i++) {
+            value += block->base + unpack_code(block->words, i, block->width);
+        }
+    } else {
+        value = block->base + unpack_code(block->words, idx, block->width);
+    }
+    intpack_denormalize(dst, value, type);
+}
+
+size_t intpack_select_between(bitmap_word_t *result, size_t offset, const intpack_block_t *block, u64 lower, u64 upper)
+{
+    GS_REQUIRE_NONNULL(result);
+    GS_REQUIRE_NONNULL(block);
+    if (lower > upper || upper < block->min || lower > block->max) {
+        return 0;
+    }
+
+    size_t count = block->count, num_matches = 0;
+    u64 *codes = GS_REQUIRE_MALLOC(count * sizeof(u64));
+    u64 lo, range;
+    if (block->scheme == IPS_DELTA) {
+        unpack_values(codes, block);
+        lo = lower;
+        range = upper - lower;
+    } else {
+        /* translate the bounds into codes; as codes are unsigned, 'lo <= code <= hi' is a single comparison */
+        intpack_unpack(codes, block);
+        lo = max(lower, block->min) - block->base;
+        range = min(upper, block->max) - block->base - lo;
+    }
+    for (size_t i = 0; i < count; i++) {
+        bitmap_word_t match = (codes[i] - lo <= range);
+        result[(offset + i) / BITMAP_WORD_NBITS] |= match << ((offset + i) % BITMAP_WORD_NBITS);
+        num_matches += match;
+    }
+    free (codes);
+    return num_matches;
+}
+
+intpack_column_t *intpack_column_new(enum field_type type)
+{
+    REQUIRE(intpack_supports(type), "Compression requires an integer type");
+    intpack_column_t *result = GS_REQUIRE_MALLOC(sizeof(intpack_column_t));
+    *result = (intpack_column_t) {
+        .type = type,
+        .nblocks = 0,
+        .capacity = 1,
+        .blocks = GS_REQUIRE_MALLOC(sizeof(intpack_block_t *))
+    };
+    return result;
+}
+
+void intpack_column_free(intpack_column_t *column)
+{
+    GS_REQUIRE_NONNULL(column);
+    for (size_t i = 0; i < column->nblocks; i++) {
+        intpack_free(column->blocks[i]);
+    }
+    free (column->blocks);
+    free (column);
+}
+
+size_t intpack_column_append(intpack_column_t *column, const void *values)
+{
+    GS_REQUIRE_NONNULL(column);
+    if (column->nblocks == column->capacity) {
+        column->capacity *= 2;
+        column->blocks = realloc(column->blocks, column->capacity * sizeof(intpack_block_t *));
+        panic_if((column->blocks == NULL), BADMALLOC, "compressed column");
+    }
+    intpack_block_t *block = intpack_encode(values, INTPACK_BLOCK_SIZE, column->type);
+    column->blocks[column->nblocks++] = block;
+    return intpack_size(block);
+}
+
+size_t intpack_column_num_of_values(const intpack_column_t *column)
+{
+    GS_REQUIRE_NONNULL(column);
+    return column->nblocks * INTPACK_BLOCK_SIZE;
+}
+
+size_t intpack_column_size(const intpack_column_t *column)
+{
+    GS_REQUIRE_NONNULL(column);
+    size_t size = sizeof(intpack_column_t) + column->capacity * sizeof(intpack_block_t *);
+    for (size_t i = 0; i < column->nblocks; i++) {
+        size += intpack_size(column->blocks[i]);
+    }
+    return size;
+}
+
+void intpack_column_get(void *dst, const intpack_column_t *column, size_t idx)
+{
+    GS_REQUIRE_NONNULL(column);
+    REQUIRE_LESSTHAN(idx, intpack_column_num_of_values(column));
+    intpack_get(dst, column->blocks[idx / INTPACK_BLOCK_SIZE], idx % INTPACK_BLOCK_SIZE, column->type);
+}
+
+void intpack_column_decode(void *dst, const intpack_column_t *column)
+{
+    GS_REQUIRE_NONNULL(column);
+    size_t block_size = INTPACK_BLOCK_SIZE * field_type_sizeof(column->type);
+    for (size_t i = 0; i < column->nblocks; i++) {
+        intpack_decode(dst + i * block_size, column->blocks[i], column->type);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u8 bit_width(u64 value)
+{
+    return (value == 0 ? 0 : 64 - __builtin_clzll(value));
+}
+
+ void pack_code(u64 *words, size_t idx, u8 width, u64 code)
+{
+    if (width > 0) {
+        size_t bit = idx * width;
+        size_t shift = bit % 64;
+        words[bit / 64] |= code << shift;
+        if (shift + width > 64) {
+            words[bit / 64 + 1] |= code >> (64 - shift);
+        }
+    }
+}
+
+ u64 unpack_code(const u64 *words, size_t idx, u8 width)
+{
+    if (width == 0) {
+        return 0;
+    }
+    size_t bit = idx * width;
+    size_t shift = bit % 64;
+    u64 code = words[bit / 64] >> shift;
+    if (shift + width > 64) {
+        code |= words[bit / 64 + 1] << (64 - shift);
+    }
+    return code & CODE_MASK(width);
+}
+
+ void unpack_scalar(u64 *dst, const u64 *words, size_t begin, size_t end, u8 width)
+{
+    for (size_t i = begin; i < end; i++) {
+        dst[i] = unpack_code(words, i, width);
+    }
+}
+
+ void unpack_values(u64 *dst, const intpack_block_t *block)
+{
+    intpack_unpack(dst, block);
+    if (block->scheme == IPS_DELTA) {
+        dst[0] = block->first;
+        for (size_t i = 1; i < block->count; i++) {
+            dst[i] = dst[i - 1] + block->base + dst[i];
+        }
+    } else {
+        for (size_t i = 0; i < block->count; i++) {
+            dst[i] += block->base;
+        }
+    }
+}
+
+#ifdef HAVE_AVX2_UNPACK
+ __attribute__((target("avx2"))) void unpack_avx2(u64 *dst, const intpack_block_t *block)
+{
+    /* four codes per iteration: gather the 64 bits starting at the byte that contains the first bit of each code,
+     * and shift/mask each lane individually; the padding word keeps the last loads inside the block */
+    const u8 width = block->width;
+    const __m256i mask = _mm256_set1_epi64x(CODE_MASK(width));
+    const __m256i step = _mm256_set1_epi64x(4 * width);
+    const __m256i seven = _mm256_set1_epi64x(7);
+    __m256i bit = _mm256_set_epi64x(3 * width, 2 * width, width, 0);
+
+    size_t i = 0;
+    for (; i + 4 <= block->count; i += 4) {
+        __m256i offset = _mm256_srli_epi64(bit, 3);
+        __m256i shift = _mm256_and_si256(bit, seven);
+        __m256i codes = _mm256_i64gather_epi64((const long long *) block->words, offset, 1);
+        codes = _mm256_and_si256(_mm256_srlv_epi64(codes, shift), mask);
+        _mm256_storeu_si256((__m256i *) (dst + i), codes);
+        bit = _mm256_add_epi64(bit, step);
+    }
+    unpack_scalar(dst, block->words, i, block->count, width);
+}
+#endif
@@ -0,0 +1,230 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/range_tree.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+typedef struct range_node_t {
+    u64 begin;
+    u64 end;
+    u64 priority; /* the priority of a node is at least the priority of its children */
+    struct range_node_t *left;
+    struct range_node_t *right;
+} range_node_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void treap_split(range_node_t **lower, range_node_t **upper, range_node_t *node, u64 key);
+
+ range_node_t *treap_merge(range_node_t *lower, range_node_t *upper);
+
+ range_node_t *treap_remove_min(range_node_t *node, range_node_t **removed);
+
+ range_node_t *treap_remove_max(range_node_t *node, range_node_t **removed);
+
+ void treap_free(range_node_t *node);
+
+ u64 treap_priority(range_tree_t *tree);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+void range_tree_create(range_tree_t *tree)
+{
+    GS_REQUIRE_NONNULL(tree);
+    *tree = (range_tree_t) {
+        .root = NULL,
+        .num_ranges = 0,
+        .num_elements = 0,
+        .seed = 0x2545F4914F6CDD1DULL
+    };
+}
+
+void range_tree_dispose(range_tree_t *tree)
+{
+    GS_REQUIRE_NONNULL(tree);
+    treap_free(tree->root);
+    tree->root = NULL;
+}
+
+bool range_tree_insert(range_tree_t *tree, u64 begin, u64 end)
+{
+    GS_REQUIRE_NONNULL(tree);
+    REQUIRE((begin < end), "Corrupted range");
+
+    range_node_t *lower, *upper, *node;
+    treap_split(&lower, &upper, tree->root, begin);
+
+    const range_node_t *pred = lower, *succ = upper;
+    while (pred != NULL && pred->right != NULL) {
+        pred = pred->right;
+    }
+    while (succ != NULL && succ->left != NULL) {
+        succ = succ->left;
+    }
+    if ((pred != NULL && pred->end > begin) || (succ != NULL && succ->begin < end)) {
+        tree->root = treap_merge(lower, upper);
+        return false;
+    }
+
+    tree->num_elements += (end - begin);
+    if (pred != NULL && pred->end == begin) {
+        lower = treap_remove_max(lower, &node);
+        begin = node->begin;
+        free(node);
+        tree->num_ranges--;
+    }
+    if (succ != NULL && succ->begin == end) {
+        upper = treap_remove_min(upper, &node);
+        end = node->end;
+        free(node);
+        tree->num_ranges--;
+    }
+
+    node = GS_REQUIRE_MALLOC(sizeof(range_node_t));
+    *node = (range_node_t) {
+        .begin = begin,
+        .end = end,
+        .priority = treap_priority(tree),
+        .left = NULL,
+        .right = NULL
+    };
+    tree->root = treap_merge(treap_merge(lower, node), upper);
+    tree->num_ranges++;
+    return true;
+}
+
+bool range_tree_take_first(u64 *begin, u64 *end, range_tree_t *tree, u64 max_length)
+{
+    GS_REQUIRE_NONNULL(begin);
+    GS_REQUIRE_NONNULL(end);
+    GS_REQUIRE_NONNULL(tree);
+    REQUIRE((max_length > 0), BADINT);
+
+    if (tree->root == NULL) {
+        return false;
+    }
+    range_node_t *first = tree->root;
+    while (first->left != NULL) {
+        first = first->left;
+    }
+    u64 length = min(first->end - first->begin, max_length);
+    *begin = first->begin;
+    *end = first->begin + length;
+    tree->num_elements -= length;
+    if (*end == first->end) {
+        tree->root = treap_remove_min(tree->root, &first);
+        free(first);
+        tree->num_ranges--;
+    } else {
+        // The range keeps its position in the tree, since it still starts before any other range
+        first->begin = *end;
+    }
+    return true;
+}
+
+bool range_tree_contains(const range_tree_t *tree, u64 value)
+{
+    GS_REQUIRE_NONNULL(tree);
+    const range_node_t *node = tree->root;
+    while (node != NULL) {
+        if (value < node->begin) {
+            node = node->left;
+        } else if (value >= node->end) {
+            node = node->right;
+        } else return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void treap_split(range_node_t **lower, range_node_t **upper, range_node_t *node, u64 key)
+{
+    // Ranges that begin before 'key' go to 'lower', all others to 'upper'
+    if (node == NULL) {
+        *lower = *upper = NULL;
+    } else if (node->begin < key) {
+        treap_split(&node->right, upper, node->right, key);
+        *lower = node;
+    } else {
+        treap_split(lower, &node->left, node->left, key);
+        *upper = node;
+    }
+}
+
+ range_node_t *treap_merge(range_node_t *lower, range_node_t *upper)
+{
+    // All ranges in 'lower' begin before any range in 'upper'
+    if (lower == NULL) {
+        return upper;
+    } else if (upper == NULL) {
+        return lower;
+    } else if (lower->priority >= upper->priority) {
+        lower->right = treap_merge(lower->right, upper);
+        return lower;
+    } else {
+        upper->left = treap_merge(lower, upper->left);
+        return upper;
+    }
+}
+
+ range_node_t *treap_remove_min(range_node_t *node, range_node_t **removed)
+{
+    if (node->left == NULL) {
+        *removed = node;
+        return node->right;
+    }
+    node->left = treap_remove_min(node->left, removed);
+    return node;
+}
+
+ range_node_t *treap_remove_max(range_node_t *node, range_node_t **removed)
+{
+    if (node->right == NULL) {
+        *removed = node;
+        return node->left;
+    }
+    node->right = treap_remove_max(node->right, removed);
+    return node;
+}
+
+ void treap_free(range_node_t *node)
+{
+    if (node != NULL) {
+        treap_free(node->left);
+        treap_free(node->right);
+        free(node);
+    }
+}
+
+ u64 treap_priority(range_tree_t *tree)
+{
+    // splitmix64
+    u64 z = (tree->seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
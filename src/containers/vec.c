@@ -194,9 +194,8 @@ void *vec_peek(const vec_t *vec)
 void *vec_begin(const vec_t *vec)
 {
     if (vec) {
-        REQUIRE_NONZERO(vec->num_elements)
-        void *result = vec_at(vec, 0);
-        return result;
+        // For an empty vector, this equals vec_end(), such that iterating over [begin, end) visits no element
+        return vec->data;
     } else return NULL;
 }
 
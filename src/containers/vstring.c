@@ -0,0 +1,144 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/vstring.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u64 vstring_head(const vstring_t *str);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+strheap_t *strheap_new(size_t capacity)
+{
+    strheap_t *result = GS_REQUIRE_MALLOC(sizeof(strheap_t));
+    result->capacity = max(1, capacity);
+    result->size = 0;
+    result->data = GS_REQUIRE_MALLOC(result->capacity);
+    return result;
+}
+
+void strheap_free(strheap_t *heap)
+{
+    GS_REQUIRE_NONNULL(heap);
+    free (heap->data);
+    free (heap);
+}
+
+u64 strheap_add(strheap_t *heap, const char *str, size_t length)
+{
+    GS_REQUIRE_NONNULL(heap);
+    GS_REQUIRE_NONNULL(str);
+    if (heap->size + length + 1 > heap->capacity) {
+        while (heap->size + length + 1 > heap->capacity) {
+            heap->capacity *= 2;
+        }
+        heap->data = realloc(heap->data, heap->capacity);
+        panic_if((heap->data == NULL), BADMALLOC, "string heap");
+    }
+    u64 offset = heap->size;
+    memcpy(heap->data + offset, str, length);
+    heap->data[offset + length] = '\0';
+    heap->size += length + 1;
+    return offset;
+}
+
+const char *strheap_get(const strheap_t *heap, u64 offset)
+{
+    GS_REQUIRE_NONNULL(heap);
+    REQUIRE_LESSTHAN(offset, heap->size);
+    return heap->data + offset;
+}
+
+size_t strheap_size(const strheap_t *heap)
+{
+    GS_REQUIRE_NONNULL(heap);
+    return heap->size;
+}
+
+void vstring_make(vstring_t *dst, strheap_t *heap, const char *str)
+{
+    GS_REQUIRE_NONNULL(dst);
+    GS_REQUIRE_NONNULL(str);
+    size_t length = strlen(str);
+    REQUIRE((length <= UINT32_MAX), "String exceeds the maximum length");
+
+    memset(dst, 0, sizeof(vstring_t));
+    dst->length = length;
+    if (vstring_is_inline(dst)) {
+        /* 'prefix' and 'suffix' are adjacent, hence the inline string occupies bytes 4 to 15 of the header */
+        memcpy(dst->prefix, str, length);
+    } else {
+        memcpy(dst->prefix, str, VSTRING_PREFIX_LEN);
+        dst->offset = strheap_add(heap, str, length);
+    }
+}
+
+void vstring_move(vstring_t *str, const strheap_t *src, strheap_t *dst)
+{
+    GS_REQUIRE_NONNULL(str);
+    if (!vstring_is_inline(str)) {
+        str->offset = strheap_add(dst, strheap_get(src, str->offset), str->length);
+    }
+}
+
+const char *vstring_str(const vstring_t *str, const strheap_t *heap)
+{
+    GS_REQUIRE_NONNULL(str);
+    return (vstring_is_inline(str) ? str->prefix : strheap_get(heap, str->offset));
+}
+
+bool vstring_equals(const vstring_t *lhs, const strheap_t *lhs_heap, const vstring_t *rhs, const strheap_t *rhs_heap)
+{
+    GS_REQUIRE_NONNULL(lhs);
+    GS_REQUIRE_NONNULL(rhs);
+    if (vstring_head(lhs) != vstring_head(rhs)) {
+        return false;
+    }
+    if (vstring_is_inline(lhs)) {
+        return (memcmp(lhs->suffix, rhs->suffix, sizeof(lhs->suffix)) == 0);
+    }
+    /* length and prefix are equal already */
+    return (memcmp(strheap_get(lhs_heap, lhs->offset) + VSTRING_PREFIX_LEN,
+                   strheap_get(rhs_heap, rhs->offset) + VSTRING_PREFIX_LEN, lhs->length - VSTRING_PREFIX_LEN) == 0);
+}
+
+bool vstring_has_prefix(const vstring_t *str, const strheap_t *heap, const char *prefix, size_t length)
+{
+    GS_REQUIRE_NONNULL(str);
+    GS_REQUIRE_NONNULL(prefix);
+    if (length > str->length || memcmp(str->prefix, prefix, min(length, VSTRING_PREFIX_LEN)) != 0) {
+        return false;
+    }
+    return (length <= VSTRING_PREFIX_LEN || memcmp(vstring_str(str, heap), prefix, length) == 0);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u64 vstring_head(const vstring_t *str)
+{
+    /* length and prefix as a single word */
+    u64 head;
+    memcpy(&head, str, sizeof(u64));
+    return head;
+}
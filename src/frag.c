@@ -19,6 +19,12 @@
 #include <frags/frag_host_vm.h>
 #include <frag_printer.h>
 #include <schema.h>
+#include <attr.h>
+#include <tuplet_field.h>
+
+ frag_t *frag_setup(frag_t *result, enum frag_impl_type_t type);
+ bool zone_supports(const attr_t *attr);
+ void zones_reset(frag_zone_t *zones, size_t begin, size_t end);
 
 void gs_checksum_nsm(schema_t *tab, const void *tuplets, size_t ntuplets)
 {
@@ -74,6 +80,53 @@ void gs_checksum_end(unsigned char *checksum_out, checksum_context_t *context)
     MD5_Final (checksum_out,context);
 }
 
+ frag_t *frag_setup(frag_t *result, enum frag_impl_type_t type)
+{
+    result->impl_type = type;
+
+    size_t num_attr = schema_num_attributes(result->schema);
+    result->validity = calloc(max(1, num_attr), sizeof(bitmap_word_t *));
+    result->null_counts = calloc(max(1, num_attr), sizeof(size_t));
+    panic_if((result->validity == NULL || result->null_counts == NULL), BADMALLOC, "fragment bookkeeping");
+    result->tombstones = NULL;
+    result->ndeleted = 0;
+
+    result->dictionaries = calloc(max(1, num_attr), sizeof(dict_t *));
+    panic_if((result->dictionaries == NULL), BADMALLOC, "fragment bookkeeping");
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (schema_attr_by_id(result->schema, attr_id)->flags.dict) {
+            result->dictionaries[attr_id] = dict_new(FRAG_DICT_CAPACITY);
+        }
+    }
+
+    result->strings = NULL;
+    for (attr_id_t attr_id = 0; attr_id < num_attr && result->strings == NULL; attr_id++) {
+        if (schema_attr_by_id(result->schema, attr_id)->flags.varlen) {
+            result->strings = strheap_new(FRAG_STRHEAP_CAPACITY);
+        }
+    }
+
+    result->zones = calloc(max(1, num_attr), sizeof(frag_zone_t *));
+    panic_if((result->zones == NULL), BADMALLOC, "fragment bookkeeping");
+    size_t nzones = (result->ncapacity + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS;
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (zone_supports(schema_attr_by_id(result->schema, attr_id))) {
+            result->zones[attr_id] = GS_REQUIRE_MALLOC(max(1, nzones) * sizeof(frag_zone_t));
+            zones_reset(result->zones[attr_id], 0, max(1, nzones));
+        }
+    }
+    if (result->ntuplets > 0) {
+        /* re-opened persistent fragments contain tuplets that were written in an earlier session */
+        frag_zones_rebuild(result);
+    }
+
+    panic_if((result->_dispose == NULL), NOTIMPLEMENTED, "frag_t::dispose");
+    panic_if((result->_scan == NULL), NOTIMPLEMENTED, "frag_t::scan");
+    panic_if((result->_open == NULL), NOTIMPLEMENTED, "frag_t::open");
+    panic_if((result->_insert == NULL), NOTIMPLEMENTED, "frag_t::this_query");
+    return result;
+}
+
 size_t find_type_match(enum frag_impl_type_t type)
 {
     size_t len = ARRAY_LEN_OF(frag_type_pool);
@@ -87,17 +140,26 @@ size_t find_type_match(enum frag_impl_type_t type)
 
 
 frag_t *frag_new(schema_t *schema, size_t tuplet_capacity, enum frag_impl_type_t type)
+{
+    return frag_new_ex(schema, tuplet_capacity, type, FRAG_DEFAULT_ALLOCATOR);
+}
+
+frag_t *frag_new_ex(schema_t *schema, size_t tuplet_capacity, enum frag_impl_type_t type,
+                    frag_allocator_type_tag allocator_type)
 {
     REQUIRE((tuplet_capacity > 0), "capacity of tuplets must be non zero");
 
-    frag_t *result = frag_type_pool[find_type_match(type)]._create(schema, tuplet_capacity);
-    result->impl_type = type;
+    frag_allocator_t *allocator = frag_allocator_get(allocator_type);
+    frag_t *result = frag_type_pool[find_type_match(type)]._create(schema, tuplet_capacity, allocator);
+    return frag_setup(result, type);
+}
 
-    panic_if((result->_dispose == NULL), NOTIMPLEMENTED, "frag_t::dispose");
-    panic_if((result->_scan == NULL), NOTIMPLEMENTED, "frag_t::scan");
-    panic_if((result->_open == NULL), NOTIMPLEMENTED, "frag_t::open");
-    panic_if((result->_insert == NULL), NOTIMPLEMENTED, "frag_t::this_query");
-    return result;
+frag_t *frag_new_mapped(schema_t *schema, const char *path, size_t tuplet_capacity)
+{
+    REQUIRE((tuplet_capacity > 0), "capacity of tuplets must be non zero");
+
+    frag_t *result = frag_host_mmap_open(schema, path, tuplet_capacity);
+    return frag_setup(result, FIT_HOST_NSM_MMAP);
 }
 
 void frag_insert(struct tuplet_t *out, frag_t *frag, size_t ntuplets)
@@ -116,6 +178,88 @@ void frag_insert(struct tuplet_t *out, frag_t *frag, size_t ntuplets)
     }
 }
 
+void frag_write_column(frag_t *frag, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void *values)
+{
+    assert (frag);
+    assert (frag->_write);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    REQUIRE((begin + count <= frag->ntuplets), "Tuplet id out of bounds");
+    if (count > 0) {
+        GS_REQUIRE_NONNULL(values);
+        frag->_write(frag, attr_id, begin, count, values);
+    }
+}
+
+void frag_column_open(frag_column_cursor_t *cursor, frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,
+                      tuplet_id_t end, size_t batch_size)
+{
+    GS_REQUIRE_NONNULL(cursor);
+    GS_REQUIRE_NONNULL(frag);
+    assert (frag->_view);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    REQUIRE((begin <= end && end <= frag->ntuplets), "Tuplet id out of bounds");
+    REQUIRE((batch_size > 0), BADINT);
+
+    *cursor = (frag_column_cursor_t) {
+        .frag = frag,
+        .attr_id = attr_id,
+        .next = begin,
+        .end = end,
+        .batch_size = batch_size,
+        .buffer = NULL,
+        .buffer_block = SIZE_MAX
+    };
+}
+
+bool frag_column_next(frag_column_view_t *view, frag_column_cursor_t *cursor)
+{
+    GS_REQUIRE_NONNULL(view);
+    GS_REQUIRE_NONNULL(cursor);
+    if (cursor->next >= cursor->end) {
+        return false;
+    }
+
+    frag_t *frag = cursor->frag;
+    attr_id_t attr_id = cursor->attr_id;
+    size_t count = min(cursor->batch_size, cursor->end - cursor->next);
+    const intpack_column_t *packed = frag_packed_column(frag, attr_id);
+    size_t npacked = (packed != NULL ? intpack_column_num_of_values(packed) : 0);
+
+    if (cursor->next < npacked) {
+        /* compressed values have no address; the batch is served from the decoded block */
+        size_t size = frag->layout->fields[attr_id].size;
+        size_t block_id = cursor->next / INTPACK_BLOCK_SIZE;
+        size_t slot = cursor->next % INTPACK_BLOCK_SIZE;
+        if (cursor->buffer == NULL) {
+            size_t buffer_size = INTPACK_BLOCK_SIZE * size;
+            cursor->buffer = GS_REQUIRE_MALLOC(buffer_size);
+        }
+        if (cursor->buffer_block != block_id) {
+            intpack_decode(cursor->buffer, packed->blocks[block_id], frag_field_type(frag, attr_id));
+            cursor->buffer_block = block_id;
+        }
+        count = min(count, min(INTPACK_BLOCK_SIZE - slot, npacked - cursor->next));
+        view->base = cursor->buffer + slot * size;
+        view->stride = size;
+    } else {
+        count = frag->_view(frag, attr_id, cursor->next, count, &view->base, &view->stride);
+    }
+
+    view->count = count;
+    view->begin = cursor->next;
+    view->validity = frag_validity(frag, attr_id);
+    view->tombstones = frag_tombstones(frag);
+    cursor->next += count;
+    return true;
+}
+
+void frag_column_close(frag_column_cursor_t *cursor)
+{
+    GS_REQUIRE_NONNULL(cursor);
+    free (cursor->buffer);
+    cursor->buffer = NULL;
+}
+
 void frag_print(FILE *file, frag_t *frag, size_t row_offset, size_t limit)
 {
     frag_print_ex(file, FPTT_CONSOLE_PRINTER, frag, row_offset, limit);
@@ -126,9 +270,61 @@ void frag_print_ex(FILE *file, enum frag_printer_type_tag type, frag_t *frag, si
     frag_printer_print(file, type, frag, row_offset, limit);
 }
 
+void frag_flush(frag_t *frag, tuplet_id_t begin, tuplet_id_t end)
+{
+    assert (frag);
+    REQUIRE((begin <= end && end <= frag->ntuplets), "Tuplet range out of bounds");
+    if (frag->_flush != NULL && begin < end) {
+        frag->_flush(frag, begin, end);
+    }
+}
+
+void frag_flush_all(frag_t *frag)
+{
+    assert (frag);
+    if (frag->_flush != NULL) {
+        frag->_flush(frag, 0, frag->ntuplets);
+    }
+}
+
+size_t frag_compress(frag_t *frag)
+{
+    assert (frag);
+    return (frag->_compress != NULL ? frag->_compress(frag) : 0);
+}
+
+const intpack_column_t *frag_packed_column(const frag_t *frag, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    return (frag->packed != NULL ? frag->packed[attr_id] : NULL);
+}
+
 void frag_delete(frag_t *frag)
 {
     assert(frag);
+    size_t num_attr = schema_num_attributes(frag->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (frag->validity[attr_id]) {
+            bitmap_free(frag->validity[attr_id]);
+        }
+    }
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (frag->dictionaries[attr_id]) {
+            dict_free(frag->dictionaries[attr_id]);
+        }
+        free (frag->zones[attr_id]);
+    }
+    free (frag->validity);
+    free (frag->null_counts);
+    free (frag->dictionaries);
+    free (frag->zones);
+    if (frag->strings) {
+        strheap_free(frag->strings);
+    }
+    if (frag->tombstones) {
+        bitmap_free(frag->tombstones);
+    }
     frag->_dispose(frag);
 }
 
@@ -137,6 +333,9 @@ const char *frag_str(enum frag_impl_type_t type)
     switch (type) {
         case FIT_HOST_NSM_VM: return "host/vm nsm";
         case FIT_HOST_DSM_VM: return "host/vm dsm";
+        case FIT_HOST_PAX_VM: return "host/vm pax";
+        case FIT_HOST_NSM_MMAP: return "host/mmap nsm";
+        case FIT_HOST_NSM_SEG: return "host/segmented nsm";
         default: panic("Unknown fragment implementation type '%d'", type);
     }
 }
@@ -162,5 +361,378 @@ schema_t *frag_schema(const frag_t *frag)
 enum field_type frag_field_type(const frag_t *frag, attr_id_t id)
 {
     assert (frag);
-    return schema_attr_type(frag->schema, id);
+    assert (id < frag->layout->nattrs);
+    return frag->layout->fields[id].type;
+}
+
+const frag_field_layout_t *frag_field_layout(const frag_t *frag, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, frag->layout->nattrs);
+    return frag->layout->fields + attr_id;
+}
+
+void frag_set_null(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE((tuplet_id < frag->ncapacity), "Tuplet id out of bounds");
+    const attr_t *attr = schema_attr_by_id(frag->schema, attr_id);
+    REQUIRE_WARGS((attr->flags.nullable), "Constraint violation: attribute '%s' is not nullable", attr->name);
+
+    if (frag->validity[attr_id] == NULL) {
+        frag->validity[attr_id] = bitmap_new(frag->ncapacity, true);
+    }
+    if (bitmap_test(frag->validity[attr_id], tuplet_id)) {
+        bitmap_clear(frag->validity[attr_id], tuplet_id);
+        frag->null_counts[attr_id]++;
+        if (frag->zones[attr_id] != NULL) {
+            frag->zones[attr_id][tuplet_id / FRAG_ZONE_NTUPLETS].null_count++;
+        }
+    }
+}
+
+void frag_set_valid(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    assert (frag);
+    bitmap_word_t *validity = frag->validity[attr_id];
+    if (validity != NULL && !bitmap_test(validity, tuplet_id)) {
+        bitmap_set(validity, tuplet_id);
+        frag->null_counts[attr_id]--;
+        if (frag->zones[attr_id] != NULL) {
+            frag->zones[attr_id][tuplet_id / FRAG_ZONE_NTUPLETS].null_count--;
+        }
+    }
+}
+
+bool frag_is_null(const frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    assert (frag);
+    const bitmap_word_t *validity = frag->validity[attr_id];
+    return (validity != NULL && !bitmap_test(validity, tuplet_id));
+}
+
+size_t frag_null_count(const frag_t *frag, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    return frag->null_counts[attr_id];
+}
+
+const size_t *frag_null_counts(const frag_t *frag)
+{
+    assert (frag);
+    return frag->null_counts;
+}
+
+const bitmap_word_t *frag_validity(const frag_t *frag, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    return (frag->null_counts[attr_id] > 0 ? frag->validity[attr_id] : NULL);
+}
+
+void frag_bookkeeping_resize(frag_t *frag, size_t old_capacity, size_t new_capacity)
+{
+    assert (frag);
+    if (frag->validity != NULL) {
+        size_t num_attr = schema_num_attributes(frag->schema);
+        for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+            if (frag->validity[attr_id]) {
+                frag->validity[attr_id] = bitmap_resize(frag->validity[attr_id], old_capacity, new_capacity, true);
+            }
+        }
+    }
+    if (frag->tombstones != NULL) {
+        frag->tombstones = bitmap_resize(frag->tombstones, old_capacity, new_capacity, false);
+    }
+    if (frag->zones != NULL) {
+        size_t old_nzones = max(1, (old_capacity + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS);
+        size_t new_nzones = max(1, (new_capacity + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS);
+        size_t num_attr = schema_num_attributes(frag->schema);
+        for (attr_id_t attr_id = 0; attr_id < num_attr && new_nzones != old_nzones; attr_id++) {
+            if (frag->zones[attr_id]) {
+                frag->zones[attr_id] = realloc(frag->zones[attr_id], new_nzones * sizeof(frag_zone_t));
+                panic_if((frag->zones[attr_id] == NULL), BADMALLOC, "zone map");
+                zones_reset(frag->zones[attr_id], old_nzones, new_nzones);
+            }
+        }
+    }
+}
+
+const strheap_t *frag_string_heap(const frag_t *frag)
+{
+    assert (frag);
+    return frag->strings;
+}
+
+size_t frag_strings_compact(frag_t *frag)
+{
+    assert (frag);
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    if (frag->strings == NULL) {
+        return 0;
+    }
+
+    size_t num_attr = schema_num_attributes(frag->schema);
+    strheap_t *heap = strheap_new(FRAG_STRHEAP_CAPACITY);
+    if (frag->ntuplets > 0) {
+        tuplet_open(&tuplet, frag, 0);
+        do {
+            tuplet_field_open(&field, &tuplet);
+            for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+                if (schema_attr_by_id(frag->schema, attr_id)->flags.varlen &&
+                    !frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+                    vstring_move(field.attr_value_ptr, frag->strings, heap);
+                }
+                tuplet_field_next(&field, false);
+            }
+        } while (tuplet_next(&tuplet));
+    }
+
+    size_t reclaimed = strheap_size(frag->strings) - strheap_size(heap);
+    strheap_free(frag->strings);
+    frag->strings = heap;
+    return reclaimed;
+}
+
+u64 frag_zone_key(enum field_type type, const void *value)
+{
+    u32 bits32;
+    u64 bits64;
+    switch (type) {
+        case FT_BOOL:
+            return *(const bool *) value;
+        case FT_FLOAT32:
+            /* IEEE-754: flip all bits of negative values, and the sign bit of positive values */
+            memcpy(&bits32, value, sizeof(u32));
+            return (bits32 & (1U << 31) ? ~bits32 : bits32 | (1U << 31));
+        case FT_FLOAT64:
+            memcpy(&bits64, value, sizeof(u64));
+            return (bits64 & (1ULL << 63) ? ~bits64 : bits64 | (1ULL << 63));
+        default:
+            return intpack_normalize(value, type);
+    }
+}
+
+void frag_zone_add(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id, const void *value)
+{
+    assert (frag);
+    frag_zone_t *zones = frag->zones[attr_id];
+    if (zones != NULL) {
+        frag_zone_t *zone = zones + tuplet_id / FRAG_ZONE_NTUPLETS;
+        u64 key = frag_zone_key(frag_field_type(frag, attr_id), value);
+        zone->min = min(zone->min, key);
+        zone->max = max(zone->max, key);
+    }
+}
+
+size_t frag_num_of_zones(const frag_t *frag)
+{
+    assert (frag);
+    return (frag->ntuplets + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS;
+}
+
+const frag_zone_t *frag_zone(const frag_t *frag, attr_id_t attr_id, size_t block_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    REQUIRE_LESSTHAN(block_id, max(1, frag_num_of_zones(frag)));
+    return (frag->zones[attr_id] != NULL ? frag->zones[attr_id] + block_id : NULL);
+}
+
+bool frag_zone_overlaps(const frag_t *frag, attr_id_t attr_id, size_t block_id, const void *lower, const void *upper)
+{
+    const frag_zone_t *zone = frag_zone(frag, attr_id, block_id);
+    if (zone == NULL) {
+        return true;
+    }
+    enum field_type type = frag_field_type(frag, attr_id);
+    return (zone->min <= zone->max && frag_zone_key(type, lower) <= zone->max &&
+            frag_zone_key(type, upper) >= zone->min);
+}
+
+void frag_zones_rebuild(frag_t *frag)
+{
+    assert (frag);
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    size_t num_attr = schema_num_attributes(frag->schema);
+    size_t nzones = max(1, (frag->ncapacity + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (frag->zones[attr_id] != NULL) {
+            zones_reset(frag->zones[attr_id], 0, nzones);
+        }
+    }
+    if (frag->ntuplets == 0) {
+        return;
+    }
+
+    /* compressed blocks already know their bounds, which are zone map keys as well (see intpack_normalize) */
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        const intpack_column_t *packed = frag_packed_column(frag, attr_id);
+        for (size_t block_id = 0; packed != NULL && block_id < packed->nblocks; block_id++) {
+            const intpack_block_t *block = packed->blocks[block_id];
+            size_t begin = block_id * INTPACK_BLOCK_SIZE;
+            size_t end = min(begin + INTPACK_BLOCK_SIZE, frag->ntuplets);
+            for (size_t zone_id = begin / FRAG_ZONE_NTUPLETS; begin < end && zone_id <= (end - 1) / FRAG_ZONE_NTUPLETS;
+                 zone_id++) {
+                frag_zone_t *zone = frag->zones[attr_id] + zone_id;
+                zone->min = min(zone->min, block->min);
+                zone->max = max(zone->max, block->max);
+            }
+        }
+    }
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_open(&field, &tuplet);
+        for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+            if (frag->zones[attr_id] != NULL) {
+                const intpack_column_t *packed = frag_packed_column(frag, attr_id);
+                if (frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+                    frag->zones[attr_id][tuplet.tuplet_id / FRAG_ZONE_NTUPLETS].null_count++;
+                } else if (packed == NULL || tuplet.tuplet_id >= intpack_column_num_of_values(packed)) {
+                    frag_zone_add(frag, tuplet.tuplet_id, attr_id, tuplet_field_read(&field));
+                }
+            }
+            tuplet_field_next(&field, false);
+        }
+    } while (tuplet_next(&tuplet));
+}
+
+dict_t *frag_dictionary(const frag_t *frag, attr_id_t attr_id)
+{
+    assert (frag);
+    REQUIRE_LESSTHAN(attr_id, schema_num_attributes(frag->schema));
+    return frag->dictionaries[attr_id];
+}
+
+void frag_tuplet_delete(frag_t *frag, tuplet_id_t tuplet_id)
+{
+    assert (frag);
+    REQUIRE((tuplet_id < frag->ntuplets), "Tuplet id out of bounds");
+    REQUIRE(!frag_host_mmap_is_persistent(frag), "Deletes are not persisted by file-backed fragments");
+    if (frag->tombstones == NULL) {
+        frag->tombstones = bitmap_new(frag->ncapacity, false);
+    }
+    if (!bitmap_test(frag->tombstones, tuplet_id)) {
+        bitmap_set(frag->tombstones, tuplet_id);
+        frag->ndeleted++;
+    }
+}
+
+bool frag_is_deleted(const frag_t *frag, tuplet_id_t tuplet_id)
+{
+    assert (frag);
+    return (frag->tombstones != NULL && bitmap_test(frag->tombstones, tuplet_id));
+}
+
+size_t frag_num_of_deleted(const frag_t *frag)
+{
+    assert (frag);
+    return frag->ndeleted;
+}
+
+size_t frag_num_of_live_tuplets(const frag_t *frag)
+{
+    assert (frag);
+    return (frag->ntuplets - frag->ndeleted);
+}
+
+float frag_dead_ratio(const frag_t *frag)
+{
+    assert (frag);
+    return (frag->ntuplets > 0 ? (float) frag->ndeleted / frag->ntuplets : 0.0f);
+}
+
+const bitmap_word_t *frag_tombstones(const frag_t *frag)
+{
+    assert (frag);
+    return frag->tombstones;
+}
+
+size_t frag_compact(frag_t *frag, tuplet_id_t *removed)
+{
+    tuplet_t src_tuplet, dst_tuplet;
+    tuplet_field_t src_field, dst_field;
+
+    assert (frag);
+    if (frag->ndeleted == 0) {
+        return 0;
+    }
+
+    size_t num_attr = schema_num_attributes(frag->schema);
+    size_t num_removed = 0;
+    tuplet_id_t dst_id = 0;
+
+    /* Move each live tuplet down to the next free slot, preserving the tuplet order. Values are copied through the
+     * fragment's own field cursors such that this works regardless of the record format, and validity bits
+     * travel with their values. */
+    for (tuplet_id_t src_id = 0; src_id < frag->ntuplets; src_id++) {
+        if (bitmap_test(frag->tombstones, src_id)) {
+            if (removed != NULL) {
+                removed[num_removed] = src_id;
+            }
+            num_removed++;
+            continue;
+        }
+        if (src_id != dst_id) {
+            tuplet_open(&src_tuplet, frag, src_id);
+            tuplet_open(&dst_tuplet, frag, dst_id);
+            tuplet_field_open(&src_field, &src_tuplet);
+            tuplet_field_open(&dst_field, &dst_tuplet);
+            for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+                if (frag_is_null(frag, src_id, attr_id)) {
+                    tuplet_field_set_null(&dst_field);
+                } else if (schema_attr_by_id(frag->schema, attr_id)->flags.varlen) {
+                    /* the header is moved only; the string stays in the heap until the heap is compacted below */
+                    memcpy(dst_field.attr_value_ptr, src_field.attr_value_ptr, sizeof(vstring_t));
+                    frag_set_valid(frag, dst_id, attr_id);
+                } else {
+                    const void *value = tuplet_field_read(&src_field);
+                    /* string fields are updated via a pointer to the string */
+                    tuplet_field_update(&dst_field, (attr_isstring(schema_attr_by_id(frag->schema, attr_id)) ?
+                                                     (const void *) &value : value));
+                }
+                tuplet_field_next(&src_field, false);
+                tuplet_field_next(&dst_field, false);
+            }
+        }
+        dst_id++;
+    }
+
+    /* Tuplets beyond the new end are garbage now; drop them from the null counts */
+    for (tuplet_id_t tuplet_id = dst_id; tuplet_id < frag->ntuplets; tuplet_id++) {
+        for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+            frag_set_valid(frag, tuplet_id, attr_id);
+        }
+    }
+
+    assert (num_removed == frag->ndeleted);
+    bitmap_free(frag->tombstones);
+    frag->tombstones = NULL;
+    frag->ndeleted = 0;
+    frag->ntuplets = dst_id;
+
+    /* moved tuplets only widened the zone maps of their new blocks */
+    frag_zones_rebuild(frag);
+    frag_strings_compact(frag);
+    return num_removed;
+}
+
+ bool zone_supports(const attr_t *attr)
+{
+    return (attr_type(attr) <= FT_FLOAT64);
+}
+
+ void zones_reset(frag_zone_t *zones, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        zones[i] = (frag_zone_t) {
+            .min = UINT64_MAX,
+            .max = 0,
+            .null_count = 0
+        };
+    }
 }
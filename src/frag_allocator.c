@@ -0,0 +1,71 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag_allocator.h>
+
+#define IMPL_COMPLETE(allocator)                                                                                       \
+    (allocator->_alloc != NULL && allocator->_realloc != NULL && allocator->_free != NULL)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+frag_allocator_t *frag_allocator_get(frag_allocator_type_tag type)
+{
+    size_t num_installed_allocators = sizeof(frag_allocator_register) / sizeof(frag_allocator_register[0]);
+    for (size_t i = 0; i < num_installed_allocators; i++) {
+        if (frag_allocator_register[i].type == type) {
+            frag_allocator_t *allocator = frag_allocator_register[i].get();
+            panic_if(!(IMPL_COMPLETE(allocator)), BADINTERNAL, "fragment allocator implementation is incomplete");
+            return allocator;
+        }
+    }
+    panic(BADINTERNAL, "selected allocator implementation is unknown");
+}
+
+const char *frag_allocator_str(frag_allocator_type_tag type)
+{
+    switch (type) {
+        case FATT_MALLOC:   return "malloc";
+        case FATT_HUGEPAGE: return "aligned/hugepage";
+        default: panic("Unknown fragment allocator type '%d'", type);
+    }
+}
+
+void *frag_allocator_alloc(frag_allocator_t *allocator, size_t size)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    void *result = allocator->_alloc(allocator, size);
+    panic_if((result == NULL), BADMALLOC, "fragment allocator failed to allocate memory");
+    return result;
+}
+
+void *frag_allocator_realloc(frag_allocator_t *allocator, void *ptr, size_t old_size, size_t new_size)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    void *result = allocator->_realloc(allocator, ptr, old_size, new_size);
+    panic_if((result == NULL), BADMALLOC, "fragment allocator failed to resize memory");
+    return result;
+}
+
+void frag_allocator_free(frag_allocator_t *allocator, void *ptr, size_t size)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    if (ptr != NULL) {
+        allocator->_free(allocator, ptr, size);
+    }
+}
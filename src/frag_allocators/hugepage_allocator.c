@@ -0,0 +1,157 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#if (defined(__linux__) || defined(linux) || defined(__linux))
+    #ifndef _GNU_SOURCE
+    #define _GNU_SOURCE /* mremap */
+    #endif
+    #define HAVE_MREMAP
+#endif
+
+#include <frag_allocator.h>
+#include <sys/mman.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// M A C R O S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define REQUIRE_INSTANCEOF_THIS(x)                                                                                     \
+    REQUIRE((x->tag == FATT_HUGEPAGE), BADTAG);
+
+#define ROUND_UP(size, unit)                                                                                           \
+    ((((size) + (unit) - 1) / (unit)) * (unit))
+
+#define IS_MAPPED(size)                                                                                                \
+    ((size) >= HUGEPAGE_ALLOCATOR_THRESHOLD)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void *hugepage_allocator_alloc(struct frag_allocator_t *self, size_t size);
+ void *hugepage_allocator_realloc(struct frag_allocator_t *self, void *ptr, size_t old_size, size_t new_size);
+ void hugepage_allocator_free(struct frag_allocator_t *self, void *ptr, size_t size);
+
+ void *aligned_block_new(size_t size);
+ void *huge_region_new(size_t size);
+ void huge_region_advise(void *region, size_t size);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+static frag_allocator_t hugepage_allocator = {
+    ._alloc   = hugepage_allocator_alloc,
+    ._realloc = hugepage_allocator_realloc,
+    ._free    = hugepage_allocator_free,
+    .tag      = FATT_HUGEPAGE,
+    .extra    = NULL
+};
+
+struct frag_allocator_t *hugepage_allocator_get()
+{
+    return &hugepage_allocator;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void *hugepage_allocator_alloc(struct frag_allocator_t *self, size_t size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    return (IS_MAPPED(size) ? huge_region_new(size) : aligned_block_new(size));
+}
+
+ void *hugepage_allocator_realloc(struct frag_allocator_t *self, void *ptr, size_t old_size, size_t new_size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+
+#ifdef HAVE_MREMAP
+    if (IS_MAPPED(old_size) && IS_MAPPED(new_size)) {
+        /* let the kernel move the page table entries instead of copying the region */
+        size_t old_mapped = ROUND_UP(old_size, HUGEPAGE_ALLOCATOR_PAGE_SIZE);
+        size_t new_mapped = ROUND_UP(new_size, HUGEPAGE_ALLOCATOR_PAGE_SIZE);
+        if (old_mapped == new_mapped) {
+            return ptr;
+        }
+        void *result = mremap(ptr, old_mapped, new_mapped, MREMAP_MAYMOVE);
+        if (result == MAP_FAILED) {
+            return NULL;
+        }
+        huge_region_advise(result, new_mapped);
+        return result;
+    }
+#endif
+
+    void *result = hugepage_allocator_alloc(self, new_size);
+    if (result != NULL) {
+        memcpy(result, ptr, min(old_size, new_size));
+        hugepage_allocator_free(self, ptr, old_size);
+    }
+    return result;
+}
+
+ void hugepage_allocator_free(struct frag_allocator_t *self, void *ptr, size_t size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    if (IS_MAPPED(size)) {
+        munmap(ptr, ROUND_UP(size, HUGEPAGE_ALLOCATOR_PAGE_SIZE));
+    } else {
+        free (ptr);
+    }
+}
+
+ void *aligned_block_new(size_t size)
+{
+    void *result;
+    size_t block_size = ROUND_UP(max(1, size), HUGEPAGE_ALLOCATOR_ALIGNMENT);
+    return (posix_memalign(&result, HUGEPAGE_ALLOCATOR_ALIGNMENT, block_size) == 0 ? result : NULL);
+}
+
+ void *huge_region_new(size_t size)
+{
+    /* over-allocate by one huge page and trim both ends such that the region starts at a huge page boundary; the
+     * kernel can back an aligned region with huge pages entirely */
+    size_t region_size = ROUND_UP(size, HUGEPAGE_ALLOCATOR_PAGE_SIZE);
+    size_t mapped_size = region_size + HUGEPAGE_ALLOCATOR_PAGE_SIZE;
+    void *mapped = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        return NULL;
+    }
+
+    uintptr_t begin = ROUND_UP((uintptr_t) mapped, HUGEPAGE_ALLOCATOR_PAGE_SIZE);
+    size_t head = begin - (uintptr_t) mapped;
+    size_t tail = mapped_size - head - region_size;
+    if (head > 0) {
+        munmap(mapped, head);
+    }
+    if (tail > 0) {
+        munmap((void *) (begin + region_size), tail);
+    }
+
+    huge_region_advise((void *) begin, region_size);
+    return (void *) begin;
+}
+
+ void huge_region_advise(void *region, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    /* only a hint; kernels without transparent huge pages fall back to regular pages */
+    madvise(region, size, MADV_HUGEPAGE);
+#endif
+}
@@ -0,0 +1,58 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag_allocator.h>
+
+#define REQUIRE_INSTANCEOF_THIS(x)                                                                                     \
+    REQUIRE((x->tag == FATT_MALLOC), BADTAG);
+
+ void *malloc_allocator_alloc(struct frag_allocator_t *self, size_t size);
+ void *malloc_allocator_realloc(struct frag_allocator_t *self, void *ptr, size_t old_size, size_t new_size);
+ void malloc_allocator_free(struct frag_allocator_t *self, void *ptr, size_t size);
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static frag_allocator_t malloc_allocator = {
+    ._alloc   = malloc_allocator_alloc,
+    ._realloc = malloc_allocator_realloc,
+    ._free    = malloc_allocator_free,
+    .tag      = FATT_MALLOC,
+    .extra    = NULL
+};
+
+struct frag_allocator_t *malloc_allocator_get()
+{
+    return &malloc_allocator;
+}
+
+ void *malloc_allocator_alloc(struct frag_allocator_t *self, size_t size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    return malloc(max(1, size));
+}
+
+ void *malloc_allocator_realloc(struct frag_allocator_t *self, void *ptr, size_t old_size, size_t new_size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    return realloc(ptr, max(1, new_size));
+}
+
+ void malloc_allocator_free(struct frag_allocator_t *self, void *ptr, size_t size)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    free (ptr);
+}
@@ -19,17 +19,21 @@
 #include <tuplet_field.h>
 #include <attr.h>
 
+#define NULL_STR "NULL"
+
 #define REQUIRE_INSTANCEOF_THIS(x)                                                                                     \
     REQUIRE((x->tag == FPTT_CONSOLE_PRINTER), BADTAG);
 
  void console_printer_print(struct frag_printer_t *self, FILE *file, frag_t *frag, size_t row_offset, size_t limit);
  void console_printer_free(struct frag_printer_t *self);
 
- void calc_field_print_lens(vec_t *field_print_lens, frag_t *frag, size_t num_attr);
+ tuplet_id_t seek_row(frag_t *frag, size_t row_offset);
+ void calc_field_print_lens(vec_t *field_print_lens, frag_t *frag, size_t num_attr, tuplet_id_t begin, size_t limit);
 
  void print_h_line(FILE *file, const frag_t *frag, size_t num_attr, schema_t *schema, vec_t *field_print_lens);
  void print_frag_header(FILE *file, const frag_t *frag, vec_t *field_print_lens, size_t num_attr);
- void print_frag_body(FILE *file, frag_t *frag, vec_t *field_print_lens, size_t num_attr, size_t row_offset, size_t limit);
+ void print_frag_body(FILE *file, frag_t *frag, vec_t *field_print_lens, size_t num_attr, tuplet_id_t begin,
+                      size_t limit);
 
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -47,32 +51,56 @@ struct frag_printer_t *console_printer_new()
 
 // ---------------------------------------------------------------------------------------------------------------------
 
- void calc_field_print_lens(vec_t *field_print_lens, frag_t *frag, size_t num_attr)
+ tuplet_id_t seek_row(frag_t *frag, size_t row_offset)
+{
+    // Rows are the tuplets that are not deleted. Without deletions, the n-th row is the n-th tuplet.
+    if (frag_num_of_deleted(frag) == 0) {
+        return min(row_offset, frag->ntuplets);
+    }
+    tuplet_id_t tuplet_id = 0;
+    for (size_t nskipped = 0; tuplet_id < frag->ntuplets; tuplet_id++) {
+        if (!frag_is_deleted(frag, tuplet_id)) {
+            if (nskipped == row_offset) {
+                break;
+            }
+            nskipped++;
+        }
+    }
+    return tuplet_id;
+}
+
+ void calc_field_print_lens(vec_t *field_print_lens, frag_t *frag, size_t num_attr, tuplet_id_t begin, size_t limit)
 {
     assert (field_print_lens);
 
     tuplet_t tuplet;
-    tuplet_open(&tuplet, frag, 0);
-    size_t num_tuplets = frag->ntuplets;
     schema_t *schema = frag_schema(frag);
 
-    while (num_tuplets--) {
+    for (size_t attr_idx = 0; attr_idx < num_attr; attr_idx++) {
+        size_t this_print_len_attr = strlen(attr_name(schema_attr_by_id(schema, attr_idx)));
+        vec_set(field_print_lens, attr_idx, 1, &this_print_len_attr);
+    }
+
+    // Only the rows that are printed determine the column widths
+    for (size_t nrows = 0; begin < frag->ntuplets && nrows < limit; begin++) {
+        if (frag_is_deleted(frag, begin)) {
+            continue;
+        }
+        nrows++;
+        tuplet_open(&tuplet, frag, begin);
         struct tuplet_field_t field;
         tuplet_field_open(&field, &tuplet);
         for (size_t attr_idx = 0; attr_idx < num_attr; attr_idx++) {
             enum field_type type = schema_attr_type(schema, attr_idx);
-            const struct attr_t *attr = schema_attr_by_id(schema, attr_idx);
 
-            size_t this_print_len_attr  = strlen(attr_name(attr));
-            size_t this_print_len_value = unsafe_field_println(type, tuplet_field_read(&field));
-            size_t this_print_len_field = max(this_print_len_attr, this_print_len_value);
+            size_t this_print_len_value = tuplet_field_is_null(&field) ? strlen(NULL_STR) :
+                                          unsafe_field_println(type, tuplet_field_read(&field));
 
             size_t all_print_len = *(size_t *) vec_at(field_print_lens, attr_idx);
-            all_print_len = max(all_print_len, this_print_len_field);
+            all_print_len = max(all_print_len, this_print_len_value);
             vec_set(field_print_lens, attr_idx, 1, &all_print_len);
             tuplet_field_next(&field, true);
         }
-        tuplet_next(&tuplet);
     }
 }
 
@@ -85,9 +113,10 @@ struct frag_printer_t *console_printer_new()
     size_t zero = 0;
     vec_memset(field_print_lens, 0, num_attr, &zero);
 
-    calc_field_print_lens(field_print_lens, frag, num_attr);
+    tuplet_id_t begin = seek_row(frag, row_offset);
+    calc_field_print_lens(field_print_lens, frag, num_attr, begin, limit);
     print_frag_header(file, frag, field_print_lens, num_attr);
-    print_frag_body(file, frag, field_print_lens, num_attr, row_offset, limit);
+    print_frag_body(file, frag, field_print_lens, num_attr, begin, limit);
     vec_free(field_print_lens);
 }
 
@@ -101,12 +130,12 @@ struct frag_printer_t *console_printer_new()
     for (size_t attr_idx = 0; attr_idx < num_attr; attr_idx++) {
         size_t   col_width = *(size_t *) vec_at(field_print_lens, attr_idx);
 
-        printf("+");
+        fprintf(file, "+");
         for (size_t i = 0; i < col_width + 2; i++)
-            printf("-");
+            fprintf(file, "-");
     }
 
-    printf("+\n");
+    fprintf(file, "+\n");
 }
 
  void print_frag_header(FILE *file, const frag_t *frag, vec_t *field_print_lens, size_t num_attr)
@@ -120,37 +149,41 @@ struct frag_printer_t *console_printer_new()
         const struct attr_t *attr = schema_attr_by_id(schema, attr_idx);
         size_t  col_width = *(size_t *) vec_at(field_print_lens, attr_idx);
         sprintf(format_buffer, "| %%-%zus ", col_width);
-        printf(format_buffer, attr_name(attr));
+        fprintf(file, format_buffer, attr_name(attr));
     }
-    printf("|\n");
+    fprintf(file, "|\n");
 
     print_h_line(file, frag, num_attr, schema, field_print_lens);
 }
 
- void print_frag_body(FILE *file, frag_t *frag, vec_t *field_print_lens, size_t num_attr, size_t row_offset, size_t limit)
+ void print_frag_body(FILE *file, frag_t *frag, vec_t *field_print_lens, size_t num_attr, tuplet_id_t begin,
+                      size_t limit)
 {
     assert (field_print_lens);
 
     char format_buffer[2048];
     tuplet_t tuplet;
-    tuplet_open(&tuplet, frag, 0);
-    size_t num_tuples = frag->ntuplets;
     schema_t *schema = frag_schema(frag);
 
-    while (num_tuples--) {
+    for (size_t nrows = 0; begin < frag->ntuplets && nrows < limit; begin++) {
+        if (frag_is_deleted(frag, begin)) {
+            continue;
+        }
+        nrows++;
+        tuplet_open(&tuplet, frag, begin);
         struct tuplet_field_t field;
         tuplet_field_open(&field, &tuplet);
         for (size_t attr_idx = 0; attr_idx < num_attr; attr_idx++) {
             const attr_t *attr = schema_attr_by_id(schema, attr_idx);
-            char *str = unsafe_field_str(attr->type, tuplet_field_read(&field));
+            char *str = tuplet_field_is_null(&field) ? strdup(NULL_STR) :
+                        unsafe_field_str(attr->type, tuplet_field_read(&field));
             size_t print_len = max(strlen(str), *(size_t *) vec_at(field_print_lens, attr_idx));
             sprintf(format_buffer, "| %%-%zus ", print_len);
-            printf(format_buffer, str);
+            fprintf(file, format_buffer, str);
             free (str);
             tuplet_field_next(&field, false);
         }
-        tuplet_next(&tuplet);
-        printf("|\n");
+        fprintf(file, "|\n");
     }
 
     print_h_line(file, frag, num_attr, schema, field_print_lens);
@@ -21,19 +21,49 @@
 #include <schema.h>
 #include <containers/vec.h>
 #include <attr.h>
+#include <frag_allocator.h>
+#include <sys/mman.h>
 
 // ---------------------------------------------------------------------------------------------------------------------
 // M A C R O S
 // ---------------------------------------------------------------------------------------------------------------------
 
 #define REQUIRE_VALID_TUPLET_FORMAT(format)                                                                            \
-    REQUIRE((format == TF_NSM || format == TF_DSM), "unknown tuplet serialization format")
+    REQUIRE((format == TF_NSM || format == TF_DSM || format == TF_PAX), "unknown tuplet serialization format")
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+typedef struct mmap_header_t {
+    u64 magic; /*!< FRAG_MMAP_MAGIC */
+    u64 tuplet_size; /*!< size of a single tuplet in bytes; must match the schema when re-opening the file */
+    u64 ntuplets; /*!< number of tuplets stored in the file */
+} mmap_header_t;
+
+typedef struct mmap_storage_t {
+    int fd; /*!< file descriptor of the backing file */
+    char *path; /*!< path of the backing file */
+    bool unlink_on_close; /*!< true for anonymous temporary files */
+    void *map_base; /*!< start of the mapped region, i.e., the file header */
+    size_t map_size; /*!< size of the mapped region in bytes */
+} mmap_storage_t;
+
+typedef struct segment_directory_t {
+    void **segments; /*!< base pointers of the segments; segment i holds the tuplets starting at
+                          i * FRAG_SEGMENT_NTUPLETS */
+    size_t nsegments; /*!< number of allocated segments */
+    size_t capacity; /*!< number of entries for which 'segments' provides space */
+} segment_directory_t;
 
 // ---------------------------------------------------------------------------------------------------------------------
 // H E L P E R   P R O T O T Y P E S
 // ---------------------------------------------------------------------------------------------------------------------
 
- frag_t *frag_create(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format);
+ frag_t *frag_create(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format,
+                     enum frag_impl_type_t impl_type, struct frag_allocator_t *allocator);
+ frag_t *frag_init(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format,
+                   enum frag_impl_type_t impl_type, struct frag_allocator_t *allocator);
 
  void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id);
  void frag_add(tuplet_t *dst, struct frag_t *self, size_t ntuplets);
@@ -44,56 +74,201 @@
  void frag_open_internal(tuplet_t *out, frag_t *self, size_t pos);
  void tuplet_bind(tuplet_field_t *dst, tuplet_t *self);
  void tuplet_set_value(tuplet_t *self, const void *data);
+ bool frag_has_encodings(const frag_t *frag);
  void tuplet_set_null2(tuplet_t *self);
- void tuplet_delete(tuplet_t *self);
+ void tuplet_delete2(tuplet_t *self);
  bool tuplet_is_null2(tuplet_t *self);
 
+ frag_layout_t *layout_create(const schema_t *schema, enum tuplet_format format);
+
  void field_rebase(tuplet_field_t *field);
- void field_movebase(tuplet_field_t *field);
- size_t field_nsm_jmp_size(tuplet_field_t *field);
- size_t field_dsm_jmp_size(tuplet_field_t *field, size_t dst_tuplet_slot_id, size_t dst_attr_id);
+ void field_locate(tuplet_field_t *field, attr_id_t attr_id);
  bool field_next(tuplet_field_t *field, bool auto_next);
  bool field_seek(tuplet_field_t *field, attr_id_t attr_id);
  const void *field_read(tuplet_field_t *field);
  void field_update(tuplet_field_t *field, const void *data);
+ void field_char_copy(void *dst, const attr_t *attr, const char *str);
  void field_set_null(tuplet_field_t *field);
  bool field_is_null(tuplet_field_t *field);
 
+ void frag_write_values(frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void *values);
+ void *field_mutable_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+ size_t frag_view_values(frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void **base,
+                         size_t *stride);
+
+ size_t pax_page_ntuplets(const frag_t *frag);
+ size_t pax_page_capacity(const frag_t *frag, size_t tuplet_capacity);
+ void *field_pax_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+
+ void **dsm_columns_new(frag_t *frag, size_t tuplet_capacity);
+ void dsm_columns_resize(frag_t *frag, size_t tuplet_capacity);
+ void dsm_columns_free(frag_t *frag);
+ void *field_dsm_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+ void *field_dsm_mutable_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id);
+ void field_dsm_load(tuplet_field_t *field);
+ size_t dsm_packed_ntuplets(const frag_t *frag, attr_id_t attr_id);
+ size_t dsm_column_size(const frag_t *frag, attr_id_t attr_id, size_t tuplet_capacity);
+ size_t dsm_compress(frag_t *self);
+ size_t dsm_column_pack(frag_t *frag, attr_id_t attr_id);
+ void dsm_column_unpack(frag_t *frag, attr_id_t attr_id);
+
+ void mmap_remap(frag_t *frag, size_t tuplet_capacity);
+ void mmap_flush(frag_t *self, tuplet_id_t begin, tuplet_id_t end);
+ void mmap_close(frag_t *frag);
+
+ size_t segments_capacity(size_t tuplet_capacity);
+ void segments_add(frag_t *frag, size_t tuplet_capacity);
+ void segments_free(frag_t *frag);
+ void *segments_tuplet_ptr(frag_t *frag, tuplet_id_t tuplet_id);
+
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E   I M P L E M E N T A T I O N
 // ---------------------------------------------------------------------------------------------------------------------
 
-struct frag_t *frag_host_vm_nsm_new(schema_t *schema, size_t tuplet_capacity)
+struct frag_t *frag_host_vm_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator)
+{
+    return frag_create(schema, tuplet_capacity, TF_NSM, FIT_HOST_NSM_VM, allocator);
+}
+
+struct frag_t *frag_host_vm_dsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator)
+{
+    return frag_create(schema, tuplet_capacity, TF_DSM, FIT_HOST_DSM_VM, allocator);
+}
+
+struct frag_t *frag_host_vm_pax_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator)
+{
+    return frag_create(schema, tuplet_capacity, TF_PAX, FIT_HOST_PAX_VM, allocator);
+}
+
+struct frag_t *frag_host_mmap_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator)
+{
+    /* the tuplet data is a file mapping, hence the allocator is not used */
+    return frag_host_mmap_open(schema, NULL, tuplet_capacity);
+}
+
+struct frag_t *frag_host_seg_nsm_new(schema_t *schema, size_t tuplet_capacity, struct frag_allocator_t *allocator)
+{
+    GS_REQUIRE_NONNULL(allocator);
+    REQUIRE((tuplet_size_by_schema(schema) > 0), "Segmented fragments require a non-empty schema");
+    size_t capacity = segments_capacity(tuplet_capacity);
+    frag_t *fragment = frag_init(schema, capacity, TF_NSM, FIT_HOST_NSM_SEG, allocator);
+    segment_directory_t *directory = GS_REQUIRE_MALLOC(sizeof(segment_directory_t));
+    *directory = (segment_directory_t) {
+        .segments = NULL,
+        .nsegments = 0,
+        .capacity = 0
+    };
+    fragment->extra = directory;
+    segments_add(fragment, capacity);
+    return fragment;
+}
+
+struct frag_t *frag_host_mmap_open(schema_t *schema, const char *path, size_t tuplet_capacity)
 {
-    return frag_create(schema, tuplet_capacity, TF_NSM);
+    GS_REQUIRE_NONNULL(schema);
+    size_t tuplet_size = tuplet_size_by_schema(schema);
+    REQUIRE((tuplet_size > 0), "File-backed fragments require a non-empty schema");
+    for (attr_id_t attr_id = 0; attr_id < schema_num_attributes(schema); attr_id++) {
+        const attr_t *attr = schema_attr_by_id(schema, attr_id);
+        REQUIRE((!attr->flags.dict && !attr->flags.varlen),
+                "Dictionary-encoded and variable-length attributes are not supported by file-backed fragments");
+        /* NULL bitmaps live in memory only, and would be lost when the file is re-opened */
+        REQUIRE((path == NULL || !attr->flags.nullable),
+                "Nullable attributes are not supported by fragments that persist under a path");
+    }
+
+    mmap_storage_t *storage = GS_REQUIRE_MALLOC(sizeof(mmap_storage_t));
+    storage->map_base = NULL;
+    storage->map_size = 0;
+    storage->unlink_on_close = (path == NULL);
+    if (path != NULL) {
+        storage->path = strdup(path);
+        storage->fd = open(path, O_RDWR | O_CREAT, 0644);
+    } else {
+        storage->path = strdup(FRAG_MMAP_DIR "/gecko-frag-XXXXXX");
+        storage->fd = mkstemp(storage->path);
+    }
+    panic_if((storage->fd < 0), "Unable to open fragment file '%s': %s", storage->path, strerror(errno));
+
+    struct stat file_stat;
+    panic_if((fstat(storage->fd, &file_stat) != 0), "Unable to stat fragment file '%s': %s", storage->path,
+             strerror(errno));
+
+    size_t ntuplets = 0;
+    if (file_stat.st_size > 0) {
+        /* re-open an existing fragment; tuplets are available right after mapping the file */
+        mmap_header_t header;
+        panic_if((file_stat.st_size < FRAG_MMAP_HEADER_SIZE ||
+                  pread(storage->fd, &header, sizeof(mmap_header_t), 0) != sizeof(mmap_header_t) ||
+                  header.magic != FRAG_MMAP_MAGIC), "Corrupted fragment file '%s'", storage->path);
+        REQUIRE_WARGS((header.tuplet_size == tuplet_size), "Fragment file '%s' does not match schema '%s'",
+                      storage->path, schema->frag_name);
+        ntuplets = header.ntuplets;
+        tuplet_capacity = max(tuplet_capacity, (file_stat.st_size - FRAG_MMAP_HEADER_SIZE) / tuplet_size);
+    }
+
+    frag_t *fragment = frag_init(schema, max(1, max(tuplet_capacity, ntuplets)), TF_NSM, FIT_HOST_NSM_MMAP, NULL);
+    fragment->extra = storage;
+    fragment->_flush = mmap_flush;
+    /* mapping writes the tuplet count into the file header, which must keep the count of a re-opened file */
+    fragment->ntuplets = ntuplets;
+    mmap_remap(fragment, fragment->ncapacity);
+    return fragment;
 }
 
-struct frag_t *frag_host_vm_dsm_new(schema_t *schema, size_t tuplet_capacity)
+bool frag_host_mmap_is_persistent(const struct frag_t *frag)
 {
-    return frag_create(schema, tuplet_capacity, TF_DSM);
+    GS_REQUIRE_NONNULL(frag);
+    return (frag->impl_type == FIT_HOST_NSM_MMAP && !((const mmap_storage_t *) frag->extra)->unlink_on_close);
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 // H E L P E R  I M P L E M E N T A T I O N
 // ---------------------------------------------------------------------------------------------------------------------
 
- frag_t *frag_create(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format)
+ frag_t *frag_create(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format,
+                     enum frag_impl_type_t impl_type, struct frag_allocator_t *allocator)
 {
-    frag_t *fragment = GS_REQUIRE_MALLOC(sizeof(frag_t));
+    GS_REQUIRE_NONNULL(allocator);
     size_t tuplet_size   = tuplet_size_by_schema(schema);
-    size_t required_size = tuplet_size * tuplet_capacity;
+    REQUIRE((format != TF_PAX || tuplet_size > 0), "PAX fragments require a non-empty schema");
+    if (format == TF_PAX) {
+        /* PAX fragments are allocated in units of entire mini-pages */
+        size_t page_ntuplets = max(1, FRAG_PAX_PAGE_SIZE / tuplet_size);
+        tuplet_capacity = ((tuplet_capacity + page_ntuplets - 1) / page_ntuplets) * page_ntuplets;
+    }
+    frag_t *fragment = frag_init(schema, tuplet_capacity, format, impl_type, allocator);
+    fragment->tuplet_data = (format == TF_DSM ? dsm_columns_new(fragment, tuplet_capacity) :
+                                                frag_allocator_alloc(allocator, tuplet_size * tuplet_capacity));
+    return fragment;
+}
+
+ frag_t *frag_init(schema_t *schema, size_t tuplet_capacity, enum tuplet_format format,
+                   enum frag_impl_type_t impl_type, struct frag_allocator_t *allocator)
+{
+    frag_t *fragment = GS_REQUIRE_MALLOC(sizeof(frag_t));
     *fragment = (frag_t) {
             .schema = schema_cpy(schema),
             .format = format,
+            .impl_type = impl_type,
             .ntuplets = 0,
             .ncapacity = tuplet_capacity,
-            .tuplet_data = GS_REQUIRE_MALLOC (required_size),
-            .tuplet_size = tuplet_size,
+            .tuplet_data = NULL,
+            .tuplet_size = tuplet_size_by_schema(schema),
+            .packed = NULL,
+            .extra = NULL,
+            .allocator = allocator,
             ._scan = scan_mediator,
             ._dispose = frag_dipose,
             ._open = frag_open,
-            ._insert = frag_add
+            ._insert = frag_add,
+            ._flush = NULL,
+            ._write = frag_write_values,
+            ._view = frag_view_values,
+            ._compress = (format == TF_DSM ? dsm_compress : NULL)
     };
+    /* the layout refers to the attributes of the fragment's own copy of the schema */
+    fragment->layout = layout_create(fragment->schema, format);
     return fragment;
 }
 
@@ -103,10 +278,44 @@ struct frag_t *frag_host_vm_dsm_new(schema_t *schema, size_t tuplet_capacity)
 
 // - F R A G M E N T   I M P L E M E N T A T I O N ---------------------------------------------------------------------
 
+ frag_layout_t *layout_create(const schema_t *schema, enum tuplet_format format)
+{
+    size_t nattrs = schema_num_attributes(schema);
+    size_t layout_size = sizeof(frag_layout_t) + nattrs * sizeof(frag_field_layout_t);
+    frag_layout_t *layout = GS_REQUIRE_MALLOC(layout_size);
+    layout->nattrs = nattrs;
+
+    size_t offset = 0;
+    for (attr_id_t attr_id = 0; attr_id < nattrs; attr_id++) {
+        const attr_t *attr = schema_attr_by_id(schema, attr_id);
+        layout->fields[attr_id] = (frag_field_layout_t) {
+            .attr = attr,
+            .type = attr->type,
+            .size = attr_total_size(attr),
+            .offset = offset
+        };
+        offset += layout->fields[attr_id].size;
+    }
+    layout->page_ntuplets = (format == TF_PAX ? max(1, FRAG_PAX_PAGE_SIZE / max(1, offset)) : 0);
+    return layout;
+}
+
 void frag_dipose(frag_t *self)
 {
-    free (self->tuplet_data);
+    if (self->impl_type == FIT_HOST_NSM_MMAP) {
+        mmap_close(self);
+    } else if (self->impl_type == FIT_HOST_NSM_SEG) {
+        segments_free(self);
+    } else {
+        if (self->format == TF_DSM) {
+            dsm_columns_free(self);
+            free (self->tuplet_data);
+        } else {
+            frag_allocator_free(self->allocator, self->tuplet_data, self->ncapacity * self->tuplet_size);
+        }
+    }
     schema_delete(self->schema);
+    free (self->layout);
     free (self);
 }
 
@@ -119,11 +328,20 @@ void frag_dipose(frag_t *self)
     tuplet->tuplet_id = tuplet_id;
     tuplet->fragment = frag;
 
-    size_t offset = tuplet_id * (frag->format == TF_NSM ?
-                               (frag->tuplet_size) :
-                                 attr_total_size(schema_attr_by_id(frag->schema, 0)));
-
-    tuplet->attr_base = frag->tuplet_data + offset;
+    switch (frag->format) {
+        case TF_NSM:
+            tuplet->attr_base = (frag->impl_type == FIT_HOST_NSM_SEG ? segments_tuplet_ptr(frag, tuplet_id) :
+                                 frag->tuplet_data + tuplet_id * frag->tuplet_size);
+            break;
+        case TF_DSM:
+            /* NULL if the first column is compressed; fields of DSM tuplets are loaded per column anyway */
+            tuplet->attr_base = field_dsm_ptr(frag, tuplet_id, 0);
+            break;
+        case TF_PAX:
+            tuplet->attr_base = field_pax_ptr(frag, tuplet_id, 0);
+            break;
+        default: panic(BADBRANCH, frag);
+    }
 }
 
  void frag_open_internal(tuplet_t *out, frag_t *self, size_t pos)
@@ -135,7 +353,7 @@ void frag_dipose(frag_t *self)
             ._open = tuplet_bind,
             ._update = tuplet_set_value,
             ._set_null = tuplet_set_null2,
-            ._delete = tuplet_delete,
+            ._delete = tuplet_delete2,
             ._is_null = tuplet_is_null2
         };
         tuplet_rebase(out, self, pos);
@@ -155,18 +373,60 @@ void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id)
     size_t return_tuplet_id = self->ntuplets;
     if (new_size > self->ncapacity) {
         size_t new_capacity = self->ncapacity;
+        if (self->impl_type == FIT_HOST_NSM_SEG) {
+            /* grow by as many segments as needed; no existing tuplet is copied or moved */
+            new_capacity = segments_capacity(new_size);
+        }
         while (new_capacity < new_size) {
             new_capacity = max(1, ceil(new_capacity * 1.7f));
         }
-        self->tuplet_data = realloc(self->tuplet_data, new_capacity * self->tuplet_size);
+        if (self->format == TF_PAX) {
+            /* mini-pages are self-contained, hence appending entire pages does not change the layout of existing
+             * pages and a plain resize of the buffer is sufficient */
+            new_capacity = pax_page_capacity(self, new_capacity);
+        }
+        if (self->impl_type == FIT_HOST_NSM_MMAP) {
+            mmap_remap(self, new_capacity);
+        } else if (self->impl_type == FIT_HOST_NSM_SEG) {
+            segments_add(self, new_capacity);
+        } else if (self->format == TF_DSM) {
+            /* each column is an independent segment, hence growing a column never moves another one */
+            dsm_columns_resize(self, new_capacity);
+        } else {
+            self->tuplet_data = frag_allocator_realloc(self->allocator, self->tuplet_data,
+                                                       self->ncapacity * self->tuplet_size,
+                                                       new_capacity * self->tuplet_size);
+        }
+        frag_bookkeeping_resize(self, self->ncapacity, new_capacity);
         self->ncapacity = new_capacity;
     }
+    if (self->format == TF_DSM) {
+        /* compaction may have shrunk the fragment below a compressed prefix; new tuplets must be addressable */
+        for (attr_id_t attr_id = 0; attr_id < schema_num_attributes(self->schema); attr_id++) {
+            if (return_tuplet_id < dsm_packed_ntuplets(self, attr_id)) {
+                dsm_column_unpack(self, attr_id);
+            }
+        }
+    }
     self->ntuplets += ntuplets;
+    if (self->impl_type == FIT_HOST_NSM_MMAP) {
+        ((mmap_header_t *) ((mmap_storage_t *) self->extra)->map_base)->ntuplets = self->ntuplets;
+    }
     frag_open_internal(dst, self, return_tuplet_id);
 }
 
 // - T U P L E T   I M P L E M E N T A T I O N -------------------------------------------------------------------------
 
+ bool frag_has_encodings(const frag_t *frag)
+{
+    size_t num_attr = schema_num_attributes(frag->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (frag->dictionaries[attr_id] != NULL || schema_attr_by_id(frag->schema, attr_id)->flags.varlen)
+            return true;
+    }
+    return false;
+}
+
  bool tuplet_step(tuplet_t *self)
 {
     assert (self);
@@ -183,21 +443,28 @@ void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id)
 {
     field->attr_id = 0;
     field->attr_value_ptr = field->tuplet->attr_base;
+    if (field->tuplet->fragment->format == TF_DSM) {
+        field_dsm_load(field);
+    }
 }
 
- void field_movebase(tuplet_field_t *field)
+ void field_locate(tuplet_field_t *field, attr_id_t attr_id)
 {
-    enum tuplet_format format = field->tuplet->fragment->format;
-
-
-    size_t skip_size = (format == TF_NSM ?
-                        field_nsm_jmp_size(field) :
-                        field_dsm_jmp_size(field, field->tuplet->tuplet_id, (field->attr_id + 1)));
-
-    field->attr_value_ptr = (format == TF_NSM ? field->attr_value_ptr : field->tuplet->fragment->tuplet_data) +
-                           skip_size;
-
-    field->attr_id++;
+    frag_t *frag = field->tuplet->fragment;
+    field->attr_id = attr_id;
+
+    switch (frag->format) {
+        case TF_NSM:
+            field->attr_value_ptr = field->tuplet->attr_base + frag->layout->fields[attr_id].offset;
+            break;
+        case TF_DSM:
+            field_dsm_load(field);
+            break;
+        case TF_PAX:
+            field->attr_value_ptr = field_pax_ptr(frag, field->tuplet->tuplet_id, attr_id);
+            break;
+        default: panic(BADBRANCH, frag);
+    }
 }
 
  void tuplet_bind(tuplet_field_t *dst, tuplet_t *self)
@@ -223,48 +490,241 @@ void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id)
 {
     assert (self);
     assert (data);
-    memcpy(self->attr_base, data, self->fragment->tuplet_size);
+    frag_t *frag = self->fragment;
+    if (frag->format == TF_NSM && !frag_has_encodings(frag)) {
+        memcpy(self->attr_base, data, frag->tuplet_size);
+        size_t num_attr = schema_num_attributes(frag->schema);
+        for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+            frag_zone_add(frag, self->tuplet_id, attr_id, data);
+            frag_set_valid(frag, self->tuplet_id, attr_id);
+            data += frag->layout->fields[attr_id].size;
+        }
+    } else {
+        /* input is a tuplet in row format with decoded values that must be scattered into the columns (resp.
+         * mini-columns), and encoded if required */
+        size_t num_attr = schema_num_attributes(frag->schema);
+        for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+            const attr_t *attr = frag->layout->fields[attr_id].attr;
+            void *dst = field_mutable_ptr(frag, self->tuplet_id, attr_id);
+            if (frag->dictionaries[attr_id] != NULL) {
+                *(dict_code_t *) dst = dict_encode(frag->dictionaries[attr_id], data);
+            } else if (attr->flags.varlen) {
+                vstring_make(dst, frag->strings, data);
+            } else {
+                memcpy(dst, data, frag->layout->fields[attr_id].size);
+                frag_zone_add(frag, self->tuplet_id, attr_id, data);
+            }
+            frag_set_valid(frag, self->tuplet_id, attr_id);
+            data += attr_value_size(attr);
+        }
+    }
 }
 
  void tuplet_set_null2(tuplet_t *self)
 {
     assert (self);
-    // TODO: Implement
-    panic(NOTIMPLEMENTED, "null values are currently not supported");
+    size_t num_attr = schema_num_attributes(self->fragment->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        frag_set_null(self->fragment, self->tuplet_id, attr_id);
+    }
 }
 
- void tuplet_delete(tuplet_t *self)
+ void tuplet_delete2(tuplet_t *self)
 {
     assert (self);
-    // TODO: Implement
-    panic(NOTIMPLEMENTED, "tuplet delete requests are currently not supported");
+    frag_tuplet_delete(self->fragment, self->tuplet_id);
 }
 
  bool tuplet_is_null2(tuplet_t *self)
 {
     assert (self);
-    // TODO: Implement
-    panic(NOTIMPLEMENTED, to_string(tuplet_is_null2));
-    return false;
+    size_t num_attr = schema_num_attributes(self->fragment->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        if (!frag_is_null(self->fragment, self->tuplet_id, attr_id)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // - F I E L D   I M P L E M E N T A T I O N ---------------------------------------------------------------------------
 
- size_t field_nsm_jmp_size(tuplet_field_t *field)
+ void **dsm_columns_new(frag_t *frag, size_t tuplet_capacity)
+{
+    size_t num_attr = schema_num_attributes(frag->schema);
+    void **columns = GS_REQUIRE_MALLOC(max(1, num_attr) * sizeof(void *));
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        columns[attr_id] = frag_allocator_alloc(frag->allocator, dsm_column_size(frag, attr_id, tuplet_capacity));
+    }
+    return columns;
+}
+
+ void dsm_columns_resize(frag_t *frag, size_t tuplet_capacity)
+{
+    void **columns = frag->tuplet_data;
+    size_t num_attr = schema_num_attributes(frag->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        columns[attr_id] = frag_allocator_realloc(frag->allocator, columns[attr_id],
+                                                  dsm_column_size(frag, attr_id, frag->ncapacity),
+                                                  dsm_column_size(frag, attr_id, tuplet_capacity));
+    }
+}
+
+ void dsm_columns_free(frag_t *frag)
+{
+    void **columns = frag->tuplet_data;
+    size_t num_attr = schema_num_attributes(frag->schema);
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        frag_allocator_free(frag->allocator, columns[attr_id], dsm_column_size(frag, attr_id, frag->ncapacity));
+        if (frag->packed != NULL && frag->packed[attr_id] != NULL) {
+            intpack_column_free(frag->packed[attr_id]);
+        }
+    }
+    free (frag->packed);
+}
+
+ void *field_dsm_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    /* the column segment holds the tuplets behind the compressed prefix only; compressed values have no address */
+    size_t npacked = dsm_packed_ntuplets(frag, attr_id);
+    void **columns = frag->tuplet_data;
+    return (tuplet_id < npacked ? NULL :
+            columns[attr_id] + (tuplet_id - npacked) * frag->layout->fields[attr_id].size);
+}
+
+ void *field_dsm_mutable_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    if (tuplet_id < dsm_packed_ntuplets(frag, attr_id)) {
+        dsm_column_unpack(frag, attr_id);
+    }
+    return field_dsm_ptr(frag, tuplet_id, attr_id);
+}
+
+ void field_dsm_load(tuplet_field_t *field)
+{
+    frag_t *frag = field->tuplet->fragment;
+    tuplet_id_t tuplet_id = field->tuplet->tuplet_id;
+    if (tuplet_id < dsm_packed_ntuplets(frag, field->attr_id)) {
+        intpack_column_get(&field->value, frag->packed[field->attr_id], tuplet_id);
+        field->attr_value_ptr = &field->value;
+    } else {
+        field->attr_value_ptr = field_dsm_ptr(frag, tuplet_id, field->attr_id);
+    }
+}
+
+ size_t dsm_packed_ntuplets(const frag_t *frag, attr_id_t attr_id)
 {
-    return tuplet_field_size(field);
+    const intpack_column_t *column = (frag->packed != NULL ? frag->packed[attr_id] : NULL);
+    return (column != NULL ? intpack_column_num_of_values(column) : 0);
 }
 
- size_t field_dsm_jmp_size(tuplet_field_t *field, size_t dst_tuplet_slot_id, size_t dst_attr_id)
+ size_t dsm_column_size(const frag_t *frag, attr_id_t attr_id, size_t tuplet_capacity)
 {
-    size_t skip_size = 0;
-    for (size_t attr_id = 0; attr_id < dst_attr_id; attr_id++) {
-        skip_size += field->tuplet->fragment->ntuplets *
-                attr_total_size(schema_attr_by_id(field->tuplet->fragment->schema, attr_id));
+    size_t attr_size = attr_total_size(schema_attr_by_id(frag->schema, attr_id));
+    return (tuplet_capacity - dsm_packed_ntuplets(frag, attr_id)) * attr_size;
+}
+
+ size_t dsm_compress(frag_t *self)
+{
+    size_t num_attr = schema_num_attributes(self->schema);
+    if (self->packed == NULL) {
+        self->packed = calloc(max(1, num_attr), sizeof(intpack_column_t *));
+        panic_if((self->packed == NULL), BADMALLOC, "compressed columns");
     }
-    skip_size += dst_tuplet_slot_id *
-            attr_total_size(schema_attr_by_id(field->tuplet->fragment->schema, dst_attr_id));
-    return skip_size;
+    size_t saved = 0;
+    for (attr_id_t attr_id = 0; attr_id < num_attr; attr_id++) {
+        const attr_t *attr = schema_attr_by_id(self->schema, attr_id);
+        if (intpack_supports(attr_type(attr)) && self->dictionaries[attr_id] == NULL) {
+            saved += dsm_column_pack(self, attr_id);
+        }
+    }
+    return saved;
+}
+
+ size_t dsm_column_pack(frag_t *frag, attr_id_t attr_id)
+{
+    void **columns = frag->tuplet_data;
+    const attr_t *attr = schema_attr_by_id(frag->schema, attr_id);
+    size_t attr_size = attr_total_size(attr);
+    size_t npacked = dsm_packed_ntuplets(frag, attr_id);
+    size_t old_size = dsm_column_size(frag, attr_id, frag->ncapacity);
+    const bitmap_word_t *validity = frag_validity(frag, attr_id);
+    void *block_values = GS_REQUIRE_MALLOC(INTPACK_BLOCK_SIZE * attr_size);
+
+    size_t begin = npacked, saved = 0;
+    while (begin + INTPACK_BLOCK_SIZE <= frag->ntuplets) {
+        memcpy(block_values, columns[attr_id] + (begin - npacked) * attr_size, INTPACK_BLOCK_SIZE * attr_size);
+        if (validity != NULL) {
+            /* NULL fields contain arbitrary data; replace them by a valid value such that they do not widen the
+             * value range of the block */
+            size_t fill = 0;
+            while (fill < INTPACK_BLOCK_SIZE && !bitmap_test(validity, begin + fill)) {
+                fill++;
+            }
+            for (size_t i = 0; i < INTPACK_BLOCK_SIZE && fill < INTPACK_BLOCK_SIZE; i++) {
+                if (!bitmap_test(validity, begin + i)) {
+                    memcpy(block_values + i * attr_size, block_values + fill * attr_size, attr_size);
+                }
+            }
+        }
+        if (frag->packed[attr_id] == NULL) {
+            frag->packed[attr_id] = intpack_column_new(attr_type(attr));
+        }
+        size_t block_size = intpack_column_append(frag->packed[attr_id], block_values);
+        saved += INTPACK_BLOCK_SIZE * attr_size - min(block_size, INTPACK_BLOCK_SIZE * attr_size);
+        begin += INTPACK_BLOCK_SIZE;
+    }
+    free (block_values);
+
+    if (begin > npacked) {
+        /* move the uncompressed tail to the front of the column segment, and release the space behind it */
+        memmove(columns[attr_id], columns[attr_id] + (begin - npacked) * attr_size,
+                (frag->ntuplets - begin) * attr_size);
+        columns[attr_id] = frag_allocator_realloc(frag->allocator, columns[attr_id], old_size,
+                                                  dsm_column_size(frag, attr_id, frag->ncapacity));
+    }
+    return saved;
+}
+
+ void dsm_column_unpack(frag_t *frag, attr_id_t attr_id)
+{
+    void **columns = frag->tuplet_data;
+    size_t attr_size = attr_total_size(schema_attr_by_id(frag->schema, attr_id));
+    size_t npacked = dsm_packed_ntuplets(frag, attr_id);
+    size_t old_size = dsm_column_size(frag, attr_id, frag->ncapacity);
+
+    void *column = frag_allocator_alloc(frag->allocator, frag->ncapacity * attr_size);
+    intpack_column_decode(column, frag->packed[attr_id]);
+    if (frag->ntuplets > npacked) {
+        memcpy(column + npacked * attr_size, columns[attr_id], (frag->ntuplets - npacked) * attr_size);
+    }
+    frag_allocator_free(frag->allocator, columns[attr_id], old_size);
+    intpack_column_free(frag->packed[attr_id]);
+    frag->packed[attr_id] = NULL;
+    columns[attr_id] = column;
+}
+
+ size_t pax_page_ntuplets(const frag_t *frag)
+{
+    return frag->layout->page_ntuplets;
+}
+
+ size_t pax_page_capacity(const frag_t *frag, size_t tuplet_capacity)
+{
+    size_t page_ntuplets = pax_page_ntuplets(frag);
+    return ((tuplet_capacity + page_ntuplets - 1) / page_ntuplets) * page_ntuplets;
+}
+
+ void *field_pax_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    size_t page_ntuplets = pax_page_ntuplets(frag);
+    size_t page_id       = tuplet_id / page_ntuplets;
+    size_t page_slot     = tuplet_id % page_ntuplets;
+
+    /* each attribute occupies a mini-column of 'page_ntuplets' values inside a page; mini-columns are ordered
+     * as the attributes in the fragment schema */
+    const frag_field_layout_t *field = frag->layout->fields + attr_id;
+    return frag->tuplet_data + (page_id * frag->tuplet_size + field->offset) * page_ntuplets + page_slot * field->size;
 }
 
  bool field_next(tuplet_field_t *field, bool auto_next)
@@ -276,8 +736,8 @@ void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id)
     REQUIRE_VALID_TUPLET_FORMAT(format);
 
     const attr_id_t next_attr_id = field->attr_id + 1;
-    if (next_attr_id < field->tuplet->fragment->schema->attr->num_elements) {
-        field_movebase(field);
+    if (next_attr_id < field->tuplet->fragment->layout->nattrs) {
+        field_locate(field, next_attr_id);
         return true;
     } else {
         if (auto_next && tuplet_step(field->tuplet)) {
@@ -290,41 +750,272 @@ void frag_open(tuplet_t *dst, frag_t *self, tuplet_id_t tuplet_id)
 
  bool field_seek(tuplet_field_t *field, attr_id_t attr_id)
 {
-    bool result = true;
-    while(attr_id-- && result)
-        result &= field_next(field, false);
-    return result;
+    /* fields are located via the fragment layout, i.e., independent of the position of the attribute; as before, an
+     * out-of-bounds seek stops at the last attribute */
+    size_t nattrs = field->tuplet->fragment->layout->nattrs;
+    if (nattrs > 0) {
+        field_locate(field, min(attr_id, nattrs - 1));
+    }
+    return (attr_id < nattrs);
 }
 
  const void *field_read(tuplet_field_t *field)
 {
     assert (field);
-    return field->attr_value_ptr;
+    frag_t *frag = field->tuplet->fragment;
+    const dict_t *dict = frag->dictionaries[field->attr_id];
+    /* dictionary-encoded fields are decoded only here, i.e., when the value is materialized */
+    if (dict != NULL) {
+        return dict_decode(dict, *(const dict_code_t *) field->attr_value_ptr);
+    }
+    return (frag->layout->fields[field->attr_id].attr->flags.varlen ?
+            vstring_str(field->attr_value_ptr, frag->strings) : field->attr_value_ptr);
 }
 
  void field_update(tuplet_field_t *field, const void *data)
 {
     assert (field && data);
-    const attr_t *attr = schema_attr_by_id(field->tuplet->fragment->schema, field->attr_id);
-    if (attr_isstring(attr)) {
+    frag_t *frag = field->tuplet->fragment;
+    const attr_t *attr = frag->layout->fields[field->attr_id].attr;
+    if (frag->format == TF_DSM) {
+        field->attr_value_ptr = field_dsm_mutable_ptr(frag, field->tuplet->tuplet_id, field->attr_id);
+    }
+    if (frag->dictionaries[field->attr_id] != NULL) {
         const char *str = *(const char **) data;
-        strcpy(field->attr_value_ptr, str);
+        *(dict_code_t *) field->attr_value_ptr = dict_encode(frag->dictionaries[field->attr_id], str);
+    } else if (attr->flags.varlen) {
+        vstring_make(field->attr_value_ptr, frag->strings, *(const char **) data);
+    } else if (attr_isstring(attr)) {
+        field_char_copy(field->attr_value_ptr, attr, *(const char **) data);
     } else {
-        memcpy(field->attr_value_ptr, data, tuplet_field_size(field));
+        memcpy(field->attr_value_ptr, data, frag->layout->fields[field->attr_id].size);
+        frag_zone_add(frag, field->tuplet->tuplet_id, field->attr_id, data);
     }
+    frag_set_valid(field->tuplet->fragment, field->tuplet->tuplet_id, field->attr_id);
+}
+
+ void field_char_copy(void *dst, const attr_t *attr, const char *str)
+{
+    /* fixed-width strings occupy exactly their slot, including the terminating zero */
+    size_t len = strlen(str);
+    REQUIRE_WARGS((len < attr_value_size(attr)), "Constraint violation: string of length %zu exceeds attribute '%s'",
+                  len, attr->name);
+    memcpy(dst, str, len + 1);
 }
 
  void field_set_null(tuplet_field_t *field)
 {
     assert (field);
-    // TODO: Implement
-    panic(NOTIMPLEMENTED, to_string(field_set_null));
+    frag_set_null(field->tuplet->fragment, field->tuplet->tuplet_id, field->attr_id);
 }
 
  bool field_is_null(tuplet_field_t *field)
 {
     assert (field);
-    // TODO: Implement
-    panic(NOTIMPLEMENTED, to_string(field_set_null));
-    return false;
-}
\ No newline at end of file
+    return frag_is_null(field->tuplet->fragment, field->tuplet->tuplet_id, field->attr_id);
+}
+
+// - C O L U M N   W R I T E S -----------------------------------------------------------------------------------------
+
+ void frag_write_values(frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void *values)
+{
+    const attr_t *attr = self->layout->fields[attr_id].attr;
+    tuplet_id_t end = begin + count;
+
+    if (attr_isstring(attr)) {
+        /* strings are passed by reference and must be encoded resp. copied one by one */
+        const char **strings = (const char **) values;
+        for (tuplet_id_t tuplet_id = begin; tuplet_id < end; tuplet_id++) {
+            void *dst = field_mutable_ptr(self, tuplet_id, attr_id);
+            const char *str = *strings++;
+            if (self->dictionaries[attr_id] != NULL) {
+                *(dict_code_t *) dst = dict_encode(self->dictionaries[attr_id], str);
+            } else if (attr->flags.varlen) {
+                vstring_make(dst, self->strings, str);
+            } else {
+                field_char_copy(dst, attr, str);
+            }
+        }
+    } else {
+        size_t attr_size = self->layout->fields[attr_id].size;
+        switch (self->format) {
+            case TF_DSM:
+                /* the range is contiguous in the column, since a compressed prefix is unpacked before */
+                memcpy(field_dsm_mutable_ptr(self, begin, attr_id), values, count * attr_size);
+                break;
+            case TF_PAX: {
+                size_t page_ntuplets = pax_page_ntuplets(self);
+                const void *src = values;
+                for (tuplet_id_t tuplet_id = begin; tuplet_id < end; ) {
+                    size_t run = min(end - tuplet_id, page_ntuplets - tuplet_id % page_ntuplets);
+                    memcpy(field_pax_ptr(self, tuplet_id, attr_id), src, run * attr_size);
+                    src += run * attr_size;
+                    tuplet_id += run;
+                }
+            } break;
+            case TF_NSM: {
+                size_t offset = self->layout->fields[attr_id].offset;
+                const void *src = values;
+                for (tuplet_id_t tuplet_id = begin; tuplet_id < end; tuplet_id++, src += attr_size) {
+                    void *base = (self->impl_type == FIT_HOST_NSM_SEG ? segments_tuplet_ptr(self, tuplet_id) :
+                                  self->tuplet_data + tuplet_id * self->tuplet_size);
+                    memcpy(base + offset, src, attr_size);
+                }
+            } break;
+            default: panic(BADBRANCH, self);
+        }
+        for (tuplet_id_t tuplet_id = begin; tuplet_id < end; tuplet_id++, values += attr_size) {
+            frag_zone_add(self, tuplet_id, attr_id, values);
+        }
+    }
+
+    if (self->validity[attr_id] != NULL) {
+        for (tuplet_id_t tuplet_id = begin; tuplet_id < end; tuplet_id++) {
+            frag_set_valid(self, tuplet_id, attr_id);
+        }
+    }
+}
+
+ size_t frag_view_values(frag_t *self, attr_id_t attr_id, tuplet_id_t begin, size_t count, const void **base,
+                         size_t *stride)
+{
+    const frag_field_layout_t *field = self->layout->fields + attr_id;
+    switch (self->format) {
+        case TF_NSM:
+            *stride = self->tuplet_size;
+            if (self->impl_type == FIT_HOST_NSM_SEG) {
+                /* tuplets are contiguous inside a segment only */
+                count = min(count, FRAG_SEGMENT_NTUPLETS - begin % FRAG_SEGMENT_NTUPLETS);
+                *base = segments_tuplet_ptr(self, begin) + field->offset;
+            } else {
+                *base = self->tuplet_data + begin * self->tuplet_size + field->offset;
+            }
+            return count;
+        case TF_DSM:
+            *stride = field->size;
+            *base = field_dsm_ptr(self, begin, attr_id);
+            return count;
+        case TF_PAX: {
+            /* mini-columns are contiguous inside a page only */
+            size_t page_ntuplets = pax_page_ntuplets(self);
+            *stride = field->size;
+            *base = field_pax_ptr(self, begin, attr_id);
+            return min(count, page_ntuplets - begin % page_ntuplets);
+        }
+        default: panic(BADBRANCH, self);
+    }
+    return 0;
+}
+
+ void *field_mutable_ptr(frag_t *frag, tuplet_id_t tuplet_id, attr_id_t attr_id)
+{
+    switch (frag->format) {
+        case TF_NSM:
+            return (frag->impl_type == FIT_HOST_NSM_SEG ? segments_tuplet_ptr(frag, tuplet_id) :
+                    frag->tuplet_data + tuplet_id * frag->tuplet_size) + frag->layout->fields[attr_id].offset;
+        case TF_DSM: return field_dsm_mutable_ptr(frag, tuplet_id, attr_id);
+        case TF_PAX: return field_pax_ptr(frag, tuplet_id, attr_id);
+        default: panic(BADBRANCH, frag);
+    }
+    return NULL;
+}
+
+// - M M A P   S T O R A G E -------------------------------------------------------------------------------------------
+
+ void mmap_remap(frag_t *frag, size_t tuplet_capacity)
+{
+    mmap_storage_t *storage = frag->extra;
+    size_t map_size = FRAG_MMAP_HEADER_SIZE + tuplet_capacity * frag->tuplet_size;
+
+    /* extend the file first such that the entire new mapping is backed by the file */
+    panic_if((ftruncate(storage->fd, map_size) != 0), "Unable to resize fragment file '%s': %s", storage->path,
+             strerror(errno));
+    if (storage->map_base != NULL) {
+        munmap(storage->map_base, storage->map_size);
+    }
+    storage->map_base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, storage->fd, 0);
+    panic_if((storage->map_base == MAP_FAILED), "Unable to map fragment file '%s': %s", storage->path,
+             strerror(errno));
+    storage->map_size = map_size;
+
+    mmap_header_t *header = storage->map_base;
+    header->magic = FRAG_MMAP_MAGIC;
+    header->tuplet_size = frag->tuplet_size;
+    header->ntuplets = frag->ntuplets;
+    frag->tuplet_data = storage->map_base + FRAG_MMAP_HEADER_SIZE;
+}
+
+ void mmap_flush(frag_t *self, tuplet_id_t begin, tuplet_id_t end)
+{
+    mmap_storage_t *storage = self->extra;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+
+    ((mmap_header_t *) storage->map_base)->ntuplets = self->ntuplets;
+    panic_if((msync(storage->map_base, min(page_size, storage->map_size), MS_SYNC) != 0),
+             "Unable to flush fragment file '%s': %s", storage->path, strerror(errno));
+
+    if (begin < end) {
+        /* msync requires a page-aligned start address */
+        size_t offset_begin = FRAG_MMAP_HEADER_SIZE + begin * self->tuplet_size;
+        size_t offset_end   = FRAG_MMAP_HEADER_SIZE + end * self->tuplet_size;
+        offset_begin -= offset_begin % page_size;
+        panic_if((msync(storage->map_base + offset_begin, offset_end - offset_begin, MS_SYNC) != 0),
+                 "Unable to flush fragment file '%s': %s", storage->path, strerror(errno));
+    }
+}
+
+ void mmap_close(frag_t *frag)
+{
+    mmap_storage_t *storage = frag->extra;
+    ((mmap_header_t *) storage->map_base)->ntuplets = frag->ntuplets;
+    munmap(storage->map_base, storage->map_size);
+    close(storage->fd);
+    if (storage->unlink_on_close) {
+        unlink(storage->path);
+    }
+    free (storage->path);
+    free (storage);
+}
+
+// - S E G M E N T E D   S T O R A G E ---------------------------------------------------------------------------------
+
+ size_t segments_capacity(size_t tuplet_capacity)
+{
+    size_t nsegments = (max(1, tuplet_capacity) + FRAG_SEGMENT_NTUPLETS - 1) / FRAG_SEGMENT_NTUPLETS;
+    return nsegments * FRAG_SEGMENT_NTUPLETS;
+}
+
+ void segments_add(frag_t *frag, size_t tuplet_capacity)
+{
+    segment_directory_t *directory = frag->extra;
+    size_t segment_size = FRAG_SEGMENT_NTUPLETS * frag->tuplet_size;
+    while (directory->nsegments * FRAG_SEGMENT_NTUPLETS < tuplet_capacity) {
+        if (directory->nsegments == directory->capacity) {
+            /* only the directory is re-allocated, which holds a single pointer per segment */
+            directory->capacity = max(1, 2 * directory->capacity);
+            directory->segments = realloc(directory->segments, directory->capacity * sizeof(void *));
+            panic_if((directory->segments == NULL), BADMALLOC, "segment directory");
+        }
+        void *segment = frag_allocator_alloc(frag->allocator, segment_size);
+        panic_if((segment == NULL), BADMALLOC, "fragment segment");
+        directory->segments[directory->nsegments++] = segment;
+    }
+}
+
+ void segments_free(frag_t *frag)
+{
+    segment_directory_t *directory = frag->extra;
+    size_t segment_size = FRAG_SEGMENT_NTUPLETS * frag->tuplet_size;
+    for (size_t i = 0; i < directory->nsegments; i++) {
+        frag_allocator_free(frag->allocator, directory->segments[i], segment_size);
+    }
+    free (directory->segments);
+    free (directory);
+}
+
+ void *segments_tuplet_ptr(frag_t *frag, tuplet_id_t tuplet_id)
+{
+    segment_directory_t *directory = frag->extra;
+    return directory->segments[tuplet_id / FRAG_SEGMENT_NTUPLETS] +
+           (tuplet_id % FRAG_SEGMENT_NTUPLETS) * frag->tuplet_size;
+}
@@ -22,6 +22,7 @@
 #include <tuplet_field.h>
 #include <tuple_field.h>
 #include <apr_strings.h>
+#include <sched.h>
 
 void create_indexes(table_t *table, size_t approx_num_horizontal_partitions);
 
@@ -29,6 +30,10 @@ void create_indexes(table_t *table, size_t approx_num_horizontal_partitions);
 
  void create_tuple_id_store(table_t *table);
 
+ void create_grid_directory(table_t *table);
+
+ void grid_directory_insert(table_t *table, grid_t *grid);
+
  grid_t *create_grid(table_t *table, const attr_id_t *attr, size_t nattr,
                                   const tuple_id_interval_t *tuple_ids, size_t ntuple_ids, enum frag_impl_type_t type);
 
@@ -39,36 +44,141 @@ void create_indexes(table_t *table, size_t approx_num_horizontal_partitions);
 
  void register_grid(table_t *table, grid_t *grid);
 
+ grid_list_t *grid_list_new(size_t capacity);
+
+ void grid_list_append(_Atomic(grid_list_t *) *list, grid_t *grid);
+
+ void grid_list_free(grid_list_t *list);
+
+ void grid_retire(grid_t *grid, bool is_frag, void *storage);
+
+ void retired_free(const grid_retired_t *retired);
+
+ bool grid_step_read(table_plan_step_t *step, const grid_t *grid, attr_id_t table_attr_id, tuple_id_t tuple_id);
+
+ bool grid_tuplet_by_tuple(tuplet_id_t *out, const grid_t *grid, tuple_id_t tuple_id);
+
+ bool grid_run_by_tuple(tuplet_id_t *out, size_t *span, const grid_t *grid, tuple_id_t tuple_id,
+                        grid_translation_cache_t *cache);
+
+ void table_write_columns(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids,
+                          const table_column_t *columns, size_t ncolumns);
+
+ void interval_list_append(vec_t *intervals, tuple_id_t tuple_id);
+
+ void interval_list_coalesce(vec_t *intervals, const tuple_id_interval_t *tuple_ids, size_t ntuple_ids);
+
+ int comp_tuple_id(const void *lhs, const void *rhs);
+
+ int comp_grid_ptr(const void *lhs, const void *rhs);
+
+ void *compact_promise(promise_result *return_value, const void *capture);
+
+typedef struct compact_args_t {
+    table_t *table;
+    float min_dead_ratio;
+} compact_args_t;
+
+typedef struct melt_run_t {
+    tuplet_id_t src_begin; /* first tuplet of the run in the source grid */
+    tuplet_id_t dst_begin; /* first tuplet of the run in the molten fragment */
+    size_t length;
+} melt_run_t;
+
+typedef struct melt_args_t {
+    const table_t *src_table;
+    frag_t *dst_frag;
+    const attr_id_t *attr_ids; /* source table attribute of the i-th molten attribute */
+    size_t nattr_ids;
+    vec_t **runs; /* per source grid id, the runs of this grid, or NULL if no molten attribute is in the grid */
+    size_t *order; /* molten attributes in the order in which they are claimed by workers */
+    size_t nsingle; /* the first 'nsingle' entries in 'order' are claimed one by one, the remaining ones (which share
+                       the string heap of the molten fragment) by a single worker */
+    size_t ntasks;
+    atomic_size_t next_task;
+    const vec_t **intervals; /* per source grid id, the interval list from which the runs of this grid are translated */
+    size_t num_grids; /* the number of grids in the source table when the runs were translated */
+    atomic_bool stale; /* set if a source grid was compacted after its runs were translated */
+} melt_args_t;
+
+ table_t *melt_table(enum frag_impl_type_t type, const table_t *src_table, const tuple_id_t *tuple_ids,
+                     size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids);
+
+ vec_t *melt_runs(const grid_t *grid, const tuple_id_t *tuple_ids, size_t ntuple_ids, bool sorted,
+                  tuplet_id_t *tuplets);
+
+ void melt_work(melt_args_t *args);
+
+ bool window_is_live(table_window_t *window, tuple_id_t tuple_id);
+
+ size_t window_num_covered(const table_t *table, attr_id_t table_attr_id, tuple_id_t end);
+
+ table_plan_step_t *plan_seek(table_plan_t *plan, size_t attr_idx, tuple_id_t tuple_id);
+
+ void *melt_promise(promise_result *return_value, const void *capture);
+
+ void melt_column(melt_args_t *args, size_t dst_attr_id);
+
+ bool melt_run(frag_t *dst, attr_id_t dst_attr_id, frag_t *src, attr_id_t src_attr_id, const melt_run_t *run,
+               void *buffer);
+
+ void melt_monitor(const table_t *src_table, size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids,
+                   vec_t **runs, size_t num_grids);
+
+ void table_plan_step_flush(table_plan_step_t *step);
+
+ frag_t *frag_copy(frag_t *src, enum frag_impl_type_t type, const grid_t *grid, u64 version);
+
+ bool frag_transpose(frag_t *dst, frag_t *src, void *buffer, const grid_t *grid, u64 version);
+
+ bool relayout_yield(const grid_t *grid, u64 version);
+
+ void *convert_promise(promise_result *return_value, const void *capture);
+
+typedef struct convert_args_t {
+    grid_t *grid;
+    enum frag_impl_type_t type;
+} convert_args_t;
+
 table_t *table_new(const schema_t *schema, size_t approx_num_horizontal_partitions)
 {
     if (schema != NULL) {
         table_t *result = GS_REQUIRE_MALLOC(sizeof(table_t));
         result->schema = schema_cpy(schema);
-        result->num_tuples = 0;
+        atomic_init(&result->num_tuples, 0);
+        pthread_mutex_init(&result->latch, NULL);
+        table_monitor_create(&result->monitor, result->schema->attr->num_elements);
         create_indexes(result, approx_num_horizontal_partitions);
         create_grid_ptr_store(result);
         create_tuple_id_store(result);
+        create_grid_directory(result);
         return result;
     } else return NULL;
 }
 
- bool free_grids(void *capture, void *begin, void *end)
+ void free_grids(grid_list_t *list)
 {
-    for (grid_t **it = (grid_t **) begin; it < (grid_t **) end; it++) {
-        grid_delete(*it);
-        free(*it);
+    size_t length = atomic_load(&list->length);
+    for (size_t i = 0; i < length; i++) {
+        grid_delete(list->grids[i]);
+        free(list->grids[i]);
     }
-    return true;
 }
 
 void table_delete(table_t *table)
 {
     schema_delete(table->schema);
-    vec_foreach(table->grid_ptrs, NULL, free_grids);
-    vec_free(table->grid_ptrs);
+    free_grids(table->grid_ptrs);
+    grid_list_free(table->grid_ptrs);
+    for (size_t i = 0; i < vec_length(table->grids_by_attr); i++) {
+        grid_list_free(((grids_by_attr_index_elem_t *) vec_at(table->grids_by_attr, i))->grid_ptrs);
+    }
+    vec_free(table->grids_by_attr);
+    pthread_mutex_destroy(&table->latch);
     vindex_delete(table->schema_cover);
     hindex_delete(table->tuple_cover);
-    freelist_dispose(&table->tuple_id_freelist);
+    id_allocator_dispose(&table->tuple_id_allocator);
+    table_monitor_dispose(&table->monitor);
     free(table->schema_cover);
     free(table->tuple_cover);
 }
@@ -78,6 +188,14 @@ void grid_delete(grid_t *grid)
     frag_delete(grid->frag);
     apr_pool_destroy(grid->pool);
     vec_free(grid->tuple_ids);
+    vec_free(grid->tuplet_offsets);
+    for (size_t i = 0; i < vec_length(grid->retired); i++) {
+        retired_free(vec_at(grid->retired, i));
+    }
+    vec_free(grid->retired);
+    pthread_mutex_destroy(&grid->retired_latch);
+    pthread_mutex_destroy(&grid->relayout_latch);
+    grid_stats_dispose(&grid->stats);
 }
 
 const char *table_name(const table_t *table)
@@ -95,32 +213,42 @@ grid_id_t table_add(table_t *table, const attr_id_t *attr_ids_covered, size_t na
     GS_REQUIRE_NONNULL(tuple_ids_covered);
 
     grid_t *grid = create_grid(table, attr_ids_covered, nattr_ids_covered, tuple_ids_covered, ntuple_ids_covered, type);
-    indexes_insert(table, grid, attr_ids_covered, nattr_ids_covered, tuple_ids_covered, ntuple_ids_covered);
+
+    // The horizontal index is keyed by the coalesced intervals of the grid, since compaction removes these keys
+    pthread_mutex_lock(&table->latch);
+    indexes_insert(table, grid, attr_ids_covered, nattr_ids_covered, vec_begin(grid->tuple_ids),
+                   vec_length(grid->tuple_ids));
     register_grid(table, grid);
 
-    // Determine the maximum number of tuples in this table
+    // Determine the maximum number of tuples in this table. The grid is registered before, such that readers that
+    // observe the new number of tuples also find the grid that covers these.
     while (ntuple_ids_covered--) {
         REQUIRE_LESSTHAN(tuple_ids_covered->begin, tuple_ids_covered->end);
-        table->num_tuples = max(table->num_tuples, tuple_ids_covered->end);
+        if (tuple_ids_covered->end > atomic_load(&table->num_tuples)) {
+            atomic_store(&table->num_tuples, tuple_ids_covered->end);
+        }
         tuple_ids_covered++;
     }
+    pthread_mutex_unlock(&table->latch);
 
-    // Return the grid identifier of the newly added grid. Since it's accessed as an index in the 'grid_ptrs' vector,
-    // just return the index of the new grid in this vector
-    return (table->grid_ptrs->num_elements - 1);
+    // Return the grid identifier of the newly added grid, which is its index in the 'grid_ptrs' list
+    return grid->grid_id;
 }
 
-const freelist_t *table_freelist(const struct table_t *table)
+const id_allocator_t *table_id_allocator(const struct table_t *table)
 {
     GS_REQUIRE_NONNULL(table);
-    return &(table->tuple_id_freelist);
+    return &(table->tuple_id_allocator);
 }
 
 grid_cursor_t *table_find(const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids,
                           const tuple_id_t *tuple_ids, size_t ntuple_ids)
 {
+    // The indexes are not safe for concurrent modification, hence they are queried under the table latch
+    pthread_mutex_lock((pthread_mutex_t *) &table->latch);
     grid_cursor_t *v_result = vindex_query(table->schema_cover, attr_ids, attr_ids + nattr_ids);
     grid_cursor_t *h_result = hindex_query(table->tuple_cover, tuple_ids, tuple_ids + ntuple_ids);
+    pthread_mutex_unlock((pthread_mutex_t *) &table->latch);
 
     bool v_less_h = (grid_cursor_numelem(v_result) < grid_cursor_numelem(h_result));
     grid_cursor_t *smaller = v_less_h ? v_result : h_result;
@@ -141,13 +269,13 @@ grid_cursor_t *table_find(const table_t *table, const attr_id_t *attr_ids, size_
 
     /* Build */
     for (const grid_t *grid = grid_cursor_next(smaller); grid != NULL; grid = grid_cursor_next(NULL)) {
-        grid_t *grid_cp = apr_pmemdup(pool, grid, sizeof(grid_t));
-        apr_hash_set(hash_table, grid_cp, sizeof(grid_t), dummy);
+        const grid_t **grid_cp = apr_pmemdup(pool, &grid, sizeof(grid_t *));
+        apr_hash_set(hash_table, grid_cp, sizeof(grid_t *), dummy);
     }
 
     /* Probe */
     for (const grid_t *grid = grid_cursor_next(larger); grid != NULL; grid = grid_cursor_next(NULL)) {
-        if (apr_hash_get(hash_table, &grid, sizeof(grid_t))) {
+        if (apr_hash_get(hash_table, &grid, sizeof(grid_t *))) {
             grid_cursor_pushback(result, &grid);
         }
     }
@@ -162,30 +290,206 @@ grid_cursor_t *table_find(const table_t *table, const attr_id_t *attr_ids, size_
 table_t *table_melt(enum frag_impl_type_t type, const table_t *src_table, const tuple_id_t *tuple_ids,
                     size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids)
 {
-    tuple_t src_tuple, dst_tuple;
-    tuple_field_t src_field, dst_field;
-    tuple_cursor_t dst_cursor;
-    tuple_id_t src_tuple_id = 0;
+    GS_REQUIRE_NONNULL(src_table);
+    GS_REQUIRE_NONNULL(tuple_ids);
+    GS_REQUIRE_NONNULL(attr_ids);
 
-    schema_t *dst_schema = schema_subset(src_table->schema, attr_ids, nattr_ids);
-    table_t *dst_table = table_new(dst_schema, 1);
-    tuple_id_interval_t cover = { .begin = 0, .end = ntuple_ids };
-    table_add(dst_table, attr_ids, nattr_ids, &cover, 1, type);
-    grid_insert(&dst_cursor, dst_table, ntuple_ids);
+    table_t *dst_table;
+    // A source grid that is compacted while melting invalidates the translated runs, hence melt again in this case
+    while ((dst_table = melt_table(type, src_table, tuple_ids, ntuple_ids, attr_ids, nattr_ids)) == NULL);
+    return dst_table;
+}
 
-    while (tuple_cursor_next(&dst_tuple, &dst_cursor)) {
-        tuple_open(&src_tuple, src_table, src_tuple_id++);
-        for (size_t x = 0; x < nattr_ids; x++) {
-            attr_id_t attr_id = attr_ids[x];
-            tuple_field_seek(&src_field, &src_tuple, attr_id);
-            tuple_field_seek(&dst_field, &dst_tuple, attr_id);
-            const void *field_data = tuple_field_read(&src_field);
-            tuple_field_write(&dst_field, field_data);
+table_plan_t *table_plan_new(const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids)
+{
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(attr_ids);
+
+    table_plan_t *plan = GS_REQUIRE_MALLOC(sizeof(table_plan_t));
+    *plan = (table_plan_t) {
+        .table = table,
+        .nattr_ids = nattr_ids,
+        .attr_ids = GS_REQUIRE_MALLOC(nattr_ids * sizeof(attr_id_t)),
+        .steps = GS_REQUIRE_MALLOC(nattr_ids * sizeof(table_plan_step_t)),
+        .ntuples = 0,
+        .last_tuple_id = 0
+    };
+    memcpy(plan->attr_ids, attr_ids, nattr_ids * sizeof(attr_id_t));
+    for (size_t i = 0; i < nattr_ids; i++) {
+        plan->steps[i] = (table_plan_step_t) { .grid = NULL };
+    }
+    return plan;
+}
+
+void table_plan_delete(table_plan_t *plan)
+{
+    GS_REQUIRE_NONNULL(plan);
+    for (size_t i = 0; i < plan->nattr_ids; i++) {
+        table_plan_step_flush(plan->steps + i);
+        if (plan->steps[i].grid != NULL) {
+            grid_unpin(plan->steps[i].grid, plan->steps[i].pin);
+            // The plan might have delayed freeing storage that was replaced while it was open
+            grid_reclaim((grid_t *) plan->steps[i].grid);
         }
     }
-    tuple_cursor_dispose(&dst_cursor);
-    schema_delete(dst_schema);
-    return dst_table;
+    table_monitor_record((table_monitor_t *) &plan->table->monitor, plan->attr_ids, plan->nattr_ids, plan->ntuples);
+    free(plan->attr_ids);
+    free(plan->steps);
+    free(plan);
+}
+
+const table_plan_step_t *table_plan_seek(table_plan_t *plan, size_t attr_idx, tuple_id_t tuple_id)
+{
+    REQUIRE_LESSTHAN(attr_idx, plan->nattr_ids);
+    const table_plan_step_t *step = plan_seek(plan, attr_idx, tuple_id);
+    panic_if(step == NULL, "Internal error: field [tuple #%u @ '%s'] is not covered by any grid", tuple_id,
+             table_attr_name_by_id(plan->table, plan->attr_ids[attr_idx]));
+    return step;
+}
+
+bool table_plan_step_resolve(table_plan_step_t *step, const table_t *table, attr_id_t table_attr_id,
+                             tuple_id_t tuple_id)
+{
+    GS_REQUIRE_NONNULL(step);
+    GS_REQUIRE_NONNULL(table);
+    REQUIRE_LESSTHAN(table_attr_id, vec_length(table->grids_by_attr));
+    table_plan_step_flush(step);
+
+    const grids_by_attr_index_elem_t *elem = vec_at(table->grids_by_attr, table_attr_id);
+    const grid_list_t *grids = atomic_load_explicit(&elem->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    for (size_t i = 0; i < ngrids; i++) {
+        const grid_t *grid = grids->grids[i];
+        table_plan_step_t candidate = { .naccesses = 0 };
+        bool covered;
+        u64 version, pin = grid_pin(grid);
+        do {
+            version = grid_read_begin(grid);
+            candidate.version = atomic_load(&table->grid_set_version);
+            covered = grid_step_read(&candidate, grid, table_attr_id, tuple_id);
+        } while (!grid_read_validate(grid, version));
+        grid_unpin(grid, pin);
+        if (covered) {
+            *step = candidate;
+            return true;
+        }
+    }
+    step->grid = NULL;
+    return false;
+}
+
+void table_window_open(table_window_t *window, const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids,
+                       size_t row_offset, size_t limit)
+{
+    GS_REQUIRE_NONNULL(window);
+    GS_REQUIRE_NONNULL(table);
+
+    if (attr_ids != NULL) {
+        window->plan = table_plan_new(table, attr_ids, nattr_ids);
+    } else {
+        nattr_ids = table_num_of_attributes(table);
+        attr_id_t *all_attr_ids = GS_REQUIRE_MALLOC(max(nattr_ids, 1) * sizeof(attr_id_t));
+        for (size_t i = 0; i < nattr_ids; all_attr_ids[i] = i, i++);
+        window->plan = table_plan_new(table, all_attr_ids, nattr_ids);
+        free(all_attr_ids);
+    }
+    REQUIRE((nattr_ids > 0), BADINT);
+    window->limit = limit;
+    window->nvisited = 0;
+    window->value = NULL;
+    window->value_capacity = 0;
+
+    // Without deleted tuples, the n-th row is the n-th tuple. Otherwise, the live rows before the window are skipped.
+    // Compaction removes deleted tuples from their grids, which is visible as tuples not covered by any grid.
+    size_t num_deleted = 0, num_tuples = table->num_tuples;
+    for (grid_id_t grid_id = 0; grid_id < table_num_of_grids(table); grid_id++) {
+        const grid_t *grid = grid_by_id(table, grid_id);
+        size_t grid_num_deleted;
+        u64 version, pin = grid_pin(grid);
+        do {
+            version = grid_read_begin(grid);
+            grid_num_deleted = frag_num_of_deleted(grid->frag);
+        } while (!grid_read_validate(grid, version));
+        grid_unpin(grid, pin);
+        num_deleted += grid_num_deleted;
+    }
+    tuple_id_t begin = 0;
+    if (num_deleted == 0 && window_num_covered(table, window->plan->attr_ids[0], num_tuples) == num_tuples) {
+        begin = min(row_offset, num_tuples);
+    } else {
+        for (size_t nskipped = 0; begin < num_tuples; begin++) {
+            if (window_is_live(window, begin)) {
+                if (nskipped == row_offset) {
+                    break;
+                }
+                nskipped++;
+            }
+        }
+    }
+    window->begin = window->next = window->current = begin;
+}
+
+bool table_window_next(table_window_t *window, tuple_id_t *tuple_id)
+{
+    GS_REQUIRE_NONNULL(window);
+    const table_t *table = window->plan->table;
+    while (window->nvisited < window->limit && window->next < table->num_tuples) {
+        tuple_id_t candidate = window->next++;
+        if (window_is_live(window, candidate)) {
+            window->current = candidate;
+            window->nvisited++;
+            if (tuple_id != NULL) {
+                *tuple_id = candidate;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+const void *table_window_read(table_window_t *window, size_t attr_idx)
+{
+    GS_REQUIRE_NONNULL(window);
+    const table_plan_step_t *step = table_plan_seek(window->plan, attr_idx, window->current);
+    tuplet_id_t tuplet_id = table_plan_step_tuplet(step, window->current);
+    const attr_t *attr = table_attr_by_id(window->plan->table, window->plan->attr_ids[attr_idx]);
+    const void *result = NULL;
+
+    // Writers free replaced buffers in place (e.g., the string heap), hence the value is copied under the latch
+    grid_share_lock(step->grid);
+    if (!frag_is_null(step->grid->frag, tuplet_id, step->grid_attr_id)) {
+        tuplet_t tuplet;
+        tuplet_field_t field;
+        tuplet_open(&tuplet, step->grid->frag, tuplet_id);
+        tuplet_field_seek(&field, &tuplet, step->grid_attr_id);
+        const void *value = tuplet_field_read(&field);
+        size_t size = (attr->flags.dict || attr->flags.varlen ? strlen(value) + 1 : attr_value_size(attr));
+        if (size > window->value_capacity) {
+            free(window->value);
+            window->value_capacity = max(size, 2 * window->value_capacity);
+            window->value = GS_REQUIRE_MALLOC(window->value_capacity);
+        }
+        result = memcpy(window->value, value, size);
+    }
+    grid_share_unlock(step->grid);
+    return result;
+}
+
+void table_window_rewind(table_window_t *window)
+{
+    GS_REQUIRE_NONNULL(window);
+    window->next = window->current = window->begin;
+    window->nvisited = 0;
+}
+
+void table_window_close(table_window_t *window)
+{
+    GS_REQUIRE_NONNULL(window);
+    table_plan_delete(window->plan);
+    window->plan = NULL;
+    free(window->value);
+    window->value = NULL;
+    window->value_capacity = 0;
 }
 
 // This function returns NULL, if the table attribute is not covered by this grid
@@ -215,26 +519,171 @@ size_t table_num_of_attributes(const table_t *table)
 size_t table_num_of_tuples(const table_t *table)
 {
     GS_REQUIRE_NONNULL(table)
-    return table->num_tuples;
+    return atomic_load(&table->num_tuples);
 }
 
 size_t table_num_of_grids(const table_t *table)
 {
     GS_REQUIRE_NONNULL(table)
-    return table->grid_ptrs->num_elements;
+    const grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    return atomic_load_explicit(&grids->length, memory_order_acquire);
 }
 
 const grid_t *grid_by_id(const table_t *table, grid_id_t id)
 {
     GS_REQUIRE_NONNULL(table);
-    REQUIRE_LESSTHAN(id, table->grid_ptrs->num_elements);
-    return *(const grid_t **) vec_at(table->grid_ptrs, id);
+    const grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    REQUIRE_LESSTHAN(id, atomic_load_explicit(&grids->length, memory_order_acquire));
+    return grids->grids[id];
+}
+
+void grid_intervals_changed(grid_t *grid)
+{
+    GS_REQUIRE_NONNULL(grid);
+    const vec_t *tuple_ids = grid->tuple_ids;
+    size_t nintervals = vec_length(tuple_ids);
+    vec_t *tuplet_offsets = vec_new(sizeof(tuplet_id_t), max(nintervals, 1));
+    vec_resize(tuplet_offsets, nintervals);
+    tuplet_id_t *offsets = vec_begin(tuplet_offsets);
+    const tuple_id_interval_t *intervals = vec_begin(tuple_ids);
+    tuplet_id_t offset = 0;
+    for (size_t i = 0; i < nintervals; i++) {
+        const tuple_id_interval_t *interval = intervals + i;
+        offsets[i] = offset;
+        offset += INTERVAL_SPAN(interval);
+    }
+
+    vec_t *retired = grid->tuplet_offsets;
+    grid->tuplet_offsets = tuplet_offsets;
+    if (retired != NULL) {
+        grid_retire(grid, false, retired);
+    }
+}
+
+bool grid_reclaim(grid_t *grid)
+{
+    GS_REQUIRE_NONNULL(grid);
+    // Storage is retired after it was replaced, hence readers that pin the grid from now on do not reach it, and
+    // none of the readers that pinned the grid before is left once no reader pins it
+    pthread_mutex_lock(&grid->retired_latch);
+    if (vec_length(grid->retired) > 0 && atomic_load(&grid->readers.count) == 0) {
+        for (size_t i = 0; i < vec_length(grid->retired); i++) {
+            retired_free(vec_at(grid->retired, i));
+        }
+        vec_resize(grid->retired, 0);
+    }
+    bool reclaimed = (vec_length(grid->retired) == 0);
+    pthread_mutex_unlock(&grid->retired_latch);
+    return reclaimed;
+}
+
+bool grid_relayout(grid_t *grid, enum frag_impl_type_t type)
+{
+    GS_REQUIRE_NONNULL(grid);
+    pthread_mutex_lock(&grid->relayout_latch);
+    if (grid->frag->impl_type == type) {
+        pthread_mutex_unlock(&grid->relayout_latch);
+        return false;
+    }
+
+    frag_t *frag = NULL;
+    for (size_t attempt = 0; frag == NULL; attempt++) {
+        if (attempt < GRID_RELAYOUT_MAX_RETRIES) {
+            // Writers free replaced buffers in place, hence the copy holds the latch in shared mode. It is released
+            // between blocks to let writers proceed, and the copy is swapped in only if no writer acquired the latch
+            // since the copy started.
+            grid_share_lock(grid);
+            u64 version = atomic_load(&grid->latch.version);
+            frag = frag_copy(grid->frag, type, grid, version);
+            grid_share_unlock(grid);
+            if (frag != NULL) {
+                grid_write_lock(grid);
+                if (atomic_load_explicit(&grid->latch.version, memory_order_relaxed) != version + 1) {
+                    grid_write_unlock(grid);
+                    frag_delete(frag);
+                    frag = NULL;
+                }
+            }
+        } else {
+            grid_write_lock(grid);
+            frag = frag_copy(grid->frag, type, NULL, 0);
+        }
+    }
+
+    frag_t *retired = grid->frag;
+    grid->frag = frag;
+    atomic_fetch_add(&grid->readers.epoch, 1);
+    grid_retire(grid, true, retired);
+    grid_write_unlock(grid);
+
+    // Readers that pin the grid from now on read the new fragment. Those that pinned it before are waited for only
+    // for a while, since open plans and windows keep their pins between calls.
+    for (size_t nwaits = 0; !grid_reclaim(grid) && nwaits < GRID_RECLAIM_MAX_WAITS; nwaits++) {
+        sched_yield();
+    }
+    pthread_mutex_unlock(&grid->relayout_latch);
+    return true;
+}
+
+future_t grid_convert(table_t *table, grid_id_t grid_id, enum frag_impl_type_t type)
+{
+    GS_REQUIRE_NONNULL(table);
+    REQUIRE_LESSTHAN(grid_id, table_num_of_grids(table));
+    convert_args_t *args = GS_REQUIRE_MALLOC(sizeof(convert_args_t));
+    *args = (convert_args_t) {
+        .grid = (grid_t *) grid_by_id(table, grid_id),
+        .type = type
+    };
+    return future_new(args, convert_promise, future_eager);
+}
+
+size_t grid_tuples_to_tuplets(tuplet_id_t *out, const grid_t *grid, const tuple_id_t *tuple_ids, size_t ntuple_ids)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(grid);
+    GS_REQUIRE_NONNULL(tuple_ids);
+
+    const vec_t *tuple_ids_vec = grid->tuple_ids, *offsets_vec = grid->tuplet_offsets;
+    const tuple_id_interval_t *intervals = vec_begin(tuple_ids_vec);
+    const tuplet_id_t *offsets = vec_begin(offsets_vec);
+    // Both lists differ in length only if an optimistic reader races with compaction, which fails its validation
+    size_t nintervals = min(vec_length(tuple_ids_vec), vec_length(offsets_vec));
+    size_t ncovered = 0;
+
+    /* both the tuple identifiers and the intervals are ascending, hence the cursor into the intervals never moves
+     * backwards; it starts at the first interval that does not end before the first tuple */
+    size_t start = 0, upper = nintervals;
+    while (ntuple_ids > 0 && start < upper) {
+        size_t mid = start + (upper - start) / 2;
+        if (intervals[mid].end <= tuple_ids[0]) {
+            start = mid + 1;
+        } else {
+            upper = mid;
+        }
+    }
+    for (size_t i = 0, idx = start; i < ntuple_ids; i++) {
+        tuple_id_t tuple_id = tuple_ids[i];
+        assert (i == 0 || tuple_ids[i - 1] <= tuple_id);
+        while (idx < nintervals && intervals[idx].end <= tuple_id) {
+            idx++;
+        }
+        if (idx < nintervals && intervals[idx].begin <= tuple_id) {
+            out[i] = offsets[idx] + (tuple_id - intervals[idx].begin);
+            ncovered++;
+        } else {
+            out[i] = GRID_TUPLET_NONE;
+        }
+    }
+    return ncovered;
 }
 
 size_t grid_num_of_attributes(const grid_t *grid)
 {
     GS_REQUIRE_NONNULL(grid);
-    return grid->frag->schema->attr->num_elements;
+    u64 pin = grid_pin(grid);
+    size_t num_attributes = grid->frag->schema->attr->num_elements;
+    grid_unpin(grid, pin);
+    return num_attributes;
 }
 
 vec_t *table_grids_by_attr(const table_t *table, const attr_id_t *attr_ids, size_t nattr_ids)
@@ -261,16 +710,178 @@ void grid_insert(tuple_cursor_t *resultset, table_t *table, size_t ntuplets)
     GS_REQUIRE_NONNULL(resultset);
     REQUIRE((ntuplets > 0), BADINT);
     tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(ntuplets * sizeof(tuple_id_t));
-    freelist_bind(tuple_ids, &table->tuple_id_freelist, ntuplets);
+    id_allocator_bind(tuple_ids, &table->tuple_id_allocator, ntuplets);
     tuple_cursor_create(resultset, table, tuple_ids, ntuplets);
 }
 
+void table_insert_columns(tuple_cursor_t *resultset, table_t *table, const table_column_t *columns, size_t ncolumns)
+{
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(resultset);
+    GS_REQUIRE_NONNULL(columns);
+    REQUIRE((ncolumns > 0), BADINT);
+
+    size_t ntuplets = columns[0].nvalues;
+    grid_insert(resultset, table, ntuplets);
+    table_write_columns(table, resultset->tuple_ids, ntuplets, columns, ncolumns);
+}
+
+void table_update_columns(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids,
+                          const table_column_t *columns, size_t ncolumns)
+{
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(tuple_ids);
+    GS_REQUIRE_NONNULL(columns);
+    table_write_columns(table, tuple_ids, ntuple_ids, columns, ncolumns);
+}
+
+void table_delete_tuples(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids)
+{
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(tuple_ids);
+    if (ntuple_ids == 0) {
+        return;
+    }
+
+    // Grids translate ascending identifiers in a single pass, see grid_tuples_to_tuplets()
+    tuple_id_t *sorted = GS_REQUIRE_MALLOC(ntuple_ids * sizeof(tuple_id_t));
+    memcpy(sorted, tuple_ids, ntuple_ids * sizeof(tuple_id_t));
+    qsort(sorted, ntuple_ids, sizeof(tuple_id_t), comp_tuple_id);
+
+    // The indexes are not safe for concurrent modification, hence they are queried under the table latch
+    pthread_mutex_lock(&table->latch);
+    grid_cursor_t *cover = hindex_query(table->tuple_cover, sorted, sorted + ntuple_ids);
+    pthread_mutex_unlock(&table->latch);
+
+    // The cover lists a grid once per tuple it contains; each grid is latched once for all of its tuples
+    size_t ngrids = 0;
+    grid_t **grids = GS_REQUIRE_MALLOC(max(1, grid_cursor_numelem(cover)) * sizeof(grid_t *));
+    for (const grid_t *grid = grid_cursor_next(cover); grid != NULL; grid = grid_cursor_next(NULL)) {
+        grids[ngrids++] = (grid_t *) grid;
+    }
+    hindex_close(cover);
+    qsort(grids, ngrids, sizeof(grid_t *), comp_grid_ptr);
+
+    tuplet_id_t *tuplets = GS_REQUIRE_MALLOC(ntuple_ids * sizeof(tuplet_id_t));
+    bitmap_word_t *covered = bitmap_new(ntuple_ids, false);
+    for (size_t i = 0; i < ngrids; i++) {
+        grid_t *grid = grids[i];
+        if (i > 0 && grids[i - 1] == grid) {
+            continue;
+        }
+        grid_write_lock(grid);
+        size_t ndeleted = grid_tuples_to_tuplets(tuplets, grid, sorted, ntuple_ids);
+        for (size_t j = 0; j < ntuple_ids; j++) {
+            if (tuplets[j] != GRID_TUPLET_NONE) {
+                frag_tuplet_delete(grid->frag, tuplets[j]);
+                bitmap_set(covered, j);
+            }
+        }
+        grid_stats_deleted(&grid->stats, ndeleted);
+        grid_write_unlock(grid);
+    }
+
+    for (size_t j = 0; j < ntuple_ids; j++) {
+        panic_if(!bitmap_test(covered, j), "Tuple '%u' is not covered by any grid in table '%s'", sorted[j],
+                 table_name(table));
+    }
+    bitmap_free(covered);
+    free(tuplets);
+    free(grids);
+    free(sorted);
+}
+
+size_t grid_compact(table_t *table, grid_t *grid)
+{
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(grid);
+
+    // Table metadata writers latch the table before the grid, see table_t
+    pthread_mutex_lock(&table->latch);
+    grid_write_lock(grid);
+    if (frag_num_of_deleted(grid->frag) == 0) {
+        grid_write_unlock(grid);
+        pthread_mutex_unlock(&table->latch);
+        return 0;
+    }
+
+    /* Rebuild the interval list without the deleted tuples. Since the i-th tuple in the order-preserving union of all
+     * intervals is mapped to the i-th tuplet, and compaction preserves the tuplet order, the mapping of the remaining
+     * tuples stays valid. */
+    vec_t *tuple_ids = vec_new(sizeof(tuple_id_interval_t), vec_length(grid->tuple_ids));
+    const tuple_id_interval_t *end = vec_end(grid->tuple_ids);
+    tuplet_id_t tuplet_id = 0;
+    for (const tuple_id_interval_t *it = vec_begin(grid->tuple_ids); it < end; it++) {
+        for (tuple_id_t tuple_id = it->begin; tuple_id < it->end; tuple_id++, tuplet_id++) {
+            if (!frag_is_deleted(grid->frag, tuplet_id)) {
+                interval_list_append(tuple_ids, tuple_id);
+            }
+        }
+    }
+
+    for (const tuple_id_interval_t *it = vec_begin(grid->tuple_ids); it < end; it++) {
+        hindex_remove_grid(table->tuple_cover, it, grid);
+    }
+    end = vec_end(tuple_ids);
+    for (const tuple_id_interval_t *it = vec_begin(tuple_ids); it < end; it++) {
+        hindex_add(table->tuple_cover, it, grid);
+    }
+
+    size_t num_removed = frag_compact(grid->frag, NULL);
+
+    vec_t *retired = grid->tuple_ids;
+    grid->tuple_ids = tuple_ids;
+    grid_retire(grid, false, retired);
+    grid_intervals_changed(grid);
+    atomic_fetch_add(&table->grid_set_version, 1);
+
+    grid_write_unlock(grid);
+    pthread_mutex_unlock(&table->latch);
+    grid_reclaim(grid);
+
+    return num_removed;
+}
+
+size_t table_compact(table_t *table, float min_dead_ratio)
+{
+    GS_REQUIRE_NONNULL(table);
+
+    /* The identifiers of removed tuples are not released to the table's identifier allocator: grids cover fixed
+     * ranges of tuple identifiers, and a re-used identifier would be covered by none of them after compaction. */
+    size_t num_removed = 0;
+    grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    size_t num_grids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    for (grid_id_t grid_id = 0; grid_id < num_grids; grid_id++) {
+        grid_t *grid = grids->grids[grid_id];
+        u64 pin = grid_pin(grid);
+        bool compact = (frag_num_of_deleted(grid->frag) > 0 && frag_dead_ratio(grid->frag) >= min_dead_ratio);
+        grid_unpin(grid, pin);
+        if (compact) {
+            num_removed += grid_compact(table, grid);
+        }
+    }
+    return num_removed;
+}
+
+future_t table_compact_async(table_t *table, float min_dead_ratio)
+{
+    GS_REQUIRE_NONNULL(table);
+    compact_args_t *args = GS_REQUIRE_MALLOC(sizeof(compact_args_t));
+    *args = (compact_args_t) {
+        .table = table,
+        .min_dead_ratio = min_dead_ratio
+    };
+    return future_new(args, compact_promise, future_eager);
+}
+
 void grid_print(FILE *file, const table_t *table, grid_id_t grid_id, size_t row_offset, size_t limit)
 {
     GS_REQUIRE_NONNULL(file)
     GS_REQUIRE_NONNULL(table)
     const grid_t *grid = grid_by_id(table, grid_id);
-    frag_print(stdout, grid->frag, row_offset, limit);
+    u64 pin = grid_pin(grid);
+    frag_print(file, grid->frag, row_offset, limit);
+    grid_unpin(grid, pin);
 }
 
 void table_grid_list_print(FILE *file, const table_t *table, size_t row_offset, size_t limit)
@@ -295,14 +906,17 @@ void table_grid_list_print(FILE *file, const table_t *table, size_t row_offset,
         tuplet_field_open(&field, &tuplet);
         for (size_t i = 0; i < num_tuples; i++) {
             const grid_t *grid = grid_by_id(table, i);
+            u64 pin = grid_pin(grid);
+            const frag_t *grid_frag = grid->frag;
             tuplet_field_write(&field, &i, true);
-            tuplet_field_write(&field, &grid->frag->format, true);
-            tuplet_field_write(&field, &grid->frag->impl_type, true);
-            tuplet_field_write(&field, &grid->frag->ntuplets, true);
-            tuplet_field_write(&field, &grid->frag->ncapacity, true);
-            tuplet_field_write(&field, &grid->frag->tuplet_size, true);
-            size_t total_size = (grid->frag->tuplet_size * grid->frag->ncapacity);
+            tuplet_field_write(&field, &grid_frag->format, true);
+            tuplet_field_write(&field, &grid_frag->impl_type, true);
+            tuplet_field_write(&field, &grid_frag->ntuplets, true);
+            tuplet_field_write(&field, &grid_frag->ncapacity, true);
+            tuplet_field_write(&field, &grid_frag->tuplet_size, true);
+            size_t total_size = (grid_frag->tuplet_size * grid_frag->ncapacity);
             tuplet_field_write(&field, &total_size, true);
+            grid_unpin(grid, pin);
         }
     } while (tuplet_next(&tuplet));
 
@@ -316,27 +930,35 @@ void table_print(FILE *file, const table_t *table, size_t row_offset, size_t lim
 {
     GS_REQUIRE_NONNULL(table);
 
-    tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(table->num_tuples * sizeof(tuple_id_t));
-    attr_id_t *attr_ids = GS_REQUIRE_MALLOC(table_num_of_attributes(table) * sizeof(attr_id_t));
-
-    for (size_t i = 0; i < table->num_tuples; tuple_ids[i] = i, i++);
-    for (size_t i = 0; i < table_num_of_attributes(table); attr_ids[i] = i, i++);
-
-    table_t *molten_table = table_melt(FIT_HOST_NSM_VM, table, tuple_ids, table->num_tuples, attr_ids,
-                                       table_num_of_attributes(table));
-
-    frag_print(file, grid_by_id(molten_table, 0)->frag, row_offset, limit);
-
-    free(attr_ids);
-    free(tuple_ids);
-    table_delete(molten_table);
-    free(molten_table);
+    // Only the rows inside the window are molten, hence the cost of printing depends on the limit only
+    table_window_t window;
+    table_window_open(&window, table, NULL, 0, row_offset, limit);
+    vec_t *tuple_ids = vec_new(sizeof(tuple_id_t), min(limit, table->num_tuples) + 1);
+    for (tuple_id_t tuple_id; table_window_next(&window, &tuple_id); vec_pushback(tuple_ids, 1, &tuple_id));
+    table_window_close(&window);
+
+    size_t num_attr = table_num_of_attributes(table);
+    if (vec_length(tuple_ids) > 0) {
+        attr_id_t *attr_ids = GS_REQUIRE_MALLOC(num_attr * sizeof(attr_id_t));
+        for (size_t i = 0; i < num_attr; attr_ids[i] = i, i++);
+        table_t *molten_table = table_melt(FIT_HOST_NSM_VM, table, vec_begin(tuple_ids), vec_length(tuple_ids),
+                                           attr_ids, num_attr);
+        frag_print(file, grid_by_id(molten_table, 0)->frag, 0, vec_length(tuple_ids));
+        free(attr_ids);
+        table_delete(molten_table);
+        free(molten_table);
+    } else {
+        frag_t *empty = frag_new(table->schema, 1, FIT_HOST_NSM_VM);
+        frag_print(file, empty, 0, 0);
+        frag_delete(empty);
+    }
+    vec_free(tuple_ids);
 }
 
 void table_structure_print(FILE *file, const table_t *table, size_t row_offset, size_t limit)
 {
     tuple_t read_tuple;
-    tuple_field_t read_field;
+    tuple_field_t read_field = { 0 };
     schema_t *write_schema;
     tuplet_t write_tuplet;
     frag_t *write_frag;
@@ -367,6 +989,7 @@ void table_structure_print(FILE *file, const table_t *table, size_t row_offset,
             const char *t_attr_name = table_attr_name_by_id(table, read_field.table_attr_id);
             for (grid_id_t grid_id = 0; grid_id < table_num_of_grids(table); grid_id++) {
                 const grid_t *grid = grid_by_id(table, grid_id);
+                u64 pin = grid_pin(grid);
                 for (attr_id_t grid_attr_id = 0; grid_attr_id < grid_num_of_attributes(grid); grid_attr_id++) {
                     const char *g_attr_name = schema_attr_by_id(frag_schema(grid->frag), grid_attr_id)->name;
                     if (strcmp(t_attr_name, g_attr_name) == 0) {
@@ -379,9 +1002,11 @@ void table_structure_print(FILE *file, const table_t *table, size_t row_offset,
                         }
                     }
                 }
+                grid_unpin(grid, pin);
             }
             tuple_field_next(&read_field);
         }
+        tuple_field_close(&read_field);
     } while (tuplet_next(&write_tuplet));
 
     frag_print(file, write_frag, row_offset, limit);
@@ -399,12 +1024,34 @@ void table_structure_print(FILE *file, const table_t *table, size_t row_offset,
 
  void create_grid_ptr_store(table_t *table)
 {
-    table->grid_ptrs = vec_new(sizeof(grid_t *), 10);
+    atomic_init(&table->grid_ptrs, grid_list_new(10));
 }
 
  void create_tuple_id_store(table_t *table)
 {
-    freelist_create(&table->tuple_id_freelist, sizeof(tuple_id_t), 100, tuple_id_init, tuple_id_inc);
+    id_allocator_create(&table->tuple_id_allocator);
+}
+
+ void create_grid_directory(table_t *table)
+{
+    size_t nattrs = table->schema->attr->num_elements;
+    table->grids_by_attr = vec_new(sizeof(grids_by_attr_index_elem_t), max(nattrs, 1));
+    for (attr_id_t attr_id = 0; attr_id < nattrs; attr_id++) {
+        grids_by_attr_index_elem_t elem = { .attr_id = attr_id };
+        atomic_init(&elem.grid_ptrs, grid_list_new(4));
+        vec_pushback(table->grids_by_attr, 1, &elem);
+    }
+    atomic_init(&table->grid_set_version, 0);
+}
+
+ void grid_directory_insert(table_t *table, grid_t *grid)
+{
+    for (attr_id_t attr_id = 0; attr_id < vec_length(table->grids_by_attr); attr_id++) {
+        if (table_attr_id_to_frag_attr_id(grid, attr_id) != NULL) {
+            grids_by_attr_index_elem_t *elem = vec_at(table->grids_by_attr, attr_id);
+            grid_list_append(&elem->grid_ptrs, grid);
+        }
+    }
 }
 
  grid_t *create_grid(table_t *table, const attr_id_t *attr, size_t nattr,
@@ -419,19 +1066,29 @@ void table_structure_print(FILE *file, const table_t *table, size_t row_offset,
     apr_pool_create(&result->pool, NULL);
 
     *result = (grid_t) {
+        .pool = result->pool,
         .context = table,
         .frag = frag_new(grid_schema, tuplet_capacity, type),
         .schema_map_indicies = apr_hash_make(result->pool),
         .tuple_ids = vec_new(sizeof(tuple_id_interval_t), ntuple_ids),
-        .last_interval_cache = NULL
-            // TODO: add mutex init here
+        .tuplet_offsets = NULL,
+        .retired = vec_new(sizeof(grid_retired_t), 2)
     };
+    atomic_init(&result->latch.version, 0);
+    atomic_init(&result->latch.nshared, 0);
+    atomic_init(&result->readers.epoch, 0);
+    atomic_init(&result->readers.count, 0);
+    pthread_mutex_init(&result->retired_latch, NULL);
+    pthread_mutex_init(&result->relayout_latch, NULL);
+    grid_monitor_create(&result->monitor, tuplet_capacity);
+    grid_stats_create(&result->stats, grid_schema);
 
     for (size_t i = 0; i < ntuple_ids; i++) {
         frag_insert(NULL, result->frag, INTERVAL_SPAN((tuple_ids + i)));
     }
 
-    vec_pushback(result->tuple_ids, ntuple_ids, tuple_ids);
+    interval_list_coalesce(result->tuple_ids, tuple_ids, ntuple_ids);
+    grid_intervals_changed(result);
 
     for (size_t i = 0; i < nattr; i++) {
         attr_id_t *key = apr_pmemdup(result->pool, (attr + i), sizeof(attr_id_t));
@@ -467,6 +1124,662 @@ void table_structure_print(FILE *file, const table_t *table, size_t row_offset,
 
  void register_grid(table_t *table, grid_t *grid)
 {
-    vec_pushback(table->grid_ptrs, 1, &grid);
-    grid->grid_id = vec_length(table->grid_ptrs) - 1;
-}
\ No newline at end of file
+    // The grid is complete before it is published in the grid list and the grid directory
+    grid->grid_id = table_num_of_grids(table);
+    grid_list_append(&table->grid_ptrs, grid);
+    grid_directory_insert(table, grid);
+    atomic_fetch_add(&table->grid_set_version, 1);
+}
+
+ grid_list_t *grid_list_new(size_t capacity)
+{
+    grid_list_t *list = GS_REQUIRE_MALLOC(sizeof(grid_list_t) + capacity * sizeof(grid_t *));
+    list->capacity = capacity;
+    list->retired = NULL;
+    atomic_init(&list->length, 0);
+    return list;
+}
+
+ void grid_list_append(_Atomic(grid_list_t *) *list, grid_t *grid)
+{
+    grid_list_t *current = atomic_load_explicit(list, memory_order_relaxed);
+    size_t length = atomic_load_explicit(&current->length, memory_order_relaxed);
+    if (length == current->capacity) {
+        // Readers might still hold the full list, hence it is retired rather than freed
+        grid_list_t *grown = grid_list_new(2 * current->capacity);
+        memcpy(grown->grids, current->grids, length * sizeof(grid_t *));
+        atomic_init(&grown->length, length);
+        grown->retired = current;
+        atomic_store_explicit(list, grown, memory_order_release);
+        current = grown;
+    }
+    current->grids[length] = grid;
+    atomic_store_explicit(&current->length, length + 1, memory_order_release);
+}
+
+ void grid_list_free(grid_list_t *list)
+{
+    while (list != NULL) {
+        grid_list_t *retired = list->retired;
+        free(list);
+        list = retired;
+    }
+}
+
+ void grid_retire(grid_t *grid, bool is_frag, void *storage)
+{
+    grid_retired_t retired = { .is_frag = is_frag, .storage = storage };
+    pthread_mutex_lock(&grid->retired_latch);
+    vec_pushback(grid->retired, 1, &retired);
+    pthread_mutex_unlock(&grid->retired_latch);
+}
+
+ void retired_free(const grid_retired_t *retired)
+{
+    if (retired->is_frag) {
+        frag_delete(retired->storage);
+    } else {
+        vec_free(retired->storage);
+    }
+}
+
+ bool grid_step_read(table_plan_step_t *step, const grid_t *grid, attr_id_t table_attr_id, tuple_id_t tuple_id)
+{
+    const vec_t *tuple_ids = grid->tuple_ids, *tuplet_offsets = grid->tuplet_offsets;
+    size_t idx = grid_interval_find(grid, tuple_id, NULL);
+    // Out of bounds only if the interval directory is replaced concurrently, which fails the reader's validation
+    if (idx == SIZE_MAX || idx >= vec_length(tuple_ids) || idx >= vec_length(tuplet_offsets)) {
+        return false;
+    }
+    step->grid = grid;
+    step->grid_attr_id = *table_attr_id_to_frag_attr_id(grid, table_attr_id);
+    step->tuples = *(const tuple_id_interval_t *) vec_at(tuple_ids, idx);
+    step->tuplet_base = *(const tuplet_id_t *) vec_at(tuplet_offsets, idx);
+    return true;
+}
+
+ bool grid_tuplet_by_tuple(tuplet_id_t *out, const grid_t *grid, tuple_id_t tuple_id)
+{
+    size_t span;
+    return grid_run_by_tuple(out, &span, grid, tuple_id, NULL);
+}
+
+ bool grid_run_by_tuple(tuplet_id_t *out, size_t *span, const grid_t *grid, tuple_id_t tuple_id,
+                        grid_translation_cache_t *cache)
+{
+    const vec_t *tuple_ids = grid->tuple_ids, *tuplet_offsets = grid->tuplet_offsets;
+    size_t idx = grid_interval_find(grid, tuple_id, cache);
+    if (idx == SIZE_MAX || idx >= vec_length(tuple_ids) || idx >= vec_length(tuplet_offsets)) {
+        return false;
+    }
+    /* the tuples [tuple_id, end) of the interval are mapped to consecutive tuplets */
+    const tuple_id_interval_t *interval = vec_at(tuple_ids, idx);
+    *out = *(const tuplet_id_t *) vec_at(tuplet_offsets, idx) + (tuple_id - interval->begin);
+    *span = interval->end - tuple_id;
+    return true;
+}
+
+ void table_write_columns(table_t *table, const tuple_id_t *tuple_ids, size_t ntuple_ids,
+                          const table_column_t *columns, size_t ncolumns)
+{
+    const attr_id_t **frag_attr_ids = GS_REQUIRE_MALLOC(ncolumns * sizeof(attr_id_t *));
+    size_t *strides = GS_REQUIRE_MALLOC(ncolumns * sizeof(size_t));
+    size_t *nwritten = GS_REQUIRE_MALLOC(ncolumns * sizeof(size_t));
+    attr_id_t *attr_ids = GS_REQUIRE_MALLOC(max(ncolumns, 1) * sizeof(attr_id_t));
+
+    for (size_t c = 0; c < ncolumns; c++) {
+        REQUIRE((columns[c].nvalues == ntuple_ids), "Column batch length does not match the number of tuples");
+        attr_ids[c] = columns[c].attr_id;
+        if (ntuple_ids > 0) {
+            GS_REQUIRE_NONNULL(columns[c].values);
+        }
+        const attr_t *attr = table_attr_by_id(table, columns[c].attr_id);
+        GS_REQUIRE_NONNULL(attr);
+        strides[c] = (attr_isstring(attr) ? sizeof(const char *) : attr_total_size(attr));
+        nwritten[c] = 0;
+    }
+
+    grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    size_t num_grids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    for (grid_id_t grid_id = 0; grid_id < num_grids; grid_id++) {
+        grid_t *grid = grids->grids[grid_id];
+
+        /* resolve the attribute mapping once per grid rather than once per field */
+        size_t ncovered = 0;
+        for (size_t c = 0; c < ncolumns; c++) {
+            frag_attr_ids[c] = table_attr_id_to_frag_attr_id(grid, columns[c].attr_id);
+            ncovered += (frag_attr_ids[c] != NULL);
+        }
+        if (ncovered == 0) {
+            continue;
+        }
+
+        /* writers of different grids do not block each other */
+        grid_write_lock(grid);
+        grid_translation_cache_t cache = { .grid = NULL };
+        for (size_t i = 0; i < ntuple_ids; ) {
+            tuplet_id_t tuplet_id;
+            size_t span;
+            if (!grid_run_by_tuple(&tuplet_id, &span, grid, tuple_ids[i], &cache)) {
+                i++;
+                continue;
+            }
+            /* consecutive tuples in the same interval are stored in consecutive tuplets */
+            size_t run = 1;
+            while (run < span && i + run < ntuple_ids && tuple_ids[i + run] == tuple_ids[i] + run) {
+                run++;
+            }
+            for (size_t c = 0; c < ncolumns; c++) {
+                if (frag_attr_ids[c] != NULL) {
+                    const void *values = columns[c].values + i * strides[c];
+                    frag_write_column(grid->frag, *frag_attr_ids[c], tuplet_id, run, values);
+                    grid_stats_add(&grid->stats, *frag_attr_ids[c], values, run);
+                    nwritten[c] += run;
+                }
+            }
+            grid_monitor_record(&grid->monitor, GRID_ACCESS_COLUMN, tuplet_id, run, ncovered);
+            i += run;
+        }
+        grid_write_unlock(grid);
+    }
+    if (ncolumns > 0) {
+        table_monitor_record(&table->monitor, attr_ids, ncolumns, ntuple_ids);
+    }
+
+    for (size_t c = 0; c < ncolumns; c++) {
+        panic_if((nwritten[c] != ntuple_ids), "Internal error: %zu of %zu fields of attribute '%s' are covered by "
+                 "grids in table '%s'", nwritten[c], ntuple_ids, table_attr_name_by_id(table, columns[c].attr_id),
+                 table_name(table));
+    }
+
+    free (frag_attr_ids);
+    free (strides);
+    free (nwritten);
+    free (attr_ids);
+}
+
+ void interval_list_append(vec_t *intervals, tuple_id_t tuple_id)
+{
+    tuple_id_interval_t *last = (vec_length(intervals) > 0 ? vec_peek(intervals) : NULL);
+    if (last != NULL && last->end == tuple_id) {
+        last->end++;
+    } else {
+        tuple_id_interval_t interval = { .begin = tuple_id, .end = tuple_id + 1 };
+        vec_pushback(intervals, 1, &interval);
+    }
+}
+
+ void interval_list_coalesce(vec_t *intervals, const tuple_id_interval_t *tuple_ids, size_t ntuple_ids)
+{
+    // Adjacent intervals are mapped to consecutive tuplets, hence merging these keeps the mapping of all tuples
+    for (size_t i = 0; i < ntuple_ids; i++) {
+        tuple_id_interval_t *last = (vec_length(intervals) > 0 ? vec_peek(intervals) : NULL);
+        if (last != NULL && last->end == tuple_ids[i].begin) {
+            last->end = tuple_ids[i].end;
+        } else vec_pushback(intervals, 1, tuple_ids + i);
+    }
+}
+
+ int comp_tuple_id(const void *lhs, const void *rhs)
+{
+    tuple_id_t a = *(const tuple_id_t *) lhs;
+    tuple_id_t b = *(const tuple_id_t *) rhs;
+    return (a > b) - (a < b);
+}
+
+ int comp_grid_ptr(const void *lhs, const void *rhs)
+{
+    uintptr_t a = (uintptr_t) *(grid_t * const *) lhs;
+    uintptr_t b = (uintptr_t) *(grid_t * const *) rhs;
+    return (a > b) - (a < b);
+}
+
+ table_t *melt_table(enum frag_impl_type_t type, const table_t *src_table, const tuple_id_t *tuple_ids,
+                     size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids)
+{
+    tuple_cursor_t dst_cursor;
+
+    // The molten table contains the selected attributes in the given order, covered by a single grid
+    schema_t *dst_schema = schema_subset(src_table->schema, attr_ids, nattr_ids);
+    table_t *dst_table = table_new(dst_schema, 1);
+    attr_id_t *dst_attr_ids = GS_REQUIRE_MALLOC(nattr_ids * sizeof(attr_id_t));
+    for (size_t i = 0; i < nattr_ids; dst_attr_ids[i] = i, i++);
+    tuple_id_interval_t cover = { .begin = 0, .end = ntuple_ids };
+    table_add(dst_table, dst_attr_ids, nattr_ids, &cover, 1, type);
+    grid_insert(&dst_cursor, dst_table, ntuple_ids);
+    tuple_cursor_dispose(&dst_cursor);
+
+    // Translate each source grid that contributes to the molten attributes once into runs of tuplets
+    bool sorted = true;
+    for (size_t i = 1; i < ntuple_ids && sorted; sorted = (tuple_ids[i - 1] <= tuple_ids[i]), i++);
+    size_t num_grids = table_num_of_grids(src_table);
+    vec_t **runs = GS_REQUIRE_MALLOC(max(num_grids, 1) * sizeof(vec_t *));
+    const vec_t **intervals = GS_REQUIRE_MALLOC(max(num_grids, 1) * sizeof(vec_t *));
+    u64 *pins = GS_REQUIRE_MALLOC(max(num_grids, 1) * sizeof(u64));
+    tuplet_id_t *tuplets = GS_REQUIRE_MALLOC(max(ntuple_ids, 1) * sizeof(tuplet_id_t));
+    memset(runs, 0, num_grids * sizeof(vec_t *));
+    for (size_t x = 0; x < nattr_ids; x++) {
+        const grids_by_attr_index_elem_t *elem = vec_at(src_table->grids_by_attr, attr_ids[x]);
+        const grid_list_t *grids = atomic_load_explicit(&elem->grid_ptrs, memory_order_acquire);
+        size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+        for (size_t i = 0; i < ngrids; i++) {
+            const grid_t *grid = grids->grids[i];
+            if (grid->grid_id < num_grids && runs[grid->grid_id] == NULL) {
+                // The runs are valid as long as the grid keeps the interval directory from which they are translated.
+                // The directory is read under the latch, since an optimistic read would be repeated after each write.
+                // The pin keeps a replaced directory until melting ends, such that its address is not reused.
+                pins[grid->grid_id] = grid_pin(grid);
+                grid_share_lock(grid);
+                intervals[grid->grid_id] = grid->tuple_ids;
+                runs[grid->grid_id] = melt_runs(grid, tuple_ids, ntuple_ids, sorted, tuplets);
+                grid_share_unlock(grid);
+            }
+        }
+    }
+    free(tuplets);
+
+    // Attributes are independent in the molten fragment except for variable-length strings, which share its heap
+    melt_args_t args = {
+        .src_table = src_table,
+        .dst_frag = grid_by_id(dst_table, 0)->frag,
+        .attr_ids = attr_ids,
+        .nattr_ids = nattr_ids,
+        .runs = runs,
+        .intervals = intervals,
+        .order = GS_REQUIRE_MALLOC(max(nattr_ids, 1) * sizeof(size_t)),
+        .nsingle = 0,
+        .num_grids = num_grids
+    };
+    size_t nvarlen = 0;
+    for (size_t x = 0; x < nattr_ids; x++) {
+        if (table_attr_by_id(src_table, attr_ids[x])->flags.varlen) {
+            args.order[nattr_ids - ++nvarlen] = x;
+        } else {
+            args.order[args.nsingle++] = x;
+        }
+    }
+    args.ntasks = args.nsingle + (nvarlen > 0);
+    atomic_init(&args.next_task, 0);
+    atomic_init(&args.stale, false);
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t num_workers = min(min(args.ntasks, GRID_MELT_MAX_WORKERS), (size_t) max(num_cpus, 1));
+    if (ntuple_ids < GRID_MELT_MIN_PARALLEL || num_workers < 2) {
+        melt_work(&args);
+    } else {
+        // The calling thread is one of the workers
+        future_t *workers = GS_REQUIRE_MALLOC((num_workers - 1) * sizeof(future_t));
+        for (size_t i = 0; i < num_workers - 1; i++) {
+            workers[i] = future_new(&args, melt_promise, future_eager);
+        }
+        melt_work(&args);
+        for (size_t i = 0; i < num_workers - 1; i++) {
+            future_resolve(NULL, workers[i]);
+        }
+        free(workers);
+    }
+
+    free(intervals);
+    free(args.order);
+    free(dst_attr_ids);
+    schema_delete(dst_schema);
+
+    if (atomic_load(&args.stale)) {
+        table_delete(dst_table);
+        free(dst_table);
+        dst_table = NULL;
+    } else {
+        melt_monitor(src_table, ntuple_ids, attr_ids, nattr_ids, runs, num_grids);
+    }
+    for (size_t i = 0; i < num_grids; i++) {
+        if (runs[i] != NULL) {
+            grid_unpin(grid_by_id(src_table, i), pins[i]);
+            vec_free(runs[i]);
+        }
+    }
+    free(pins);
+    free(runs);
+    return dst_table;
+}
+
+
+ vec_t *melt_runs(const grid_t *grid, const tuple_id_t *tuple_ids, size_t ntuple_ids, bool sorted,
+                  tuplet_id_t *tuplets)
+{
+    if (sorted) {
+        grid_tuples_to_tuplets(tuplets, grid, tuple_ids, ntuple_ids);
+    } else {
+        grid_translation_cache_t cache = { .grid = NULL };
+        for (size_t i = 0; i < ntuple_ids; i++) {
+            size_t span;
+            if (!grid_run_by_tuple(tuplets + i, &span, grid, tuple_ids[i], &cache)) {
+                tuplets[i] = GRID_TUPLET_NONE;
+            }
+        }
+    }
+
+    vec_t *runs = vec_new(sizeof(melt_run_t), 16);
+    melt_run_t *last = NULL;
+    for (size_t i = 0; i < ntuple_ids; i++) {
+        if (tuplets[i] == GRID_TUPLET_NONE) {
+            continue;
+        }
+        if (last != NULL && last->dst_begin + last->length == i && last->src_begin + last->length == tuplets[i]) {
+            last->length++;
+        } else {
+            melt_run_t run = { .src_begin = tuplets[i], .dst_begin = i, .length = 1 };
+            vec_pushback(runs, 1, &run);
+            last = vec_at(runs, vec_length(runs) - 1);
+        }
+    }
+    return runs;
+}
+
+ void melt_work(melt_args_t *args)
+{
+    size_t task;
+    while ((task = atomic_fetch_add(&args->next_task, 1)) < args->ntasks) {
+        size_t end = (task < args->nsingle ? task + 1 : args->nattr_ids);
+        for (size_t i = task; i < end; i++) {
+            melt_column(args, args->order[i]);
+        }
+    }
+}
+
+ void *melt_promise(promise_result *return_value, const void *capture)
+{
+    melt_work((melt_args_t *) capture);
+    *return_value = resolved;
+    return NULL;
+}
+
+ void melt_column(melt_args_t *args, size_t dst_attr_id)
+{
+    attr_id_t table_attr_id = args->attr_ids[dst_attr_id];
+    const grids_by_attr_index_elem_t *elem = vec_at(args->src_table->grids_by_attr, table_attr_id);
+    size_t buffer_size = FRAG_VIEW_BATCH_SIZE * max(attr_total_size(table_attr_by_id(args->src_table, table_attr_id)),
+                                                   sizeof(const char *));
+    void *buffer = GS_REQUIRE_MALLOC(buffer_size);
+
+    const grid_list_t *grids = atomic_load_explicit(&elem->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    for (size_t i = 0; i < ngrids && !atomic_load(&args->stale); i++) {
+        const grid_t *grid = grids->grids[i];
+        if (grid->grid_id >= args->num_grids) {
+            // Grids added after the translation do not cover any of the molten tuples
+            continue;
+        }
+        attr_id_t src_attr_id = *table_attr_id_to_frag_attr_id(grid, table_attr_id);
+        const vec_t *runs = args->runs[grid->grid_id];
+        size_t nruns = vec_length(runs);
+        // Optimistic reads cannot copy the grid, since writers free replaced buffers in place. Instead, the runs are
+        // copied under the latch, which also excludes conversions that replace the fragment.
+        for (size_t r = 0; r < nruns && !atomic_load(&args->stale);) {
+            grid_share_lock(grid);
+            bool valid = (grid->tuple_ids == args->intervals[grid->grid_id]);
+            for (size_t ncopied = 0; valid && r < nruns && ncopied < GRID_MELT_LATCH_SIZE; r++) {
+                const melt_run_t *run = vec_at(runs, r);
+                valid = melt_run(args->dst_frag, dst_attr_id, grid->frag, src_attr_id, run, buffer);
+                ncopied += run->length;
+            }
+            grid_share_unlock(grid);
+            if (!valid) {
+                // The grid was compacted after its runs were translated
+                atomic_store(&args->stale, true);
+            }
+        }
+    }
+    free(buffer);
+}
+
+ bool melt_run(frag_t *dst, attr_id_t dst_attr_id, frag_t *src, attr_id_t src_attr_id, const melt_run_t *run,
+               void *buffer)
+{
+    if (run->src_begin + run->length > src->ntuplets) {
+        return false;
+    }
+
+    const attr_t *attr = frag_field_layout(src, src_attr_id)->attr;
+    size_t attr_size = frag_field_layout(src, src_attr_id)->size;
+    // Dictionary codes and string headers refer to structures of the source fragment, hence decode these fields
+    bool decode = (attr->flags.dict || attr->flags.varlen);
+    tuplet_id_t dst_tuplet_id = run->dst_begin;
+    frag_column_cursor_t cursor;
+    frag_column_view_t view;
+
+    frag_column_open(&cursor, src, src_attr_id, run->src_begin, run->src_begin + run->length, FRAG_VIEW_BATCH_SIZE);
+    while (frag_column_next(&view, &cursor)) {
+        const void *values = view.base;
+        if (attr_isstring(attr)) {
+            const char **strings = buffer;
+            for (size_t i = 0; i < view.count; i++) {
+                if (view.validity != NULL && !bitmap_test(view.validity, view.begin + i)) {
+                    strings[i] = "";
+                } else if (decode) {
+                    tuplet_t tuplet;
+                    tuplet_field_t field;
+                    tuplet_open(&tuplet, src, view.begin + i);
+                    tuplet_field_seek(&field, &tuplet, src_attr_id);
+                    strings[i] = tuplet_field_read(&field);
+                } else {
+                    strings[i] = frag_column_view_at(&view, i);
+                }
+            }
+            values = strings;
+        } else if (view.stride != attr_size) {
+            // Gather the strided values (e.g., of a NSM fragment) into a dense column run
+            for (size_t i = 0; i < view.count; i++) {
+                memcpy(buffer + i * attr_size, frag_column_view_at(&view, i), attr_size);
+            }
+            values = buffer;
+        }
+        frag_write_column(dst, dst_attr_id, dst_tuplet_id, view.count, values);
+
+        if (view.validity != NULL) {
+            for (size_t i = 0; i < view.count; i++) {
+                if (!bitmap_test(view.validity, view.begin + i)) {
+                    frag_set_null(dst, dst_tuplet_id + i, dst_attr_id);
+                }
+            }
+        }
+        dst_tuplet_id += view.count;
+    }
+    frag_column_close(&cursor);
+    return true;
+}
+
+ void melt_monitor(const table_t *src_table, size_t ntuple_ids, const attr_id_t *attr_ids, size_t nattr_ids,
+                   vec_t **runs, size_t num_grids)
+{
+    // Melting reads the molten attributes of each source grid column-wise along its runs
+    for (grid_id_t grid_id = 0; grid_id < num_grids; grid_id++) {
+        if (runs[grid_id] == NULL) {
+            continue;
+        }
+        grid_t *grid = (grid_t *) grid_by_id(src_table, grid_id);
+        size_t nattrs = 0;
+        for (size_t i = 0; i < nattr_ids; i++) {
+            nattrs += (table_attr_id_to_frag_attr_id(grid, attr_ids[i]) != NULL);
+        }
+        for (size_t r = 0; r < vec_length(runs[grid_id]); r++) {
+            const melt_run_t *run = vec_at(runs[grid_id], r);
+            grid_monitor_record(&grid->monitor, GRID_ACCESS_COLUMN, run->src_begin, run->length, nattrs);
+        }
+    }
+    table_monitor_record((table_monitor_t *) &src_table->monitor, attr_ids, nattr_ids, ntuple_ids);
+}
+
+ void table_plan_step_flush(table_plan_step_t *step)
+{
+    if (step->grid != NULL && step->naccesses > 0) {
+        grid_monitor_count((grid_monitor_t *) &step->grid->monitor, GRID_ACCESS_ROW, step->naccesses);
+    }
+    step->naccesses = 0;
+}
+
+ frag_t *frag_copy(frag_t *src, enum frag_impl_type_t type, const grid_t *grid, u64 version)
+{
+    frag_t *dst = frag_new(frag_schema(src), src->ncapacity, type);
+    size_t ntuplets = src->ntuplets;
+    if (ntuplets > 0) {
+        frag_insert(NULL, dst, ntuplets);
+    }
+
+    size_t buffer_size = 0;
+    for (attr_id_t attr_id = 0; attr_id < frag_num_of_attributes(src); attr_id++) {
+        buffer_size = max(buffer_size, max(frag_field_layout(src, attr_id)->size, sizeof(const char *)));
+    }
+    void *buffer = GS_REQUIRE_MALLOC(FRAG_VIEW_BATCH_SIZE * buffer_size);
+    bool complete = frag_transpose(dst, src, buffer, grid, version);
+    free(buffer);
+    if (!complete) {
+        frag_delete(dst);
+        return NULL;
+    }
+
+    for (tuplet_id_t tuplet_id = 0; src->ndeleted > 0 && tuplet_id < ntuplets; tuplet_id++) {
+        if (frag_is_deleted(src, tuplet_id)) {
+            frag_tuplet_delete(dst, tuplet_id);
+        }
+    }
+    if (src->packed != NULL) {
+        for (attr_id_t attr_id = 0; attr_id < frag_num_of_attributes(src); attr_id++) {
+            if (src->packed[attr_id] != NULL) {
+                frag_compress(dst);
+                break;
+            }
+        }
+    }
+    return dst;
+}
+
+ bool frag_transpose(frag_t *dst, frag_t *src, void *buffer, const grid_t *grid, u64 version)
+{
+    // Copying a whole column at a time reads each tuplet of a NSM source (resp. writes each tuplet of a NSM
+    // destination) once per attribute. Instead, each block of tuplets is copied attribute by attribute while both
+    // the source and the destination block are cached.
+    size_t ntuplets = src->ntuplets;
+    size_t block_size = min(max(GRID_RELAYOUT_BLOCK_SIZE / max(src->tuplet_size, 1), 1), FRAG_VIEW_BATCH_SIZE);
+    size_t nattrs = frag_num_of_attributes(src);
+    for (tuplet_id_t begin = 0; begin < ntuplets; begin += block_size) {
+        melt_run_t run = { .src_begin = begin, .dst_begin = begin, .length = min(block_size, ntuplets - begin) };
+        for (attr_id_t attr_id = 0; attr_id < nattrs; attr_id++) {
+            if (src->packed == NULL || src->packed[attr_id] == NULL) {
+                melt_run(dst, attr_id, src, attr_id, &run, buffer);
+            }
+        }
+        if (!relayout_yield(grid, version)) {
+            return false;
+        }
+    }
+
+    // Compressed columns are decoded block by block, hence these are copied in runs of whole compressed blocks
+    for (attr_id_t attr_id = 0; ntuplets > 0 && src->packed != NULL && attr_id < nattrs; attr_id++) {
+        for (tuplet_id_t begin = 0; src->packed[attr_id] != NULL && begin < ntuplets; begin += INTPACK_BLOCK_SIZE) {
+            melt_run_t run = { .src_begin = begin, .dst_begin = begin,
+                               .length = min(INTPACK_BLOCK_SIZE, ntuplets - begin) };
+            melt_run(dst, attr_id, src, attr_id, &run, buffer);
+            if (!relayout_yield(grid, version)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ bool relayout_yield(const grid_t *grid, u64 version)
+{
+    // Writers may acquire the latch between two blocks of a copy that holds it in shared mode, which makes the copy
+    // outdated. Without a grid, the caller holds the latch exclusively.
+    if (grid == NULL) {
+        return true;
+    }
+    grid_share_unlock(grid);
+    grid_share_lock(grid);
+    return (atomic_load(&grid->latch.version) == version);
+}
+
+ bool window_is_live(table_window_t *window, tuple_id_t tuple_id)
+{
+    // Deleted tuples are marked in each grid that covers them, hence any of the windowed attributes tells. Compaction
+    // removes deleted tuples from their grids, which then do not cover them anymore.
+    const table_plan_step_t *step = plan_seek(window->plan, 0, tuple_id);
+    if (step == NULL) {
+        return false;
+    }
+    grid_share_lock(step->grid);
+    bool live = !frag_is_deleted(step->grid->frag, table_plan_step_tuplet(step, tuple_id));
+    grid_share_unlock(step->grid);
+    return live;
+}
+
+ size_t window_num_covered(const table_t *table, attr_id_t table_attr_id, tuple_id_t end)
+{
+    // The grids that cover an attribute partition its tuples, hence their intervals are disjoint
+    const grids_by_attr_index_elem_t *elem = vec_at(table->grids_by_attr, table_attr_id);
+    const grid_list_t *grids = atomic_load_explicit(&elem->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire), num_covered = 0;
+    for (size_t i = 0; i < ngrids; i++) {
+        const grid_t *grid = grids->grids[i];
+        size_t grid_num_covered;
+        u64 version, pin = grid_pin(grid);
+        do {
+            version = grid_read_begin(grid);
+            grid_num_covered = 0;
+            const tuple_id_interval_t *intervals = vec_begin(grid->tuple_ids);
+            for (size_t j = 0; j < vec_length(grid->tuple_ids); j++) {
+                if (intervals[j].begin < end) {
+                    grid_num_covered += min(intervals[j].end, end) - intervals[j].begin;
+                }
+            }
+        } while (!grid_read_validate(grid, version));
+        grid_unpin(grid, pin);
+        num_covered += grid_num_covered;
+    }
+    return num_covered;
+}
+
+ table_plan_step_t *plan_seek(table_plan_t *plan, size_t attr_idx, tuple_id_t tuple_id)
+{
+    table_plan_step_t *step = plan->steps + attr_idx;
+    if (!table_plan_step_covers(step, plan->table, tuple_id)) {
+        // The plan keeps the grid of each step pinned, such that fields read via the plan stay valid until it moves on
+        const grid_t *pinned = step->grid;
+        u64 pin = step->pin;
+        bool covered = table_plan_step_resolve(step, plan->table, plan->attr_ids[attr_idx], tuple_id);
+        if (!covered || step->grid != pinned) {
+            if (pinned != NULL) {
+                grid_unpin(pinned, pin);
+            }
+            if (!covered) {
+                return NULL;
+            }
+            pin = grid_pin(step->grid);
+        }
+        step->pin = pin;
+    }
+    if (plan->ntuples == 0 || tuple_id != plan->last_tuple_id) {
+        plan->ntuples++;
+        plan->last_tuple_id = tuple_id;
+    }
+    table_plan_step_touch(step, tuple_id);
+    return step;
+}
+
+ void *compact_promise(promise_result *return_value, const void *capture)
+{
+    compact_args_t *args = (compact_args_t *) capture;
+    table_compact(args->table, args->min_dead_ratio);
+    free (args);
+    *return_value = resolved;
+    return NULL;
+}
+
+ void *convert_promise(promise_result *return_value, const void *capture)
+{
+    convert_args_t *args = (convert_args_t *) capture;
+    grid_relayout(args->grid, args->type);
+    free (args);
+    *return_value = resolved;
+    return NULL;
+}
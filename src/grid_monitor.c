@@ -0,0 +1,162 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid_monitor.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void counter_decay(atomic_uint_fast64_t *counter, unsigned shift);
+
+ size_t coaccess_idx(const table_monitor_t *monitor, attr_id_t lhs, attr_id_t rhs);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+void grid_monitor_create(grid_monitor_t *monitor, size_t ntuplets)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    for (size_t i = 0; i < GRID_ACCESS_KIND_MAX; i++) {
+        atomic_init(&monitor->fields[i], 0);
+    }
+    for (size_t i = 0; i < GRID_MONITOR_HEAT_BUCKETS; i++) {
+        atomic_init(&monitor->heat[i], 0);
+    }
+    monitor->heat_shift = 0;
+    while ((ntuplets >> monitor->heat_shift) > GRID_MONITOR_HEAT_BUCKETS) {
+        monitor->heat_shift++;
+    }
+}
+
+void grid_monitor_count(grid_monitor_t *monitor, enum grid_access_kind kind, u64 nfields)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    REQUIRE_LESSTHAN(kind, GRID_ACCESS_KIND_MAX);
+    atomic_fetch_add_explicit(&monitor->fields[kind], nfields, memory_order_relaxed);
+}
+
+void grid_monitor_heat(grid_monitor_t *monitor, size_t begin, size_t ntuplets, u64 weight)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    // Each range gets the accesses to the tuplets it contains; tuplets behind the last range count for the last one
+    size_t end = begin + ntuplets;
+    while (begin < end) {
+        size_t bucket = min(begin >> monitor->heat_shift, GRID_MONITOR_HEAT_BUCKETS - 1);
+        size_t bucket_end = (bucket == GRID_MONITOR_HEAT_BUCKETS - 1 ? end : (bucket + 1) << monitor->heat_shift);
+        size_t n = min(end, bucket_end) - begin;
+        atomic_fetch_add_explicit(&monitor->heat[bucket], n * weight, memory_order_relaxed);
+        begin += n;
+    }
+}
+
+void grid_monitor_record(grid_monitor_t *monitor, enum grid_access_kind kind, size_t begin, size_t ntuplets,
+                         size_t nattrs)
+{
+    grid_monitor_count(monitor, kind, (u64) ntuplets * nattrs);
+    grid_monitor_heat(monitor, begin, ntuplets, nattrs);
+}
+
+void grid_monitor_snapshot(grid_workload_t *out, const grid_monitor_t *monitor)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(monitor);
+    for (size_t i = 0; i < GRID_ACCESS_KIND_MAX; i++) {
+        out->fields[i] = atomic_load_explicit(&monitor->fields[i], memory_order_relaxed);
+    }
+    for (size_t i = 0; i < GRID_MONITOR_HEAT_BUCKETS; i++) {
+        out->heat[i] = atomic_load_explicit(&monitor->heat[i], memory_order_relaxed);
+    }
+}
+
+void grid_monitor_decay(grid_monitor_t *monitor, unsigned shift)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    for (size_t i = 0; i < GRID_ACCESS_KIND_MAX; i++) {
+        counter_decay(&monitor->fields[i], shift);
+    }
+    for (size_t i = 0; i < GRID_MONITOR_HEAT_BUCKETS; i++) {
+        counter_decay(&monitor->heat[i], shift);
+    }
+}
+
+void table_monitor_create(table_monitor_t *monitor, size_t nattrs)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    monitor->nattrs = nattrs;
+    monitor->coaccess = GS_REQUIRE_MALLOC(max(nattrs * nattrs, 1) * sizeof(atomic_uint_fast64_t));
+    for (size_t i = 0; i < nattrs * nattrs; i++) {
+        atomic_init(&monitor->coaccess[i], 0);
+    }
+}
+
+void table_monitor_dispose(table_monitor_t *monitor)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    free(monitor->coaccess);
+    monitor->coaccess = NULL;
+}
+
+void table_monitor_record(table_monitor_t *monitor, const attr_id_t *attr_ids, size_t nattr_ids, u64 ntuples)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    GS_REQUIRE_NONNULL(attr_ids);
+    if (ntuples == 0) {
+        return;
+    }
+    for (size_t i = 0; i < nattr_ids; i++) {
+        for (size_t j = i; j < nattr_ids; j++) {
+            if (j == i || attr_ids[i] != attr_ids[j]) {
+                size_t idx = coaccess_idx(monitor, attr_ids[i], attr_ids[j]);
+                atomic_fetch_add_explicit(&monitor->coaccess[idx], ntuples, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+u64 table_monitor_coaccess(const table_monitor_t *monitor, attr_id_t lhs, attr_id_t rhs)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    return atomic_load_explicit(&monitor->coaccess[coaccess_idx(monitor, lhs, rhs)], memory_order_relaxed);
+}
+
+void table_monitor_decay(table_monitor_t *monitor, unsigned shift)
+{
+    GS_REQUIRE_NONNULL(monitor);
+    for (size_t i = 0; i < monitor->nattrs * monitor->nattrs; i++) {
+        counter_decay(&monitor->coaccess[i], shift);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void counter_decay(atomic_uint_fast64_t *counter, unsigned shift)
+{
+    // Subtracting the aged part rather than storing the aged value keeps increments that race with the decay
+    u64 value = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_fetch_sub_explicit(counter, value - (value >> shift), memory_order_relaxed);
+}
+
+ size_t coaccess_idx(const table_monitor_t *monitor, attr_id_t lhs, attr_id_t rhs)
+{
+    REQUIRE_LESSTHAN(lhs, monitor->nattrs);
+    REQUIRE_LESSTHAN(rhs, monitor->nattrs);
+    return min(lhs, rhs) * monitor->nattrs + max(lhs, rhs);
+}
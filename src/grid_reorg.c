@@ -0,0 +1,548 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid_reorg.h>
+#include <tuplet_field.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* The attributes of a grid and the accesses to these in the current round */
+typedef struct reorg_grid_t {
+    grid_t *grid;
+    attr_id_t *attr_ids; /* the table attributes covered by the grid */
+    size_t nattr_ids;
+    grid_workload_t workload;
+    double coaccess; /* the average number of attributes of the grid that are accessed together in a tuple */
+} reorg_grid_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void reorg_grid_open(reorg_grid_t *out, const table_t *table, grid_t *grid, attr_id_t *attr_ids);
+
+ bool reorg_convert(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *info);
+
+ bool reorg_advise_split(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *info);
+
+ bool reorg_advise_merge(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *lhs,
+                         const reorg_grid_t *rhs);
+
+ void reorg_log(grid_reorg_t *reorg, const grid_reorg_entry_t *entry);
+
+ double layout_cost(enum frag_impl_type_t type, const grid_workload_t *workload, const frag_t *frag, double coaccess);
+
+ double probe_cost(frag_t *frag, const table_t *table, const reorg_grid_t *info);
+
+ bool grid_tuple_range(tuple_id_interval_t *out, const grid_t *grid);
+
+ u64 coaccess_sum(const table_t *table, const attr_id_t *lhs, size_t nlhs, const attr_id_t *rhs, size_t nrhs);
+
+ size_t find_root(size_t *parents, size_t idx);
+
+ double now_ns();
+
+ void *reorg_promise(promise_result *return_value, const void *capture);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+grid_reorg_t *grid_reorg_new(table_t *table, FILE *log_file)
+{
+    GS_REQUIRE_NONNULL(table);
+    grid_reorg_t *reorg = GS_REQUIRE_MALLOC(sizeof(grid_reorg_t));
+    *reorg = (grid_reorg_t) {
+        .table = table,
+        .log_file = log_file,
+        .log = vec_new(sizeof(grid_reorg_entry_t), 16),
+        .converted = vec_new(sizeof(size_t), 16),
+        .round = 0,
+        .running = false,
+        .interval_ms = 0,
+        .worker = NULL
+    };
+    pthread_mutex_init(&reorg->round_latch, NULL);
+    pthread_mutex_init(&reorg->latch, NULL);
+    pthread_cond_init(&reorg->wakeup, NULL);
+    return reorg;
+}
+
+void grid_reorg_delete(grid_reorg_t *reorg)
+{
+    GS_REQUIRE_NONNULL(reorg);
+    grid_reorg_stop(reorg);
+    vec_free(reorg->log);
+    vec_free(reorg->converted);
+    pthread_cond_destroy(&reorg->wakeup);
+    pthread_mutex_destroy(&reorg->latch);
+    pthread_mutex_destroy(&reorg->round_latch);
+    free(reorg);
+}
+
+size_t grid_reorg_run(grid_reorg_t *reorg)
+{
+    GS_REQUIRE_NONNULL(reorg);
+    pthread_mutex_lock(&reorg->round_latch);
+    table_t *table = reorg->table;
+
+    // Grids added during the round are considered in the next one
+    grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    size_t nattrs = table_num_of_attributes(table);
+    reorg_grid_t *infos = GS_REQUIRE_MALLOC(max(ngrids, 1) * sizeof(reorg_grid_t));
+    attr_id_t *attr_ids = GS_REQUIRE_MALLOC(max(ngrids * nattrs, 1) * sizeof(attr_id_t));
+    for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+        reorg_grid_open(infos + grid_id, table, grids->grids[grid_id], attr_ids + grid_id * nattrs);
+    }
+
+    pthread_mutex_lock(&reorg->latch);
+    grid_reorg_entry_t entry = { .round = reorg->round };
+    pthread_mutex_unlock(&reorg->latch);
+
+    // The counters of a grid need a few rounds after its conversion to reflect the accesses to the new layout
+    size_t nconverted = 0;
+    size_t *converted = reorg->converted->data;
+    for (size_t i = vec_length(reorg->converted); i < ngrids; i++) {
+        vec_pushback(reorg->converted, 1, &(size_t) { 0 });
+        converted = reorg->converted->data;
+    }
+    for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+        if (grid_workload_total(&infos[grid_id].workload) < GRID_REORG_MIN_ACCESSES) {
+            continue;
+        }
+        bool cooling = (converted[grid_id] > 0 && entry.round < converted[grid_id] + GRID_REORG_COOLDOWN);
+        if (!cooling && reorg_convert(&entry, table, infos + grid_id)) {
+            reorg_log(reorg, &entry);
+            converted[grid_id] = entry.round + 1;
+            nconverted++;
+        }
+        if (reorg_advise_split(&entry, table, infos + grid_id)) {
+            reorg_log(reorg, &entry);
+        }
+        for (grid_id_t other_id = grid_id + 1; other_id < ngrids; other_id++) {
+            if (grid_workload_total(&infos[other_id].workload) >= GRID_REORG_MIN_ACCESSES &&
+                reorg_advise_merge(&entry, table, infos + grid_id, infos + other_id)) {
+                reorg_log(reorg, &entry);
+            }
+        }
+    }
+
+    // Aging the counters lets the decisions of the next rounds follow changes of the workload
+    for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+        grid_monitor_decay(&infos[grid_id].grid->monitor, GRID_REORG_DECAY_SHIFT);
+    }
+    table_monitor_decay(&table->monitor, GRID_REORG_DECAY_SHIFT);
+
+    pthread_mutex_lock(&reorg->latch);
+    reorg->round++;
+    pthread_mutex_unlock(&reorg->latch);
+    pthread_mutex_unlock(&reorg->round_latch);
+
+    free(attr_ids);
+    free(infos);
+    return nconverted;
+}
+
+void grid_reorg_start(grid_reorg_t *reorg, unsigned interval_ms)
+{
+    GS_REQUIRE_NONNULL(reorg);
+    pthread_mutex_lock(&reorg->latch);
+    panic_if(reorg->running, BADSTATE, "reorganizer is already running");
+    reorg->running = true;
+    reorg->interval_ms = interval_ms;
+    pthread_mutex_unlock(&reorg->latch);
+    reorg->worker = future_new(reorg, reorg_promise, future_eager);
+}
+
+void grid_reorg_stop(grid_reorg_t *reorg)
+{
+    GS_REQUIRE_NONNULL(reorg);
+    pthread_mutex_lock(&reorg->latch);
+    bool running = reorg->running;
+    reorg->running = false;
+    pthread_cond_signal(&reorg->wakeup);
+    pthread_mutex_unlock(&reorg->latch);
+    if (running) {
+        future_resolve(NULL, reorg->worker);
+        reorg->worker = NULL;
+    }
+}
+
+vec_t *grid_reorg_log(grid_reorg_t *reorg)
+{
+    GS_REQUIRE_NONNULL(reorg);
+    pthread_mutex_lock(&reorg->latch);
+    vec_t *result = vec_cpy_deep(reorg->log);
+    pthread_mutex_unlock(&reorg->latch);
+    return result;
+}
+
+void grid_reorg_entry_print(FILE *file, const grid_reorg_entry_t *entry)
+{
+    GS_REQUIRE_NONNULL(file);
+    GS_REQUIRE_NONNULL(entry);
+    fprintf(file, "# [REORG] round %zu: ", entry->round);
+    switch (entry->action) {
+        case GRID_REORG_CONVERT:
+            fprintf(file, "grid %zu converted from %s to %s", entry->grid_id, frag_str(entry->from),
+                    frag_str(entry->to));
+            break;
+        case GRID_REORG_ADVISE_SPLIT:
+            fprintf(file, "grid %zu should be split into %s", entry->grid_id, entry->detail);
+            break;
+        case GRID_REORG_ADVISE_MERGE:
+            fprintf(file, "grids %zu and %zu should be merged", entry->grid_id, entry->other_grid_id);
+            break;
+        default: panic("Unknown reorganization action '%d'", entry->action);
+    }
+    fprintf(file, " (%llu row-wise and %llu column-wise field accesses, %.1f attributes per tuple)",
+            (unsigned long long) entry->workload.fields[GRID_ACCESS_ROW],
+            (unsigned long long) entry->workload.fields[GRID_ACCESS_COLUMN], entry->coaccess);
+    if (entry->action == GRID_REORG_CONVERT) {
+        double benefit = (entry->cost_before > 0 ? 1.0 - entry->cost_after / entry->cost_before : 0);
+        fprintf(file, ": estimated gain %.0f%%, measured %.2f ns -> %.2f ns per field (gain %.0f%%)",
+                entry->est_gain * 100, entry->cost_before, entry->cost_after, benefit * 100);
+    }
+    fprintf(file, "\n");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void reorg_grid_open(reorg_grid_t *out, const table_t *table, grid_t *grid, attr_id_t *attr_ids)
+{
+    out->grid = grid;
+    out->attr_ids = attr_ids;
+    out->nattr_ids = 0;
+    for (attr_id_t attr_id = 0; attr_id < table_num_of_attributes(table); attr_id++) {
+        if (table_attr_id_to_frag_attr_id(grid, attr_id) != NULL) {
+            out->attr_ids[out->nattr_ids++] = attr_id;
+        }
+    }
+    grid_monitor_snapshot(&out->workload, &grid->monitor);
+
+    // The expected number of attributes of this grid that are accessed in a tuple together with an accessed one
+    u64 naccessed = 0;
+    for (size_t i = 0; i < out->nattr_ids; i++) {
+        naccessed += table_monitor_coaccess(&table->monitor, out->attr_ids[i], out->attr_ids[i]);
+    }
+    u64 npairs = coaccess_sum(table, out->attr_ids, out->nattr_ids, out->attr_ids, out->nattr_ids);
+    out->coaccess = (naccessed > 0 ? (double) npairs / naccessed : out->nattr_ids);
+    out->coaccess = max(1.0, min(out->coaccess, (double) max(out->nattr_ids, 1)));
+}
+
+ bool reorg_convert(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *info)
+{
+    // The fragment is inspected and probed under the latch in shared mode, since the grid might be converted by others
+    // meanwhile, and writers free replaced buffers (e.g., the string heap) in place
+    grid_share_lock(info->grid);
+    frag_t *frag = info->grid->frag;
+    enum frag_impl_type_t type;
+    switch (frag->impl_type) {
+        case FIT_HOST_NSM_VM: type = FIT_HOST_DSM_VM; break;
+        case FIT_HOST_DSM_VM: type = FIT_HOST_NSM_VM; break;
+        default: grid_share_unlock(info->grid); return false;
+    }
+    double current_cost = layout_cost(frag->impl_type, &info->workload, frag, info->coaccess);
+    double cost = layout_cost(type, &info->workload, frag, info->coaccess);
+    if (current_cost <= 0 || cost > current_cost * (1 - GRID_REORG_MIN_GAIN)) {
+        grid_share_unlock(info->grid);
+        return false;
+    }
+
+    entry->action = GRID_REORG_CONVERT;
+    entry->grid_id = entry->other_grid_id = info->grid->grid_id;
+    entry->from = frag->impl_type;
+    entry->to = type;
+    entry->workload = info->workload;
+    entry->coaccess = info->coaccess;
+    entry->est_gain = 1 - cost / current_cost;
+    entry->detail[0] = '\0';
+    entry->cost_before = probe_cost(frag, table, info);
+    grid_share_unlock(info->grid);
+    if (!grid_relayout(info->grid, type)) {
+        return false;
+    }
+    grid_share_lock(info->grid);
+    entry->cost_after = probe_cost(info->grid->frag, table, info);
+    grid_share_unlock(info->grid);
+    return true;
+}
+
+ bool reorg_advise_split(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *info)
+{
+    // Attributes that are accessed together (directly or via others) form a group; attributes that are never accessed
+    // do not separate groups
+    size_t n = info->nattr_ids;
+    size_t *parents = GS_REQUIRE_MALLOC(max(n, 1) * sizeof(size_t));
+    u64 *naccessed = GS_REQUIRE_MALLOC(max(n, 1) * sizeof(u64));
+    for (size_t i = 0; i < n; i++) {
+        parents[i] = i;
+        naccessed[i] = table_monitor_coaccess(&table->monitor, info->attr_ids[i], info->attr_ids[i]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            u64 ncommon = table_monitor_coaccess(&table->monitor, info->attr_ids[i], info->attr_ids[j]);
+            if (naccessed[i] > 0 && naccessed[j] > 0 &&
+                ncommon >= GRID_REORG_AFFINITY * min(naccessed[i], naccessed[j])) {
+                parents[find_root(parents, i)] = find_root(parents, j);
+            }
+        }
+    }
+
+    size_t ngroups = 0, length = 0;
+    entry->detail[0] = '\0';
+    for (size_t i = 0; i < n; i++) {
+        if (naccessed[i] == 0 || find_root(parents, i) != i) {
+            continue;
+        }
+        ngroups++;
+        for (size_t j = 0, nmembers = 0; j < n; j++) {
+            if (naccessed[j] > 0 && find_root(parents, j) == i && length < GRID_REORG_DETAIL_SIZE) {
+                length += snprintf(entry->detail + length, GRID_REORG_DETAIL_SIZE - length, "%s%s",
+                                   (nmembers++ == 0 ? (ngroups > 1 ? " {" : "{") : ", "),
+                                   table_attr_name_by_id(table, info->attr_ids[j]));
+            }
+        }
+        if (length < GRID_REORG_DETAIL_SIZE) {
+            length += snprintf(entry->detail + length, GRID_REORG_DETAIL_SIZE - length, "}");
+        }
+    }
+    free(parents);
+    free(naccessed);
+
+    if (ngroups < 2) {
+        return false;
+    }
+    entry->action = GRID_REORG_ADVISE_SPLIT;
+    entry->grid_id = entry->other_grid_id = info->grid->grid_id;
+    u64 pin = grid_pin(info->grid);
+    entry->from = entry->to = info->grid->frag->impl_type;
+    grid_unpin(info->grid, pin);
+    entry->workload = info->workload;
+    entry->coaccess = info->coaccess;
+    entry->est_gain = entry->cost_before = entry->cost_after = 0;
+    return true;
+}
+
+ bool reorg_advise_merge(grid_reorg_entry_t *entry, const table_t *table, const reorg_grid_t *lhs,
+                         const reorg_grid_t *rhs)
+{
+    // Row-wise accesses to attributes of both grids resolve and read two grids per tuple
+    if (lhs->workload.fields[GRID_ACCESS_ROW] < lhs->workload.fields[GRID_ACCESS_COLUMN] ||
+        rhs->workload.fields[GRID_ACCESS_ROW] < rhs->workload.fields[GRID_ACCESS_COLUMN]) {
+        return false;
+    }
+    tuple_id_interval_t lhs_range, rhs_range;
+    if (!grid_tuple_range(&lhs_range, lhs->grid) || !grid_tuple_range(&rhs_range, rhs->grid) ||
+        lhs_range.end <= rhs_range.begin || rhs_range.end <= lhs_range.begin) {
+        return false;
+    }
+    u64 lhs_accessed = coaccess_sum(table, lhs->attr_ids, lhs->nattr_ids, lhs->attr_ids, lhs->nattr_ids);
+    u64 rhs_accessed = coaccess_sum(table, rhs->attr_ids, rhs->nattr_ids, rhs->attr_ids, rhs->nattr_ids);
+    u64 ncommon = coaccess_sum(table, lhs->attr_ids, lhs->nattr_ids, rhs->attr_ids, rhs->nattr_ids);
+    if (ncommon == 0 || ncommon < GRID_REORG_AFFINITY * min(lhs_accessed, rhs_accessed)) {
+        return false;
+    }
+
+    entry->action = GRID_REORG_ADVISE_MERGE;
+    entry->grid_id = lhs->grid->grid_id;
+    entry->other_grid_id = rhs->grid->grid_id;
+    u64 pin = grid_pin(lhs->grid);
+    entry->from = entry->to = lhs->grid->frag->impl_type;
+    grid_unpin(lhs->grid, pin);
+    entry->workload = lhs->workload;
+    entry->coaccess = lhs->coaccess;
+    entry->est_gain = entry->cost_before = entry->cost_after = 0;
+    entry->detail[0] = '\0';
+    return true;
+}
+
+ void reorg_log(grid_reorg_t *reorg, const grid_reorg_entry_t *entry)
+{
+    pthread_mutex_lock(&reorg->latch);
+    // An advice is logged once until it changes, although it is made again in each round
+    bool repeated = false;
+    for (size_t i = vec_length(reorg->log); entry->action != GRID_REORG_CONVERT && i > 0; i--) {
+        const grid_reorg_entry_t *last = vec_at(reorg->log, i - 1);
+        if (last->action == entry->action && last->grid_id == entry->grid_id &&
+            last->other_grid_id == entry->other_grid_id) {
+            repeated = !strcmp(last->detail, entry->detail);
+            break;
+        }
+    }
+    if (!repeated) {
+        vec_pushback(reorg->log, 1, entry);
+        if (reorg->log_file != NULL) {
+            grid_reorg_entry_print(reorg->log_file, entry);
+        }
+    }
+    pthread_mutex_unlock(&reorg->latch);
+}
+
+ double layout_cost(enum frag_impl_type_t type, const grid_workload_t *workload, const frag_t *frag, double coaccess)
+{
+    /* The number of cache lines loaded per accessed field, given that 'coaccess' fields of a tuple are accessed
+     * together: an NSM tuplet is loaded once for all its accessed fields, while each DSM field is in a line of its
+     * own column. Runs of a column share lines with their neighbours in DSM, while in NSM the entire tuplets are
+     * loaded. */
+    double tuplet_lines = ceil((double) frag->tuplet_size / GRID_REORG_LINE_SIZE);
+    double field_size = (double) frag->tuplet_size / max(frag_num_of_attributes(frag), 1);
+    double row, column;
+    if (type == FIT_HOST_NSM_VM) {
+        row = min(tuplet_lines, coaccess) / coaccess;
+        column = (double) frag->tuplet_size / GRID_REORG_LINE_SIZE / coaccess;
+    } else {
+        row = 1;
+        column = field_size / GRID_REORG_LINE_SIZE;
+    }
+    return row * workload->fields[GRID_ACCESS_ROW] + column * workload->fields[GRID_ACCESS_COLUMN];
+}
+
+ double probe_cost(frag_t *frag, const table_t *table, const reorg_grid_t *info)
+{
+    // The most accessed attributes of the grid are read row-wise and column-wise in the observed proportion
+    size_t ntuplets = min(frag->ntuplets, GRID_REORG_PROBE_SIZE);
+    u64 total = grid_workload_total(&info->workload);
+    if (ntuplets == 0 || total == 0) {
+        return 0;
+    }
+    size_t nprobed = min(max((size_t) (info->coaccess + 0.5), 1), info->nattr_ids);
+    attr_id_t *probed = GS_REQUIRE_MALLOC(max(info->nattr_ids, 1) * sizeof(attr_id_t));
+    u64 *naccessed = GS_REQUIRE_MALLOC(max(info->nattr_ids, 1) * sizeof(u64));
+    for (size_t i = 0; i < info->nattr_ids; i++) {
+        probed[i] = *table_attr_id_to_frag_attr_id(info->grid, info->attr_ids[i]);
+        naccessed[i] = table_monitor_coaccess(&table->monitor, info->attr_ids[i], info->attr_ids[i]);
+    }
+    for (size_t i = 0; i < nprobed; i++) {
+        for (size_t j = i + 1; j < info->nattr_ids; j++) {
+            if (naccessed[j] > naccessed[i]) {
+                u64 count = naccessed[i];
+                attr_id_t attr_id = probed[i];
+                naccessed[i] = naccessed[j];
+                probed[i] = probed[j];
+                naccessed[j] = count;
+                probed[j] = attr_id;
+            }
+        }
+    }
+
+    volatile u64 sink = 0;
+    double begin = now_ns();
+    for (size_t i = 0; i < ntuplets; i++) {
+        tuplet_t tuplet;
+        tuplet_field_t field;
+        tuplet_open(&tuplet, frag, (tuplet_id_t) ((i * 7919) % frag->ntuplets));
+        for (size_t j = 0; j < nprobed; j++) {
+            tuplet_field_seek(&field, &tuplet, probed[j]);
+            const void *value = tuplet_field_read(&field);
+            sink += (value != NULL ? *(const u8 *) value : 0);
+        }
+    }
+    double row = (now_ns() - begin) / (ntuplets * nprobed);
+
+    begin = now_ns();
+    for (size_t j = 0; j < nprobed; j++) {
+        frag_column_cursor_t cursor;
+        frag_column_view_t view;
+        frag_column_open(&cursor, frag, probed[j], 0, ntuplets, FRAG_VIEW_BATCH_SIZE);
+        while (frag_column_next(&view, &cursor)) {
+            for (size_t i = 0; i < view.count; i++) {
+                sink += *(const u8 *) frag_column_view_at(&view, i);
+            }
+        }
+        frag_column_close(&cursor);
+    }
+    double column = (now_ns() - begin) / (ntuplets * nprobed);
+    (void) sink;
+
+    free(probed);
+    free(naccessed);
+    return (row * info->workload.fields[GRID_ACCESS_ROW] + column * info->workload.fields[GRID_ACCESS_COLUMN]) / total;
+}
+
+ bool grid_tuple_range(tuple_id_interval_t *out, const grid_t *grid)
+{
+    bool covers;
+    u64 version, pin = grid_pin(grid);
+    do {
+        version = grid_read_begin(grid);
+        const vec_t *tuple_ids = grid->tuple_ids;
+        size_t nintervals = vec_length(tuple_ids);
+        covers = (nintervals > 0);
+        if (covers) {
+            out->begin = ((const tuple_id_interval_t *) vec_at(tuple_ids, 0))->begin;
+            out->end = ((const tuple_id_interval_t *) vec_at(tuple_ids, nintervals - 1))->end;
+        }
+    } while (!grid_read_validate(grid, version));
+    grid_unpin(grid, pin);
+    return covers;
+}
+
+ u64 coaccess_sum(const table_t *table, const attr_id_t *lhs, size_t nlhs, const attr_id_t *rhs, size_t nrhs)
+{
+    u64 sum = 0;
+    for (size_t i = 0; i < nlhs; i++) {
+        for (size_t j = 0; j < nrhs; j++) {
+            sum += table_monitor_coaccess(&table->monitor, lhs[i], rhs[j]);
+        }
+    }
+    return sum;
+}
+
+ size_t find_root(size_t *parents, size_t idx)
+{
+    while (parents[idx] != idx) {
+        idx = parents[idx] = parents[parents[idx]];
+    }
+    return idx;
+}
+
+ double now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+ void *reorg_promise(promise_result *return_value, const void *capture)
+{
+    grid_reorg_t *reorg = (grid_reorg_t *) capture;
+    pthread_mutex_lock(&reorg->latch);
+    while (reorg->running) {
+        pthread_mutex_unlock(&reorg->latch);
+        grid_reorg_run(reorg);
+        pthread_mutex_lock(&reorg->latch);
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += reorg->interval_ms / 1000;
+        deadline.tv_nsec += (reorg->interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (reorg->running && pthread_cond_timedwait(&reorg->wakeup, &reorg->latch, &deadline) == 0);
+    }
+    pthread_mutex_unlock(&reorg->latch);
+    *return_value = resolved;
+    return NULL;
+}
@@ -0,0 +1,211 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid_stats.h>
+#include <attr.h>
+#include <frag.h>
+#include <stdatomic.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// G L O B A L S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* Distinguishes the generators of different sketches, such that the samples of different grids are independent */
+static atomic_uint_fast64_t generators;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u64 value_bits(const void *value, size_t size);
+
+ void reservoir_next(attr_sketch_t *sketch, u64 *seed);
+
+ u64 next_random(u64 *seed);
+
+ double next_uniform(u64 *seed);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+void grid_stats_create(grid_stats_t *stats, const schema_t *schema)
+{
+    GS_REQUIRE_NONNULL(stats);
+    GS_REQUIRE_NONNULL(schema);
+    pthread_mutex_init(&stats->latch, NULL);
+    stats->nattrs = schema_num_attributes(schema);
+    stats->attrs = GS_REQUIRE_MALLOC(max(stats->nattrs, 1) * sizeof(attr_sketch_t));
+    stats->nchanges = 0;
+    stats->seed = hll_hash_u64(atomic_fetch_add_explicit(&generators, 1, memory_order_relaxed)) | 1;
+    for (attr_id_t attr_id = 0; attr_id < stats->nattrs; attr_id++) {
+        const attr_t *attr = schema_attr_by_id(schema, attr_id);
+        attr_sketch_t *sketch = stats->attrs + attr_id;
+        sketch->type = attr_type(attr);
+        sketch->ordered = (attr_type(attr) <= FT_FLOAT64 && attr->type_rep == 1);
+        sketch->string = attr_isstring(attr);
+        sketch->size = (sketch->string ? sizeof(const char *) : attr_total_size(attr));
+        hll_create(&sketch->distinct);
+        sketch->sample = (sketch->ordered ? GS_REQUIRE_MALLOC(GRID_STATS_SAMPLE_SIZE * sizeof(u64)) : NULL);
+        sketch->nsample = 0;
+        sketch->nseen = 0;
+        sketch->next = 0;
+        sketch->weight = 1;
+    }
+}
+
+void grid_stats_dispose(grid_stats_t *stats)
+{
+    GS_REQUIRE_NONNULL(stats);
+    for (attr_id_t attr_id = 0; attr_id < stats->nattrs; attr_id++) {
+        free(stats->attrs[attr_id].sample);
+    }
+    free(stats->attrs);
+    pthread_mutex_destroy(&stats->latch);
+}
+
+void grid_stats_add(grid_stats_t *stats, attr_id_t attr_id, const void *values, size_t count)
+{
+    GS_REQUIRE_NONNULL(stats);
+    REQUIRE_LESSTHAN(attr_id, stats->nattrs);
+
+    pthread_mutex_lock(&stats->latch);
+    // A rescan may swap the sketches meanwhile, see grid_stats_swap()
+    attr_sketch_t *sketch = stats->attrs + attr_id;
+    if (!sketch->ordered) {
+        for (size_t i = 0; i < count; i++) {
+            const void *value = values + i * sketch->size;
+            hll_add(&sketch->distinct, attr_sketch_hash(sketch, (sketch->string ? *(const char **) value : value)));
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            hll_add(&sketch->distinct, hll_hash_u64(value_bits(values + i * sketch->size, sketch->size)));
+        }
+        // Reservoir sampling: the first values fill the sample, and each later value replaces a sampled one with
+        // probability GRID_STATS_SAMPLE_SIZE / n. Rather than drawing whether each value is sampled, the position of
+        // the next sampled value is drawn (Li's algorithm L), which leaves most values untouched.
+        u64 begin = sketch->nseen, end = begin + count;
+        for (u64 n = begin; n < end && sketch->nsample < GRID_STATS_SAMPLE_SIZE; n++) {
+            sketch->sample[sketch->nsample++] = frag_zone_key(sketch->type, values + (n - begin) * sketch->size);
+            if (sketch->nsample == GRID_STATS_SAMPLE_SIZE) {
+                sketch->next = n;
+                reservoir_next(sketch, &stats->seed);
+            }
+        }
+        for (; sketch->nsample == GRID_STATS_SAMPLE_SIZE && sketch->next < end; reservoir_next(sketch, &stats->seed)) {
+            const void *value = values + (sketch->next - begin) * sketch->size;
+            sketch->sample[next_random(&stats->seed) % GRID_STATS_SAMPLE_SIZE] = frag_zone_key(sketch->type, value);
+        }
+    }
+    sketch->nseen += count;
+    stats->nchanges += count;
+    pthread_mutex_unlock(&stats->latch);
+}
+
+void grid_stats_deleted(grid_stats_t *stats, u64 count)
+{
+    GS_REQUIRE_NONNULL(stats);
+    pthread_mutex_lock(&stats->latch);
+    stats->nchanges += count * stats->nattrs;
+    pthread_mutex_unlock(&stats->latch);
+}
+
+u64 grid_stats_num_of_changes(grid_stats_t *stats)
+{
+    GS_REQUIRE_NONNULL(stats);
+    pthread_mutex_lock(&stats->latch);
+    u64 result = stats->nchanges;
+    pthread_mutex_unlock(&stats->latch);
+    return result;
+}
+
+void grid_stats_snapshot(attr_sketch_t *out, grid_stats_t *stats, attr_id_t attr_id)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(stats);
+    REQUIRE_LESSTHAN(attr_id, stats->nattrs);
+    pthread_mutex_lock(&stats->latch);
+    const attr_sketch_t *sketch = stats->attrs + attr_id;
+    u64 *sample = out->sample;
+    *out = *sketch;
+    out->sample = sample;
+    if (sketch->ordered) {
+        GS_REQUIRE_NONNULL(sample);
+        memcpy(sample, sketch->sample, sketch->nsample * sizeof(u64));
+    }
+    pthread_mutex_unlock(&stats->latch);
+}
+
+void grid_stats_swap(grid_stats_t *stats, grid_stats_t *fresh, u64 nchanges)
+{
+    GS_REQUIRE_NONNULL(stats);
+    GS_REQUIRE_NONNULL(fresh);
+    REQUIRE((stats->nattrs == fresh->nattrs), "Sketches of different grids cannot be swapped");
+    pthread_mutex_lock(&stats->latch);
+    attr_sketch_t *attrs = stats->attrs;
+    stats->attrs = fresh->attrs;
+    fresh->attrs = attrs;
+    // Changes that happened during the rebuild were possibly not seen by it, and are kept for the next one
+    stats->nchanges -= min(nchanges, stats->nchanges);
+    pthread_mutex_unlock(&stats->latch);
+}
+
+u64 attr_sketch_hash(const attr_sketch_t *sketch, const void *value)
+{
+    GS_REQUIRE_NONNULL(sketch);
+    GS_REQUIRE_NONNULL(value);
+    if (sketch->ordered) {
+        return hll_hash_u64(value_bits(value, sketch->size));
+    } else return hll_hash(value, (sketch->string ? strlen(value) : sketch->size));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ u64 value_bits(const void *value, size_t size)
+{
+    // Equal values of an attribute with a total order have equal bits, hence the bits are hashed rather than the key
+    switch (size) {
+        case sizeof(u8):  return *(const u8 *) value;
+        case sizeof(u16): return *(const u16 *) value;
+        case sizeof(u32): return *(const u32 *) value;
+        default:          return *(const u64 *) value;
+    }
+}
+
+ void reservoir_next(attr_sketch_t *sketch, u64 *seed)
+{
+    sketch->weight *= exp(log(next_uniform(seed)) / GRID_STATS_SAMPLE_SIZE);
+    double skip = floor(log(next_uniform(seed)) / log1p(-sketch->weight));
+    sketch->next += (skip < (double) UINT32_MAX ? (u64) skip : UINT32_MAX) + 1;
+}
+
+ u64 next_random(u64 *seed)
+{
+    // xorshift64*
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    return *seed * 0x2545f4914f6cdd1dULL;
+}
+
+ double next_uniform(u64 *seed)
+{
+    // A double in (0, 1], i.e., whose logarithm is finite
+    return ((next_random(seed) >> 11) + 1) * 0x1p-53;
+}
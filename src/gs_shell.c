@@ -3,6 +3,7 @@
 #include <apr_file_io.h>
 #include <apr_strings.h>
 #include <gs_dispatcher.h>
+#include <stats_catalog.h>
 
 typedef struct gs_shell_t {
     gs_dispatcher_t     *dispatcher;
@@ -14,6 +15,7 @@ typedef struct gs_shell_t {
     //apr_gid_t            group_id;
     //char                *user_name;
     apr_time_t           uptime;
+    vec_t               *catalogs;
 } gs_shell_t;
 
  int shell_loop(void *args);
@@ -23,6 +25,7 @@ typedef struct gs_shell_t {
  void process_command_help(gs_shell_t *shell, apr_file_t *in, apr_file_t *out, char *input);
  void process_command_exit(gs_shell_t *shell, apr_file_t *in, apr_file_t *out, char *input);
  void process_command_uptime(gs_shell_t *shell, apr_file_t *in, apr_file_t *out, char *input);
+ void process_command_stats(gs_shell_t *shell, apr_file_t *in, apr_file_t *out, char *input);
 
 GS_DECLARE(gs_status_t) gs_shell_create(gs_shell_t **shell, gs_dispatcher_t *dispatcher)
 {
@@ -34,6 +37,7 @@ GS_DECLARE(gs_status_t) gs_shell_create(gs_shell_t **shell, gs_dispatcher_t *dis
   //  apr_uid_current(&result->user_id, &result->group_id, result->pool);
   //  apr_uid_name_get(&result->user_name, result->user_id, result->pool);
     result->uptime = apr_time_now();
+    result->catalogs = vec_new(sizeof(stats_catalog_t *), 1);
     *shell = result;
     return GS_SUCCESS;
 }
@@ -52,6 +56,19 @@ GS_DECLARE(gs_status_t) gs_shell_start(gs_shell_t *shell)
     }
 }
 
+GS_DECLARE(gs_status_t) gs_shell_register_catalog(gs_shell_t *shell, stats_catalog_t *catalog)
+{
+    GS_REQUIRE_NONNULL(shell);
+    GS_REQUIRE_NONNULL(catalog);
+    if (!shell->is_running) {
+        vec_pushback(shell->catalogs, 1, &catalog);
+        return GS_SUCCESS;
+    } else {
+        warn("shell %p was requested to register a catalog but runs already", shell);
+        return GS_FAILED;
+    }
+}
+
 GS_DECLARE(gs_status_t) gs_shell_dispose(gs_shell_t **shell_ptr)
 {
     GS_REQUIRE_NONNULL(shell_ptr);
@@ -59,6 +76,7 @@ GS_DECLARE(gs_status_t) gs_shell_dispose(gs_shell_t **shell_ptr)
     gs_shell_t *shell = *shell_ptr;
     if (shell->is_disposable) {
         apr_pool_destroy(shell->pool);
+        vec_free(shell->catalogs);
         GS_DEBUG("shell %p disposed", shell);
         free(shell);
         *shell_ptr = NULL;
@@ -133,6 +151,8 @@ GS_DECLARE(gs_status_t) gs_shell_shutdown(gs_shell_t *shell)
         return false;
     } else if (apr_strnatcasecmp(input, "uptime") == 0) {
         process_command_uptime(shell, in, out, input);
+    } else if (apr_strnatcasecmp(input, "stats") == 0) {
+        process_command_stats(shell, in, out, input);
     } else {
         apr_file_printf(out, "no such command: %s", input);
     }
@@ -145,6 +165,7 @@ GS_DECLARE(gs_status_t) gs_shell_shutdown(gs_shell_t *shell)
     apr_file_printf(out, "Available commands:\n");
     apr_file_printf(out, "  help    Shows this help message\n");
     apr_file_printf(out, "  uptime  Shows how long the system is running\n");
+    apr_file_printf(out, "  stats   Shows the statistics of the registered tables\n");
     apr_file_printf(out, "  exit    Shutdowns the system, and exit the shell\n");
 
 }
@@ -161,4 +182,15 @@ GS_DECLARE(gs_status_t) gs_shell_shutdown(gs_shell_t *shell)
     apr_time_exp_t result;
     apr_time_exp_gmt(&result, apr_time_now() - shell->uptime);
     printf("%dh, %dmin, %dsec\n", result.tm_hour, result.tm_min, result.tm_sec);
-}
\ No newline at end of file
+}
+
+ void process_command_stats(gs_shell_t *shell, apr_file_t *in, apr_file_t *out, char *input)
+{
+    GS_DEBUG("shell %p command 'stats' entered", shell);
+    if (vec_length(shell->catalogs) == 0) {
+        apr_file_printf(out, "no statistics available\n");
+    }
+    for (size_t i = 0; i < vec_length(shell->catalogs); i++) {
+        stats_catalog_print(stdout, *(stats_catalog_t **) vec_at(shell->catalogs, i));
+    }
+}
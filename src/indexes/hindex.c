@@ -56,6 +56,16 @@ void hindex_remove_having(struct hindex_t *index, tuple_id_t tid)
     DELEGATE_CALL_WARGS(index, _remove_intersec, tid);
 }
 
+void hindex_remove_grid(struct hindex_t *index, const tuple_id_interval_t *key, const struct grid_t *grid)
+{
+    GS_REQUIRE_NONNULL(index)
+    GS_REQUIRE_NONNULL(key)
+    GS_REQUIRE_NONNULL(grid)
+    DELEGATE_CALL_WARGS(index, _remove_grid, key, grid);
+    index->bounds.begin = (key->begin == index->bounds.begin)? DELEGATE_CALL(index, _minbegin) : index->bounds.begin;
+    index->bounds.end = (key->end == index->bounds.end)? DELEGATE_CALL(index, _maxend) : index->bounds.end;
+}
+
 bool hindex_contains(const struct hindex_t *index, tuple_id_t tid)
 {
     return DELEGATE_CALL_WARGS(index, _contains, tid);
@@ -40,9 +40,18 @@ typedef struct entry_t {
 // H E L P E R   P R O T O T Y P E S
 // ---------------------------------------------------------------------------------------------------------------------
 
+ void remove_entry(vec_t *haystack, entry_t *entry)
+{
+    entry_t *last = vec_peek_unsafe(haystack);
+    vec_free(entry->grids);
+    memmove(entry, entry + 1, (last - entry) * sizeof(entry_t));
+    haystack->num_elements--;
+}
+
  void this_add(struct hindex_t *self, const tuple_id_interval_t *key, const struct grid_t *grid);
  void this_remove_interval(struct hindex_t *self, const tuple_id_interval_t *key);
  void this_remove_intersec(struct hindex_t *self, tuple_id_t tid);
+ void this_remove_grid(struct hindex_t *self, const tuple_id_interval_t *key, const struct grid_t *grid);
  bool this_contains(const struct hindex_t *self, tuple_id_t tid);
  void this_delete(struct hindex_t *self);
  void this_query(grid_cursor_t *result, const struct hindex_t *self, const tuple_id_t *tid_begin,
@@ -53,6 +62,7 @@ typedef struct entry_t {
 
  entry_t *find_interval(vec_t *haystack, const tuple_id_interval_t *needle);
  void find_all_by_point(vec_t *result, vec_t *haystack, const tuple_id_t needle);
+ void remove_entry(vec_t *haystack, entry_t *entry);
 
 // ---------------------------------------------------------------------------------------------------------------------
 // I N T E R F A C E  I M P L E M E N T A T I O N
@@ -69,6 +79,7 @@ hindex_t *lesearch_hindex_new(size_t approx_num_horizontal_partitions, const sch
         ._add = this_add,
         ._remove_interval = this_remove_interval,
         ._remove_intersec = this_remove_intersec,
+        ._remove_grid = this_remove_grid,
         ._contains = this_contains,
         ._query = this_query,
         ._delete = this_delete,
@@ -145,19 +156,57 @@ hindex_t *lesearch_hindex_new(size_t approx_num_horizontal_partitions, const sch
 
  void this_remove_interval(struct hindex_t *self, const tuple_id_interval_t *key)
 {
-    panic(NOTIMPLEMENTED, to_string(this_remove_interval))
+    REQUIRE_INSTANCEOF_THIS(self);
+    GS_REQUIRE_NONNULL(key);
+    entry_t *entry = find_interval(self->extra, key);
+    if (entry) {
+        remove_entry(self->extra, entry);
+    }
 }
 
  void this_remove_intersec(struct hindex_t *self, tuple_id_t tid)
 {
-    panic(NOTIMPLEMENTED, to_string(this_remove_intersec))
+    REQUIRE_INSTANCEOF_THIS(self);
+    vec_t *vec = self->extra;
+    for (size_t idx = 0; idx < vec->num_elements; ) {
+        entry_t *entry = vec_at(vec, idx);
+        if (INTERVAL_CONTAINS((&entry->interval), tid)) {
+            remove_entry(vec, entry);
+        } else idx++;
+    }
+}
+
+ void this_remove_grid(struct hindex_t *self, const tuple_id_interval_t *key, const struct grid_t *grid)
+{
+    REQUIRE_INSTANCEOF_THIS(self);
+    GS_REQUIRE_NONNULL(key);
+    entry_t *entry = find_interval(self->extra, key);
+    if (entry) {
+        const struct grid_t **grids = vec_begin(entry->grids);
+        size_t num_grids = vec_length(entry->grids);
+        for (size_t idx = 0; idx < num_grids; idx++) {
+            if (grids[idx] == grid) {
+                grids[idx] = grids[--num_grids];
+                entry->grids->num_elements--;
+                break;
+            }
+        }
+        if (vec_length(entry->grids) == 0) {
+            remove_entry(self->extra, entry);
+        }
+    }
 }
 
  bool this_contains(const struct hindex_t *self, tuple_id_t tid)
 {
     REQUIRE_INSTANCEOF_THIS(self);
-    // TODO:...
-    panic(NOTIMPLEMENTED, to_string(this_contains))
+    const entry_t *it = (const entry_t *) ((vec_t *) self->extra)->data;
+    size_t num_elements = vec_length(self->extra);
+    while (num_elements--) {
+        if (INTERVAL_CONTAINS((&it->interval), tid))
+            return true;
+        it++;
+    }
     return false;
 }
 
@@ -179,8 +228,9 @@ hindex_t *lesearch_hindex_new(size_t approx_num_horizontal_partitions, const sch
  tuple_id_t bounds(struct hindex_t *self, bool begin)
 {
     REQUIRE_INSTANCEOF_THIS(self);
-    tuple_id_t tuple = begin ? INT_MAX : INT_MIN;
-    entry_t *it = vec_begin((vec_t *) self->extra);
+    /* an index without entries (e.g., while a grid's intervals are replaced) has the empty bounds [INT_MAX, 0) */
+    tuple_id_t tuple = begin ? INT_MAX : 0;
+    entry_t *it = (entry_t *) ((vec_t *) self->extra)->data;
     size_t num  = vec_length((vec_t *) self->extra);
     while (num--) { tuple = begin ? min(tuple, (it++)->interval.begin) : max(tuple, (it++)->interval.end); }
     return tuple;
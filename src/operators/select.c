@@ -0,0 +1,322 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <operators/select.h>
+#include <tuplet_field.h>
+#include <frag_accessors.h>
+#include <attr.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// M A C R O S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* Generates select_<format>_<name>_between() that evaluates 'lower <= value <= upper' for the tuplets [begin, end)
+ * via the specialized accessors of frag_accessors.h, and ORs the outcome into 'result' without branching */
+#define SELECT_BETWEEN(format, name, ctype)                                                                            \
+ void select_##format##_##name##_between(bitmap_word_t *result, const frag_t *frag, attr_id_t attr_id,                 \
+                                         tuplet_id_t begin, tuplet_id_t end, const void *lower, const void *upper)     \
+{                                                                                                                      \
+    ctype lo = *(const ctype *) lower, hi = *(const ctype *) upper;                                                    \
+    for (tuplet_id_t tuplet_id = begin; tuplet_id < end; tuplet_id++) {                                                \
+        ctype value = frag_##format##_##name##_read(frag, attr_id, tuplet_id);                                         \
+        result[tuplet_id / BITMAP_WORD_NBITS] |= ((bitmap_word_t) (value >= lo && value <= hi)) <<                     \
+                                                 (tuplet_id % BITMAP_WORD_NBITS);                                      \
+    }                                                                                                                  \
+}
+
+#define SELECT_BETWEEN_NSM(name, ctype, ftype)  SELECT_BETWEEN(nsm, name, ctype)
+#define SELECT_BETWEEN_DSM(name, ctype, ftype)  SELECT_BETWEEN(dsm, name, ctype)
+
+#define SELECT_BETWEEN_CASE(name, ctype, ftype)                                                                        \
+    case ftype:                                                                                                        \
+        if (frag_nsm_##name##_supports(frag, attr_id)) {                                                               \
+            select_nsm_##name##_between(result, frag, attr_id, begin, end, lower, upper);                              \
+            return true;                                                                                               \
+        } else if (frag_dsm_##name##_supports(frag, attr_id)) {                                                        \
+            select_dsm_##name##_between(result, frag, attr_id, begin, end, lower, upper);                              \
+            return true;                                                                                               \
+        }                                                                                                              \
+        return false;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ size_t select_codes_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues);
+ size_t select_values_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues);
+ size_t select_vstrings_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values,
+                           size_t nvalues);
+ void select_range(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, tuplet_id_t begin, const void *lower,
+                   const void *upper);
+ size_t select_finalize(bitmap_word_t *result, const frag_t *frag, attr_id_t attr_id);
+ bool select_between_specialized(bitmap_word_t *result, const frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,
+                                 tuplet_id_t end, const void *lower, const void *upper);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t select_str_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues)
+{
+    GS_REQUIRE_NONNULL(result);
+    GS_REQUIRE_NONNULL(frag);
+    GS_REQUIRE_NONNULL(values);
+    REQUIRE(attr_isstring(schema_attr_by_id(frag->schema, attr_id)), "Predicate requires a string attribute");
+
+    memset(result, 0, bitmap_nwords(frag->ntuplets) * sizeof(bitmap_word_t));
+    if (frag->ntuplets == 0 || nvalues == 0) {
+        return 0;
+    }
+    if (frag_dictionary(frag, attr_id) != NULL) {
+        return select_codes_in(result, frag, attr_id, values, nvalues);
+    } else if (schema_attr_by_id(frag->schema, attr_id)->flags.varlen) {
+        return select_vstrings_in(result, frag, attr_id, values, nvalues);
+    } else {
+        return select_values_in(result, frag, attr_id, values, nvalues);
+    }
+}
+
+size_t select_str_eq(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char *value)
+{
+    return select_str_in(result, frag, attr_id, &value, 1);
+}
+
+size_t select_str_prefix(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char *prefix)
+{
+    GS_REQUIRE_NONNULL(result);
+    GS_REQUIRE_NONNULL(frag);
+    GS_REQUIRE_NONNULL(prefix);
+    const attr_t *attr = schema_attr_by_id(frag->schema, attr_id);
+    REQUIRE(attr_isstring(attr), "Predicate requires a string attribute");
+
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    size_t length = strlen(prefix);
+
+    memset(result, 0, bitmap_nwords(frag->ntuplets) * sizeof(bitmap_word_t));
+    if (frag->ntuplets == 0) {
+        return 0;
+    }
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        if (frag_is_deleted(frag, tuplet.tuplet_id) || frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+            continue;
+        }
+        tuplet_field_seek(&field, &tuplet, attr_id);
+        /* headers of variable-length strings reject most values without reading the string */
+        bool match = (attr->flags.varlen ? vstring_has_prefix(field.attr_value_ptr, frag_string_heap(frag), prefix,
+                                                              length) :
+                                           strncmp(tuplet_field_read(&field), prefix, length) == 0);
+        if (match) {
+            bitmap_set(result, tuplet.tuplet_id);
+        }
+    } while (tuplet_next(&tuplet));
+    return bitmap_popcount(result, frag->ntuplets);
+}
+
+size_t select_int_between(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const void *lower, const void *upper)
+{
+    GS_REQUIRE_NONNULL(result);
+    GS_REQUIRE_NONNULL(frag);
+    GS_REQUIRE_NONNULL(lower);
+    GS_REQUIRE_NONNULL(upper);
+    enum field_type type = frag_field_type(frag, attr_id);
+    REQUIRE(intpack_supports(type), "Predicate requires an integer attribute");
+
+    memset(result, 0, bitmap_nwords(frag->ntuplets) * sizeof(bitmap_word_t));
+    if (frag->ntuplets == 0) {
+        return 0;
+    }
+
+    /* bounds are compared in the normalized domain, in which signed and unsigned values have the same order */
+    u64 lo = intpack_normalize(lower, type), hi = intpack_normalize(upper, type);
+    const intpack_column_t *packed = frag_packed_column(frag, attr_id);
+    size_t npacked = 0;
+    if (packed != NULL) {
+        /* a compressed block that is not entirely used (e.g., after compaction) is evaluated per tuplet */
+        for (size_t block_id = 0; block_id < packed->nblocks && npacked + INTPACK_BLOCK_SIZE <= frag->ntuplets;
+             block_id++) {
+            intpack_select_between(result, npacked, packed->blocks[block_id], lo, hi);
+            npacked += INTPACK_BLOCK_SIZE;
+        }
+    }
+    if (npacked < frag->ntuplets) {
+        select_range(result, frag, attr_id, npacked, lower, upper);
+    }
+    return select_finalize(result, frag, attr_id);
+}
+
+size_t select_int_eq(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const void *value)
+{
+    return select_int_between(result, frag, attr_id, value, value);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ size_t select_codes_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    dict_code_t code;
+    size_t num_codes = 0, num_matches = 0;
+    const dict_t *dict = frag_dictionary(frag, attr_id);
+
+    /* the IN-list is turned into a set of codes, such that each tuplet costs a single bit test */
+    bitmap_word_t *codes = bitmap_new(max(1, dict_size(dict)), false);
+    for (size_t i = 0; i < nvalues; i++) {
+        if (dict_lookup(&code, dict, values[i])) {
+            bitmap_set(codes, code);
+            num_codes++;
+        }
+    }
+
+    if (num_codes > 0) {
+        tuplet_open(&tuplet, frag, 0);
+        do {
+            if (frag_is_deleted(frag, tuplet.tuplet_id) || frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+                continue;
+            }
+            tuplet_field_seek(&field, &tuplet, attr_id);
+            /* read the raw field, i.e., the code rather than the decoded string */
+            if (bitmap_test(codes, *(const dict_code_t *) field.attr_value_ptr)) {
+                bitmap_set(result, tuplet.tuplet_id);
+                num_matches++;
+            }
+        } while (tuplet_next(&tuplet));
+    }
+
+    bitmap_free(codes);
+    return num_matches;
+}
+
+ size_t select_values_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values, size_t nvalues)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    size_t num_matches = 0;
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        if (frag_is_deleted(frag, tuplet.tuplet_id) || frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+            continue;
+        }
+        tuplet_field_seek(&field, &tuplet, attr_id);
+        const char *str = tuplet_field_read(&field);
+        for (size_t i = 0; i < nvalues; i++) {
+            if (strcmp(str, values[i]) == 0) {
+                bitmap_set(result, tuplet.tuplet_id);
+                num_matches++;
+                break;
+            }
+        }
+    } while (tuplet_next(&tuplet));
+
+    return num_matches;
+}
+
+ void select_range(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, tuplet_id_t begin, const void *lower,
+                   const void *upper)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    enum field_type type = frag_field_type(frag, attr_id);
+    u64 lo = intpack_normalize(lower, type), hi = intpack_normalize(upper, type);
+
+    /* blocks whose zone map excludes the range are not read at all */
+    for (size_t block_id = begin / FRAG_ZONE_NTUPLETS; block_id < frag_num_of_zones(frag); block_id++) {
+        if (!frag_zone_overlaps(frag, attr_id, block_id, lower, upper)) {
+            continue;
+        }
+        size_t block_begin = max(begin, block_id * FRAG_ZONE_NTUPLETS);
+        size_t block_end = min((block_id + 1) * FRAG_ZONE_NTUPLETS, frag->ntuplets);
+        if (select_between_specialized(result, frag, attr_id, block_begin, block_end, lower, upper)) {
+            continue;
+        }
+        tuplet_open(&tuplet, frag, block_begin);
+        do {
+            tuplet_field_seek(&field, &tuplet, attr_id);
+            u64 value = intpack_normalize(tuplet_field_read(&field), type);
+            if (value >= lo && value <= hi) {
+                bitmap_set(result, tuplet.tuplet_id);
+            }
+        } while (tuplet.tuplet_id + 1 < block_end && tuplet_next(&tuplet));
+    }
+}
+
+FRAG_ACCESSOR_TYPES(SELECT_BETWEEN_NSM)
+FRAG_ACCESSOR_TYPES(SELECT_BETWEEN_DSM)
+
+ bool select_between_specialized(bitmap_word_t *result, const frag_t *frag, attr_id_t attr_id, tuplet_id_t begin,
+                                 tuplet_id_t end, const void *lower, const void *upper)
+{
+    switch (frag_field_type(frag, attr_id)) {
+        FRAG_ACCESSOR_TYPES(SELECT_BETWEEN_CASE)
+        default: return false;
+    }
+}
+
+ size_t select_finalize(bitmap_word_t *result, const frag_t *frag, attr_id_t attr_id)
+{
+    /* NULL fields and deleted tuplets are dropped word-wise after the predicate was evaluated */
+    const bitmap_word_t *validity = frag_validity(frag, attr_id);
+    const bitmap_word_t *tombstones = frag_tombstones(frag);
+    size_t nwords = bitmap_nwords(frag->ntuplets);
+    for (size_t i = 0; i < nwords; i++) {
+        result[i] &= (validity != NULL ? validity[i] : ~0ULL) & (tombstones != NULL ? ~tombstones[i] : ~0ULL);
+    }
+    if (frag->ntuplets % BITMAP_WORD_NBITS != 0) {
+        result[nwords - 1] &= (1ULL << (frag->ntuplets % BITMAP_WORD_NBITS)) - 1;
+    }
+    return bitmap_popcount(result, frag->ntuplets);
+}
+
+ size_t select_vstrings_in(bitmap_word_t *result, frag_t *frag, attr_id_t attr_id, const char **values,
+                           size_t nvalues)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    size_t num_matches = 0;
+    const strheap_t *heap = frag_string_heap(frag);
+
+    /* the values are turned into headers once, such that most fields are rejected by comparing headers */
+    strheap_t *values_heap = strheap_new(FRAG_STRHEAP_CAPACITY);
+    vstring_t *headers = GS_REQUIRE_MALLOC(nvalues * sizeof(vstring_t));
+    for (size_t i = 0; i < nvalues; i++) {
+        vstring_make(headers + i, values_heap, values[i]);
+    }
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        if (frag_is_deleted(frag, tuplet.tuplet_id) || frag_is_null(frag, tuplet.tuplet_id, attr_id)) {
+            continue;
+        }
+        tuplet_field_seek(&field, &tuplet, attr_id);
+        for (size_t i = 0; i < nvalues; i++) {
+            if (vstring_equals(field.attr_value_ptr, heap, headers + i, values_heap)) {
+                bitmap_set(result, tuplet.tuplet_id);
+                num_matches++;
+                break;
+            }
+        }
+    } while (tuplet_next(&tuplet));
+
+    free (headers);
+    strheap_free(values_heap);
+    return num_matches;
+}
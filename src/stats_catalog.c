@@ -0,0 +1,516 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <stats_catalog.h>
+#include <tuplet_field.h>
+#include <containers/intpack.h>
+#include <inttypes.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// D A T A   T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+/* A sampled key of a grid, which stands for 'weight' values of the grid */
+typedef struct sample_point_t {
+    u64 key;
+    double weight;
+} sample_point_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ bool column_add_grid(column_stats_t *out, vec_t *points, grid_t *grid);
+
+ void column_finish(column_stats_t *out, vec_t *points);
+
+ void grid_rescan(grid_t *grid);
+
+ bool rescan_block(grid_stats_t *fresh, grid_t *grid, tuplet_id_t begin, void *buffer);
+
+ void histogram_build(histogram_t *out, sample_point_t *points, size_t npoints);
+
+ void histogram_add(histogram_t *histogram, u64 lower, u64 upper, double depth);
+
+ double bucket_overlap(const column_stats_t *stats, size_t bucket, u64 from, u64 to);
+
+ int compare_points(const void *lhs, const void *rhs);
+
+ void *refresh_promise(promise_result *return_value, const void *capture);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+stats_catalog_t *stats_catalog_new(table_t *table)
+{
+    GS_REQUIRE_NONNULL(table);
+    stats_catalog_t *catalog = GS_REQUIRE_MALLOC(sizeof(stats_catalog_t));
+    *catalog = (stats_catalog_t) {
+        .table = table,
+        .nrefreshed = 0,
+        .running = false,
+        .interval_ms = 0,
+        .worker = NULL
+    };
+    pthread_mutex_init(&catalog->refresh_latch, NULL);
+    pthread_mutex_init(&catalog->latch, NULL);
+    pthread_cond_init(&catalog->wakeup, NULL);
+    return catalog;
+}
+
+void stats_catalog_delete(stats_catalog_t *catalog)
+{
+    GS_REQUIRE_NONNULL(catalog);
+    stats_catalog_stop(catalog);
+    pthread_cond_destroy(&catalog->wakeup);
+    pthread_mutex_destroy(&catalog->latch);
+    pthread_mutex_destroy(&catalog->refresh_latch);
+    free(catalog);
+}
+
+size_t stats_catalog_refresh(stats_catalog_t *catalog, bool force)
+{
+    GS_REQUIRE_NONNULL(catalog);
+    pthread_mutex_lock(&catalog->refresh_latch);
+
+    // Grids added during the refresh are considered by the next one
+    grid_list_t *grids = atomic_load_explicit(&catalog->table->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    size_t nrefreshed = 0;
+    for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+        grid_t *grid = grids->grids[grid_id];
+        u64 pin = grid_pin(grid);
+        double nfields = (double) frag_num_of_tuplets(grid->frag) * grid->stats.nattrs;
+        grid_unpin(grid, pin);
+        u64 nchanges = grid_stats_num_of_changes(&grid->stats);
+        if (nchanges > 0 && (force || nchanges > STATS_CATALOG_REFRESH_RATIO * nfields)) {
+            grid_rescan(grid);
+            nrefreshed++;
+        }
+    }
+
+    pthread_mutex_lock(&catalog->latch);
+    catalog->nrefreshed += nrefreshed;
+    pthread_mutex_unlock(&catalog->latch);
+    pthread_mutex_unlock(&catalog->refresh_latch);
+    return nrefreshed;
+}
+
+void stats_catalog_start(stats_catalog_t *catalog, unsigned interval_ms)
+{
+    GS_REQUIRE_NONNULL(catalog);
+    pthread_mutex_lock(&catalog->latch);
+    panic_if(catalog->running, BADSTATE, "statistics refresher is already running");
+    catalog->running = true;
+    catalog->interval_ms = interval_ms;
+    pthread_mutex_unlock(&catalog->latch);
+    catalog->worker = future_new(catalog, refresh_promise, future_eager);
+}
+
+void stats_catalog_stop(stats_catalog_t *catalog)
+{
+    GS_REQUIRE_NONNULL(catalog);
+    pthread_mutex_lock(&catalog->latch);
+    bool running = catalog->running;
+    catalog->running = false;
+    pthread_cond_signal(&catalog->wakeup);
+    pthread_mutex_unlock(&catalog->latch);
+    if (running) {
+        future_resolve(NULL, catalog->worker);
+        catalog->worker = NULL;
+    }
+}
+
+bool stats_catalog_grid_column(column_stats_t *out, stats_catalog_t *catalog, grid_id_t grid_id, attr_id_t attr_id)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(catalog);
+    REQUIRE_LESSTHAN(attr_id, table_num_of_attributes(catalog->table));
+    grid_list_t *grids = atomic_load_explicit(&catalog->table->grid_ptrs, memory_order_acquire);
+    REQUIRE_LESSTHAN(grid_id, atomic_load_explicit(&grids->length, memory_order_acquire));
+
+    *out = (column_stats_t) { .attr_id = attr_id };
+    hll_create(&out->distinct);
+    vec_t *points = vec_new(sizeof(sample_point_t), GRID_STATS_SAMPLE_SIZE);
+    bool result = column_add_grid(out, points, grids->grids[grid_id]);
+    column_finish(out, points);
+    vec_free(points);
+    return result;
+}
+
+bool stats_catalog_column(column_stats_t *out, stats_catalog_t *catalog, attr_id_t attr_id)
+{
+    GS_REQUIRE_NONNULL(out);
+    GS_REQUIRE_NONNULL(catalog);
+    REQUIRE_LESSTHAN(attr_id, table_num_of_attributes(catalog->table));
+    grid_list_t *grids = atomic_load_explicit(&catalog->table->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+
+    *out = (column_stats_t) { .attr_id = attr_id };
+    hll_create(&out->distinct);
+    vec_t *points = vec_new(sizeof(sample_point_t), GRID_STATS_SAMPLE_SIZE);
+    for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+        column_add_grid(out, points, grids->grids[grid_id]);
+    }
+    column_finish(out, points);
+    vec_free(points);
+    return (out->ngrids > 0);
+}
+
+double column_stats_distinct(const column_stats_t *stats)
+{
+    GS_REQUIRE_NONNULL(stats);
+    u64 nvalues = stats->nrows - stats->nnulls;
+    if (nvalues == 0) {
+        return 0;
+    }
+    // Deleted values remain in the sketch until the grid is rescanned, hence the estimate is bounded by the values
+    return max(1.0, min(hll_estimate(&stats->distinct), (double) nvalues));
+}
+
+double column_stats_eq_selectivity(const column_stats_t *stats, const void *value)
+{
+    GS_REQUIRE_NONNULL(stats);
+    GS_REQUIRE_NONNULL(value);
+    double distinct = column_stats_distinct(stats);
+    if (distinct == 0) {
+        return 0;
+    }
+    const histogram_t *histogram = &stats->histogram;
+    if (stats->ordered && histogram->nbuckets > 0) {
+        u64 key = frag_zone_key(stats->type, value);
+        if (key < histogram->lower[0] || key > histogram->upper[histogram->nbuckets - 1]) {
+            // The value is out of the sampled range, hence it is (if at all) rare
+            return 1.0 / stats->nrows;
+        }
+        for (size_t bucket = 0; bucket < histogram->nbuckets; bucket++) {
+            if (histogram->lower[bucket] == key && histogram->upper[bucket] == key) {
+                // A frequent value, see histogram_build()
+                return min(1.0, histogram->depths[bucket] / stats->nrows);
+            }
+        }
+    }
+    // Values are assumed to be equally frequent
+    return (stats->nrows - stats->nnulls) / distinct / stats->nrows;
+}
+
+double column_stats_range_selectivity(const column_stats_t *stats, const void *lower, const void *upper)
+{
+    GS_REQUIRE_NONNULL(stats);
+    REQUIRE(stats->ordered, "Range selectivity requires an attribute with a total order");
+    u64 from = (lower != NULL ? frag_zone_key(stats->type, lower) : 0);
+    u64 to = (upper != NULL ? frag_zone_key(stats->type, upper) : UINT64_MAX);
+    if (stats->nrows == 0 || from > to) {
+        return 0;
+    }
+    const histogram_t *histogram = &stats->histogram;
+    double nvalues = 0;
+    for (size_t bucket = 0; bucket < histogram->nbuckets; bucket++) {
+        nvalues += histogram->depths[bucket] * bucket_overlap(stats, bucket, from, to);
+    }
+    return min(1.0, nvalues / stats->nrows);
+}
+
+double column_stats_key_value(const column_stats_t *stats, u64 key)
+{
+    GS_REQUIRE_NONNULL(stats);
+    REQUIRE(stats->ordered, "Keys are defined for attributes with a total order only");
+    u32 bits32;
+    float value32;
+    double value64;
+    s64 svalue;
+    u64 value;
+    switch (stats->type) {
+        case FT_BOOL:
+            return key;
+        case FT_FLOAT32:
+            /* inverse of frag_zone_key() */
+            bits32 = (key & (1U << 31) ? (u32) key & ~(1U << 31) : ~(u32) key);
+            memcpy(&value32, &bits32, sizeof(u32));
+            return value32;
+        case FT_FLOAT64:
+            key = (key & (1ULL << 63) ? key & ~(1ULL << 63) : ~key);
+            memcpy(&value64, &key, sizeof(u64));
+            return value64;
+        case FT_INT8: case FT_INT16: case FT_INT32: case FT_INT64:
+            /* keys of signed integers are sign-extended to 64 bits, see intpack_normalize() */
+            intpack_denormalize(&svalue, key, FT_INT64);
+            return svalue;
+        default:
+            intpack_denormalize(&value, key, FT_UINT64);
+            return value;
+    }
+}
+
+void column_stats_print(FILE *file, const table_t *table, const column_stats_t *stats)
+{
+    GS_REQUIRE_NONNULL(file);
+    GS_REQUIRE_NONNULL(table);
+    GS_REQUIRE_NONNULL(stats);
+    fprintf(file, "attribute '%s' (%s): %" PRIu64 " rows, %" PRIu64 " nulls, ~%.0f distinct, %" PRIu64 " changed "
+            "fields", table_attr_name_by_id(table, stats->attr_id), field_type_str(stats->type), stats->nrows,
+            stats->nnulls, column_stats_distinct(stats), stats->nchanges);
+    const histogram_t *histogram = &stats->histogram;
+    if (stats->ordered && histogram->nbuckets > 0) {
+        fprintf(file, ", histogram");
+        for (size_t bucket = 0; bucket < histogram->nbuckets; bucket++) {
+            fprintf(file, " [%g, %g]:%.0f", column_stats_key_value(stats, histogram->lower[bucket]),
+                    column_stats_key_value(stats, histogram->upper[bucket]), histogram->depths[bucket]);
+        }
+    }
+    fprintf(file, "\n");
+}
+
+void stats_catalog_print(FILE *file, stats_catalog_t *catalog)
+{
+    GS_REQUIRE_NONNULL(file);
+    GS_REQUIRE_NONNULL(catalog);
+    table_t *table = catalog->table;
+    grid_list_t *grids = atomic_load_explicit(&table->grid_ptrs, memory_order_acquire);
+    size_t ngrids = atomic_load_explicit(&grids->length, memory_order_acquire);
+    column_stats_t stats;
+
+    pthread_mutex_lock(&catalog->latch);
+    size_t nrefreshed = catalog->nrefreshed;
+    pthread_mutex_unlock(&catalog->latch);
+    fprintf(file, "# [STATS] table '%s': %zu grids, %zu rescans so far\n", table_name(table), ngrids, nrefreshed);
+
+    for (attr_id_t attr_id = 0; attr_id < table_num_of_attributes(table); attr_id++) {
+        for (grid_id_t grid_id = 0; grid_id < ngrids; grid_id++) {
+            if (stats_catalog_grid_column(&stats, catalog, grid_id, attr_id)) {
+                fprintf(file, "# [STATS] grid %zu, ", grid_id);
+                column_stats_print(file, table, &stats);
+            }
+        }
+        if (stats_catalog_column(&stats, catalog, attr_id)) {
+            fprintf(file, "# [STATS] table, ");
+            column_stats_print(file, table, &stats);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ bool column_add_grid(column_stats_t *out, vec_t *points, grid_t *grid)
+{
+    const attr_id_t *grid_attr_id = table_attr_id_to_frag_attr_id(grid, out->attr_id);
+    if (grid_attr_id == NULL) {
+        return false;
+    }
+
+    // Row and NULL counts are kept by the fragment, and are read optimistically
+    u64 pin = grid_pin(grid);
+    u64 version, nrows, nnulls;
+    do {
+        version = grid_read_begin(grid);
+        const frag_t *frag = grid->frag;
+        nrows = frag_num_of_live_tuplets(frag);
+        nnulls = min(frag_null_count(frag, *grid_attr_id), nrows);
+    } while (!grid_read_validate(grid, version));
+    grid_unpin(grid, pin);
+
+    u64 sample[GRID_STATS_SAMPLE_SIZE];
+    attr_sketch_t sketch = { .sample = sample };
+    grid_stats_snapshot(&sketch, &grid->stats, *grid_attr_id);
+
+    out->type = sketch.type;
+    out->ordered = sketch.ordered;
+    out->ngrids++;
+    out->nrows += nrows;
+    out->nnulls += nnulls;
+    out->nchanges += grid_stats_num_of_changes(&grid->stats);
+    hll_merge(&out->distinct, &sketch.distinct);
+    if (sketch.ordered && sketch.nsample > 0) {
+        // Each sampled key stands for the same share of the values of the grid, such that samples of grids of
+        // different sizes are merged in proportion
+        double weight = (double) (nrows - nnulls) / sketch.nsample;
+        for (size_t i = 0; i < sketch.nsample; i++) {
+            vec_pushback(points, 1, &(sample_point_t) { .key = sample[i], .weight = weight });
+        }
+    }
+    return true;
+}
+
+ void column_finish(column_stats_t *out, vec_t *points)
+{
+    out->histogram.nbuckets = 0;
+    if (out->ordered) {
+        histogram_build(&out->histogram, vec_begin(points), vec_length(points));
+    }
+}
+
+ void grid_rescan(grid_t *grid)
+{
+    // Fields changed after this point are possibly not seen by the rescan, and are left for the next one
+    u64 nchanges = grid_stats_num_of_changes(&grid->stats);
+
+    grid_stats_t fresh;
+    u64 pin = grid_pin(grid);
+    grid_stats_create(&fresh, grid->frag->schema);
+    grid_unpin(grid, pin);
+
+    size_t value_size = sizeof(const char *);
+    for (attr_id_t attr_id = 0; attr_id < fresh.nattrs; attr_id++) {
+        value_size = max(value_size, fresh.attrs[attr_id].size);
+    }
+    void *buffer = GS_REQUIRE_MALLOC(FRAG_VIEW_BATCH_SIZE * value_size);
+    for (tuplet_id_t begin = 0; rescan_block(&fresh, grid, begin, buffer); begin += STATS_CATALOG_BLOCK_SIZE);
+    free(buffer);
+
+    grid_stats_swap(&grid->stats, &fresh, nchanges);
+    grid_stats_dispose(&fresh);
+}
+
+ bool rescan_block(grid_stats_t *fresh, grid_t *grid, tuplet_id_t begin, void *buffer)
+{
+    // The latch keeps the fragment (and its strings) from being modified or replaced while the block is scanned. It is
+    // held in shared mode, since the scan only reads, such that readers that copy values proceed meanwhile.
+    grid_share_lock(grid);
+    frag_t *frag = grid->frag;
+    bool result = (begin < frag->ntuplets);
+    tuplet_id_t end = min(begin + STATS_CATALOG_BLOCK_SIZE, frag->ntuplets);
+    frag_column_cursor_t cursor;
+    frag_column_view_t view;
+
+    for (attr_id_t attr_id = 0; result && attr_id < fresh->nattrs; attr_id++) {
+        const attr_sketch_t *sketch = fresh->attrs + attr_id;
+        const attr_t *attr = frag_field_layout(frag, attr_id)->attr;
+        // Dictionary codes and string headers are decoded, see melt_run()
+        bool decode = (attr->flags.dict || attr->flags.varlen);
+
+        frag_column_open(&cursor, frag, attr_id, begin, end, FRAG_VIEW_BATCH_SIZE);
+        while (frag_column_next(&view, &cursor)) {
+            // Gather the non-null values of live tuplets into a dense array
+            size_t nvalues = 0;
+            for (size_t i = 0; i < view.count; i++) {
+                if (!frag_column_view_is_valid(&view, i)) {
+                    continue;
+                }
+                if (sketch->string && decode) {
+                    tuplet_t tuplet;
+                    tuplet_field_t field;
+                    tuplet_open(&tuplet, frag, view.begin + i);
+                    tuplet_field_seek(&field, &tuplet, attr_id);
+                    ((const char **) buffer)[nvalues++] = tuplet_field_read(&field);
+                } else if (sketch->string) {
+                    ((const char **) buffer)[nvalues++] = frag_column_view_at(&view, i);
+                } else {
+                    memcpy(buffer + nvalues++ * sketch->size, frag_column_view_at(&view, i), sketch->size);
+                }
+            }
+            grid_stats_add(fresh, attr_id, buffer, nvalues);
+        }
+        frag_column_close(&cursor);
+    }
+    grid_share_unlock(grid);
+    return result;
+}
+
+ void histogram_build(histogram_t *out, sample_point_t *points, size_t npoints)
+{
+    qsort(points, npoints, sizeof(sample_point_t), compare_points);
+    double total = 0;
+    for (size_t i = 0; i < npoints; i++) {
+        total += points[i].weight;
+    }
+
+    // A bucket is closed once it holds its share of the values, but equal keys are kept in the same bucket
+    out->nbuckets = 0;
+    size_t first = 0;
+    double depth = 0, sum = 0;
+    for (size_t i = 0, next; i < npoints; i = next) {
+        double weight = 0;
+        for (next = i; next < npoints && points[next].key == points[i].key; next++) {
+            weight += points[next].weight;
+        }
+        bool open = (out->nbuckets + 1 < STATS_CATALOG_BUCKETS);
+        // A frequent key gets a bucket of its own, such that its values are not spread over the keys of a wider one
+        if (first < i && open && weight >= total / STATS_CATALOG_BUCKETS) {
+            histogram_add(out, points[first].key, points[i - 1].key, depth);
+            first = i;
+            depth = 0;
+            open = (out->nbuckets + 1 < STATS_CATALOG_BUCKETS);
+        }
+        depth += weight;
+        sum += weight;
+        if (next == npoints || (open && sum >= total * (out->nbuckets + 1) / STATS_CATALOG_BUCKETS)) {
+            histogram_add(out, points[first].key, points[next - 1].key, depth);
+            first = next;
+            depth = 0;
+        }
+    }
+}
+
+ void histogram_add(histogram_t *histogram, u64 lower, u64 upper, double depth)
+{
+    histogram->lower[histogram->nbuckets] = lower;
+    histogram->upper[histogram->nbuckets] = upper;
+    histogram->depths[histogram->nbuckets++] = depth;
+}
+
+ double bucket_overlap(const column_stats_t *stats, size_t bucket, u64 from, u64 to)
+{
+    u64 lower = stats->histogram.lower[bucket];
+    u64 upper = stats->histogram.upper[bucket];
+    if (to < lower || from > upper) {
+        return 0;
+    } else if (lower == upper || (from <= lower && to >= upper)) {
+        return 1;
+    }
+    // Values are assumed to be spread uniformly between the bounds of a bucket, i.e., over the integers resp. the
+    // reals between these bounds
+    u64 begin = max(lower, from);
+    u64 end = min(upper, to);
+    if (stats->type == FT_FLOAT32 || stats->type == FT_FLOAT64) {
+        double width = column_stats_key_value(stats, upper) - column_stats_key_value(stats, lower);
+        return (width > 0 ? (column_stats_key_value(stats, end) - column_stats_key_value(stats, begin)) / width : 1);
+    } else return ((double) (end - begin) + 1) / ((double) (upper - lower) + 1);
+}
+
+ int compare_points(const void *lhs, const void *rhs)
+{
+    u64 a = ((const sample_point_t *) lhs)->key;
+    u64 b = ((const sample_point_t *) rhs)->key;
+    return (a > b) - (a < b);
+}
+
+ void *refresh_promise(promise_result *return_value, const void *capture)
+{
+    stats_catalog_t *catalog = (stats_catalog_t *) capture;
+    pthread_mutex_lock(&catalog->latch);
+    while (catalog->running) {
+        pthread_mutex_unlock(&catalog->latch);
+        stats_catalog_refresh(catalog, false);
+        pthread_mutex_lock(&catalog->latch);
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += catalog->interval_ms / 1000;
+        deadline.tv_nsec += (catalog->interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (catalog->running && pthread_cond_timedwait(&catalog->wakeup, &catalog->latch, &deadline) == 0);
+    }
+    pthread_mutex_unlock(&catalog->latch);
+    *return_value = resolved;
+    return NULL;
+}
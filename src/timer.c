@@ -32,5 +32,5 @@ void timer_stop(m_timer_t *timer)
 double timer_diff_ms(m_timer_t *timer)
 {
     assert (timer);
-    return (double)(timer->stop - timer->start) / CLOCKS_PER_SEC;
+    return (double)(timer->stop - timer->start) * 1000 / CLOCKS_PER_SEC;
 }
\ No newline at end of file
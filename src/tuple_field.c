@@ -19,8 +19,23 @@
 #include <grid.h>
 #include <schema.h>
 
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void field_reopen(tuple_field_t *field);
+ void field_unlatch(tuple_field_t *field);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N T E R F A C E  I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
 void tuple_field_open(tuple_field_t *field, tuple_t *tuple)
 {
+    field->step = (table_plan_step_t) { .grid = NULL };
+    field->latched = NULL;
+    field->value = NULL;
+    field->value_capacity = 0;
     tuple_field_seek(field, tuple, 0);
 }
 
@@ -28,38 +43,52 @@ void tuple_field_seek(tuple_field_t *tuple_field, tuple_t *tuple, attr_id_t tabl
 {
     GS_REQUIRE_NONNULL(tuple_field);
     GS_REQUIRE_NONNULL(tuple);
+    // Resolving the field reads the interval directory optimistically, which waits for writers
+    field_unlatch(tuple_field);
 
-    grid_cursor_t *cursor = table_find(tuple->table, &table_attr_id, 1, &tuple->tuple_id, 1);
-    REQUIRE_WARGS((grid_cursor_numelem(cursor) == 1),
-                  "Internal error: tuple_field [tuple #%d @ '%s'] is covered by %zu grids. Must be covered by "
-                  "exactly one grid instead.", tuple->tuple_id, table_attr_by_id(tuple->table,
-                                                                                 table_attr_id)->name,
-                  grid_cursor_numelem(cursor));
-    grid_t *grid = grid_cursor_next(cursor);
-
-    tuplet_open(&tuple_field->tuplet, grid->frag, global_to_local(grid, tuple->tuple_id, AT_RANDOM));
+    // Reuse the grid of the previous seek if it serves this tuple and covers the attribute; otherwise resolve the
+    // field via the grid directory of the table (no index query required)
+    table_plan_step_t *step = &tuple_field->step;
+    const attr_id_t *grid_attr_id = NULL;
+    if (table_plan_step_covers(step, tuple->table, tuple->tuple_id)) {
+        grid_attr_id = table_attr_id_to_frag_attr_id(step->grid, table_attr_id);
+    }
+    if (grid_attr_id == NULL) {
+        bool covered = table_plan_step_resolve(step, tuple->table, table_attr_id, tuple->tuple_id);
+        REQUIRE_WARGS(covered, "Internal error: tuple_field [tuple #%d @ '%s'] is not covered by any grid.",
+                      tuple->tuple_id, table_attr_by_id(tuple->table, table_attr_id)->name);
+        grid_attr_id = &step->grid_attr_id;
+    }
+    table_plan_step_touch(step, tuple->tuple_id);
 
-    attr_id_t grid_attr_id = *table_attr_id_to_frag_attr_id(grid, table_attr_id);
+    u64 pin = grid_pin(step->grid);
+    tuplet_open(&tuple_field->tuplet, step->grid->frag, table_plan_step_tuplet(step, tuple->tuple_id));
 
     tuplet_field_t tuplet_field;
-    tuplet_field_seek(&tuplet_field, &tuple_field->tuplet, grid_attr_id);
+    tuplet_field_seek(&tuplet_field, &tuple_field->tuplet, *grid_attr_id);
+    grid_unpin(step->grid, pin);
 
     tuple_field->tuple = tuple;
     tuple_field->table_attr_id = table_attr_id;
-    tuple_field->grid_attr_id = grid_attr_id;
-    tuple_field->grid = grid;
+    tuple_field->grid_attr_id = *grid_attr_id;
+    tuple_field->grid = step->grid;
     tuple_field->tuplet_field = tuplet_field;
-
-    grid_cursor_delete(cursor);
+    tuple_field->epoch = pin;
 }
 
 void tuple_field_next(tuple_field_t *field)
 {
     const attr_id_t *attr_id = table_attr_id_to_frag_attr_id(field->grid, ++field->table_attr_id);
     if (attr_id) {
+        u64 pin = grid_pin(field->grid);
+        field_reopen(field);
         tuplet_field_seek(&field->tuplet_field, &field->tuplet, *attr_id);
+        grid_unpin(field->grid, pin);
+        field->grid_attr_id = *attr_id;
+        table_plan_step_touch(&field->step, field->tuple->tuple_id);
     } else {
         // next tuple field is in another tuplet (i.e., requires to search the other grid)
+        field_unlatch(field);
         if (field->table_attr_id < field->grid->context->schema->attr->num_elements) {
             // there are is at least one attribute in the table schema left that is covered by some grid, so proceed.
             tuple_field_seek(field, field->tuple, field->table_attr_id);
@@ -69,11 +98,72 @@ void tuple_field_next(tuple_field_t *field)
 
 void tuple_field_write(tuple_field_t *field, const void *data)
 {
+    // Writers hold the grid latch, such that a write is not lost by a concurrent conversion of the grid's fragment. The
+    // latch is kept while the following attributes of the tuple are in the same grid.
+    grid_t *grid = (grid_t *) field->grid;
+    if (field->latched != grid) {
+        field_unlatch(field);
+        grid_write_lock(grid);
+        field->latched = grid;
+    }
+    field_reopen(field);
     tuplet_field_write(&field->tuplet_field, data, false);
+    grid_stats_add(&grid->stats, field->grid_attr_id, data, 1);
     tuple_field_next(field);
 }
 
 const void *tuple_field_read(tuple_field_t *field)
 {
-    return tuplet_field_read(&field->tuplet_field);
-}
\ No newline at end of file
+    GS_REQUIRE_NONNULL(field);
+    field_unlatch(field);
+    // A pin would keep the fragment, but not the string heap or dictionaries that writers replace in place
+    grid_share_lock(field->grid);
+    field_reopen(field);
+    const attr_t *attr = table_attr_by_id(field->grid->context, field->table_attr_id);
+    const void *value = tuplet_field_read(&field->tuplet_field);
+    size_t size = (attr->flags.dict || attr->flags.varlen ? strlen(value) + 1 : attr_value_size(attr));
+    void *result = field->inline_value.bytes;
+    if (size > TUPLE_FIELD_INLINE_SIZE) {
+        if (size > field->value_capacity) {
+            free(field->value);
+            field->value_capacity = max(size, 2 * field->value_capacity);
+            field->value = GS_REQUIRE_MALLOC(field->value_capacity);
+        }
+        result = field->value;
+    }
+    memcpy(result, value, size);
+    grid_share_unlock(field->grid);
+    return result;
+}
+
+void tuple_field_close(tuple_field_t *field)
+{
+    GS_REQUIRE_NONNULL(field);
+    field_unlatch(field);
+    free(field->value);
+    field->value = NULL;
+    field->value_capacity = 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   I M P L E M E N T A T I O N
+// ---------------------------------------------------------------------------------------------------------------------
+
+ void field_reopen(tuple_field_t *field)
+{
+    // The tuplet of the field refers to a replaced fragment if the grid was converted since the field was opened
+    u64 epoch = atomic_load(&field->grid->readers.epoch);
+    if (field->epoch != epoch) {
+        tuplet_open(&field->tuplet, field->grid->frag, field->tuplet.tuplet_id);
+        tuplet_field_seek(&field->tuplet_field, &field->tuplet, field->grid_attr_id);
+        field->epoch = epoch;
+    }
+}
+
+ void field_unlatch(tuple_field_t *field)
+{
+    if (field->latched != NULL) {
+        grid_write_unlock(field->latched);
+        field->latched = NULL;
+    }
+}
@@ -49,6 +49,19 @@ void tuplet_set_null(tuplet_t *tuplet)
     tuplet->_set_null(tuplet);
 }
 
+void tuplet_delete(tuplet_t *tuplet)
+{
+    GS_REQUIRE_NONNULL(tuplet);
+    GS_REQUIRE_NONNULL(tuplet->_delete);
+    tuplet->_delete(tuplet);
+}
+
+bool tuplet_is_deleted(tuplet_t *tuplet)
+{
+    GS_REQUIRE_NONNULL(tuplet);
+    return frag_is_deleted(tuplet->fragment, tuplet->tuplet_id);
+}
+
 bool tuplet_is_null(tuplet_t *tuplet)
 {
     GS_REQUIRE_NONNULL(tuplet);
@@ -90,6 +103,7 @@ const char *tuplet_format_str(enum tuplet_format format)
     switch (format) {
         case TF_NSM: return "row";
         case TF_DSM: return "column";
+        case TF_PAX: return "hybrid";
         default: perror("Unknown tuple format"); abort();
     }
 }
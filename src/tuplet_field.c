@@ -74,9 +74,9 @@ void tuplet_field_seek(tuplet_field_t *dst, tuplet_t *tuplet, attr_id_t attr_id)
 size_t tuplet_field_size(tuplet_field_t *field)
 {
     assert (field);
-    panic_if((field->attr_id >= field->tuplet->fragment->schema->attr->num_elements), BADBOUNDS, "attribute tuplet_id invalid");
-    const attr_t *attr = schema_attr_by_id(field->tuplet->fragment->schema, field->attr_id);
-    return (attr_total_size(attr));
+    const frag_layout_t *layout = field->tuplet->fragment->layout;
+    panic_if((field->attr_id >= layout->nattrs), BADBOUNDS, "attribute tuplet_id invalid");
+    return layout->fields[field->attr_id].size;
 }
 
 enum field_type tuplet_field_get_type(const tuplet_field_t *field)
@@ -0,0 +1,119 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      1000
+#define NUM_DELETED     10
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+u64 read_step(const table_plan_step_t *step, tuple_id_t tuple_id);
+void check_plan(table_plan_t *plan, tuple_id_t begin, tuple_id_t end);
+
+// Resolves fields of a table whose attributes and tuples are split over several grids through an access plan, and
+// checks that the plan serves every field from the right grid and tuplet, also after grids are added or compacted.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint64("b", schema);
+    attr_create_uint64("c", schema);
+    table_t *table = table_new(schema, 4);
+    attr_id_t left[] = { 0, 1 }, right[] = { 2 };
+    tuple_id_interval_t even[] = { { 0, 250 }, { 500, 750 } }, odd[] = { { 250, 500 }, { 750, 1000 } };
+    tuple_id_interval_t all = { 0, NUM_TUPLES };
+    table_add(table, left, 2, even, 2, FIT_HOST_NSM_VM);
+    table_add(table, left, 2, odd, 2, FIT_HOST_DSM_VM);
+    table_add(table, right, 1, &all, 1, FIT_HOST_PAX_VM);
+
+    u64 *values[3];
+    for (size_t i = 0; i < 3; i++) {
+        values[i] = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+        for (size_t j = 0; j < NUM_TUPLES; j++) {
+            values[i][j] = 10 * j + i;
+        }
+    }
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 0, values[0], NUM_TUPLES }, { 1, values[1], NUM_TUPLES },
+                                 { 2, values[2], NUM_TUPLES } };
+    table_insert_columns(&cursor, table, columns, 3);
+    tuple_cursor_dispose(&cursor);
+
+    // Attributes are planned in a different order than in the table schema
+    attr_id_t attr_ids[] = { 2, 0, 1 };
+    table_plan_t *plan = table_plan_new(table, attr_ids, 3);
+    check_plan(plan, 0, NUM_TUPLES);
+
+    // A step serves the whole run of tuples that is mapped to consecutive tuplets
+    const table_plan_step_t *step = table_plan_seek(plan, 1, 300);
+    TEST_CHECK_EQ(step->tuples.begin, 250);
+    TEST_CHECK_EQ(step->tuples.end, 500);
+    TEST_CHECK_EQ(table_plan_step_tuplet(step, 300), 50);
+
+    // Compaction changes the tuplets that store the remaining tuples, which invalidates resolved steps
+    tuple_id_t deleted[NUM_DELETED];
+    for (size_t i = 0; i < NUM_DELETED; i++) {
+        deleted[i] = 100 + i;
+    }
+    size_t version = table->grid_set_version;
+    table_delete_tuples(table, deleted, NUM_DELETED);
+    table_compact(table, 0.0f);
+    TEST_CHECK(table->grid_set_version != version);
+    check_plan(plan, 0, 100);
+    check_plan(plan, 100 + NUM_DELETED, NUM_TUPLES);
+    step = table_plan_seek(plan, 0, 120);
+    TEST_CHECK_EQ(table_plan_step_tuplet(step, 120), 120 - NUM_DELETED);
+
+    table_plan_delete(plan);
+    for (size_t i = 0; i < 3; i++) {
+        free(values[i]);
+    }
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+u64 read_step(const table_plan_step_t *step, tuple_id_t tuple_id)
+{
+    tuplet_t tuplet;
+    tuplet_field_t field;
+    tuplet_open(&tuplet, step->grid->frag, table_plan_step_tuplet(step, tuple_id));
+    tuplet_field_seek(&field, &tuplet, step->grid_attr_id);
+    return *(const u64 *) tuplet_field_read(&field);
+}
+
+void check_plan(table_plan_t *plan, tuple_id_t begin, tuple_id_t end)
+{
+    for (tuple_id_t tuple_id = begin; tuple_id < end; tuple_id++) {
+        for (size_t attr_idx = 0; attr_idx < plan->nattr_ids; attr_idx++) {
+            const table_plan_step_t *step = table_plan_seek(plan, attr_idx, tuple_id);
+            TEST_CHECK(table_plan_step_covers(step, plan->table, tuple_id));
+            TEST_CHECK_EQ(read_step(step, tuple_id), 10 * tuple_id + plan->attr_ids[attr_idx]);
+        }
+    }
+}
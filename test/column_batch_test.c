@@ -0,0 +1,124 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      300
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+const void *read_field(table_t *table, tuple_id_t tuple_id, attr_id_t attr_id);
+
+// Inserts and updates a table column by column, where each column is spread over several grids of different types,
+// and reads the values back tuple by tuple. Strings that exceed a fixed-size attribute are rejected.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_ex("s", FT_CHAR, 32, FLAG_VARLEN, schema);
+    attr_create_string("c", 8, schema);
+
+    table_t *table = table_new(schema, 4);
+    attr_id_t left[] = { 0, 2 }, right[] = { 1, 3 };
+    tuple_id_interval_t outer[] = { { 0, 100 }, { 200, 300 } }, inner[] = { { 100, 200 } };
+    table_add(table, left, 2, outer, 2, FIT_HOST_DSM_VM);
+    table_add(table, right, 2, outer, 2, FIT_HOST_NSM_VM);
+    table_add(table, left, 2, inner, 1, FIT_HOST_PAX_VM);
+    table_add(table, right, 2, inner, 1, FIT_HOST_NSM_SEG);
+
+    u64 *a = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+    u32 *b = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u32));
+    const char **s = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(char *));
+    const char **c = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(char *));
+    char (*strings)[32] = GS_REQUIRE_MALLOC(NUM_TUPLES * 32);
+    for (size_t i = 0; i < NUM_TUPLES; i++) {
+        a[i] = 3 * i;
+        b[i] = i + 7;
+        snprintf(strings[i], 32, (i % 2 ? "short %zu" : "a longer string %zu"), i);
+        s[i] = strings[i];
+        c[i] = (i % 3 ? "x" : "seven");
+    }
+
+    // Columns are given in any order
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 2, s, NUM_TUPLES }, { 0, a, NUM_TUPLES }, { 3, c, NUM_TUPLES },
+                                 { 1, b, NUM_TUPLES } };
+    table_insert_columns(&cursor, table, columns, 4);
+    for (size_t i = 0; i < NUM_TUPLES; i++) {
+        tuple_id_t tuple_id = cursor.tuple_ids[i];
+        TEST_CHECK_EQ(tuple_id, i);
+        TEST_CHECK_EQ(*(const u64 *) read_field(table, tuple_id, 0), 3 * i);
+        TEST_CHECK_EQ(*(const u32 *) read_field(table, tuple_id, 1), i + 7);
+        TEST_CHECK(strcmp(read_field(table, tuple_id, 2), strings[i]) == 0);
+        TEST_CHECK(strcmp(read_field(table, tuple_id, 3), c[i]) == 0);
+    }
+    tuple_cursor_dispose(&cursor);
+
+    // Updates touch the given tuples and columns only, across grid boundaries
+    tuple_id_t updated[] = { 5, 99, 100, 150, 299 };
+    u64 new_a[5];
+    const char *new_s[5];
+    for (size_t i = 0; i < 5; i++) {
+        new_a[i] = 1000 + i;
+        new_s[i] = "updated";
+    }
+    table_column_t updates[] = { { 0, new_a, 5 }, { 2, new_s, 5 } };
+    table_update_columns(table, updated, 5, updates, 2);
+    for (size_t i = 0; i < 5; i++) {
+        TEST_CHECK_EQ(*(const u64 *) read_field(table, updated[i], 0), 1000 + i);
+        TEST_CHECK_EQ(*(const u32 *) read_field(table, updated[i], 1), updated[i] + 7);
+        TEST_CHECK(strcmp(read_field(table, updated[i], 2), "updated") == 0);
+    }
+    TEST_CHECK_EQ(*(const u64 *) read_field(table, 6, 0), 18);
+
+    // A string does not fit into a fixed-size slot that lacks the space for its terminator
+    tuple_id_t first = 0;
+    const char *overlong[] = { "eight ch" };
+    table_column_t overflow = { 3, overlong, 1 };
+    TEST_CHECK_PANICS(table_update_columns(table, &first, 1, &overflow, 1));
+    TEST_CHECK(strcmp(read_field(table, 0, 3), "seven") == 0);
+
+    free(a);
+    free(b);
+    free(s);
+    free(c);
+    free(strings);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+const void *read_field(table_t *table, tuple_id_t tuple_id, attr_id_t attr_id)
+{
+    static tuple_t tuple;
+    static tuple_field_t field;
+    tuple_open(&tuple, table, tuple_id);
+    tuple_field_open(&field, &tuple);
+    tuple_field_seek(&field, &tuple, attr_id);
+    return tuple_field_read(&field);
+}
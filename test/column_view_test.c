@@ -0,0 +1,110 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     150000
+#define RANGE_BEGIN     3
+#define RANGE_END       (NUM_TUPLETS - 5)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void scan_column(frag_t *frag, attr_id_t attr_id, size_t batch_size, const void *expected, size_t value_size);
+
+// Scans columns of every fragment type through column views in different batch sizes, and checks that batches cover
+// the requested range in order, that every value is at its tuplet, and that NULL and deleted fields are invalid.
+int main(void) {
+    enum frag_impl_type_t types[] = {
+        FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM, FIT_HOST_NSM_SEG, FIT_HOST_NSM_MMAP
+    };
+    size_t batch_sizes[] = { 1024, 1000, 1 };
+
+    u32 *a = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(u32));
+    s64 *b = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(s64));
+    u16 *c = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(u16));
+    for (size_t i = 0; i < NUM_TUPLETS; i++) {
+        a[i] = i % 977;
+        b[i] = (s64) i - 5000;
+        c[i] = i % 13;
+    }
+
+    for (size_t k = 0; k < ARRAY_LEN_OF(types); k++) {
+        schema_t *schema = schema_new("test");
+        attr_create_uint32("a", schema);
+        attr_create_ex("b", FT_INT64, 1, FLAG_NULLABLE, schema);
+        attr_create_uint16("c", schema);
+        frag_t *frag = frag_new(schema, 16, types[k]);
+        frag_insert(NULL, frag, NUM_TUPLETS);
+        frag_write_column(frag, 0, 0, NUM_TUPLETS, a);
+        frag_write_column(frag, 1, 0, NUM_TUPLETS, b);
+        frag_write_column(frag, 2, 0, NUM_TUPLETS, c);
+        for (size_t i = 0; i < NUM_TUPLETS; i += 7) {
+            frag_set_null(frag, i, 1);
+        }
+        for (size_t i = 0; i < NUM_TUPLETS; i += 11) {
+            frag_tuplet_delete(frag, i);
+        }
+
+        // Compressed DSM columns are decoded block-wise into the cursor buffer
+        frag_compress(frag);
+
+        for (size_t i = 0; i < ARRAY_LEN_OF(batch_sizes); i++) {
+            scan_column(frag, 0, batch_sizes[i], a, sizeof(u32));
+            scan_column(frag, 1, batch_sizes[i], b, sizeof(s64));
+            scan_column(frag, 2, batch_sizes[i], c, sizeof(u16));
+        }
+        frag_delete(frag);
+        schema_delete(schema);
+    }
+
+    free(a);
+    free(b);
+    free(c);
+    return EXIT_SUCCESS;
+}
+
+void scan_column(frag_t *frag, attr_id_t attr_id, size_t batch_size, const void *expected, size_t value_size)
+{
+    frag_column_cursor_t cursor;
+    frag_column_view_t view;
+    tuplet_id_t next = RANGE_BEGIN;
+    frag_column_open(&cursor, frag, attr_id, RANGE_BEGIN, RANGE_END, batch_size);
+    while (frag_column_next(&view, &cursor)) {
+        TEST_CHECK_EQ(view.begin, next);
+        TEST_CHECK(view.count > 0 && view.count <= batch_size);
+        for (size_t i = 0; i < view.count; i++) {
+            tuplet_id_t tuplet_id = view.begin + i;
+            bool valid = (tuplet_id % 11 != 0) && (attr_id != 1 || tuplet_id % 7 != 0);
+            TEST_CHECK_EQ(frag_column_view_is_valid(&view, i), valid);
+            if (valid) {
+                TEST_CHECK(memcmp(frag_column_view_at(&view, i), expected + tuplet_id * value_size, value_size) == 0);
+            }
+        }
+        next += view.count;
+    }
+    frag_column_close(&cursor);
+    TEST_CHECK_EQ(next, RANGE_END);
+}
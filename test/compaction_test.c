@@ -0,0 +1,203 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+table_t *create_table(schema_t *schema, size_t ntuples, bool split);
+void insert_rows(table_t *table, size_t ntuples, u64 base, tuple_id_t *tuple_ids);
+u64 read_value(table_t *table, tuple_id_t tuple_id, attr_id_t attr_id);
+void test_single_grid();
+void test_split_grids();
+void test_emptied_grid();
+
+// Deletes tuples, compacts the grids and inserts again, both for a table that consists of a single grid and for a
+// table whose attributes are split across two grids. Finally, compacts a grid whose tuples are all deleted.
+int main(void) {
+    test_single_grid();
+    test_split_grids();
+    test_emptied_grid();
+    return EXIT_SUCCESS;
+}
+
+table_t *create_table(schema_t *schema, size_t ntuples, bool split)
+{
+    table_t *table = table_new(schema, 4);
+    attr_id_t all[] = { 0, 1, 2 }, left[] = { 0 }, right[] = { 1, 2 };
+    tuple_id_interval_t tuple_ids = { 0, ntuples };
+    if (split) {
+        table_add(table, left, 1, &tuple_ids, 1, FIT_HOST_NSM_VM);
+        table_add(table, right, 2, &tuple_ids, 1, FIT_HOST_DSM_VM);
+    } else {
+        table_add(table, all, 3, &tuple_ids, 1, FIT_HOST_DSM_VM);
+    }
+    return table;
+}
+
+void insert_rows(table_t *table, size_t ntuples, u64 base, tuple_id_t *tuple_ids)
+{
+    tuple_cursor_t cursor;
+    tuple_t tuple;
+    grid_insert(&cursor, table, ntuples);
+    for (size_t i = 0; tuple_cursor_next(&tuple, &cursor); i++) {
+        tuple_field_t field;
+        u64 a = base + i;
+        u32 b = 2 * (base + i), c = 3 * (base + i);
+        tuple_field_open(&field, &tuple);
+        tuple_field_write(&field, &a);
+        tuple_field_write(&field, &b);
+        tuple_field_write(&field, &c);
+        if (tuple_ids != NULL) {
+            tuple_ids[i] = tuple.tuple_id;
+        }
+    }
+    tuple_cursor_dispose(&cursor);
+}
+
+u64 read_value(table_t *table, tuple_id_t tuple_id, attr_id_t attr_id)
+{
+    tuple_t tuple;
+    tuple_field_t field;
+    tuple_open(&tuple, table, tuple_id);
+    tuple_field_open(&field, &tuple);
+    tuple_field_seek(&field, &tuple, attr_id);
+    return (attr_id == 0 ? *(const u64 *) tuple_field_read(&field) : *(const u32 *) tuple_field_read(&field));
+}
+
+void test_single_grid()
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_uint32("c", schema);
+
+    // The grid covers more tuples than inserted (all of them have a tuplet), hence inserts after compaction stay in it
+    table_t *table = create_table(schema, 64, false);
+    insert_rows(table, 10, 0, NULL);
+    tuple_id_t deleted[] = { 1, 2, 3 };
+    table_delete_tuples(table, deleted, 3);
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 0)->frag), 3);
+
+    table_compact(table, 0.0f);
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 0)->frag), 0);
+    TEST_CHECK_EQ(grid_by_id(table, 0)->frag->ntuplets, 64 - 3);
+    for (tuple_id_t tuple_id = 4; tuple_id < 10; tuple_id++) {
+        TEST_CHECK_EQ(read_value(table, tuple_id, 0), tuple_id);
+        TEST_CHECK_EQ(read_value(table, tuple_id, 2), 3 * tuple_id);
+    }
+
+    // Identifiers of removed tuples are not bound again, since no grid covers them anymore
+    tuple_id_t inserted[3];
+    insert_rows(table, 3, 100, inserted);
+    for (size_t i = 0; i < 3; i++) {
+        TEST_CHECK(inserted[i] >= 10);
+        TEST_CHECK_EQ(read_value(table, inserted[i], 0), 100 + i);
+        TEST_CHECK_EQ(read_value(table, inserted[i], 1), 2 * (100 + i));
+    }
+
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+}
+
+void test_split_grids()
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_uint32("c", schema);
+
+    table_t *table = create_table(schema, 60, true);
+    insert_rows(table, 60, 0, NULL);
+    tuple_id_t deleted[] = { 53, 54, 55 };
+    table_delete_tuples(table, deleted, 3);
+    for (grid_id_t grid_id = 0; grid_id < 2; grid_id++) {
+        TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, grid_id)->frag), 3);
+    }
+
+    table_compact(table, 0.0f);
+    for (grid_id_t grid_id = 0; grid_id < 2; grid_id++) {
+        TEST_CHECK_EQ(grid_by_id(table, grid_id)->frag->ntuplets, 60 - 3);
+    }
+    for (tuple_id_t tuple_id = 50; tuple_id < 60; tuple_id++) {
+        if (tuple_id < 53 || tuple_id > 55) {
+            TEST_CHECK_EQ(read_value(table, tuple_id, 0), tuple_id);
+            TEST_CHECK_EQ(read_value(table, tuple_id, 1), 2 * tuple_id);
+        }
+    }
+
+    // New tuples are covered by a grid that is added for them, and never take the place of removed ones
+    attr_id_t all[] = { 0, 1, 2 };
+    tuple_id_interval_t tuple_ids = { 60, 70 };
+    table_add(table, all, 3, &tuple_ids, 1, FIT_HOST_NSM_VM);
+    tuple_id_t inserted[10];
+    insert_rows(table, 10, 200, inserted);
+    for (size_t i = 0; i < 10; i++) {
+        TEST_CHECK_EQ(inserted[i], 60 + i);
+        TEST_CHECK_EQ(read_value(table, inserted[i], 0), 200 + i);
+        TEST_CHECK_EQ(read_value(table, inserted[i], 2), 3 * (200 + i));
+    }
+
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+}
+
+void test_emptied_grid()
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_uint32("c", schema);
+
+    table_t *table = table_new(schema, 4);
+    attr_id_t all[] = { 0, 1, 2 };
+    tuple_id_interval_t lower = { 0, 10 }, upper = { 10, 20 };
+    table_add(table, all, 3, &lower, 1, FIT_HOST_NSM_VM);
+    table_add(table, all, 3, &upper, 1, FIT_HOST_DSM_VM);
+    insert_rows(table, 20, 0, NULL);
+
+    // Compaction removes all tuples of the first grid, which then covers no tuple anymore
+    tuple_id_t deleted[10];
+    for (size_t i = 0; i < 10; i++) {
+        deleted[i] = i;
+    }
+    table_delete_tuples(table, deleted, 10);
+    TEST_CHECK_EQ(table_compact(table, 0.0f), 10);
+    TEST_CHECK_EQ(grid_by_id(table, 0)->frag->ntuplets, 0);
+    for (tuple_id_t tuple_id = 10; tuple_id < 20; tuple_id++) {
+        TEST_CHECK_EQ(read_value(table, tuple_id, 0), tuple_id);
+        TEST_CHECK_EQ(read_value(table, tuple_id, 2), 3 * tuple_id);
+    }
+
+    // The emptied grid is skipped by later deletions and compactions
+    tuple_id_t more[] = { 15 };
+    table_delete_tuples(table, more, 1);
+    TEST_CHECK_EQ(table_compact(table, 0.0f), 1);
+    TEST_CHECK_EQ(read_value(table, 16, 0), 16);
+
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+}
@@ -0,0 +1,192 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <grid.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_GRID_TUPLES 4096
+#define NUM_GRIDS       5
+#define NUM_ADDED       40
+#define ADDED_TUPLES    256
+#define NUM_ROUNDS      20
+#define NUM_DELETED     16
+
+#define ADDED_BEGIN     (NUM_GRIDS * NUM_GRID_TUPLES)
+#define DELETED_BEGIN   ((NUM_GRIDS - 1) * NUM_GRID_TUPLES)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void write_range(table_t *table, tuple_id_t begin, size_t ntuples, bool update);
+void *scan(void *table);
+void *update(void *table);
+void *add(void *table);
+void *delete(void *table);
+
+// Scans a table by melting and by windows, while other threads update tuples, add grids, and delete and compact
+// tuples in other grids. Readers must see every value as written, since each writer stores the same values again.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    table_t *table = table_new(schema, 8);
+    attr_id_t attr_ids[] = { 0, 1 };
+    for (size_t i = 0; i < NUM_GRIDS; i++) {
+        tuple_id_interval_t interval = { i * NUM_GRID_TUPLES, (i + 1) * NUM_GRID_TUPLES };
+        table_add(table, attr_ids, 2, &interval, 1, (i % 2 ? FIT_HOST_DSM_VM : FIT_HOST_NSM_VM));
+    }
+    write_range(table, 0, ADDED_BEGIN, false);
+
+    pthread_t threads[6];
+    void *(*workers[])(void *) = { scan, scan, update, update, add, delete };
+    for (size_t i = 0; i < ARRAY_LEN_OF(workers); i++) {
+        pthread_create(threads + i, NULL, workers[i], table);
+    }
+    for (size_t i = 0; i < ARRAY_LEN_OF(workers); i++) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_CHECK_EQ(table_num_of_grids(table), NUM_GRIDS + NUM_ADDED);
+
+    // Values written into added grids are readable afterwards
+    for (tuple_id_t tuple_id = ADDED_BEGIN; tuple_id < ADDED_BEGIN + NUM_ADDED * ADDED_TUPLES; tuple_id++) {
+        tuple_t tuple;
+        tuple_field_t field;
+        tuple_open(&tuple, table, tuple_id);
+        tuple_field_open(&field, &tuple);
+        TEST_CHECK_EQ(*(const u64 *) tuple_field_read(&field), tuple_id);
+    }
+
+    // Deletes group the tuples by grid, regardless of their order, and reject tuples that no grid covers
+    tuple_id_t deleted[] = { 3 * NUM_GRID_TUPLES + 5, 7, 2 * NUM_GRID_TUPLES, 3 * NUM_GRID_TUPLES + 4, 8 };
+    table_delete_tuples(table, deleted, ARRAY_LEN_OF(deleted));
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 0)->frag), 2);
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 1)->frag), 0);
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 2)->frag), 1);
+    TEST_CHECK_EQ(frag_num_of_deleted(grid_by_id(table, 3)->frag), 2);
+    tuple_id_t uncovered = DELETED_BEGIN;
+    TEST_CHECK_PANICS(table_delete_tuples(table, &uncovered, 1));
+
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+void write_range(table_t *table, tuple_id_t begin, size_t ntuples, bool update)
+{
+    tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(ntuples * sizeof(tuple_id_t));
+    u64 *a = GS_REQUIRE_MALLOC(ntuples * sizeof(u64));
+    u32 *b = GS_REQUIRE_MALLOC(ntuples * sizeof(u32));
+    for (size_t i = 0; i < ntuples; i++) {
+        tuple_ids[i] = begin + i;
+        a[i] = begin + i;
+        b[i] = (begin + i) * 3;
+    }
+    table_column_t columns[] = { { 0, a, ntuples }, { 1, b, ntuples } };
+    if (update) {
+        table_update_columns(table, tuple_ids, ntuples, columns, 2);
+    } else {
+        tuple_cursor_t cursor;
+        table_insert_columns(&cursor, table, columns, 2);
+        tuple_cursor_dispose(&cursor);
+    }
+    free(tuple_ids);
+    free(a);
+    free(b);
+}
+
+void *scan(void *table)
+{
+    size_t ntuples = 2 * NUM_GRID_TUPLES;
+    tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(ntuples * sizeof(tuple_id_t));
+    for (size_t i = 0; i < ntuples; i++) {
+        tuple_ids[i] = NUM_GRID_TUPLES + i;
+    }
+    attr_id_t attr_ids[] = { 0, 1 };
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        table_t *molten = table_melt(FIT_HOST_DSM_VM, table, tuple_ids, ntuples, attr_ids, 2);
+        tuplet_t tuplet;
+        tuplet_open(&tuplet, grid_by_id(molten, 0)->frag, 0);
+        do {
+            tuplet_field_t field;
+            tuplet_field_open(&field, &tuplet);
+            TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuple_ids[tuplet.tuplet_id]);
+            tuplet_field_next(&field, false);
+            TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), tuple_ids[tuplet.tuplet_id] * 3);
+        } while (tuplet_next(&tuplet));
+        table_delete(molten);
+        free(molten);
+
+        table_window_t window;
+        tuple_id_t tuple_id;
+        size_t nrows = 0;
+        table_window_open(&window, table, attr_ids, 2, 100, 500);
+        while (table_window_next(&window, &tuple_id)) {
+            TEST_CHECK_EQ(*(const u64 *) table_window_read(&window, 0), tuple_id);
+            TEST_CHECK_EQ(*(const u32 *) table_window_read(&window, 1), tuple_id * 3);
+            nrows++;
+        }
+        table_window_close(&window);
+        TEST_CHECK_EQ(nrows, 500);
+    }
+    free(tuple_ids);
+    return NULL;
+}
+
+void *update(void *table)
+{
+    static atomic_uint next_grid = 1;
+    tuple_id_t begin = atomic_fetch_add(&next_grid, 1) * NUM_GRID_TUPLES;
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        write_range(table, begin, NUM_GRID_TUPLES, true);
+    }
+    return NULL;
+}
+
+void *add(void *table)
+{
+    attr_id_t attr_ids[] = { 0, 1 };
+    for (size_t i = 0; i < NUM_ADDED; i++) {
+        tuple_id_interval_t interval = { ADDED_BEGIN + i * ADDED_TUPLES, ADDED_BEGIN + (i + 1) * ADDED_TUPLES };
+        table_add(table, attr_ids, 2, &interval, 1, (i % 2 ? FIT_HOST_NSM_VM : FIT_HOST_PAX_VM));
+        write_range(table, interval.begin, ADDED_TUPLES, true);
+    }
+    return NULL;
+}
+
+void *delete(void *table)
+{
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuple_id_t tuple_ids[NUM_DELETED];
+        for (size_t i = 0; i < NUM_DELETED; i++) {
+            tuple_ids[i] = DELETED_BEGIN + round * NUM_DELETED + i;
+        }
+        table_delete_tuples(table, tuple_ids, NUM_DELETED);
+        table_compact(table, 0.0f);
+    }
+    return NULL;
+}
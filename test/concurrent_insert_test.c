@@ -0,0 +1,144 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <grid.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include <containers/id_allocator.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_THREADS     8
+#define NUM_ROUNDS      40
+#define MAX_BATCH       100
+#define THREAD_TUPLES   (NUM_ROUNDS * (MAX_BATCH + 1) / 2)
+#define NUM_TUPLES      (NUM_THREADS * THREAD_TUPLES)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void check_allocator(void);
+void *insert(void *arg);
+
+typedef struct producer_t {
+    table_t *table;
+    size_t thread_id;
+    tuple_id_t tuple_ids[THREAD_TUPLES];
+} producer_t;
+
+// Inserts tuples into a single grid from several threads at once. Since identifiers are bound without gaps, a grid
+// that covers [0, n) serves all n tuples, and each tuple holds the value written by the thread that inserted it.
+int main(void) {
+    check_allocator();
+
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    table_t *table = table_new(schema, 1);
+    attr_id_t attr_ids[] = { 0, 1 };
+    tuple_id_interval_t interval = { 0, NUM_TUPLES };
+    table_add(table, attr_ids, 2, &interval, 1, FIT_HOST_NSM_VM);
+
+    pthread_t threads[NUM_THREADS];
+    producer_t *producers = GS_REQUIRE_MALLOC(NUM_THREADS * sizeof(producer_t));
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        producers[i] = (producer_t) { .table = table, .thread_id = i };
+        pthread_create(threads + i, NULL, insert, producers + i);
+    }
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_CHECK_EQ(id_allocator_high_water(table_id_allocator(table)), NUM_TUPLES);
+
+    bitmap_word_t *seen = bitmap_new(NUM_TUPLES, false);
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        for (size_t j = 0; j < THREAD_TUPLES; j++) {
+            tuple_id_t tuple_id = producers[i].tuple_ids[j];
+            TEST_CHECK(tuple_id < NUM_TUPLES && !bitmap_test(seen, tuple_id));
+            bitmap_set(seen, tuple_id);
+
+            tuple_t tuple;
+            tuple_field_t field;
+            tuple_open(&tuple, table, tuple_id);
+            tuple_field_open(&field, &tuple);
+            TEST_CHECK_EQ(*(const u64 *) tuple_field_read(&field), i);
+            tuple_field_next(&field);
+            TEST_CHECK_EQ(*(const u32 *) tuple_field_read(&field), j);
+        }
+    }
+    bitmap_free(seen);
+
+    free(producers);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+void check_allocator(void)
+{
+    id_allocator_t allocator;
+    u32 ids[10];
+    id_allocator_create(&allocator);
+    id_allocator_bind(ids, &allocator, 10);
+    for (size_t i = 0; i < 10; i++) {
+        TEST_CHECK_EQ(ids[i], i);
+    }
+
+    // Released identifiers are bound before never used ones
+    u32 released[] = { 4, 3 };
+    id_allocator_release(&allocator, released, 2);
+    id_allocator_bind(ids, &allocator, 3);
+    TEST_CHECK_EQ(ids[0], 3);
+    TEST_CHECK_EQ(ids[1], 4);
+    TEST_CHECK_EQ(ids[2], 10);
+    TEST_CHECK_EQ(id_allocator_high_water(&allocator), 11);
+    id_allocator_dispose(&allocator);
+}
+
+void *insert(void *arg)
+{
+    producer_t *producer = arg;
+    size_t ninserted = 0;
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        // Batch sizes vary between threads and rounds, but sum up to THREAD_TUPLES per thread
+        size_t nbatch = (round % 2 == producer->thread_id % 2 ? round / 2 + 1 : MAX_BATCH - round / 2);
+        tuple_cursor_t cursor;
+        grid_insert(&cursor, producer->table, nbatch);
+        TEST_CHECK_EQ(cursor.tuple_ids[nbatch - 1], cursor.tuple_ids[0] + nbatch - 1);
+
+        tuple_t tuple;
+        tuple_field_t field;
+        while (tuple_cursor_next(&tuple, &cursor)) {
+            u64 a = producer->thread_id;
+            u32 b = ninserted;
+            tuple_field_open(&field, &tuple);
+            tuple_field_write(&field, &a);
+            tuple_field_write(&field, &b);
+            producer->tuple_ids[ninserted++] = tuple.tuple_id;
+        }
+        tuple_cursor_dispose(&cursor);
+    }
+    TEST_CHECK_EQ(ninserted, THREAD_TUPLES);
+    return NULL;
+}
@@ -0,0 +1,117 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include <operators/select.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     1000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// G L O B A L S
+// ---------------------------------------------------------------------------------------------------------------------
+
+static const char *colors[] = { "red", "green", "blue", "yellow", "black" };
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void test_strings(enum frag_impl_type_t type, bool encoded);
+
+// Stores a column with few distinct strings plain and dictionary-encoded, and checks that reads and string
+// selections return the same results for both, also after deletion and compaction.
+int main(void) {
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM };
+    for (size_t i = 0; i < ARRAY_LEN_OF(types); i++) {
+        test_strings(types[i], false);
+        test_strings(types[i], true);
+    }
+    return EXIT_SUCCESS;
+}
+
+void test_strings(enum frag_impl_type_t type, bool encoded)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint32("id", schema);
+    attr_create_ex("color", FT_CHAR, 256, (encoded ? FLAG_DICTIONARY : 0) | FLAG_NULLABLE, schema);
+
+    frag_t *frag = frag_new(schema, 4, type);
+    tuplet_t tuplet;
+    frag_insert(&tuplet, frag, NUM_TUPLETS);
+    do {
+        tuplet_field_t field;
+        u32 id = tuplet.tuplet_id;
+        tuplet_field_open(&field, &tuplet);
+        tuplet_field_write(&field, &id, false);
+        tuplet_field_next(&field, false);
+        if (id % 7 == 0) {
+            tuplet_field_set_null(&field);
+        } else {
+            const char *color = colors[id % 5];
+            tuplet_field_update(&field, &color);
+        }
+    } while (tuplet_next(&tuplet));
+
+    // Encoded fields store a code instead of the string
+    TEST_CHECK((frag_dictionary(frag, 1) != NULL) == encoded);
+    if (encoded) {
+        TEST_CHECK(frag->tuplet_size < sizeof(u32) + 256);
+        TEST_CHECK_EQ(dict_size(frag_dictionary(frag, 1)), 5);
+    }
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_seek(&field, &tuplet, 1);
+        if (tuplet.tuplet_id % 7 != 0) {
+            TEST_CHECK(strcmp(tuplet_field_read(&field), colors[tuplet.tuplet_id % 5]) == 0);
+        }
+    } while (tuplet_next(&tuplet));
+
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < NUM_TUPLETS; tuplet_id += 10) {
+        tuplet_open(&tuplet, frag, tuplet_id);
+        tuplet_delete(&tuplet);
+    }
+
+    size_t expected_red = 0, expected_in = 0;
+    for (size_t i = 0; i < NUM_TUPLETS; i++) {
+        bool live = (i % 10 != 0 && i % 7 != 0);
+        expected_red += (live && i % 5 == 0);
+        expected_in += (live && (i % 5 == 0 || i % 5 == 2));
+    }
+    const char *in[] = { "blue", "red", "purple" };
+    bitmap_word_t *result = bitmap_new(NUM_TUPLETS, false);
+    TEST_CHECK_EQ(select_str_eq(result, frag, 1, "red"), expected_red);
+    TEST_CHECK_EQ(select_str_in(result, frag, 1, in, 3), expected_in);
+    TEST_CHECK_EQ(select_str_eq(result, frag, 1, "purple"), 0);
+
+    frag_compact(frag, NULL);
+    TEST_CHECK_EQ(frag->ntuplets, NUM_TUPLETS - NUM_TUPLETS / 10);
+    TEST_CHECK_EQ(select_str_eq(result, frag, 1, "red"), expected_red);
+
+    bitmap_free(result);
+    frag_delete(frag);
+    schema_delete(schema);
+}
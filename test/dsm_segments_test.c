@@ -0,0 +1,76 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_ROUNDS      20
+#define NUM_TUPLETS     500
+
+// Appends to a column-wise (DSM) fragment in many small rounds. Each column lives in its own segment, hence growing the
+// fragment must neither move column boundaries nor corrupt the values that were written before.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint16("b", schema);
+    attr_create_uint32("c", schema);
+
+    frag_t *frag = frag_new(schema, 1, FIT_HOST_DSM_VM);
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            tuplet_field_t field;
+            u64 a = tuplet.tuplet_id;
+            u16 b = tuplet.tuplet_id % 1000;
+            u32 c = 3 * tuplet.tuplet_id;
+            tuplet_field_open(&field, &tuplet);
+            tuplet_field_write(&field, &a, false);
+            tuplet_field_write(&field, &b, false);
+            tuplet_field_write(&field, &c, false);
+        } while (tuplet_next(&tuplet));
+
+        // Each attribute has a column segment of its own
+        void **columns = frag->tuplet_data;
+        TEST_CHECK(columns[0] != NULL && columns[1] != NULL && columns[2] != NULL);
+        TEST_CHECK(columns[0] != columns[1] && columns[1] != columns[2]);
+
+        // All values written in previous rounds survived the growth of the columns
+        tuplet_open(&tuplet, frag, 0);
+        do {
+            tuplet_field_t field;
+            tuplet_field_open(&field, &tuplet);
+            TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+            tuplet_field_next(&field, false);
+            TEST_CHECK_EQ(*(const u16 *) tuplet_field_read(&field), tuplet.tuplet_id % 1000);
+            tuplet_field_next(&field, false);
+            TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), 3 * tuplet.tuplet_id);
+        } while (tuplet_next(&tuplet));
+    }
+    TEST_CHECK_EQ(frag->ntuplets, NUM_ROUNDS * NUM_TUPLETS);
+
+    frag_delete(frag);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
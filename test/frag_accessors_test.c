@@ -0,0 +1,110 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag_accessors.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include <operators/select.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     5000
+
+// Writes through the typed accessors of NSM and DSM fragments, and checks that generic field reads, the gather
+// functions, NULL tracking and zone-map based selections all see the written values.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_ex("a", FT_UINT32, 1, FLAG_NULLABLE, schema);
+    attr_create_int64("b", schema);
+    attr_create_float64("c", schema);
+    attr_create_string("d", 8, schema);
+
+    frag_t *nsm = frag_new(schema, 10, FIT_HOST_NSM_VM);
+    frag_t *dsm = frag_new(schema, 10, FIT_HOST_DSM_VM);
+    frag_t *pax = frag_new(schema, 10, FIT_HOST_PAX_VM);
+    frag_t *seg = frag_new(schema, 10, FIT_HOST_NSM_SEG);
+    frag_insert(NULL, nsm, NUM_TUPLETS);
+    frag_insert(NULL, dsm, NUM_TUPLETS);
+
+    // Accessors apply only to their format and to attributes of matching type
+    TEST_CHECK(frag_nsm_uint32_supports(nsm, 0) && !frag_nsm_uint32_supports(nsm, 1));
+    TEST_CHECK(frag_nsm_int64_supports(nsm, 1) && !frag_nsm_int64_supports(nsm, 3));
+    TEST_CHECK(!frag_nsm_uint32_supports(dsm, 0) && !frag_nsm_uint32_supports(pax, 0));
+    TEST_CHECK(!frag_nsm_uint32_supports(seg, 0) && !frag_nsm_uint32_supports(nsm, 4));
+    TEST_CHECK(frag_dsm_float64_supports(dsm, 2) && !frag_dsm_float64_supports(nsm, 2));
+    TEST_CHECK(!frag_dsm_int32_supports(dsm, 0));
+
+    frag_set_null(nsm, 7, 0);
+    frag_set_null(dsm, 7, 0);
+    for (tuplet_id_t i = 0; i < NUM_TUPLETS; i++) {
+        frag_nsm_uint32_write(nsm, 0, i, i * 2);
+        frag_nsm_int64_write(nsm, 1, i, -(INT64) i);
+        frag_nsm_float64_write(nsm, 2, i, i / 4.0);
+        frag_dsm_uint32_write(dsm, 0, i, i * 2);
+        frag_dsm_int64_write(dsm, 1, i, -(INT64) i);
+        frag_dsm_float64_write(dsm, 2, i, i / 4.0);
+    }
+    TEST_CHECK(!frag_is_null(nsm, 7, 0) && !frag_is_null(dsm, 7, 0));
+
+    UINT32 *gathered = GS_REQUIRE_MALLOC(NUM_TUPLETS * sizeof(UINT32));
+    frag_t *frags[] = { nsm, dsm };
+    for (size_t f = 0; f < ARRAY_LEN_OF(frags); f++) {
+        frag_t *frag = frags[f];
+        tuplet_t tuplet;
+        tuplet_open(&tuplet, frag, 0);
+        do {
+            tuplet_field_t field;
+            tuplet_field_open(&field, &tuplet);
+            TEST_CHECK_EQ(*(const UINT32 *) tuplet_field_read(&field), tuplet.tuplet_id * 2);
+            tuplet_field_next(&field, false);
+            TEST_CHECK_EQ(*(const INT64 *) tuplet_field_read(&field), -(INT64) tuplet.tuplet_id);
+            tuplet_field_next(&field, false);
+            TEST_CHECK(*(const FLOAT64 *) tuplet_field_read(&field) == tuplet.tuplet_id / 4.0);
+        } while (tuplet_next(&tuplet));
+
+        if (frag->format == TF_NSM) {
+            frag_nsm_uint32_gather(gathered, frag, 0, 100, 1000);
+            TEST_CHECK_EQ(frag_nsm_int64_read(frag, 1, 42), -42);
+        } else {
+            frag_dsm_uint32_gather(gathered, frag, 0, 100, 1000);
+            TEST_CHECK_EQ(frag_dsm_uint32_column(frag, 0)[42], 84);
+            TEST_CHECK(frag_dsm_float64_read(frag, 2, 42) == 10.5);
+        }
+        for (size_t i = 0; i < 1000; i++) {
+            TEST_CHECK_EQ(gathered[i], (100 + i) * 2);
+        }
+
+        // Zone maps are maintained by accessor writes, hence selections find the written values
+        bitmap_word_t *result = bitmap_new(frag->ntuplets, false);
+        UINT32 lower = 1000, upper = 1999;
+        TEST_CHECK_EQ(select_int_between(result, frag, 0, &lower, &upper), 500);
+        TEST_CHECK(bitmap_test(result, 500) && !bitmap_test(result, 1000));
+        bitmap_free(result);
+    }
+
+    free(gathered);
+    frag_delete(nsm);
+    frag_delete(dsm);
+    frag_delete(pax);
+    frag_delete(seg);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <frag_allocator.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_ROUNDS      10
+#define NUM_TUPLETS     20000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void test_regions(frag_allocator_type_tag type);
+void test_fragment(frag_allocator_type_tag allocator, enum frag_impl_type_t type);
+
+// Checks that both allocators keep the contents of regions when they grow, that the huge-page aware allocator returns
+// cache-line aligned regions, and that fragments grow correctly on top of both.
+int main(void) {
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM };
+    for (frag_allocator_type_tag allocator = FATT_MALLOC; allocator <= FATT_HUGEPAGE; allocator++) {
+        test_regions(allocator);
+        for (size_t i = 0; i < ARRAY_LEN_OF(types); i++) {
+            test_fragment(allocator, types[i]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+void test_regions(frag_allocator_type_tag type)
+{
+    frag_allocator_t *allocator = frag_allocator_get(type);
+    TEST_CHECK(allocator->tag == type);
+
+    size_t size = 1000;
+    u8 *region = frag_allocator_alloc(allocator, size);
+    for (size_t i = 0; i < size; i++) {
+        region[i] = i % 251;
+    }
+    // Grows from a small region to one that is large enough for huge pages
+    for (size_t new_size = 4096; new_size <= (8 << 20); new_size *= 4) {
+        region = frag_allocator_realloc(allocator, region, size, new_size);
+        if (type == FATT_HUGEPAGE) {
+            TEST_CHECK((uintptr_t) region % 64 == 0);
+        }
+        for (size_t i = 0; i < 1000; i++) {
+            TEST_CHECK_EQ(region[i], i % 251);
+        }
+        size = new_size;
+    }
+    frag_allocator_free(allocator, region, size);
+}
+
+void test_fragment(frag_allocator_type_tag allocator, enum frag_impl_type_t type)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+
+    frag_t *frag = frag_new_ex(schema, 16, type, allocator);
+    TEST_CHECK(frag->allocator->tag == allocator);
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            tuplet_field_t field;
+            u64 a = tuplet.tuplet_id;
+            u32 b = 3 * tuplet.tuplet_id;
+            tuplet_field_open(&field, &tuplet);
+            tuplet_field_write(&field, &a, true);
+            tuplet_field_write(&field, &b, false);
+        } while (tuplet_next(&tuplet));
+    }
+
+    tuplet_t tuplet;
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), (u32) (3 * tuplet.tuplet_id));
+    } while (tuplet_next(&tuplet));
+
+    if (allocator == FATT_HUGEPAGE) {
+        const void *base = (type == FIT_HOST_DSM_VM ? ((void **) frag->tuplet_data)[0] : frag->tuplet_data);
+        TEST_CHECK((uintptr_t) base % 64 == 0);
+    }
+
+    frag_delete(frag);
+    schema_delete(schema);
+}
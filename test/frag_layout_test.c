@@ -0,0 +1,113 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     1000
+#define NUM_ATTRS       5
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void check_layout(frag_t *frag);
+
+// Checks that the precomputed layout matches the schema, and that seeking directly to any attribute reads the same
+// values as were written field by field, for every host fragment format.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint8("a", schema);
+    attr_create_uint64("b", schema);
+    attr_create_string("c", 12, schema);
+    attr_create_uint16("d", schema);
+    attr_create_uint32("e", schema);
+
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM, FIT_HOST_NSM_SEG };
+    for (size_t i = 0; i < ARRAY_LEN_OF(types); i++) {
+        frag_t *frag = frag_new(schema, 10, types[i]);
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            tuplet_field_t field;
+            tuplet_field_open(&field, &tuplet);
+            u8 a = tuplet.tuplet_id % 256;
+            u64 b = tuplet.tuplet_id * 3;
+            char c[12];
+            const char *str = c;
+            snprintf(c, sizeof(c), "s%u", tuplet.tuplet_id);
+            u16 d = tuplet.tuplet_id + 1;
+            u32 e = tuplet.tuplet_id * 7;
+            tuplet_field_write(&field, &a, true);
+            tuplet_field_write(&field, &b, true);
+            tuplet_field_write(&field, &str, true);
+            tuplet_field_write(&field, &d, true);
+            tuplet_field_write(&field, &e, false);
+        } while (tuplet_next(&tuplet));
+        check_layout(frag);
+        frag_delete(frag);
+    }
+
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+void check_layout(frag_t *frag)
+{
+    size_t offset = 0;
+    for (attr_id_t attr_id = 0; attr_id < NUM_ATTRS; attr_id++) {
+        const frag_field_layout_t *layout = frag_field_layout(frag, attr_id);
+        const attr_t *attr = schema_attr_by_id(frag->schema, attr_id);
+        TEST_CHECK(layout->attr == attr);
+        TEST_CHECK_EQ(layout->type, attr_type(attr));
+        TEST_CHECK_EQ(layout->size, attr_total_size(attr));
+        TEST_CHECK_EQ(layout->offset, offset);
+        TEST_CHECK_EQ(frag_field_type(frag, attr_id), attr_type(attr));
+        offset += layout->size;
+    }
+    TEST_CHECK_EQ(frag->layout->nattrs, NUM_ATTRS);
+    TEST_CHECK((frag->format == TF_PAX) == (frag->layout->page_ntuplets > 0));
+
+    // Visit the attributes in reverse order, such that every seek skips preceding attributes
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < NUM_TUPLETS; tuplet_id += 37) {
+        tuplet_t tuplet;
+        tuplet_field_t field;
+        char c[12];
+        snprintf(c, sizeof(c), "s%u", tuplet_id);
+        tuplet_open(&tuplet, frag, tuplet_id);
+        tuplet_field_seek(&field, &tuplet, 4);
+        TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), tuplet_id * 7);
+        TEST_CHECK_EQ(tuplet_field_size(&field), sizeof(u32));
+        tuplet_field_seek(&field, &tuplet, 3);
+        TEST_CHECK_EQ(*(const u16 *) tuplet_field_read(&field), tuplet_id + 1);
+        tuplet_field_seek(&field, &tuplet, 2);
+        TEST_CHECK(strcmp(tuplet_field_read(&field), c) == 0);
+        tuplet_field_seek(&field, &tuplet, 1);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet_id * 3);
+        TEST_CHECK(tuplet_field_next(&field, false));
+        TEST_CHECK(strcmp(tuplet_field_read(&field), c) == 0);
+        tuplet_field_seek(&field, &tuplet, 0);
+        TEST_CHECK_EQ(*(const u8 *) tuplet_field_read(&field), tuplet_id % 256);
+    }
+}
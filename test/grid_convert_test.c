@@ -0,0 +1,211 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <grid.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      5000
+#define NULL_STRIDE     5
+#define DELETE_STRIDE   11
+#define NUM_READERS     2
+#define NUM_CONVERSIONS 6
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+table_t *create_table(void);
+void check_table(const table_t *table);
+void check_pinned_relayout(table_t *table);
+void check_field_reads(table_t *table);
+void *read_fields(void *table);
+
+static atomic_bool stop;
+
+// Converts a grid between layouts while readers pin it through windows and tuple fields, and checks that values, NULL
+// values and deletion marks are kept, that the old fragment is freed once the readers are gone, and that values read
+// before a conversion stay valid.
+int main(void) {
+    table_t *table = create_table();
+    check_pinned_relayout(table);
+    check_field_reads(table);
+
+    // Readers proceed while the grid is converted in the background
+    pthread_t readers[NUM_READERS];
+    for (size_t i = 0; i < NUM_READERS; i++) {
+        pthread_create(readers + i, NULL, read_fields, table);
+    }
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_PAX_VM, FIT_HOST_DSM_VM };
+    for (size_t i = 0; i < NUM_CONVERSIONS; i++) {
+        future_t future = grid_convert(table, 0, types[i % ARRAY_LEN_OF(types)]);
+        future_wait_for(future);
+        TEST_CHECK_EQ(grid_by_id(table, 0)->frag->impl_type, types[i % ARRAY_LEN_OF(types)]);
+        check_table(table);
+    }
+    atomic_store(&stop, true);
+    for (size_t i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    TEST_CHECK(grid_reclaim((grid_t *) grid_by_id(table, 0)));
+
+    table_delete(table);
+    free(table);
+    return EXIT_SUCCESS;
+}
+
+table_t *create_table(void)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_ex("b", FT_UINT32, 1, FLAG_NULLABLE, schema);
+    attr_create_ex("s", FT_CHAR, 64, FLAG_VARLEN, schema);
+    table_t *table = table_new(schema, 1);
+    schema_delete(schema);
+    attr_id_t attr_ids[] = { 0, 1, 2 };
+    tuple_id_interval_t all = { 0, NUM_TUPLES };
+    table_add(table, attr_ids, 3, &all, 1, FIT_HOST_DSM_VM);
+
+    u64 *a = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+    u32 *b = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u32));
+    const char **s = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(char *));
+    char (*strings)[64] = GS_REQUIRE_MALLOC(NUM_TUPLES * 64);
+    for (size_t i = 0; i < NUM_TUPLES; i++) {
+        a[i] = i;
+        b[i] = 3 * i;
+        snprintf(strings[i], 64, "a string that does not fit into a tuple field %zu", i);
+        s[i] = strings[i];
+    }
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 0, a, NUM_TUPLES }, { 1, b, NUM_TUPLES }, { 2, s, NUM_TUPLES } };
+    table_insert_columns(&cursor, table, columns, 3);
+    tuple_cursor_dispose(&cursor);
+
+    frag_t *frag = grid_by_id(table, 0)->frag;
+    tuple_id_t deleted[NUM_TUPLES / DELETE_STRIDE + 1];
+    size_t ndeleted = 0;
+    for (tuple_id_t tuple_id = 0; tuple_id < NUM_TUPLES; tuple_id++) {
+        if (tuple_id % NULL_STRIDE == 0) {
+            frag_set_null(frag, tuple_id, 1);
+        }
+        if (tuple_id % DELETE_STRIDE == 0) {
+            deleted[ndeleted++] = tuple_id;
+        }
+    }
+    table_delete_tuples(table, deleted, ndeleted);
+
+    free(a);
+    free(b);
+    free(s);
+    free(strings);
+    return table;
+}
+
+void check_table(const table_t *table)
+{
+    frag_t *frag = grid_by_id(table, 0)->frag;
+    size_t nrows = 0;
+    table_window_t window;
+    tuple_id_t tuple_id;
+    char expected[64];
+    table_window_open(&window, table, NULL, 0, 0, NUM_TUPLES);
+    while (table_window_next(&window, &tuple_id)) {
+        TEST_CHECK(tuple_id % DELETE_STRIDE != 0);
+        TEST_CHECK_EQ(*(const u64 *) table_window_read(&window, 0), tuple_id);
+        const u32 *b = table_window_read(&window, 1);
+        TEST_CHECK((b == NULL) == (tuple_id % NULL_STRIDE == 0));
+        TEST_CHECK(b == NULL || *b == 3 * tuple_id);
+        snprintf(expected, sizeof(expected), "a string that does not fit into a tuple field %u", tuple_id);
+        TEST_CHECK(strcmp(table_window_read(&window, 2), expected) == 0);
+        nrows++;
+    }
+    table_window_close(&window);
+    TEST_CHECK_EQ(nrows, NUM_TUPLES - (NUM_TUPLES + DELETE_STRIDE - 1) / DELETE_STRIDE);
+    TEST_CHECK_EQ(frag_num_of_deleted(frag), NUM_TUPLES - nrows);
+}
+
+void check_pinned_relayout(table_t *table)
+{
+    grid_t *grid = (grid_t *) grid_by_id(table, 0);
+    table_window_t window;
+    tuple_id_t tuple_id;
+    table_window_open(&window, table, NULL, 0, 0, 100);
+    for (size_t i = 0; i < 10; i++) {
+        TEST_CHECK(table_window_next(&window, &tuple_id));
+    }
+
+    // The window pins the grid, hence the conversion does not wait for it to be closed and leaves the old fragment
+    TEST_CHECK(grid_relayout(grid, FIT_HOST_NSM_VM));
+    TEST_CHECK_EQ(grid->frag->impl_type, FIT_HOST_NSM_VM);
+    TEST_CHECK(vec_length(grid->retired) > 0);
+    TEST_CHECK(!grid_reclaim(grid));
+    while (table_window_next(&window, &tuple_id)) {
+        TEST_CHECK_EQ(*(const u64 *) table_window_read(&window, 0), tuple_id);
+    }
+    table_window_close(&window);
+    TEST_CHECK_EQ(vec_length(grid->retired), 0);
+
+    TEST_CHECK(!grid_relayout(grid, FIT_HOST_NSM_VM));
+    check_table(table);
+}
+
+void check_field_reads(table_t *table)
+{
+    tuple_t tuple;
+    tuple_field_t field;
+    tuple_open(&tuple, table, 7);
+    tuple_field_open(&field, &tuple);
+
+    // Numbers are copied into the field itself
+    const u64 *a = tuple_field_read(&field);
+    TEST_CHECK((const void *) a >= (const void *) &field && (const void *) a < (const void *) (&field + 1));
+    TEST_CHECK_EQ(*a, 7);
+
+    // Values read before a conversion remain valid, and reads after a conversion find the new fragment
+    tuple_field_seek(&field, &tuple, 2);
+    const char *s = tuple_field_read(&field);
+    TEST_CHECK(grid_relayout((grid_t *) grid_by_id(table, 0), FIT_HOST_PAX_VM));
+    TEST_CHECK(strcmp(s, "a string that does not fit into a tuple field 7") == 0);
+    tuple_field_seek(&field, &tuple, 1);
+    TEST_CHECK_EQ(*(const u32 *) tuple_field_read(&field), 21);
+    tuple_field_close(&field);
+}
+
+void *read_fields(void *table)
+{
+    for (tuple_id_t tuple_id = 1; !atomic_load(&stop); tuple_id = (tuple_id + 1) % NUM_TUPLES) {
+        if (tuple_id % DELETE_STRIDE == 0) {
+            continue;
+        }
+        tuple_t tuple;
+        tuple_field_t field;
+        tuple_open(&tuple, table, tuple_id);
+        tuple_field_open(&field, &tuple);
+        TEST_CHECK_EQ(*(const u64 *) tuple_field_read(&field), tuple_id);
+        tuple_field_seek(&field, &tuple, 2);
+        TEST_CHECK(strncmp(tuple_field_read(&field), "a string", 8) == 0);
+        tuple_field_close(&field);
+    }
+    return NULL;
+}
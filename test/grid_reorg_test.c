@@ -0,0 +1,230 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <grid.h>
+#include <grid_reorg.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      100000
+#define NUM_ATTRS       10
+#define NUM_READ_ROWS   40000
+#define NUM_MELTS       10
+#define WRITER_RANGE    1000
+#define UPDATE_DELTA    7
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+u64 expected(attr_id_t attr_id, tuple_id_t tuple_id);
+void check_write_latching(void);
+void read_rows(table_t *table, const attr_id_t *attr_ids, size_t nattr_ids, size_t row_offset, size_t limit);
+void melt(table_t *table, const tuple_id_t *tuple_ids, const attr_id_t *attr_ids, size_t nattr_ids);
+void *rewrite(void *table);
+
+static atomic_bool stop;
+
+// Runs a workload that reads the attributes of an NSM grid column by column and those of a DSM grid row by row, and
+// checks that the reorganizer converts both grids, keeps their contents, and does not block concurrent writers.
+int main(void) {
+    check_write_latching();
+
+    schema_t *schema = schema_new("test");
+    char name[16];
+    for (size_t i = 0; i < NUM_ATTRS; i++) {
+        snprintf(name, sizeof(name), "a%zu", i);
+        attr_create_uint64(name, schema);
+    }
+    table_t *table = table_new(schema, 3);
+    attr_id_t row_attrs[] = { 0, 1, 2, 3 }, column_attrs[] = { 4, 5, 6, 7 }, other_attrs[] = { 8, 9 };
+    tuple_id_interval_t all = { 0, NUM_TUPLES };
+    table_add(table, row_attrs, 4, &all, 1, FIT_HOST_NSM_VM);
+    table_add(table, column_attrs, 4, &all, 1, FIT_HOST_DSM_VM);
+    table_add(table, other_attrs, 2, &all, 1, FIT_HOST_NSM_VM);
+
+    tuple_cursor_t cursor;
+    u64 *values = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+    grid_insert(&cursor, table, NUM_TUPLES);
+    for (attr_id_t attr_id = 0; attr_id < NUM_ATTRS; attr_id++) {
+        for (tuple_id_t tuple_id = 0; tuple_id < NUM_TUPLES; tuple_id++) {
+            values[tuple_id] = expected(attr_id, tuple_id);
+        }
+        table_column_t column = { attr_id, values, NUM_TUPLES };
+        table_update_columns(table, cursor.tuple_ids, NUM_TUPLES, &column, 1);
+    }
+    tuple_id_t deleted[] = { 5, 77, 1234 };
+    table_delete_tuples(table, deleted, 3);
+
+    // Loading the table is not part of the workload
+    for (grid_id_t grid_id = 0; grid_id < table_num_of_grids(table); grid_id++) {
+        grid_monitor_decay((grid_monitor_t *) &grid_by_id(table, grid_id)->monitor, 63);
+    }
+    table_monitor_decay(&table->monitor, 63);
+
+    attr_id_t first[] = { 0 }, second[] = { 1, 2 }, rows[] = { 4, 5, 6, 7, 8, 9 };
+    for (size_t i = 0; i < 2; i++) {
+        melt(table, cursor.tuple_ids, first, 1);
+        melt(table, cursor.tuple_ids, second, 2);
+    }
+    read_rows(table, rows, 6, 0, NUM_READ_ROWS);
+
+    grid_reorg_t *reorg = grid_reorg_new(table, NULL);
+    TEST_CHECK_EQ(grid_reorg_run(reorg), 2);
+    TEST_CHECK_EQ(grid_by_id(table, 0)->frag->impl_type, FIT_HOST_DSM_VM);
+    TEST_CHECK_EQ(grid_by_id(table, 1)->frag->impl_type, FIT_HOST_NSM_VM);
+    TEST_CHECK_EQ(grid_by_id(table, 2)->frag->impl_type, FIT_HOST_NSM_VM);
+    TEST_CHECK(frag_is_deleted(grid_by_id(table, 0)->frag, 5) && frag_is_deleted(grid_by_id(table, 1)->frag, 1234));
+    vec_t *log = grid_reorg_log(reorg);
+    size_t nconverted = 0;
+    for (size_t i = 0; i < vec_length(log); i++) {
+        nconverted += (((const grid_reorg_entry_t *) vec_at(log, i))->action == GRID_REORG_CONVERT);
+    }
+    TEST_CHECK_EQ(nconverted, 2);
+    vec_free(log);
+
+    // Converted grids cool down before they are reconsidered
+    TEST_CHECK_EQ(grid_reorg_run(reorg), 0);
+
+    // The background reorganizer runs while a writer rewrites tuples through tuple fields
+    pthread_t writer;
+    grid_reorg_start(reorg, 5);
+    pthread_create(&writer, NULL, rewrite, table);
+    for (size_t i = 0; i < NUM_MELTS; i++) {
+        melt(table, cursor.tuple_ids, rows, 1);
+        read_rows(table, rows, 6, i * WRITER_RANGE, WRITER_RANGE);
+    }
+    atomic_store(&stop, true);
+    pthread_join(writer, NULL);
+    grid_reorg_stop(reorg);
+
+    attr_id_t attr_ids[NUM_ATTRS];
+    for (attr_id_t attr_id = 0; attr_id < NUM_ATTRS; attr_id++) {
+        attr_ids[attr_id] = attr_id;
+    }
+    read_rows(table, attr_ids, NUM_ATTRS, 0, NUM_TUPLES);
+
+    grid_reorg_delete(reorg);
+    tuple_cursor_dispose(&cursor);
+    free(values);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+u64 expected(attr_id_t attr_id, tuple_id_t tuple_id)
+{
+    return attr_id * 1000003ull + tuple_id;
+}
+
+void check_write_latching(void)
+{
+    schema_t *schema = schema_new("test");
+    for (size_t i = 0; i < 4; i++) {
+        attr_create_uint64("a", schema);
+    }
+    table_t *table = table_new(schema, 2);
+    attr_id_t left[] = { 0, 1, 2 }, right[] = { 3 };
+    tuple_id_interval_t all = { 0, 16 };
+    const grid_t *left_grid = grid_by_id(table, table_add(table, left, 3, &all, 1, FIT_HOST_NSM_VM));
+    const grid_t *right_grid = grid_by_id(table, table_add(table, right, 1, &all, 1, FIT_HOST_DSM_VM));
+
+    // Each grid is latched once per tuple, regardless of the number of attributes written into it
+    tuple_cursor_t cursor;
+    tuple_t tuple;
+    tuple_field_t field;
+    grid_insert(&cursor, table, 16);
+    u64 left_version = left_grid->latch.version, right_version = right_grid->latch.version;
+    while (tuple_cursor_next(&tuple, &cursor)) {
+        tuple_field_open(&field, &tuple);
+        for (attr_id_t attr_id = 0; attr_id < 4; attr_id++) {
+            u64 value = expected(attr_id, tuple.tuple_id);
+            tuple_field_write(&field, &value);
+        }
+    }
+    TEST_CHECK_EQ(left_grid->latch.version - left_version, 2 * 16);
+    TEST_CHECK_EQ(right_grid->latch.version - right_version, 2 * 16);
+
+    // A partially written tuple holds the latch until its field is closed
+    tuple_cursor_rewind(&cursor);
+    tuple_cursor_next(&tuple, &cursor);
+    tuple_field_open(&field, &tuple);
+    u64 value = 42;
+    tuple_field_write(&field, &value);
+    TEST_CHECK(left_grid->latch.version % 2 == 1);
+    tuple_field_close(&field);
+    TEST_CHECK(left_grid->latch.version % 2 == 0);
+    tuple_field_open(&field, &tuple);
+    TEST_CHECK_EQ(*(const u64 *) tuple_field_read(&field), 42);
+    tuple_field_next(&field);
+    TEST_CHECK_EQ(*(const u64 *) tuple_field_read(&field), expected(1, tuple.tuple_id));
+
+    tuple_cursor_dispose(&cursor);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+}
+
+void read_rows(table_t *table, const attr_id_t *attr_ids, size_t nattr_ids, size_t row_offset, size_t limit)
+{
+    table_window_t window;
+    tuple_id_t tuple_id;
+    table_window_open(&window, table, attr_ids, nattr_ids, row_offset, limit);
+    while (table_window_next(&window, &tuple_id)) {
+        for (size_t i = 0; i < nattr_ids; i++) {
+            const u64 *value = table_window_read(&window, i);
+            TEST_CHECK(value != NULL);
+            TEST_CHECK(*value == expected(attr_ids[i], tuple_id) ||
+                       *value == expected(attr_ids[i], tuple_id) + UPDATE_DELTA);
+        }
+    }
+    table_window_close(&window);
+}
+
+void melt(table_t *table, const tuple_id_t *tuple_ids, const attr_id_t *attr_ids, size_t nattr_ids)
+{
+    table_t *molten = table_melt(FIT_HOST_DSM_VM, table, tuple_ids, NUM_TUPLES, attr_ids, nattr_ids);
+    table_delete(molten);
+    free(molten);
+}
+
+void *rewrite(void *table)
+{
+    // Alternates the values of a range between two states that readers accept
+    for (size_t round = 0; !atomic_load(&stop); round++) {
+        for (tuple_id_t tuple_id = 0; tuple_id < WRITER_RANGE; tuple_id++) {
+            tuple_t tuple;
+            tuple_field_t field;
+            tuple_open(&tuple, table, tuple_id);
+            tuple_field_open(&field, &tuple);
+            tuple_field_seek(&field, &tuple, 4);
+            for (attr_id_t attr_id = 4; attr_id < 8; attr_id++) {
+                u64 value = expected(attr_id, tuple_id) + (round % 2 ? UPDATE_DELTA : 0);
+                tuple_field_write(&field, &value);
+            }
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include <containers/intpack.h>
+#include <operators/select.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     (5 * INTPACK_BLOCK_SIZE + 100)
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void test_blocks();
+void test_fragment();
+void check_block(const void *values, enum field_type type, enum intpack_scheme scheme);
+
+// Encodes blocks that favour each compression scheme and decodes them again, and compresses the integer columns of a
+// DSM fragment whose values and range selections must not change by compression.
+int main(void) {
+    test_blocks();
+    test_fragment();
+    return EXIT_SUCCESS;
+}
+
+void check_block(const void *values, enum field_type type, enum intpack_scheme scheme)
+{
+    size_t size = field_type_sizeof(type);
+    intpack_block_t *block = intpack_encode(values, INTPACK_BLOCK_SIZE, type);
+    TEST_CHECK_EQ(block->scheme, scheme);
+    TEST_CHECK(intpack_size(block) < INTPACK_BLOCK_SIZE * size);
+
+    char *decoded = GS_REQUIRE_MALLOC(INTPACK_BLOCK_SIZE * size);
+    intpack_decode(decoded, block, type);
+    TEST_CHECK(memcmp(decoded, values, INTPACK_BLOCK_SIZE * size) == 0);
+    for (size_t i = 0; i < INTPACK_BLOCK_SIZE; i += 7) {
+        u64 value = 0;
+        intpack_get(&value, block, i, type);
+        TEST_CHECK(memcmp(&value, (const char *) values + i * size, size) == 0);
+    }
+    free(decoded);
+    intpack_free(block);
+}
+
+void test_blocks()
+{
+    s64 ascending[INTPACK_BLOCK_SIZE];
+    int32_t clustered[INTPACK_BLOCK_SIZE];
+    u16 small[INTPACK_BLOCK_SIZE];
+    for (size_t i = 0; i < INTPACK_BLOCK_SIZE; i++) {
+        ascending[i] = 3 * (s64) i - 500;
+        clustered[i] = 1000000 + (i * 7919) % 100;
+        small[i] = i % 13;
+    }
+    check_block(ascending, FT_INT64, IPS_DELTA);
+    check_block(clustered, FT_INT32, IPS_FOR);
+    check_block(small, FT_UINT16, IPS_BITPACK);
+}
+
+void test_fragment()
+{
+    schema_t *schema = schema_new("test");
+    attr_create_int32("id", schema);
+    attr_create_int64("big", schema);
+
+    frag_t *frag = frag_new(schema, 16, FIT_HOST_DSM_VM);
+    tuplet_t tuplet;
+    frag_insert(&tuplet, frag, NUM_TUPLETS);
+    do {
+        tuplet_field_t field;
+        int32_t id = tuplet.tuplet_id;
+        s64 big = (s64) (tuplet.tuplet_id * 2654435761ULL) % 100000;
+        tuplet_field_open(&field, &tuplet);
+        tuplet_field_write(&field, &id, true);
+        tuplet_field_write(&field, &big, false);
+    } while (tuplet_next(&tuplet));
+
+    int32_t lower = 1000, upper = 4999;
+    bitmap_word_t *before = bitmap_new(NUM_TUPLETS, false), *after = bitmap_new(NUM_TUPLETS, false);
+    size_t nselected = select_int_between(before, frag, 0, &lower, &upper);
+    TEST_CHECK_EQ(nselected, 4000);
+
+    TEST_CHECK(frag_compress(frag) > 0);
+    TEST_CHECK(frag_packed_column(frag, 0) != NULL);
+    TEST_CHECK_EQ(select_int_between(after, frag, 0, &lower, &upper), nselected);
+    TEST_CHECK(memcmp(before, after, bitmap_nwords(NUM_TUPLETS) * sizeof(bitmap_word_t)) == 0);
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const int32_t *) tuplet_field_read(&field), tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const s64 *) tuplet_field_read(&field), (s64) (tuplet.tuplet_id * 2654435761ULL) % 100000);
+    } while (tuplet_next(&tuplet));
+
+    // Updating a compressed tuplet keeps all other values
+    int32_t id = -1;
+    tuplet_open(&tuplet, frag, 10);
+    tuplet_field_t field;
+    tuplet_field_open(&field, &tuplet);
+    tuplet_field_update(&field, &id);
+    tuplet_open(&tuplet, frag, 11);
+    tuplet_field_open(&field, &tuplet);
+    TEST_CHECK_EQ(*(const int32_t *) tuplet_field_read(&field), 11);
+    tuplet_open(&tuplet, frag, 10);
+    tuplet_field_open(&field, &tuplet);
+    TEST_CHECK_EQ(*(const int32_t *) tuplet_field_read(&field), -1);
+
+    bitmap_free(before);
+    bitmap_free(after);
+    frag_delete(frag);
+    schema_delete(schema);
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_ROUNDS      5
+#define NUM_TUPLETS     100
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void fill(frag_t *frag);
+void check(frag_t *frag);
+
+// Fills a file-backed fragment that grows several times, re-opens the file and reads the tuplets back. State that the
+// file does not persist (deletion marks) is rejected for file-backed fragments, but not for anonymous ones.
+int main(void) {
+    char path[] = "/tmp/gs_mapped_frag_test_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_CHECK(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+
+    frag_t *frag = frag_new_mapped(schema, path, 4);
+    TEST_CHECK(frag->impl_type == FIT_HOST_NSM_MMAP);
+    fill(frag);
+    frag_flush(frag, 100, 300);
+    frag_flush_all(frag);
+    frag_delete(frag);
+
+    // The re-opened fragment keeps the tuplets of the file, whatever capacity is requested
+    frag = frag_new_mapped(schema, path, 1);
+    TEST_CHECK_EQ(frag->ntuplets, NUM_ROUNDS * NUM_TUPLETS);
+    check(frag);
+    TEST_CHECK_PANICS(frag_tuplet_delete(frag, 1));
+    frag_delete(frag);
+    unlink(path);
+
+    frag_t *anonymous = frag_new(schema, 10, FIT_HOST_NSM_MMAP);
+    fill(anonymous);
+    check(anonymous);
+    frag_tuplet_delete(anonymous, 1);
+    TEST_CHECK_EQ(frag_num_of_deleted(anonymous), 1);
+    frag_delete(anonymous);
+
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+void fill(frag_t *frag)
+{
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            tuplet_field_t field;
+            u64 a = tuplet.tuplet_id;
+            u32 b = 3 * tuplet.tuplet_id;
+            tuplet_field_open(&field, &tuplet);
+            tuplet_field_write(&field, &a, true);
+            tuplet_field_write(&field, &b, false);
+        } while (tuplet_next(&tuplet));
+    }
+}
+
+void check(frag_t *frag)
+{
+    tuplet_t tuplet;
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), 3 * tuplet.tuplet_id);
+    } while (tuplet_next(&tuplet));
+}
@@ -0,0 +1,111 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     300
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void null_round_trip(enum frag_impl_type_t type);
+
+// Writes NULL and non-NULL values into nullable columns field by field and row by row, and checks that the validity
+// bitmaps, the null counts and the values read back agree with what was written.
+int main(void) {
+    null_round_trip(FIT_HOST_NSM_VM);
+    null_round_trip(FIT_HOST_DSM_VM);
+    null_round_trip(FIT_HOST_PAX_VM);
+    return EXIT_SUCCESS;
+}
+
+void null_round_trip(enum frag_impl_type_t type)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_ex("a", FT_UINT64, 1, FLAG_NULLABLE, schema);
+    attr_create_uint32("b", schema);
+
+    frag_t *frag = frag_new(schema, 4, type);
+    tuplet_t tuplet;
+    frag_insert(&tuplet, frag, NUM_TUPLETS);
+
+    // Dense columns do not materialize a validity bitmap
+    TEST_CHECK(frag_validity(frag, 0) == NULL);
+
+    do {
+        tuplet_field_t field;
+        u64 a = tuplet.tuplet_id;
+        u32 b = 1;
+        tuplet_field_open(&field, &tuplet);
+        if (tuplet.tuplet_id % 3 == 0) {
+            tuplet_field_set_null(&field);
+        } else {
+            tuplet_field_update(&field, &a);
+        }
+        tuplet_field_next(&field, false);
+        tuplet_field_update(&field, &b);
+    } while (tuplet_next(&tuplet));
+
+    TEST_CHECK_EQ(frag_null_count(frag, 0), NUM_TUPLETS / 3);
+    TEST_CHECK_EQ(frag_null_count(frag, 1), 0);
+    TEST_CHECK(frag_validity(frag, 0) != NULL);
+    TEST_CHECK(frag_validity(frag, 1) == NULL);
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_open(&field, &tuplet);
+        bool is_null = (tuplet.tuplet_id % 3 == 0);
+        TEST_CHECK_EQ(tuplet_field_is_null(&field), is_null);
+        TEST_CHECK_EQ(frag_is_null(frag, tuplet.tuplet_id, 0), is_null);
+        if (!is_null) {
+            TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+        }
+    } while (tuplet_next(&tuplet));
+
+    // Overwriting a NULL field with a value makes it valid again
+    tuplet_field_t field;
+    u64 value = 42;
+    tuplet_open(&tuplet, frag, 0);
+    tuplet_field_open(&field, &tuplet);
+    tuplet_field_update(&field, &value);
+    TEST_CHECK(!frag_is_null(frag, 0, 0));
+    TEST_CHECK_EQ(frag_null_count(frag, 0), NUM_TUPLETS / 3 - 1);
+
+    // Writing an entire row does so as well
+    struct __attribute__((packed)) { u64 a; u32 b; } row = { 7, 8 };
+    tuplet_open(&tuplet, frag, 3);
+    TEST_CHECK(frag_is_null(frag, 3, 0));
+    tuplet._update(&tuplet, &row);
+    TEST_CHECK(!frag_is_null(frag, 3, 0));
+    TEST_CHECK_EQ(frag_null_count(frag, 0), NUM_TUPLETS / 3 - 2);
+    tuplet_open(&tuplet, frag, 3);
+    tuplet_field_open(&field, &tuplet);
+    TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), 7);
+
+    frag_delete(frag);
+    schema_delete(schema);
+}
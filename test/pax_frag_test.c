@@ -0,0 +1,94 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_ROUNDS      3
+#define NUM_TUPLETS     1000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void round_trip(enum frag_impl_type_t type);
+
+// Writes tuplets of mixed-size attributes into fragments that grow several times, and reads them back field by field.
+// The PAX fragment must behave exactly like the row-wise (NSM) and column-wise (DSM) ones.
+int main(void) {
+    round_trip(FIT_HOST_NSM_VM);
+    round_trip(FIT_HOST_DSM_VM);
+    round_trip(FIT_HOST_PAX_VM);
+    return EXIT_SUCCESS;
+}
+
+void round_trip(enum frag_impl_type_t type)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_string("c", 10, schema);
+    attr_create_uint16("d", schema);
+
+    // The initial capacity is tiny, such that each round grows the fragment
+    frag_t *frag = frag_new(schema, 3, type);
+    TEST_CHECK(frag->impl_type == type);
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            tuplet_field_t field;
+            u64 a = tuplet.tuplet_id;
+            u32 b = 2 * tuplet.tuplet_id;
+            char buffer[10];
+            snprintf(buffer, sizeof(buffer), "s%u", tuplet.tuplet_id);
+            const char *c = buffer;
+            u16 d = tuplet.tuplet_id % 60000;
+            tuplet_field_open(&field, &tuplet);
+            tuplet_field_write(&field, &a, false);
+            tuplet_field_write(&field, &b, false);
+            tuplet_field_write(&field, &c, false);
+            tuplet_field_write(&field, &d, false);
+        } while (tuplet_next(&tuplet));
+    }
+    TEST_CHECK_EQ(frag->ntuplets, NUM_ROUNDS * NUM_TUPLETS);
+
+    tuplet_t tuplet;
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        char expected[10];
+        snprintf(expected, sizeof(expected), "s%u", tuplet.tuplet_id);
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), 2 * tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK(strcmp(tuplet_field_read(&field), expected) == 0);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u16 *) tuplet_field_read(&field), tuplet.tuplet_id % 60000);
+    } while (tuplet_next(&tuplet));
+
+    frag_delete(frag);
+    schema_delete(schema);
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <containers/range_tree.h>
+#include <containers/id_allocator.h>
+#include <grid.h>
+#include <attr.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define UNIVERSE        4096
+#define NUM_OPERATIONS  100000
+#define NUM_IDS         100000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void check_tree(void);
+void check_allocator(void);
+void check_intervals(void);
+
+// Checks the range tree against a plain array, the coalescing of released identifiers, and the merging of adjacent
+// tuple id intervals of grids.
+int main(void) {
+    check_tree();
+    check_allocator();
+    check_intervals();
+    return EXIT_SUCCESS;
+}
+
+void check_tree(void)
+{
+    range_tree_t tree;
+    bool contained[UNIVERSE] = { false };
+    range_tree_create(&tree);
+    srand(7);
+    for (size_t op = 0; op < NUM_OPERATIONS; op++) {
+        if (rand() % 2) {
+            u64 begin = rand() % UNIVERSE, length = 1 + rand() % 16, end = min(begin + length, UNIVERSE);
+            bool disjoint = true;
+            for (u64 i = begin; i < end; i++) {
+                disjoint &= !contained[i];
+            }
+            TEST_CHECK_EQ(range_tree_insert(&tree, begin, end), disjoint);
+            for (u64 i = begin; disjoint && i < end; i++) {
+                contained[i] = true;
+            }
+        } else {
+            u64 begin, end, max_length = 1 + rand() % 32, first = 0;
+            while (first < UNIVERSE && !contained[first]) {
+                first++;
+            }
+            bool taken = range_tree_take_first(&begin, &end, &tree, max_length);
+            TEST_CHECK_EQ(taken, first < UNIVERSE);
+            if (taken) {
+                TEST_CHECK_EQ(begin, first);
+                TEST_CHECK(end > begin && end - begin <= max_length);
+                for (u64 i = begin; i < end; i++) {
+                    TEST_CHECK(contained[i]);
+                    contained[i] = false;
+                }
+            }
+        }
+
+        if (op % 997 == 0) {
+            // Adjacent ranges are merged, hence each run of contained integers is a single range
+            size_t num_elements = 0, num_ranges = 0;
+            for (size_t i = 0; i < UNIVERSE; i++) {
+                TEST_CHECK_EQ(range_tree_contains(&tree, i), contained[i]);
+                num_elements += contained[i];
+                num_ranges += (contained[i] && (i == 0 || !contained[i - 1]));
+            }
+            TEST_CHECK_EQ(tree.num_elements, num_elements);
+            TEST_CHECK_EQ(tree.num_ranges, num_ranges);
+        }
+    }
+    range_tree_dispose(&tree);
+}
+
+void check_allocator(void)
+{
+    id_allocator_t allocator;
+    u32 *ids = GS_REQUIRE_MALLOC(NUM_IDS * sizeof(u32));
+    id_allocator_create(&allocator);
+    id_allocator_bind(ids, &allocator, NUM_IDS);
+
+    // Identifiers released in any order coalesce into a single range, and are bound together again
+    for (size_t i = 0; i < NUM_IDS; i += 2) {
+        id_allocator_release(&allocator, ids + i, 1);
+    }
+    for (size_t i = 1; i < NUM_IDS; i += 2) {
+        id_allocator_release(&allocator, ids + i, 1);
+    }
+    TEST_CHECK_EQ(allocator.released.num_ranges, 1);
+    TEST_CHECK_EQ(allocator.released.num_elements, NUM_IDS);
+    id_allocator_bind(ids, &allocator, NUM_IDS);
+    for (size_t i = 0; i < NUM_IDS; i++) {
+        TEST_CHECK_EQ(ids[i], i);
+    }
+    TEST_CHECK_EQ(id_allocator_high_water(&allocator), NUM_IDS);
+
+    id_allocator_release_range(&allocator, 10, 20);
+    TEST_CHECK_PANICS(id_allocator_release_range(&allocator, 15, 25));
+    free(ids);
+    id_allocator_dispose(&allocator);
+}
+
+void check_intervals(void)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    table_t *table = table_new(schema, 1);
+    attr_id_t attr_id = 0;
+    tuple_id_interval_t intervals[] = { { 0, 10 }, { 10, 20 }, { 25, 30 }, { 30, 31 } };
+    const grid_t *grid = grid_by_id(table, table_add(table, &attr_id, 1, intervals, 4, FIT_HOST_NSM_VM));
+    TEST_CHECK_EQ(vec_length(grid->tuple_ids), 2);
+    const tuple_id_interval_t *merged = vec_begin(grid->tuple_ids);
+    TEST_CHECK(merged[0].begin == 0 && merged[0].end == 20 && merged[1].begin == 25 && merged[1].end == 31);
+    TEST_CHECK_EQ(grid->frag->ntuplets, 26);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_ROUNDS      30
+#define NUM_TUPLETS     5000
+
+// Grows a segmented NSM fragment over several segments and checks that the address of a tuplet written first never
+// changes, that the capacity is a multiple of the segment size, and that compaction keeps the order of the tuplets.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+
+    frag_t *frag = frag_new(schema, 10, FIT_HOST_NSM_SEG);
+    TEST_CHECK_EQ(frag->ncapacity % FRAG_SEGMENT_NTUPLETS, 0);
+
+    tuplet_t first;
+    tuplet_field_t field;
+    u64 a = 0;
+    u32 b = 0;
+    frag_insert(&first, frag, 1);
+    tuplet_field_open(&field, &first);
+    tuplet_field_write(&field, &a, true);
+    tuplet_field_write(&field, &b, false);
+    const void *address = first.attr_base;
+
+    for (size_t round = 0; round < NUM_ROUNDS; round++) {
+        tuplet_t tuplet;
+        frag_insert(&tuplet, frag, NUM_TUPLETS);
+        do {
+            a = tuplet.tuplet_id;
+            b = 3 * tuplet.tuplet_id;
+            tuplet_field_open(&field, &tuplet);
+            tuplet_field_write(&field, &a, true);
+            tuplet_field_write(&field, &b, false);
+        } while (tuplet_next(&tuplet));
+        TEST_CHECK_EQ(*(const u64 *) address, 0);
+    }
+    TEST_CHECK(frag->ncapacity > FRAG_SEGMENT_NTUPLETS);
+    TEST_CHECK_EQ(frag->ncapacity % FRAG_SEGMENT_NTUPLETS, 0);
+
+    tuplet_t tuplet;
+    tuplet_open(&tuplet, frag, 0);
+    TEST_CHECK(tuplet.attr_base == address);
+    do {
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), tuplet.tuplet_id);
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u32 *) tuplet_field_read(&field), 3 * tuplet.tuplet_id);
+    } while (tuplet_next(&tuplet));
+
+    size_t ntuplets = frag->ntuplets;
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < ntuplets; tuplet_id += 2) {
+        tuplet_open(&tuplet, frag, tuplet_id);
+        tuplet_delete(&tuplet);
+    }
+    frag_compact(frag, NULL);
+    TEST_CHECK_EQ(frag->ntuplets, ntuplets / 2);
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), 2 * tuplet.tuplet_id + 1);
+    } while (tuplet_next(&tuplet));
+
+    frag_delete(frag);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <math.h>
+#include <grid.h>
+#include <stats_catalog.h>
+#include <attr.h>
+#include <tuple_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      100000
+#define NUM_STRINGS     5000
+#define NULL_STRIDE     10
+#define NUM_CONVERSIONS 10
+#define WRITER_RANGE    1000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void check_close(double estimate, double exact, double tolerance);
+void *rewrite(void *table);
+
+static atomic_bool stop;
+
+// Builds statistics over a table whose attributes are spread over several grids, and checks exact counts, distinct
+// estimates and selectivities before and after the table is modified, also while writers and conversions run.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_int32("a0", schema);
+    attr_create_uint64("a1", schema);
+    attr_create_float64("a2", schema);
+    attr_create_ex("a3", FT_CHAR, 32, FLAG_VARLEN, schema);
+    attr_create_ex("a4", FT_INT64, 1, FLAG_NULLABLE, schema);
+    table_t *table = table_new(schema, 4);
+    attr_id_t numbers[] = { 0, 1, 2 }, others[] = { 3, 4 };
+    tuple_id_interval_t lower = { 0, NUM_TUPLES / 4 }, upper = { NUM_TUPLES / 4, NUM_TUPLES }, all = { 0, NUM_TUPLES };
+    table_add(table, numbers, 3, &lower, 1, FIT_HOST_NSM_VM);
+    table_add(table, numbers, 3, &upper, 1, FIT_HOST_DSM_VM);
+    table_add(table, others, 2, &all, 1, FIT_HOST_DSM_VM);
+
+    int32_t *a0 = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(int32_t));
+    u64 *a1 = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+    double *a2 = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(double));
+    const char **a3 = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(char *));
+    s64 *a4 = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(s64));
+    char (*strings)[16] = GS_REQUIRE_MALLOC(NUM_TUPLES * 16);
+    tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(tuple_id_t));
+    for (size_t i = 0; i < NUM_TUPLES; i++) {
+        a0[i] = (int32_t) (i % 1000) - 500;
+        a1[i] = i;
+        a2[i] = (double) ((i * 7919) % NUM_TUPLES) / NUM_TUPLES;
+        snprintf(strings[i], 16, "s%zu", i % NUM_STRINGS);
+        a3[i] = strings[i];
+        a4[i] = i % 100;
+        tuple_ids[i] = i;
+    }
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 0, a0, NUM_TUPLES }, { 1, a1, NUM_TUPLES }, { 2, a2, NUM_TUPLES },
+                                 { 3, a3, NUM_TUPLES }, { 4, a4, NUM_TUPLES } };
+    table_insert_columns(&cursor, table, columns, 5);
+    tuple_cursor_dispose(&cursor);
+    for (tuple_id_t tuple_id = 0; tuple_id < NUM_TUPLES; tuple_id += NULL_STRIDE) {
+        frag_set_null(grid_by_id(table, 2)->frag, tuple_id, 1);
+    }
+
+    stats_catalog_t *catalog = stats_catalog_new(table);
+    column_stats_t stats;
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 1));
+    TEST_CHECK_EQ(stats.nrows, NUM_TUPLES);
+    TEST_CHECK_EQ(stats.nnulls, 0);
+    TEST_CHECK_EQ(stats.ngrids, 2);
+    check_close(column_stats_distinct(&stats), NUM_TUPLES, 0.05 * NUM_TUPLES);
+    u64 lower_key = NUM_TUPLES / 10, upper_key = NUM_TUPLES / 10 + NUM_TUPLES / 4 - 1;
+    check_close(column_stats_range_selectivity(&stats, &lower_key, &upper_key), 0.25, 0.02);
+
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 0));
+    int32_t value = 7, out_of_range = 100000, lower_int = -500, upper_int = -251;
+    check_close(column_stats_eq_selectivity(&stats, &value), 0.001, 0.0005);
+    check_close(column_stats_eq_selectivity(&stats, &out_of_range), 0, 0.0001);
+    check_close(column_stats_range_selectivity(&stats, &lower_int, &upper_int), 0.25, 0.02);
+
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 2));
+    double lower_float = 0.1, upper_float = 0.3;
+    check_close(column_stats_range_selectivity(&stats, &lower_float, &upper_float), 0.2, 0.02);
+
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 4));
+    TEST_CHECK_EQ(stats.nrows, NUM_TUPLES);
+    TEST_CHECK_EQ(stats.nnulls, NUM_TUPLES / NULL_STRIDE);
+    // The values replaced by NULL were added to the sketch when they were written
+    check_close(column_stats_distinct(&stats), 100, 5);
+
+    // Statistics of a single grid, which do not exist for attributes that the grid does not cover
+    TEST_CHECK(stats_catalog_grid_column(&stats, catalog, 0, 1));
+    TEST_CHECK_EQ(stats.nrows, NUM_TUPLES / 4);
+    TEST_CHECK_EQ(stats.ngrids, 1);
+    TEST_CHECK(!stats_catalog_grid_column(&stats, catalog, 2, 1));
+
+    // Overwritten and deleted values remain in the sketches until the grid is rescanned
+    for (size_t i = 0; i < NUM_TUPLES / 2; i++) {
+        a1[i] = 1000000 + i % 10;
+    }
+    table_column_t update = { 1, a1, NUM_TUPLES / 2 };
+    table_update_columns(table, tuple_ids, NUM_TUPLES / 2, &update, 1);
+    table_delete_tuples(table, tuple_ids + NUM_TUPLES / 2, NUM_TUPLES / 10);
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 1));
+    TEST_CHECK(stats.nchanges > 0);
+    TEST_CHECK(stats_catalog_refresh(catalog, false) > 0);
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 1));
+    TEST_CHECK_EQ(stats.nchanges, 0);
+    TEST_CHECK_EQ(stats.nrows, NUM_TUPLES - NUM_TUPLES / 10);
+    check_close(column_stats_distinct(&stats), NUM_TUPLES / 2 - NUM_TUPLES / 10 + 10, 0.05 * NUM_TUPLES / 2);
+    u64 lower_updated = 1000000, upper_updated = 1000009;
+    check_close(column_stats_range_selectivity(&stats, &lower_updated, &upper_updated),
+                (double) (NUM_TUPLES / 2) / (NUM_TUPLES - NUM_TUPLES / 10), 0.02);
+    TEST_CHECK_EQ(stats_catalog_refresh(catalog, false), 0);
+
+    // The background refresher runs while grids are converted and written
+    pthread_t writer;
+    stats_catalog_start(catalog, 2);
+    pthread_create(&writer, NULL, rewrite, table);
+    for (size_t i = 0; i < NUM_CONVERSIONS; i++) {
+        future_wait_for(grid_convert(table, i % 3, (i % 2 ? FIT_HOST_NSM_VM : FIT_HOST_DSM_VM)));
+        TEST_CHECK(stats_catalog_column(&stats, catalog, 1));
+    }
+    atomic_store(&stop, true);
+    pthread_join(writer, NULL);
+    stats_catalog_stop(catalog);
+    stats_catalog_refresh(catalog, true);
+    TEST_CHECK(stats_catalog_column(&stats, catalog, 3));
+    TEST_CHECK_EQ(stats.nrows, NUM_TUPLES - NUM_TUPLES / 10);
+    check_close(column_stats_distinct(&stats), NUM_STRINGS + 1, 0.05 * NUM_STRINGS);
+
+    stats_catalog_delete(catalog);
+    free(a0);
+    free(a1);
+    free(a2);
+    free(a3);
+    free(a4);
+    free(strings);
+    free(tuple_ids);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+void check_close(double estimate, double exact, double tolerance)
+{
+    if (fabs(estimate - exact) > tolerance) {
+        fprintf(stderr, "estimate %g is not within %g of %g\n", estimate, tolerance, exact);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void *rewrite(void *table)
+{
+    const char *written = "written";
+    for (size_t round = 0; !atomic_load(&stop); round++) {
+        for (tuple_id_t tuple_id = 0; tuple_id < WRITER_RANGE; tuple_id++) {
+            tuple_t tuple;
+            tuple_field_t field;
+            tuple_open(&tuple, table, tuple_id);
+            tuple_field_open(&field, &tuple);
+            tuple_field_seek(&field, &tuple, 3);
+            tuple_field_write(&field, &written);
+            tuple_field_close(&field);
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_SMALL       3000
+#define NUM_LARGE       (2 * GRID_MELT_MIN_PARALLEL)
+#define NULL_STRIDE     7
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void melt_and_check(size_t ntuples, enum frag_impl_type_t type);
+
+// Melts tables whose attributes and tuples are spread over grids of different types into a single grid, on the
+// caller's thread for small melts and in parallel for large ones, and checks every value and NULL of the result.
+int main(void) {
+    melt_and_check(NUM_SMALL, FIT_HOST_NSM_VM);
+    melt_and_check(NUM_SMALL, FIT_HOST_DSM_VM);
+    melt_and_check(NUM_LARGE, FIT_HOST_DSM_VM);
+    melt_and_check(NUM_LARGE, FIT_HOST_PAX_VM);
+    return EXIT_SUCCESS;
+}
+
+void melt_and_check(size_t ntuples, enum frag_impl_type_t type)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_uint32("b", schema);
+    attr_create_ex("s", FT_CHAR, 24, FLAG_VARLEN, schema);
+    attr_create_ex("f", FT_FLOAT64, 1, FLAG_NULLABLE, schema);
+    table_t *table = table_new(schema, 4);
+    attr_id_t left[] = { 0, 2 }, right[] = { 1, 3 };
+    tuple_id_interval_t all = { 0, ntuples }, lower = { 0, ntuples / 2 }, upper = { ntuples / 2, ntuples };
+    table_add(table, left, 2, &all, 1, FIT_HOST_DSM_VM);
+    grid_id_t lower_grid = table_add(table, right, 2, &lower, 1, FIT_HOST_NSM_VM);
+    grid_id_t upper_grid = table_add(table, right, 2, &upper, 1, FIT_HOST_PAX_VM);
+
+    u64 *a = GS_REQUIRE_MALLOC(ntuples * sizeof(u64));
+    u32 *b = GS_REQUIRE_MALLOC(ntuples * sizeof(u32));
+    const char **s = GS_REQUIRE_MALLOC(ntuples * sizeof(char *));
+    double *f = GS_REQUIRE_MALLOC(ntuples * sizeof(double));
+    char (*strings)[24] = GS_REQUIRE_MALLOC(ntuples * 24);
+    for (size_t i = 0; i < ntuples; i++) {
+        a[i] = 3 * i;
+        b[i] = i + 7;
+        snprintf(strings[i], 24, (i % 2 ? "s%zu" : "a longer string %zu"), i);
+        s[i] = strings[i];
+        f[i] = i * 0.5;
+    }
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 0, a, ntuples }, { 1, b, ntuples }, { 2, s, ntuples }, { 3, f, ntuples } };
+    table_insert_columns(&cursor, table, columns, 4);
+    tuple_cursor_dispose(&cursor);
+    for (tuple_id_t tuple_id = 0; tuple_id < ntuples; tuple_id += NULL_STRIDE) {
+        if (tuple_id < ntuples / 2) {
+            frag_set_null(grid_by_id(table, lower_grid)->frag, tuple_id, 1);
+        } else {
+            frag_set_null(grid_by_id(table, upper_grid)->frag, tuple_id - ntuples / 2, 1);
+        }
+    }
+
+    // Melt every other tuple in descending order, and the attributes in a different order than the table schema
+    size_t nmolten = ntuples / 2;
+    tuple_id_t *tuple_ids = GS_REQUIRE_MALLOC(nmolten * sizeof(tuple_id_t));
+    for (size_t i = 0; i < nmolten; i++) {
+        tuple_ids[i] = ntuples - 1 - 2 * i;
+    }
+    attr_id_t attr_ids[] = { 3, 0, 2 };
+    table_t *molten = table_melt(type, table, tuple_ids, nmolten, attr_ids, 3);
+    TEST_CHECK_EQ(table_num_of_grids(molten), 1);
+    frag_t *frag = grid_by_id(molten, 0)->frag;
+    TEST_CHECK_EQ(frag->ntuplets, nmolten);
+
+    tuplet_t tuplet;
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuple_id_t tuple_id = tuple_ids[tuplet.tuplet_id];
+        tuplet_field_t field;
+        tuplet_field_open(&field, &tuplet);
+        TEST_CHECK_EQ(tuplet_field_is_null(&field), tuple_id % NULL_STRIDE == 0);
+        if (tuple_id % NULL_STRIDE != 0) {
+            TEST_CHECK(*(const double *) tuplet_field_read(&field) == f[tuple_id]);
+        }
+        tuplet_field_next(&field, false);
+        TEST_CHECK_EQ(*(const u64 *) tuplet_field_read(&field), a[tuple_id]);
+        tuplet_field_next(&field, false);
+        TEST_CHECK(strcmp(tuplet_field_read(&field), s[tuple_id]) == 0);
+    } while (tuplet_next(&tuplet));
+
+    table_delete(molten);
+    free(molten);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    free(tuple_ids);
+    free(a);
+    free(b);
+    free(s);
+    free(f);
+    free(strings);
+}
@@ -0,0 +1,148 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLES      1000
+#define PAGE_SIZE       128
+#define NULL_STRIDE     9
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool is_deleted(tuple_id_t tuple_id);
+void check_pages(const table_t *table, bool skips_deleted);
+
+// Pages through a table whose tuples are split over two grids, and checks that windows visit the live tuples in order,
+// return NULL for NULL fields, and skip tuples that are deleted or that were removed by compaction.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    attr_create_ex("f", FT_FLOAT64, 1, FLAG_NULLABLE, schema);
+    attr_create_string("s", 16, schema);
+    table_t *table = table_new(schema, 2);
+    attr_id_t attr_ids[] = { 0, 1, 2 };
+    tuple_id_interval_t lower = { 0, NUM_TUPLES / 2 }, upper = { NUM_TUPLES / 2, NUM_TUPLES };
+    grid_id_t lower_grid = table_add(table, attr_ids, 3, &lower, 1, FIT_HOST_NSM_VM);
+    grid_id_t upper_grid = table_add(table, attr_ids, 3, &upper, 1, FIT_HOST_DSM_VM);
+
+    u64 *a = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(u64));
+    double *f = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(double));
+    const char **s = GS_REQUIRE_MALLOC(NUM_TUPLES * sizeof(char *));
+    char (*strings)[16] = GS_REQUIRE_MALLOC(NUM_TUPLES * 16);
+    for (size_t i = 0; i < NUM_TUPLES; i++) {
+        a[i] = i;
+        f[i] = i * 0.25;
+        snprintf(strings[i], 16, "row %zu", i);
+        s[i] = strings[i];
+    }
+    tuple_cursor_t cursor;
+    table_column_t columns[] = { { 0, a, NUM_TUPLES }, { 1, f, NUM_TUPLES }, { 2, s, NUM_TUPLES } };
+    table_insert_columns(&cursor, table, columns, 3);
+    tuple_cursor_dispose(&cursor);
+    for (tuple_id_t tuple_id = 0; tuple_id < NUM_TUPLES; tuple_id += NULL_STRIDE) {
+        if (tuple_id < NUM_TUPLES / 2) {
+            frag_set_null(grid_by_id(table, lower_grid)->frag, tuple_id, 1);
+        } else {
+            frag_set_null(grid_by_id(table, upper_grid)->frag, tuple_id - NUM_TUPLES / 2, 1);
+        }
+    }
+    check_pages(table, false);
+
+    tuple_id_t deleted[NUM_TUPLES];
+    size_t ndeleted = 0;
+    for (tuple_id_t tuple_id = 0; tuple_id < NUM_TUPLES; tuple_id++) {
+        if (is_deleted(tuple_id)) {
+            deleted[ndeleted++] = tuple_id;
+        }
+    }
+    table_delete_tuples(table, deleted, ndeleted);
+    check_pages(table, true);
+
+    // Compaction removes the deleted tuples from their grids
+    table_compact(table, 0.0f);
+    check_pages(table, true);
+
+    free(a);
+    free(f);
+    free(s);
+    free(strings);
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+bool is_deleted(tuple_id_t tuple_id)
+{
+    return ((tuple_id >= 10 && tuple_id < 20) || tuple_id == 499 || tuple_id == 500 || tuple_id == NUM_TUPLES - 1);
+}
+
+void check_pages(const table_t *table, bool skips_deleted)
+{
+    attr_id_t attr_ids[] = { 2, 1 };
+    tuple_id_t expected = 0;
+    size_t nrows = 0;
+    for (size_t row_offset = 0; ; row_offset += PAGE_SIZE) {
+        table_window_t window;
+        tuple_id_t tuple_id;
+        size_t npage = 0;
+        table_window_open(&window, table, attr_ids, 2, row_offset, PAGE_SIZE);
+        while (table_window_next(&window, &tuple_id)) {
+            while (skips_deleted && is_deleted(expected)) {
+                expected++;
+            }
+            TEST_CHECK_EQ(tuple_id, expected);
+            char name[16];
+            snprintf(name, sizeof(name), "row %u", tuple_id);
+            TEST_CHECK(strcmp(table_window_read(&window, 0), name) == 0);
+            const double *value = table_window_read(&window, 1);
+            TEST_CHECK((value == NULL) == (tuple_id % NULL_STRIDE == 0));
+            TEST_CHECK(value == NULL || *value == tuple_id * 0.25);
+            expected++;
+            npage++;
+        }
+
+        // A rewound window visits the same rows again
+        table_window_rewind(&window);
+        size_t nrewound = 0;
+        while (table_window_next(&window, &tuple_id)) {
+            nrewound++;
+        }
+        TEST_CHECK_EQ(nrewound, npage);
+        table_window_close(&window);
+
+        TEST_CHECK(npage <= PAGE_SIZE);
+        nrows += npage;
+        if (npage < PAGE_SIZE) {
+            break;
+        }
+    }
+    while (skips_deleted && expected < NUM_TUPLES && is_deleted(expected)) {
+        expected++;
+    }
+    TEST_CHECK_EQ(expected, NUM_TUPLES);
+    TEST_CHECK(nrows <= NUM_TUPLES);
+}
@@ -0,0 +1,61 @@
+// Assertions shared by the test programs of the storage engine
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <gs.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// M A C R O S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define TEST_CHECK(expr)                                                                                               \
+    do {                                                                                                               \
+        if (!(expr)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, to_string(expr));                       \
+            exit(EXIT_FAILURE);                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+#define TEST_CHECK_EQ(lhs, rhs)                                                                                        \
+    do {                                                                                                               \
+        long long _lhs = (long long) (lhs), _rhs = (long long) (rhs);                                                  \
+        if (_lhs != _rhs) {                                                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, to_string(lhs),     \
+                    to_string(rhs), _lhs, _rhs);                                                                       \
+            exit(EXIT_FAILURE);                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+// Runs the statement in a child process and checks that it does not return (i.e., a constraint is enforced by panic)
+#define TEST_CHECK_PANICS(stmt)                                                                                        \
+    do {                                                                                                               \
+        fflush(stdout);                                                                                                \
+        fflush(stderr);                                                                                                \
+        pid_t _pid = fork();                                                                                           \
+        if (_pid == 0) {                                                                                               \
+            if (freopen("/dev/null", "w", stderr) == NULL) { _exit(EXIT_SUCCESS); }                                   \
+            stmt;                                                                                                      \
+            _exit(EXIT_SUCCESS);                                                                                       \
+        }                                                                                                              \
+        int _status;                                                                                                   \
+        waitpid(_pid, &_status, 0);                                                                                    \
+        TEST_CHECK(!(WIFEXITED(_status) && WEXITSTATUS(_status) == EXIT_SUCCESS));                                     \
+    } while (0)
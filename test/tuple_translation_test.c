@@ -0,0 +1,108 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <grid.h>
+#include <attr.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_INTERVALS   200
+#define NUM_PROBES      5000
+#define NUM_BATCH       500
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+tuplet_id_t reference(const tuple_id_interval_t *intervals, size_t nintervals, tuple_id_t tuple_id);
+
+// Translates tuple ids of a grid with many intervals of different lengths, in ascending and random order, and in
+// batches, and compares the results against a linear scan over the intervals.
+int main(void) {
+    schema_t *schema = schema_new("test");
+    attr_create_uint64("a", schema);
+    table_t *table = table_new(schema, 1);
+
+    tuple_id_interval_t intervals[NUM_INTERVALS];
+    tuple_id_t end = 3;
+    for (size_t i = 0; i < NUM_INTERVALS; i++) {
+        intervals[i].begin = end;
+        intervals[i].end = end + 1 + (i * 7) % 13;
+        end = intervals[i].end + (i % 3);
+    }
+    attr_id_t attr_id = 0;
+    const grid_t *grid = grid_by_id(table, table_add(table, &attr_id, 1, intervals, NUM_INTERVALS, FIT_HOST_NSM_VM));
+
+    size_t ncovered = 0;
+    grid_translation_cache_t to_local = { 0 }, to_global = { 0 };
+    for (tuple_id_t tuple_id = 0; tuple_id < end + 5; tuple_id++) {
+        tuplet_id_t expected = reference(intervals, NUM_INTERVALS, tuple_id);
+        if (expected != GRID_TUPLET_NONE) {
+            TEST_CHECK_EQ(global_to_local(grid, tuple_id, &to_local), expected);
+            TEST_CHECK_EQ(local_to_global(grid, expected, &to_global), tuple_id);
+            ncovered++;
+        }
+    }
+    TEST_CHECK_EQ(ncovered, grid->frag->ntuplets);
+
+    // Random order defeats the translation cache
+    srand(42);
+    for (size_t i = 0; i < NUM_PROBES; i++) {
+        tuple_id_t tuple_id = rand() % end;
+        tuplet_id_t expected = reference(intervals, NUM_INTERVALS, tuple_id);
+        if (expected != GRID_TUPLET_NONE) {
+            TEST_CHECK_EQ(global_to_local(grid, tuple_id, &to_local), expected);
+            TEST_CHECK_EQ(local_to_global(grid, expected, NULL), tuple_id);
+        }
+    }
+
+    // Batches of ascending tuple ids mark uncovered tuples
+    tuple_id_t tuple_ids[NUM_BATCH];
+    tuplet_id_t tuplet_ids[NUM_BATCH];
+    size_t ntuple_ids = 0, nexpected = 0;
+    for (tuple_id_t tuple_id = 0; tuple_id < end + 5 && ntuple_ids < NUM_BATCH; tuple_id += 1 + rand() % 3) {
+        tuple_ids[ntuple_ids++] = tuple_id;
+    }
+    size_t nfound = grid_tuples_to_tuplets(tuplet_ids, grid, tuple_ids, ntuple_ids);
+    for (size_t i = 0; i < ntuple_ids; i++) {
+        tuplet_id_t expected = reference(intervals, NUM_INTERVALS, tuple_ids[i]);
+        TEST_CHECK_EQ(tuplet_ids[i], expected);
+        nexpected += (expected != GRID_TUPLET_NONE);
+    }
+    TEST_CHECK_EQ(nfound, nexpected);
+
+    table_delete(table);
+    free(table);
+    schema_delete(schema);
+    return EXIT_SUCCESS;
+}
+
+tuplet_id_t reference(const tuple_id_interval_t *intervals, size_t nintervals, tuple_id_t tuple_id)
+{
+    tuplet_id_t offset = 0;
+    for (size_t i = 0; i < nintervals; i++) {
+        if (tuple_id >= intervals[i].begin && tuple_id < intervals[i].end) {
+            return offset + (tuple_id - intervals[i].begin);
+        }
+        offset += intervals[i].end - intervals[i].begin;
+    }
+    return GRID_TUPLET_NONE;
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include <operators/select.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     2000
+#define NUM_WORDS       8
+
+// ---------------------------------------------------------------------------------------------------------------------
+// G L O B A L S
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Strings that fit into the header, that exceed it by a single byte, and long ones that share or miss a prefix
+static const char *words[NUM_WORDS] = {
+    "a", "abcdefghijk", "abcdefghijkl", "hello world, this is long", "hello there", "hellO", "", "zzzz"
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void test_strings(enum frag_impl_type_t type, bool varlen);
+size_t count_live(bool after_compaction, bool (*match)(size_t word));
+bool is_long_word(size_t word);
+bool is_in_word(size_t word);
+bool is_hello_word(size_t word);
+
+// Stores strings of various lengths as fixed-size slots and as variable-length headers, and checks reads and string
+// selections for both representations, before and after compaction.
+int main(void) {
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM, FIT_HOST_NSM_SEG };
+    for (size_t i = 0; i < ARRAY_LEN_OF(types); i++) {
+        test_strings(types[i], false);
+        test_strings(types[i], true);
+    }
+    return EXIT_SUCCESS;
+}
+
+bool is_long_word(size_t word)
+{
+    return (word == 2);
+}
+
+bool is_in_word(size_t word)
+{
+    return (word == 1 || word == 3 || word == 6);
+}
+
+bool is_hello_word(size_t word)
+{
+    return (word == 3 || word == 4);
+}
+
+size_t count_live(bool after_compaction, bool (*match)(size_t word))
+{
+    size_t count = 0;
+    for (size_t i = 0; i < NUM_TUPLETS; i++) {
+        bool live = (i % 9 != 0) && (!after_compaction || i % 2 == 1);
+        count += (live && match(i % NUM_WORDS));
+    }
+    return count;
+}
+
+void test_strings(enum frag_impl_type_t type, bool varlen)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_uint32("id", schema);
+    attr_create_ex("s", FT_CHAR, 1024, (varlen ? FLAG_VARLEN : 0) | FLAG_NULLABLE, schema);
+
+    frag_t *frag = frag_new(schema, 4, type);
+    tuplet_t tuplet;
+    frag_insert(&tuplet, frag, NUM_TUPLETS);
+    do {
+        tuplet_field_t field;
+        u32 id = tuplet.tuplet_id;
+        tuplet_field_open(&field, &tuplet);
+        tuplet_field_write(&field, &id, false);
+        tuplet_field_next(&field, false);
+        if (id % 9 == 0) {
+            tuplet_field_set_null(&field);
+        } else {
+            const char *word = words[id % NUM_WORDS];
+            tuplet_field_update(&field, &word);
+        }
+    } while (tuplet_next(&tuplet));
+
+    // A variable-length field occupies a 16-byte header instead of the entire slot
+    TEST_CHECK_EQ(frag->tuplet_size, sizeof(u32) + (varlen ? 16 : 1024));
+
+    tuplet_open(&tuplet, frag, 0);
+    do {
+        tuplet_field_t field;
+        tuplet_field_seek(&field, &tuplet, 1);
+        if (tuplet.tuplet_id % 9 != 0) {
+            TEST_CHECK(strcmp(tuplet_field_read(&field), words[tuplet.tuplet_id % NUM_WORDS]) == 0);
+        }
+    } while (tuplet_next(&tuplet));
+
+    const char *in[] = { "abcdefghijk", "hello world, this is long", "nope", "" };
+    bitmap_word_t *result = bitmap_new(NUM_TUPLETS, false);
+    TEST_CHECK_EQ(select_str_eq(result, frag, 1, "abcdefghijkl"), count_live(false, is_long_word));
+    TEST_CHECK_EQ(select_str_in(result, frag, 1, in, 4), count_live(false, is_in_word));
+    TEST_CHECK_EQ(select_str_prefix(result, frag, 1, "hello "), count_live(false, is_hello_word));
+
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < NUM_TUPLETS; tuplet_id += 2) {
+        tuplet_open(&tuplet, frag, tuplet_id);
+        tuplet_delete(&tuplet);
+    }
+    frag_compact(frag, NULL);
+    TEST_CHECK_EQ(frag->ntuplets, NUM_TUPLETS / 2);
+    TEST_CHECK_EQ(select_str_eq(result, frag, 1, "abcdefghijkl"), count_live(true, is_long_word));
+    TEST_CHECK_EQ(select_str_in(result, frag, 1, in, 4), count_live(true, is_in_word));
+    TEST_CHECK_EQ(select_str_prefix(result, frag, 1, "hello "), count_live(true, is_hello_word));
+
+    tuplet_open(&tuplet, frag, frag->ntuplets - 1);
+    tuplet_field_t field;
+    tuplet_field_seek(&field, &tuplet, 1);
+    TEST_CHECK(strcmp(tuplet_field_read(&field), words[(NUM_TUPLETS - 1) % NUM_WORDS]) == 0);
+
+    bitmap_free(result);
+    frag_delete(frag);
+    schema_delete(schema);
+}
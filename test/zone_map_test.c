@@ -0,0 +1,116 @@
+// Copyright (C) 2017 Marcus Pinnecke
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation, either user_port 3 of the License, or
+// (at your option) any later user_port.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// I N C L U D E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+#include <frag.h>
+#include <attr.h>
+#include <tuplet_field.h>
+#include <operators/select.h>
+#include "test.h"
+
+// ---------------------------------------------------------------------------------------------------------------------
+// C O N F I G
+// ---------------------------------------------------------------------------------------------------------------------
+
+#define NUM_TUPLETS     10000
+#define TS_BASE         1000
+
+// ---------------------------------------------------------------------------------------------------------------------
+// H E L P E R   P R O T O T Y P E S
+// ---------------------------------------------------------------------------------------------------------------------
+
+void test_zones(enum frag_impl_type_t type);
+bool zone_is(const frag_zone_t *zone, s64 min, s64 max);
+
+// Fills an ascending timestamp column and a nullable float column, and checks the zone map entries of both, the blocks
+// that a range selection has to visit, and the entries after compaction.
+int main(void) {
+    enum frag_impl_type_t types[] = { FIT_HOST_NSM_VM, FIT_HOST_DSM_VM, FIT_HOST_PAX_VM, FIT_HOST_NSM_SEG };
+    for (size_t i = 0; i < ARRAY_LEN_OF(types); i++) {
+        test_zones(types[i]);
+    }
+    return EXIT_SUCCESS;
+}
+
+bool zone_is(const frag_zone_t *zone, s64 min, s64 max)
+{
+    return (zone->min == frag_zone_key(FT_INT64, &min) && zone->max == frag_zone_key(FT_INT64, &max));
+}
+
+void test_zones(enum frag_impl_type_t type)
+{
+    schema_t *schema = schema_new("test");
+    attr_create_int64("ts", schema);
+    attr_create_ex("v", FT_FLOAT64, 1, FLAG_NULLABLE, schema);
+
+    frag_t *frag = frag_new(schema, 8, type);
+    tuplet_t tuplet;
+    frag_insert(&tuplet, frag, NUM_TUPLETS);
+    do {
+        tuplet_field_t field;
+        s64 ts = TS_BASE + tuplet.tuplet_id;
+        double v = -5.0 + 0.5 * tuplet.tuplet_id;
+        tuplet_field_open(&field, &tuplet);
+        tuplet_field_write(&field, &ts, true);
+        if (tuplet.tuplet_id % 3 == 0) {
+            tuplet_field_set_null(&field);
+        } else {
+            tuplet_field_update(&field, &v);
+        }
+    } while (tuplet_next(&tuplet));
+
+    size_t nzones = frag_num_of_zones(frag);
+    TEST_CHECK_EQ(nzones, (NUM_TUPLETS + FRAG_ZONE_NTUPLETS - 1) / FRAG_ZONE_NTUPLETS);
+    TEST_CHECK(zone_is(frag_zone(frag, 0, 0), TS_BASE, TS_BASE + FRAG_ZONE_NTUPLETS - 1));
+    TEST_CHECK(zone_is(frag_zone(frag, 0, 9), TS_BASE + 9 * FRAG_ZONE_NTUPLETS, TS_BASE + NUM_TUPLETS - 1));
+
+    // Null values do not widen the bounds, but are counted
+    double v_min = -4.5;
+    TEST_CHECK_EQ(frag_zone(frag, 1, 0)->min, frag_zone_key(FT_FLOAT64, &v_min));
+    TEST_CHECK_EQ(frag_zone(frag, 1, 0)->null_count, (FRAG_ZONE_NTUPLETS + 2) / 3);
+
+    // A narrow range overlaps a single block, which contains all matches
+    s64 lower = TS_BASE + 5000, upper = TS_BASE + 5100;
+    size_t noverlapping = 0;
+    for (size_t block_id = 0; block_id < nzones; block_id++) {
+        noverlapping += frag_zone_overlaps(frag, 0, block_id, &lower, &upper);
+    }
+    TEST_CHECK_EQ(noverlapping, 1);
+    bitmap_word_t *result = bitmap_new(NUM_TUPLETS, false);
+    TEST_CHECK_EQ(select_int_between(result, frag, 0, &lower, &upper), 101);
+    TEST_CHECK(bitmap_test(result, 5000) && bitmap_test(result, 5100) && !bitmap_test(result, 5101));
+
+    // Updates widen the entry of their block, but never narrow it
+    s64 ts = -77;
+    tuplet_field_t field;
+    tuplet_open(&tuplet, frag, NUM_TUPLETS - 1);
+    tuplet_field_open(&field, &tuplet);
+    tuplet_field_update(&field, &ts);
+    TEST_CHECK(zone_is(frag_zone(frag, 0, nzones - 1), -77, TS_BASE + NUM_TUPLETS - 1));
+
+    // Compaction moves the tuplets and recomputes the entries
+    for (tuplet_id_t tuplet_id = 0; tuplet_id < NUM_TUPLETS; tuplet_id += 2) {
+        tuplet_open(&tuplet, frag, tuplet_id);
+        tuplet_delete(&tuplet);
+    }
+    frag_compact(frag, NULL);
+    TEST_CHECK(zone_is(frag_zone(frag, 0, 0), TS_BASE + 1, TS_BASE + 2 * FRAG_ZONE_NTUPLETS - 1));
+
+    bitmap_free(result);
+    frag_delete(frag);
+    schema_delete(schema);
+}